@@ -10,6 +10,7 @@
 #include "memory.h"
 #include "functional.h"
 #include "exceptdef.h"
+#include "simd.h"
 
 namespace mystl
 {
@@ -140,6 +141,7 @@ struct char_traits<wchar_t>
 };
 
 // Partialized. char_traits<char16_t>
+// length、compare 和 fill 使用 simd.h 中的向量化内核，copy 和 move 使用 memcpy / memmove
 template <>
 struct char_traits<char16_t>
 {
@@ -147,61 +149,33 @@ struct char_traits<char16_t>
 
   static size_t length(const char_type* str) noexcept
   {
-    size_t len = 0;
-    for (; *str != char_type(0); ++str)
-      ++len;
-    return len;
+    return mystl::simd_length(str);
   }
 
   static int compare(const char_type* s1, const char_type* s2, size_t n) noexcept
   {
-    for (; n != 0; --n, ++s1, ++s2)
-    {
-      if (*s1 < *s2)
-        return -1;
-      if (*s2 < *s1)
-        return 1;
-    }
-    return 0;
+    return mystl::simd_compare(s1, s2, n);
   }
 
   static char_type* copy(char_type* dst, const char_type* src, size_t n) noexcept
   {
     MYSTL_DEBUG(src + n <= dst || dst + n <= src);
-    char_type* r = dst;
-    for (; n != 0; --n, ++dst, ++src)
-      *dst = *src;
-    return r;
+    return static_cast<char_type*>(std::memcpy(dst, src, n * sizeof(char_type)));
   }
 
   static char_type* move(char_type* dst, const char_type* src, size_t n) noexcept
   {
-    char_type* r = dst;
-    if (dst < src)
-    {
-      for (; n != 0; --n, ++dst, ++src)
-        *dst = *src;
-    }
-    else if (src < dst)
-    {
-      dst += n;
-      src += n;
-      for (; n != 0; --n)
-        *--dst = *--src;
-    }
-    return r;
+    return static_cast<char_type*>(std::memmove(dst, src, n * sizeof(char_type)));
   }
 
   static char_type* fill(char_type* dst, char_type ch, size_t count) noexcept
   {
-    char_type* r = dst;
-    for (; count > 0; --count, ++dst)
-      *dst = ch;
-    return r;
+    return mystl::simd_fill(dst, ch, count);
   }
 };
 
 // Partialized. char_traits<char32_t>
+// length、compare 和 fill 使用 simd.h 中的向量化内核，copy 和 move 使用 memcpy / memmove
 template <>
 struct char_traits<char32_t>
 {
@@ -209,57 +183,28 @@ struct char_traits<char32_t>
 
   static size_t length(const char_type* str) noexcept
   {
-    size_t len = 0;
-    for (; *str != char_type(0); ++str)
-      ++len;
-    return len;
+    return mystl::simd_length(str);
   }
 
   static int compare(const char_type* s1, const char_type* s2, size_t n) noexcept
   {
-    for (; n != 0; --n, ++s1, ++s2)
-    {
-      if (*s1 < *s2)
-        return -1;
-      if (*s2 < *s1)
-        return 1;
-    }
-    return 0;
+    return mystl::simd_compare(s1, s2, n);
   }
 
   static char_type* copy(char_type* dst, const char_type* src, size_t n) noexcept
   {
     MYSTL_DEBUG(src + n <= dst || dst + n <= src);
-    char_type* r = dst;
-    for (; n != 0; --n, ++dst, ++src)
-      *dst = *src;
-    return r;
+    return static_cast<char_type*>(std::memcpy(dst, src, n * sizeof(char_type)));
   }
 
   static char_type* move(char_type* dst, const char_type* src, size_t n) noexcept
   {
-    char_type* r = dst;
-    if (dst < src)
-    {
-      for (; n != 0; --n, ++dst, ++src)
-        *dst = *src;
-    }
-    else if (src < dst)
-    {
-      dst += n;
-      src += n;
-      for (; n != 0; --n)
-        *--dst = *--src;
-    }
-    return r;
+    return static_cast<char_type*>(std::memmove(dst, src, n * sizeof(char_type)));
   }
 
   static char_type* fill(char_type* dst, char_type ch, size_t count) noexcept
   {
-    char_type* r = dst;
-    for (; count > 0; --count, ++dst)
-      *dst = ch;
-    return r;
+    return mystl::simd_fill(dst, ch, count);
   }
 };
 
@@ -2063,9 +2008,9 @@ void swap(basic_string<CharType, CharTraits>& lhs,
 template <class CharType, class CharTraits>
 struct hash<basic_string<CharType, CharTraits>>
 {
-  size_t operator()(const basic_string<CharType, CharTraits>& str)
+  size_t operator()(const basic_string<CharType, CharTraits>& str) const
   {
-    return bitwise_hash((const unsigned char*)str.c_str(),
+    return bitwise_hash((const unsigned char*)str.begin(),
                         str.size() * sizeof(CharType));
   }
 };
@@ -0,0 +1,341 @@
+﻿#ifndef MYTINYSTL_BLOOM_FILTER_H_
+#define MYTINYSTL_BLOOM_FILTER_H_
+
+// 这个头文件包含一个模板类 bloom_filter
+// bloom_filter : 分块的布隆过滤器，用于在查找大容器或外部存储之前快速排除不存在的键值
+
+// notes:
+//
+// 1. 位数组按 64 字节（一个缓存行）分块，每块 8 个 64 位的字；一个键值只落在一个块中，
+//    并在块内每个字里各置一位，所以插入与查询都只访问一个缓存行
+// 2. 键值先用 Hash（缺省为 mystl::hash）求哈希值，再用 bitwise_hash 的 wy_mix 派生出两个互不相关的
+//    64 位值：一个选块，一个给出 8 个 6 位的位号；mystl::hash 对整数是恒等映射，派生这一步不能省
+// 3. 有 SSE2 时，查询用 4 次 128 位的 andnot / or 一次检查整块，插入用 128 位的 or 写回
+// 4. 按预计的元素个数与目标假阳性率构造时，按分块后的实际假阳性率（块内键值个数服从泊松分布）选块数
+// 5. 只能插入不能删除；形状（块数）相同的两个过滤器可以按位或合并，合并后等价于插入了两者的全部键值
+//
+// 异常保证：
+// 合并形状不同的过滤器时抛出 std::runtime_error，过滤器不变
+
+#include <cmath>
+#include <cstring>
+
+#include "functional.h"
+#include "memory.h"
+#include "exceptdef.h"
+#include "simd.h"
+#include "util.h"
+
+namespace mystl
+{
+
+// 模板类 bloom_filter
+// 参数一代表键值类型，参数二代表哈希函数，缺省使用 mystl::hash
+template <class Key, class Hash = mystl::hash<Key>>
+class bloom_filter
+{
+public:
+  // bloom_filter 的型别定义
+  typedef Key                          key_type;
+  typedef Hash                         hasher;
+  typedef size_t                       size_type;
+  typedef mystl::allocator<uint64_t>   word_allocator;
+
+  static constexpr size_type block_words = 8;                              // 每块的字数
+  static constexpr size_type block_bytes = block_words * sizeof(uint64_t); // 每块的字节数，一个缓存行
+
+private:
+  uint64_t* raw_;          // 申请到的内存，多申请一块用于对齐
+  uint64_t* blocks_;       // 按 64 字节对齐的块起点
+  size_type block_count_;  // 块数
+  size_type size_;         // 插入的次数
+  hasher    hash_;
+
+public:
+  // 构造、复制、移动、析构函数
+
+  // 按预计的元素个数与目标假阳性率确定块数
+  explicit bloom_filter(size_type expected = 0, double fpp = 0.01, const Hash& hash = Hash())
+    :raw_(nullptr), blocks_(nullptr), block_count_(0), size_(0), hash_(hash)
+  {
+    THROW_RUNTIME_ERROR_IF(!(fpp > 0.0 && fpp < 1.0),
+                           "bloom_filter<Key>'s false positive rate must be in (0, 1)");
+    allocate_blocks(blocks_for(expected, fpp));
+  }
+
+  bloom_filter(const bloom_filter& rhs)
+    :raw_(nullptr), blocks_(nullptr), block_count_(0), size_(rhs.size_), hash_(rhs.hash_)
+  {
+    allocate_blocks(rhs.block_count_);
+    std::memcpy(blocks_, rhs.blocks_, block_count_ * block_bytes);
+  }
+  // 被移动的过滤器换成只有一个空块的过滤器，仍然可以插入与查询
+  bloom_filter(bloom_filter&& rhs)
+    :raw_(nullptr), blocks_(nullptr), block_count_(0), size_(0), hash_(rhs.hash_)
+  {
+    allocate_blocks(1);
+    swap(rhs);
+  }
+
+  bloom_filter& operator=(const bloom_filter& rhs)
+  {
+    if (this != &rhs)
+    {
+      bloom_filter tmp(rhs);
+      swap(tmp);
+    }
+    return *this;
+  }
+  bloom_filter& operator=(bloom_filter&& rhs) noexcept
+  {
+    swap(rhs);
+    return *this;
+  }
+
+  ~bloom_filter()
+  {
+    if (raw_ != nullptr)
+      word_allocator::deallocate(raw_, (block_count_ + 1) * block_words);
+  }
+
+public:
+  // 容量相关
+  bool      empty()       const noexcept { return size_ == 0; }
+  size_type size()        const noexcept { return size_; }
+  size_type block_count() const noexcept { return block_count_; }
+  size_type bit_count()   const noexcept { return block_count_ * block_bytes * 8; }
+  size_type bytes()       const noexcept { return block_count_ * block_bytes; }
+
+  // 插入与查询，contains 返回 false 时键值一定不存在，返回 true 时可能是假阳性
+  void insert(const key_type& key)         noexcept { insert_hash(hash_(key)); }
+  bool contains(const key_type& key) const noexcept { return contains_hash(hash_(key)); }
+
+  template <class InputIter>
+  void insert(InputIter first, InputIter last)
+  {
+    for (; first != last; ++first)
+      insert(*first);
+  }
+
+  // 直接使用已经算好的 Hash 结果，调用方已经有哈希值时可以省去一次计算
+  void insert_hash(size_t h) noexcept;
+  bool contains_hash(size_t h) const noexcept;
+
+  // 按位或合并形状相同的过滤器
+  void merge(const bloom_filter& other);
+  bloom_filter& operator|=(const bloom_filter& other)
+  {
+    merge(other);
+    return *this;
+  }
+
+  void clear() noexcept
+  {
+    std::memset(blocks_, 0, block_count_ * block_bytes);
+    size_ = 0;
+  }
+
+  void swap(bloom_filter& rhs) noexcept
+  {
+    mystl::swap(raw_, rhs.raw_);
+    mystl::swap(blocks_, rhs.blocks_);
+    mystl::swap(block_count_, rhs.block_count_);
+    mystl::swap(size_, rhs.size_);
+    mystl::swap(hash_, rhs.hash_);
+  }
+
+  // 以当前插入的次数估计的假阳性率
+  double estimated_fpp() const noexcept
+  { return block_fpp(static_cast<double>(size_) / static_cast<double>(block_count_)); }
+
+  hasher hash_fcn() const { return hash_; }
+
+  // 每块平均有 lambda 个键值时的假阳性率
+  static double    block_fpp(double lambda) noexcept;
+  // 插入 expected 个键值后假阳性率不超过 fpp 所需的最少块数
+  static size_type blocks_for(size_type expected, double fpp) noexcept;
+
+private:
+  // helper functions
+
+  void allocate_blocks(size_type count);
+
+  static uint64_t block_hash(size_t h) noexcept
+  { return wy_mix(static_cast<uint64_t>(h) ^ wy_secret[0], wy_secret[1]); }
+  static uint64_t bits_hash(uint64_t b) noexcept
+  { return wy_mix(b ^ wy_secret[2], wy_secret[3]); }
+
+  // 用 64 x 64 位乘积的高 64 位把哈希值映射到 [0, block_count_)，不需要取模
+  size_type block_index(uint64_t b) const noexcept
+  {
+    uint64_t lo = b, hi = static_cast<uint64_t>(block_count_);
+    wy_mum(lo, hi);
+    return static_cast<size_type>(hi);
+  }
+
+  // 块内每个字各置一位，位号取 bits 中相邻的 6 位
+  static void make_mask(uint64_t bits, uint64_t* mask) noexcept
+  {
+    for (size_type i = 0; i < block_words; ++i)
+      mask[i] = uint64_t(1) << ((bits >> (6 * i)) & 63);
+  }
+};
+
+/*****************************************************************************************/
+
+template <class Key, class Hash>
+constexpr typename bloom_filter<Key, Hash>::size_type bloom_filter<Key, Hash>::block_words;
+
+template <class Key, class Hash>
+constexpr typename bloom_filter<Key, Hash>::size_type bloom_filter<Key, Hash>::block_bytes;
+
+// 插入一个哈希值
+template <class Key, class Hash>
+void bloom_filter<Key, Hash>::
+insert_hash(size_t h) noexcept
+{
+  const auto b = block_hash(h);
+  uint64_t* block = blocks_ + block_index(b) * block_words;
+  alignas(16) uint64_t mask[block_words];
+  make_mask(bits_hash(b), mask);
+#ifdef MYSTL_HAS_SSE2
+  for (size_type i = 0; i < block_words; i += 2)
+  {
+    __m128i* p = reinterpret_cast<__m128i*>(block + i);
+    _mm_store_si128(p, _mm_or_si128(_mm_load_si128(p),
+                                    _mm_load_si128(reinterpret_cast<const __m128i*>(mask + i))));
+  }
+#else
+  for (size_type i = 0; i < block_words; ++i)
+    block[i] |= mask[i];
+#endif
+  ++size_;
+}
+
+// 查询一个哈希值，块内 8 个位都为 1 时才可能存在
+template <class Key, class Hash>
+bool bloom_filter<Key, Hash>::
+contains_hash(size_t h) const noexcept
+{
+  const auto b = block_hash(h);
+  const uint64_t* block = blocks_ + block_index(b) * block_words;
+  alignas(16) uint64_t mask[block_words];
+  make_mask(bits_hash(b), mask);
+#ifdef MYSTL_HAS_SSE2
+  // 收集 mask 中为 1 而块中为 0 的位，全为 0 才算命中
+  __m128i miss = _mm_setzero_si128();
+  for (size_type i = 0; i < block_words; i += 2)
+  {
+    miss = _mm_or_si128(miss, _mm_andnot_si128(
+      _mm_load_si128(reinterpret_cast<const __m128i*>(block + i)),
+      _mm_load_si128(reinterpret_cast<const __m128i*>(mask + i))));
+  }
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(miss, _mm_setzero_si128())) == 0xffff;
+#else
+  uint64_t miss = 0;
+  for (size_type i = 0; i < block_words; ++i)
+    miss |= mask[i] & ~block[i];
+  return miss == 0;
+#endif
+}
+
+// 合并形状相同的过滤器
+template <class Key, class Hash>
+void bloom_filter<Key, Hash>::
+merge(const bloom_filter& other)
+{
+  THROW_RUNTIME_ERROR_IF(block_count_ != other.block_count_,
+                         "bloom_filter<Key>'s merge needs filters of the same shape");
+  if (this == &other)
+    return;
+  const size_type n = block_count_ * block_words;
+#ifdef MYSTL_HAS_SSE2
+  for (size_type i = 0; i < n; i += 2)
+  {
+    __m128i* p = reinterpret_cast<__m128i*>(blocks_ + i);
+    _mm_store_si128(p, _mm_or_si128(_mm_load_si128(p),
+      _mm_load_si128(reinterpret_cast<const __m128i*>(other.blocks_ + i))));
+  }
+#else
+  for (size_type i = 0; i < n; ++i)
+    blocks_[i] |= other.blocks_[i];
+#endif
+  size_ += other.size_;
+}
+
+// 每块平均有 lambda 个键值时的假阳性率
+// 块内有 j 个键值时，一个字的某一位为 1 的概率为 1 - (63/64)^j，8 个字都命中才是假阳性；
+// j 服从均值为 lambda 的泊松分布，对 j 求期望
+template <class Key, class Hash>
+double bloom_filter<Key, Hash>::
+block_fpp(double lambda) noexcept
+{
+  if (lambda <= 0.0)
+    return 0.0;
+  if (lambda > 500.0)
+    return 1.0;
+  const double q = 63.0 / 64.0;
+  const size_type jmax = static_cast<size_type>(lambda + 12.0 * std::sqrt(lambda) + 30.0);
+  double p = std::exp(-lambda);  // 泊松分布的第 j 项
+  double qj = 1.0;               // q 的 j 次方
+  double fpp = 0.0;
+  for (size_type j = 0; j <= jmax; ++j)
+  {
+    fpp += p * std::pow(1.0 - qj, static_cast<double>(block_words));
+    p *= lambda / static_cast<double>(j + 1);
+    qj *= q;
+  }
+  return fpp < 1.0 ? fpp : 1.0;
+}
+
+// 假阳性率随块数单调下降，每块一个键值时约为 1.1e-11，更低的目标需要更多的块：
+// 上界从 expected 块起倍增到满足要求，再二分查找满足要求的最少块数；
+// 块数最多取到申请字节数不溢出的上限，目标低到上限也达不到时返回上限
+template <class Key, class Hash>
+typename bloom_filter<Key, Hash>::size_type
+bloom_filter<Key, Hash>::
+blocks_for(size_type expected, double fpp) noexcept
+{
+  if (expected == 0)
+    return 1;
+  const size_type max_blocks = static_cast<size_type>(-1) / block_bytes - 1;
+  size_type lo = 1, hi = mystl::min(expected, max_blocks);
+  while (block_fpp(static_cast<double>(expected) / static_cast<double>(hi)) > fpp)
+  {
+    if (hi == max_blocks)
+      return max_blocks;
+    lo = hi + 1;
+    hi = hi > max_blocks / 2 ? max_blocks : hi * 2;
+  }
+  while (lo < hi)
+  {
+    const size_type mid = lo + (hi - lo) / 2;
+    if (block_fpp(static_cast<double>(expected) / static_cast<double>(mid)) <= fpp)
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+  return lo;
+}
+
+// 申请 count 块清零的内存，起点按 64 字节对齐
+template <class Key, class Hash>
+void bloom_filter<Key, Hash>::
+allocate_blocks(size_type count)
+{
+  raw_ = word_allocator::allocate((count + 1) * block_words);
+  const auto addr = reinterpret_cast<uintptr_t>(raw_);
+  blocks_ = reinterpret_cast<uint64_t*>((addr + block_bytes - 1) & ~(uintptr_t)(block_bytes - 1));
+  block_count_ = count;
+  std::memset(blocks_, 0, count * block_bytes);
+}
+
+// 重载 mystl 的 swap
+template <class Key, class Hash>
+void swap(bloom_filter<Key, Hash>& lhs, bloom_filter<Key, Hash>& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+
+} // namespace mystl
+#endif // !MYTINYSTL_BLOOM_FILTER_H_
@@ -0,0 +1,1626 @@
+﻿#ifndef MYTINYSTL_BTREE_H_
+#define MYTINYSTL_BTREE_H_
+
+// 这个头文件包含一个模板类 btree
+// btree : B 树，每个节点连续存放多个元素，是 btree_map / btree_set 的底层实现
+
+// notes:
+//
+// 1. 节点的大小约为 256 字节（四个缓存行），元素按键值有序地放在节点内的数组中；
+//    内部节点另有 count + 1 个子节点指针。一次查找只访问 log(n) / log(节点元素数) 个节点
+// 2. 键值为算术类型且比较函数为 mystl::less / mystl::greater 时，节点内用无分支的计数循环查找，
+//    编译器可以向量化；其他情况在节点内二分查找
+// 3. 插入只发生在叶节点，节点满时分裂，中间的元素上移到父节点；在节点末尾插入导致的分裂
+//    只移出最后一个元素，所以按顺序插入时节点接近满
+// 4. 删除内部节点中的元素时，用它的前驱（叶节点中的最后一个元素）替换；节点中的元素少于一半时，
+//    与兄弟节点合并，或者从兄弟节点借一个元素
+// 5. 插入、删除元素都可能移动同一节点或相邻节点中的其他元素，使所有迭代器、指针和引用失效
+// 6. 元素直接存放在节点中，不提供节点句柄
+//
+// 异常保证：
+// mystl::btree<T> 满足基本异常保证，若元素的移动构造函数不抛出异常，插入操作满足强异常安全保证
+
+#include <initializer_list>
+
+#include <cstdint>
+#include <cstring>
+
+#include "algobase.h"
+#include "functional.h"
+#include "iterator.h"
+#include "memory.h"
+#include "type_traits.h"
+#include "exceptdef.h"
+
+namespace mystl
+{
+
+// 节点的目标大小
+static constexpr size_t btree_node_target_size = 256;
+
+// 节点中最多存放的元素个数：使节点接近目标大小，不少于 3 个，不多于 255 个
+constexpr size_t btree_node_slots(size_t value_size)
+{
+  return (btree_node_target_size - 16) / value_size < 3   ? 3
+       : (btree_node_target_size - 16) / value_size > 255 ? 255
+       : (btree_node_target_size - 16) / value_size;
+}
+
+// forward declaration
+
+template <class T> struct btree_node;
+template <class T> struct btree_internal_node;
+
+template <class T> struct btree_iterator;
+template <class T> struct btree_const_iterator;
+
+// btree value traits
+
+template <class T, bool>
+struct btree_value_traits_imp
+{
+  typedef T key_type;
+  typedef T mapped_type;
+  typedef T value_type;
+
+  template <class Ty>
+  static const key_type& get_key(const Ty& value)
+  {
+    return value;
+  }
+
+  template <class Ty>
+  static const value_type& get_value(const Ty& value)
+  {
+    return value;
+  }
+};
+
+template <class T>
+struct btree_value_traits_imp<T, true>
+{
+  typedef typename std::remove_cv<typename T::first_type>::type key_type;
+  typedef typename T::second_type                               mapped_type;
+  typedef T                                                     value_type;
+
+  template <class Ty>
+  static const key_type& get_key(const Ty& value)
+  {
+    return value.first;
+  }
+
+  template <class Ty>
+  static const value_type& get_value(const Ty& value)
+  {
+    return value;
+  }
+};
+
+template <class T>
+struct btree_value_traits
+{
+  static constexpr bool is_map = mystl::is_pair<T>::value;
+
+  typedef btree_value_traits_imp<T, is_map> value_traits_type;
+
+  typedef typename value_traits_type::key_type    key_type;
+  typedef typename value_traits_type::mapped_type mapped_type;
+  typedef typename value_traits_type::value_type  value_type;
+
+  template <class Ty>
+  static const key_type& get_key(const Ty& value)
+  {
+    return value_traits_type::get_key(value);
+  }
+
+  template <class Ty>
+  static const value_type& get_value(const Ty& value)
+  {
+    return value_traits_type::get_value(value);
+  }
+};
+
+// 节点内是否使用无分支的线性查找
+
+template <class Key, class Compare>
+struct btree_linear_search
+  : mystl::m_bool_constant<std::is_arithmetic<Key>::value &&
+                           (std::is_same<Compare, mystl::less<Key>>::value ||
+                            std::is_same<Compare, mystl::greater<Key>>::value)>
+{
+};
+
+// btree 的节点设计
+// 叶节点只有元素，内部节点在元素之后还有 count + 1 个子节点指针
+
+template <class T>
+struct btree_node
+{
+  typedef btree_node<T>* node_ptr;
+
+  static constexpr size_t slots = btree_node_slots(sizeof(T));
+
+  node_ptr parent;    // 父节点，根节点为 nullptr
+  uint16_t position;  // 在父节点的子节点中的下标
+  uint16_t count;     // 元素个数
+  bool     leaf;      // 是否为叶节点
+  union
+  {
+    T values[slots];  // 元素，只有前 count 个已经构造
+  };
+
+  btree_node() noexcept :parent(nullptr), position(0), count(0), leaf(true) {}
+  ~btree_node() {}
+
+  node_ptr& child(size_t i) noexcept;
+};
+
+template <class T>
+constexpr size_t btree_node<T>::slots;
+
+template <class T>
+struct btree_internal_node :public btree_node<T>
+{
+  typedef btree_node<T>* node_ptr;
+
+  node_ptr children[btree_node<T>::slots + 1];
+
+  btree_internal_node() noexcept { this->leaf = false; }
+};
+
+template <class T>
+inline typename btree_node<T>::node_ptr& btree_node<T>::child(size_t i) noexcept
+{
+  MYSTL_DEBUG(!leaf);
+  return static_cast<btree_internal_node<T>*>(this)->children[i];
+}
+
+// 所有空树共用的根节点，没有元素，begin() == end()
+template <class T>
+inline btree_node<T>* btree_empty_node() noexcept
+{
+  static btree_node<T> sentinel;
+  return &sentinel;
+}
+
+// 把 [first, last) 的元素移动到未初始化的 result 处，并析构原来的元素
+// result 不能位于 (first, last) 之内
+template <class T>
+void btree_relocate(T* first, T* last, T* result, std::true_type) noexcept
+{
+  if (first != last)
+    std::memmove(static_cast<void*>(result), static_cast<const void*>(first),
+                 static_cast<size_t>(last - first) * sizeof(T));
+}
+
+template <class T>
+void btree_relocate(T* first, T* last, T* result, std::false_type) noexcept
+{
+  for (; first != last; ++first, ++result)
+  {
+    mystl::construct(result, mystl::move(*first));
+    mystl::destroy(first);
+  }
+}
+
+template <class T>
+void btree_relocate(T* first, T* last, T* result) noexcept
+{
+  btree_relocate(first, last, result, std::is_trivially_copyable<T>{});
+}
+
+// 从后往前移动，result_last 不能位于 (first, last] 之内
+template <class T>
+void btree_relocate_backward(T* first, T* last, T* result_last, std::true_type) noexcept
+{
+  if (first != last)
+    std::memmove(static_cast<void*>(result_last - (last - first)), static_cast<const void*>(first),
+                 static_cast<size_t>(last - first) * sizeof(T));
+}
+
+template <class T>
+void btree_relocate_backward(T* first, T* last, T* result_last, std::false_type) noexcept
+{
+  while (first != last)
+  {
+    --last;
+    --result_last;
+    mystl::construct(result_last, mystl::move(*last));
+    mystl::destroy(last);
+  }
+}
+
+template <class T>
+void btree_relocate_backward(T* first, T* last, T* result_last) noexcept
+{
+  btree_relocate_backward(first, last, result_last, std::is_trivially_copyable<T>{});
+}
+
+// btree 的迭代器设计
+// 迭代器由节点与节点内的下标组成，end() 指向最右叶节点的最后一个元素之后
+
+template <class T>
+struct btree_iterator_base :public mystl::iterator<mystl::bidirectional_iterator_tag, T>
+{
+  typedef btree_node<T>* node_ptr;
+
+  node_ptr node;      // 所在的节点
+  size_t   position;  // 在节点中的下标
+
+  btree_iterator_base() :node(nullptr), position(0) {}
+  btree_iterator_base(node_ptr x, size_t i) :node(x), position(i) {}
+
+  // 使迭代器前进
+  void inc()
+  {
+    if (node->leaf)
+    {
+      if (++position < node->count)
+        return;
+      // 叶节点已走完，回到第一个还有后继元素的祖先；没有则是 end()，保持原位置
+      auto x = node;
+      auto i = position;
+      while (i == x->count && x->parent != nullptr)
+      {
+        i = x->position;
+        x = x->parent;
+      }
+      if (i != x->count)
+      {
+        node = x;
+        position = i;
+      }
+    }
+    else
+    {  // 内部节点的后继是右侧子树的最左元素
+      node = node->child(position + 1);
+      while (!node->leaf)
+        node = node->child(0);
+      position = 0;
+    }
+  }
+
+  // 使迭代器后退
+  void dec()
+  {
+    if (node->leaf)
+    {
+      if (position > 0)
+      {
+        --position;
+        return;
+      }
+      auto x = node;
+      auto i = position;
+      while (i == 0 && x->parent != nullptr)
+      {
+        i = x->position;
+        x = x->parent;
+      }
+      if (i != 0)
+      {
+        node = x;
+        position = i - 1;
+      }
+    }
+    else
+    {  // 内部节点的前驱是左侧子树的最右元素
+      node = node->child(position);
+      while (!node->leaf)
+        node = node->child(node->count);
+      position = node->count - 1;
+    }
+  }
+
+  bool operator==(const btree_iterator_base& rhs) const
+  { return node == rhs.node && position == rhs.position; }
+  bool operator!=(const btree_iterator_base& rhs) const
+  { return !(*this == rhs); }
+};
+
+template <class T>
+struct btree_iterator :public btree_iterator_base<T>
+{
+  typedef T                        value_type;
+  typedef T*                       pointer;
+  typedef T&                       reference;
+  typedef btree_node<T>*           node_ptr;
+
+  typedef btree_iterator<T>        iterator;
+  typedef btree_const_iterator<T>  const_iterator;
+  typedef iterator                 self;
+
+  using btree_iterator_base<T>::node;
+  using btree_iterator_base<T>::position;
+
+  // 构造函数
+  btree_iterator() {}
+  btree_iterator(node_ptr x, size_t i) :btree_iterator_base<T>(x, i) {}
+  btree_iterator(const const_iterator& rhs) :btree_iterator_base<T>(rhs.node, rhs.position) {}
+
+  // 重载操作符
+  reference operator*()  const { return node->values[position]; }
+  pointer   operator->() const { return &(operator*()); }
+
+  self& operator++()
+  {
+    this->inc();
+    return *this;
+  }
+  self operator++(int)
+  {
+    self tmp(*this);
+    this->inc();
+    return tmp;
+  }
+  self& operator--()
+  {
+    this->dec();
+    return *this;
+  }
+  self operator--(int)
+  {
+    self tmp(*this);
+    this->dec();
+    return tmp;
+  }
+};
+
+template <class T>
+struct btree_const_iterator :public btree_iterator_base<T>
+{
+  typedef T                        value_type;
+  typedef const T*                 pointer;
+  typedef const T&                 reference;
+  typedef btree_node<T>*           node_ptr;
+
+  typedef btree_iterator<T>        iterator;
+  typedef btree_const_iterator<T>  const_iterator;
+  typedef const_iterator           self;
+
+  using btree_iterator_base<T>::node;
+  using btree_iterator_base<T>::position;
+
+  // 构造函数
+  btree_const_iterator() {}
+  btree_const_iterator(node_ptr x, size_t i) :btree_iterator_base<T>(x, i) {}
+  btree_const_iterator(const iterator& rhs) :btree_iterator_base<T>(rhs.node, rhs.position) {}
+
+  // 重载操作符
+  reference operator*()  const { return node->values[position]; }
+  pointer   operator->() const { return &(operator*()); }
+
+  self& operator++()
+  {
+    this->inc();
+    return *this;
+  }
+  self operator++(int)
+  {
+    self tmp(*this);
+    this->inc();
+    return tmp;
+  }
+  self& operator--()
+  {
+    this->dec();
+    return *this;
+  }
+  self operator--(int)
+  {
+    self tmp(*this);
+    this->dec();
+    return tmp;
+  }
+};
+
+// 模板类 btree
+// 参数一代表数据类型，参数二代表键值比较类型
+template <class T, class Compare>
+class btree
+{
+public:
+  // btree 的嵌套型别定义
+
+  typedef btree_value_traits<T>                    value_traits;
+
+  typedef typename value_traits::key_type          key_type;
+  typedef typename value_traits::mapped_type       mapped_type;
+  typedef typename value_traits::value_type        value_type;
+  typedef Compare                                  key_compare;
+
+  typedef btree_node<T>                            node_type;
+  typedef btree_internal_node<T>                   internal_node_type;
+  typedef node_type*                               node_ptr;
+
+  typedef mystl::allocator<T>                      allocator_type;
+  typedef mystl::allocator<T>                      data_allocator;
+  typedef mystl::allocator<node_type>              leaf_allocator;
+  typedef mystl::allocator<internal_node_type>     internal_allocator;
+
+  typedef typename allocator_type::pointer         pointer;
+  typedef typename allocator_type::const_pointer   const_pointer;
+  typedef typename allocator_type::reference       reference;
+  typedef typename allocator_type::const_reference const_reference;
+  typedef typename allocator_type::size_type       size_type;
+  typedef typename allocator_type::difference_type difference_type;
+
+  typedef btree_iterator<T>                        iterator;
+  typedef btree_const_iterator<T>                  const_iterator;
+  typedef mystl::reverse_iterator<iterator>        reverse_iterator;
+  typedef mystl::reverse_iterator<const_iterator>  const_reverse_iterator;
+
+  // 节点中最多、最少（根节点除外）的元素个数
+  static constexpr size_type node_slots     = node_type::slots;
+  static constexpr size_type min_node_count = node_type::slots / 2;
+
+  allocator_type get_allocator() const { return allocator_type(); }
+  key_compare    key_comp()      const { return key_comp_; }
+
+private:
+  // 用以下数据表现 btree，空树的三个节点指针都指向共用的空节点
+  node_ptr    root_;       // 根节点
+  node_ptr    leftmost_;   // 最左的叶节点，begin() 所在的节点
+  node_ptr    rightmost_;  // 最右的叶节点，end() 所在的节点
+  size_type   size_;       // 元素个数
+  key_compare key_comp_;   // 键值比较的准则
+
+public:
+  // 构造、复制、析构函数
+  btree() :root_(btree_empty_node<T>()), leftmost_(root_), rightmost_(root_), size_(0), key_comp_() {}
+
+  btree(const btree& rhs);
+  btree(btree&& rhs) noexcept;
+
+  btree& operator=(const btree& rhs);
+  btree& operator=(btree&& rhs);
+
+  ~btree() { clear(); }
+
+public:
+  // 迭代器相关操作
+
+  iterator               begin()         noexcept
+  { return iterator(leftmost_, 0); }
+  const_iterator         begin()   const noexcept
+  { return const_iterator(leftmost_, 0); }
+  iterator               end()           noexcept
+  { return iterator(rightmost_, rightmost_->count); }
+  const_iterator         end()     const noexcept
+  { return const_iterator(rightmost_, rightmost_->count); }
+
+  reverse_iterator       rbegin()        noexcept
+  { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin()  const noexcept
+  { return const_reverse_iterator(end()); }
+  reverse_iterator       rend()          noexcept
+  { return reverse_iterator(begin()); }
+  const_reverse_iterator rend()    const noexcept
+  { return const_reverse_iterator(begin()); }
+
+  const_iterator         cbegin()  const noexcept
+  { return begin(); }
+  const_iterator         cend()    const noexcept
+  { return end(); }
+  const_reverse_iterator crbegin() const noexcept
+  { return rbegin(); }
+  const_reverse_iterator crend()   const noexcept
+  { return rend(); }
+
+  // 容量相关操作
+
+  bool      empty()    const noexcept { return size_ == 0; }
+  size_type size()     const noexcept { return size_; }
+  size_type max_size() const noexcept { return static_cast<size_type>(-1) / sizeof(T); }
+
+  // 所有节点占用的字节数
+  size_type bytes_used() const noexcept
+  { return size_ == 0 ? 0 : bytes_used(root_); }
+
+  // 树的高度，空树为 0
+  size_type height() const noexcept;
+
+  // 插入删除相关操作
+
+  // emplace
+
+  template <class ...Args>
+  iterator  emplace_multi(Args&& ...args);
+
+  // 第一个参数就是键值时直接用它查找，否则先构造出元素再查找
+  template <class ...Args>
+  mystl::pair<iterator, bool> emplace_unique(Args&& ...args)
+  {
+    return M_emplace_unique(mystl::is_key_first<key_type, Args...>(),
+                            mystl::forward<Args>(args)...);
+  }
+
+  // 按 key 查找，不存在时才用 args 构造元素插入
+  template <class ...Args>
+  mystl::pair<iterator, bool> try_emplace_unique(const key_type& key, Args&& ...args);
+
+  template <class ...Args>
+  iterator  emplace_multi_use_hint(iterator hint, Args&& ...args);
+
+  template <class ...Args>
+  iterator  emplace_unique_use_hint(iterator hint, Args&& ...args);
+
+  // insert
+
+  iterator  insert_multi(const value_type& value)
+  {
+    auto pos = M_leaf_upper_bound(value_traits::get_key(value));
+    return insert_at(pos.node, pos.position, value);
+  }
+  iterator  insert_multi(value_type&& value)
+  {
+    auto pos = M_leaf_upper_bound(value_traits::get_key(value));
+    return insert_at(pos.node, pos.position, mystl::move(value));
+  }
+
+  iterator  insert_multi(iterator hint, const value_type& value)
+  {
+    return emplace_multi_use_hint(hint, value);
+  }
+  iterator  insert_multi(iterator hint, value_type&& value)
+  {
+    return emplace_multi_use_hint(hint, mystl::move(value));
+  }
+
+  // 每个元素都以 end() 为提示插入，已排序的区间每次都直接追加到最右的叶节点
+  template <class InputIterator>
+  void      insert_multi(InputIterator first, InputIterator last)
+  {
+    for (; first != last; ++first)
+      emplace_multi_use_hint(end(), *first);
+  }
+
+  mystl::pair<iterator, bool> insert_unique(const value_type& value)
+  {
+    return try_emplace_unique(value_traits::get_key(value), value);
+  }
+  mystl::pair<iterator, bool> insert_unique(value_type&& value)
+  {
+    return try_emplace_unique(value_traits::get_key(value), mystl::move(value));
+  }
+
+  iterator  insert_unique(iterator hint, const value_type& value)
+  {
+    return emplace_unique_use_hint(hint, value);
+  }
+  iterator  insert_unique(iterator hint, value_type&& value)
+  {
+    return emplace_unique_use_hint(hint, mystl::move(value));
+  }
+
+  template <class InputIterator>
+  void      insert_unique(InputIterator first, InputIterator last)
+  {
+    for (; first != last; ++first)
+      emplace_unique_use_hint(end(), *first);
+  }
+
+  // erase
+
+  iterator  erase(iterator position);
+
+  size_type erase_multi(const key_type& key);
+  size_type erase_unique(const key_type& key);
+
+  iterator  erase(iterator first, iterator last);
+
+  void      clear();
+
+  // btree 相关操作
+
+  iterator       find(const key_type& key)
+  { return iterator(M_find(key)); }
+  const_iterator find(const key_type& key) const
+  { return const_iterator(M_find(key)); }
+
+  size_type      count_multi(const key_type& key) const
+  {
+    auto p = equal_range_multi(key);
+    return static_cast<size_type>(mystl::distance(p.first, p.second));
+  }
+  size_type      count_unique(const key_type& key) const
+  {
+    return find(key) != end() ? 1 : 0;
+  }
+
+  iterator       lower_bound(const key_type& key)
+  { return iterator(M_lower_bound(key)); }
+  const_iterator lower_bound(const key_type& key) const
+  { return const_iterator(M_lower_bound(key)); }
+
+  iterator       upper_bound(const key_type& key)
+  { return iterator(M_upper_bound(key)); }
+  const_iterator upper_bound(const key_type& key) const
+  { return const_iterator(M_upper_bound(key)); }
+
+  mystl::pair<iterator, iterator>
+  equal_range_multi(const key_type& key)
+  {
+    return mystl::pair<iterator, iterator>(lower_bound(key), upper_bound(key));
+  }
+  mystl::pair<const_iterator, const_iterator>
+  equal_range_multi(const key_type& key) const
+  {
+    return mystl::pair<const_iterator, const_iterator>(lower_bound(key), upper_bound(key));
+  }
+
+  mystl::pair<iterator, iterator>
+  equal_range_unique(const key_type& key)
+  {
+    iterator it = find(key);
+    auto next = it;
+    return it == end() ? mystl::make_pair(it, it) : mystl::make_pair(it, ++next);
+  }
+  mystl::pair<const_iterator, const_iterator>
+  equal_range_unique(const key_type& key) const
+  {
+    const_iterator it = find(key);
+    auto next = it;
+    return it == end() ? mystl::make_pair(it, it) : mystl::make_pair(it, ++next);
+  }
+
+  // 透明查找：比较函数定义了 is_transparent 时，接受任意能与键值比较的类型，
+  // 不构造 key_type 的临时对象
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  iterator       find(const K& key)
+  { return iterator(M_find(key)); }
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  const_iterator find(const K& key) const
+  { return const_iterator(M_find(key)); }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  size_type      count_multi(const K& key) const
+  {
+    return static_cast<size_type>(mystl::distance(const_iterator(M_lower_bound(key)),
+                                                  const_iterator(M_upper_bound(key))));
+  }
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  size_type      count_unique(const K& key) const
+  {
+    return find(key) != end() ? 1 : 0;
+  }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  iterator       lower_bound(const K& key)
+  { return iterator(M_lower_bound(key)); }
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  const_iterator lower_bound(const K& key) const
+  { return const_iterator(M_lower_bound(key)); }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  iterator       upper_bound(const K& key)
+  { return iterator(M_upper_bound(key)); }
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  const_iterator upper_bound(const K& key) const
+  { return const_iterator(M_upper_bound(key)); }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  mystl::pair<iterator, iterator>
+  equal_range_multi(const K& key)
+  {
+    return mystl::pair<iterator, iterator>(lower_bound(key), upper_bound(key));
+  }
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  mystl::pair<const_iterator, const_iterator>
+  equal_range_multi(const K& key) const
+  {
+    return mystl::pair<const_iterator, const_iterator>(lower_bound(key), upper_bound(key));
+  }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  mystl::pair<iterator, iterator>
+  equal_range_unique(const K& key)
+  {
+    iterator it = find(key);
+    auto next = it;
+    return it == end() ? mystl::make_pair(it, it) : mystl::make_pair(it, ++next);
+  }
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  mystl::pair<const_iterator, const_iterator>
+  equal_range_unique(const K& key) const
+  {
+    const_iterator it = find(key);
+    auto next = it;
+    return it == end() ? mystl::make_pair(it, it) : mystl::make_pair(it, ++next);
+  }
+
+  void swap(btree& rhs) noexcept;
+
+private:
+
+  // node related
+  node_ptr new_leaf_node();
+  node_ptr new_internal_node();
+  void     free_node(node_ptr x) noexcept;
+  void     destroy_subtree(node_ptr x) noexcept;
+  node_ptr clone_subtree(node_ptr x, node_ptr p);
+  void     reset_empty() noexcept;
+  size_type bytes_used(node_ptr x) const noexcept;
+
+  // 节点内的查找
+  template <class K>
+  size_type node_lower_bound(node_ptr x, const K& key, m_true_type) const;
+  template <class K>
+  size_type node_lower_bound(node_ptr x, const K& key, m_false_type) const;
+  template <class K>
+  size_type node_upper_bound(node_ptr x, const K& key, m_true_type) const;
+  template <class K>
+  size_type node_upper_bound(node_ptr x, const K& key, m_false_type) const;
+  template <class K>
+  size_type node_lower_bound(node_ptr x, const K& key) const
+  { return node_lower_bound(x, key, btree_linear_search<key_type, Compare>()); }
+  template <class K>
+  size_type node_upper_bound(node_ptr x, const K& key) const
+  { return node_upper_bound(x, key, btree_linear_search<key_type, Compare>()); }
+
+  // find
+  template <class K>
+  iterator M_leaf_lower_bound(const K& key) const;
+  template <class K>
+  iterator M_leaf_upper_bound(const K& key) const;
+  iterator M_normalize(iterator it) const noexcept;
+  template <class K>
+  iterator M_find(const K& key) const;
+  template <class K>
+  iterator M_lower_bound(const K& key) const
+  { return M_normalize(M_leaf_lower_bound(key)); }
+  template <class K>
+  iterator M_upper_bound(const K& key) const
+  { return M_normalize(M_leaf_upper_bound(key)); }
+
+  // emplace
+  template <class ...Args>
+  mystl::pair<iterator, bool> M_emplace_unique(m_false_type, Args&& ...args);
+  template <class K, class ...Args>
+  mystl::pair<iterator, bool> M_emplace_unique(m_true_type, K&& key, Args&& ...args)
+  { return try_emplace_unique(key, mystl::forward<K>(key), mystl::forward<Args>(args)...); }
+
+  // insert
+  template <class ...Args>
+  iterator insert_at(node_ptr x, size_type pos, Args&& ...args);
+  template <class ...Args>
+  iterator insert_before(iterator position, Args&& ...args);
+  void     split(node_ptr& x, size_type& pos);
+  void     insert_into_parent(node_ptr p, size_type pos, T* value, node_ptr child) noexcept;
+
+  // erase
+  iterator rebalance_after_erase(node_ptr x, size_type pos) noexcept;
+  void     merge_nodes(node_ptr left, node_ptr right) noexcept;
+  void     rotate_right(node_ptr left, node_ptr x) noexcept;
+  void     rotate_left(node_ptr x, node_ptr right) noexcept;
+
+  // 把 src 的子节点 [first, last) 放到 dst 中下标为 d_first 开始的位置
+  static void move_children(node_ptr dst, size_type d_first,
+                            node_ptr src, size_type first, size_type last) noexcept;
+};
+
+template <class T, class Compare>
+constexpr typename btree<T, Compare>::size_type btree<T, Compare>::node_slots;
+
+template <class T, class Compare>
+constexpr typename btree<T, Compare>::size_type btree<T, Compare>::min_node_count;
+
+/*****************************************************************************************/
+
+// 复制构造函数，复制出相同的树形
+template <class T, class Compare>
+btree<T, Compare>::
+btree(const btree& rhs)
+  :root_(btree_empty_node<T>()), leftmost_(root_), rightmost_(root_), size_(0),
+   key_comp_(rhs.key_comp_)
+{
+  if (rhs.size_ != 0)
+  {
+    root_ = clone_subtree(rhs.root_, nullptr);
+    leftmost_ = root_;
+    while (!leftmost_->leaf)
+      leftmost_ = leftmost_->child(0);
+    rightmost_ = root_;
+    while (!rightmost_->leaf)
+      rightmost_ = rightmost_->child(rightmost_->count);
+    size_ = rhs.size_;
+  }
+}
+
+// 移动构造函数
+template <class T, class Compare>
+btree<T, Compare>::
+btree(btree&& rhs) noexcept
+  :root_(rhs.root_), leftmost_(rhs.leftmost_), rightmost_(rhs.rightmost_), size_(rhs.size_),
+   key_comp_(mystl::move(rhs.key_comp_))
+{
+  rhs.reset_empty();
+}
+
+// 复制赋值操作符
+template <class T, class Compare>
+btree<T, Compare>&
+btree<T, Compare>::
+operator=(const btree& rhs)
+{
+  if (this != &rhs)
+  {
+    btree tmp(rhs);
+    swap(tmp);
+  }
+  return *this;
+}
+
+// 移动赋值操作符
+template <class T, class Compare>
+btree<T, Compare>&
+btree<T, Compare>::
+operator=(btree&& rhs)
+{
+  clear();
+  root_ = rhs.root_;
+  leftmost_ = rhs.leftmost_;
+  rightmost_ = rhs.rightmost_;
+  size_ = rhs.size_;
+  key_comp_ = mystl::move(rhs.key_comp_);
+  rhs.reset_empty();
+  return *this;
+}
+
+// 树的高度
+template <class T, class Compare>
+typename btree<T, Compare>::size_type
+btree<T, Compare>::
+height() const noexcept
+{
+  if (size_ == 0)
+    return 0;
+  size_type h = 1;
+  for (auto x = root_; !x->leaf; x = x->child(0))
+    ++h;
+  return h;
+}
+
+// 就地插入元素，键值允许重复
+template <class T, class Compare>
+template <class ...Args>
+typename btree<T, Compare>::iterator
+btree<T, Compare>::
+emplace_multi(Args&& ...args)
+{
+  value_type tmp(mystl::forward<Args>(args)...);
+  auto pos = M_leaf_upper_bound(value_traits::get_key(tmp));
+  return insert_at(pos.node, pos.position, mystl::move(tmp));
+}
+
+// 按 key 查找，不存在时才在叶节点中构造元素
+template <class T, class Compare>
+template <class ...Args>
+mystl::pair<typename btree<T, Compare>::iterator, bool>
+btree<T, Compare>::
+try_emplace_unique(const key_type& key, Args&& ...args)
+{
+  auto pos = M_leaf_lower_bound(key);
+  auto it = M_normalize(pos);
+  if (it != end() && !key_comp_(key, value_traits::get_key(*it)))
+    return mystl::make_pair(it, false);
+  return mystl::make_pair(insert_at(pos.node, pos.position, mystl::forward<Args>(args)...), true);
+}
+
+// 就地插入元素，键值允许重复，当 hint 位置恰当时直接在 hint 之前插入
+template <class T, class Compare>
+template <class ...Args>
+typename btree<T, Compare>::iterator
+btree<T, Compare>::
+emplace_multi_use_hint(iterator hint, Args&& ...args)
+{
+  value_type tmp(mystl::forward<Args>(args)...);
+  const key_type& key = value_traits::get_key(tmp);
+  if (hint != begin())
+  {
+    auto before = hint;
+    --before;
+    if (key_comp_(key, value_traits::get_key(*before)))
+      return insert_multi(mystl::move(tmp));
+  }
+  if (hint != end() && key_comp_(value_traits::get_key(*hint), key))
+    return insert_multi(mystl::move(tmp));
+  return insert_before(hint, mystl::move(tmp));
+}
+
+// 就地插入元素，键值不允许重复，当 hint 位置恰当时直接在 hint 之前插入
+template <class T, class Compare>
+template <class ...Args>
+typename btree<T, Compare>::iterator
+btree<T, Compare>::
+emplace_unique_use_hint(iterator hint, Args&& ...args)
+{
+  value_type tmp(mystl::forward<Args>(args)...);
+  const key_type& key = value_traits::get_key(tmp);
+  if (hint != begin())
+  {
+    auto before = hint;
+    --before;
+    if (!key_comp_(value_traits::get_key(*before), key))
+      return insert_unique(mystl::move(tmp)).first;
+  }
+  if (hint != end() && !key_comp_(key, value_traits::get_key(*hint)))
+    return insert_unique(mystl::move(tmp)).first;
+  return insert_before(hint, mystl::move(tmp));
+}
+
+// 删除 position 位置的元素，返回它的下一个元素
+template <class T, class Compare>
+typename btree<T, Compare>::iterator
+btree<T, Compare>::
+erase(iterator position)
+{
+  MYSTL_DEBUG(position != end());
+  node_ptr x = position.node;
+  size_type pos = position.position;
+  const bool internal_delete = !x->leaf;
+  data_allocator::destroy(x->values + pos);
+  if (internal_delete)
+  { // 用前驱（叶节点中的最后一个元素）填补内部节点的空位，转为删除叶节点中的元素
+    auto pred = position;
+    --pred;
+    btree_relocate(pred.node->values + pred.position,
+                   pred.node->values + pred.position + 1, x->values + pos);
+    x = pred.node;
+    pos = pred.position;
+  }
+  else
+  {
+    btree_relocate(x->values + pos + 1, x->values + x->count, x->values + pos);
+  }
+  --x->count;
+  --size_;
+  auto res = rebalance_after_erase(x, pos);
+  if (internal_delete)
+    ++res;  // res 指向移到内部节点中的前驱
+  return res;
+}
+
+// 删除键值等于 key 的元素，返回删除的个数
+template <class T, class Compare>
+typename btree<T, Compare>::size_type
+btree<T, Compare>::
+erase_multi(const key_type& key)
+{
+  auto p = equal_range_multi(key);
+  size_type n = mystl::distance(p.first, p.second);
+  erase(p.first, p.second);
+  return n;
+}
+
+// 删除键值等于 key 的元素，返回删除的个数
+template <class T, class Compare>
+typename btree<T, Compare>::size_type
+btree<T, Compare>::
+erase_unique(const key_type& key)
+{
+  auto it = find(key);
+  if (it != end())
+  {
+    erase(it);
+    return 1;
+  }
+  return 0;
+}
+
+// 删除[first, last)区间内的元素
+// 每次删除都可能移动后面的元素，所以先数出个数，再从 first 开始依次删除
+template <class T, class Compare>
+typename btree<T, Compare>::iterator
+btree<T, Compare>::
+erase(iterator first, iterator last)
+{
+  if (first == begin() && last == end())
+  {
+    clear();
+    return end();
+  }
+  for (auto n = mystl::distance(first, last); n > 0; --n)
+    first = erase(first);
+  return first;
+}
+
+// 清空 btree
+template <class T, class Compare>
+void btree<T, Compare>::
+clear()
+{
+  if (size_ != 0)
+  {
+    destroy_subtree(root_);
+    reset_empty();
+  }
+}
+
+// 交换 btree
+template <class T, class Compare>
+void btree<T, Compare>::
+swap(btree& rhs) noexcept
+{
+  if (this != &rhs)
+  {
+    mystl::swap(root_, rhs.root_);
+    mystl::swap(leftmost_, rhs.leftmost_);
+    mystl::swap(rightmost_, rhs.rightmost_);
+    mystl::swap(size_, rhs.size_);
+    mystl::swap(key_comp_, rhs.key_comp_);
+  }
+}
+
+/*****************************************************************************************/
+// helper function
+
+// 分配一个叶节点
+template <class T, class Compare>
+typename btree<T, Compare>::node_ptr
+btree<T, Compare>::
+new_leaf_node()
+{
+  auto x = leaf_allocator::allocate(1);
+  mystl::construct(x);
+  return x;
+}
+
+// 分配一个内部节点
+template <class T, class Compare>
+typename btree<T, Compare>::node_ptr
+btree<T, Compare>::
+new_internal_node()
+{
+  auto x = internal_allocator::allocate(1);
+  mystl::construct(x);
+  return x;
+}
+
+// 析构节点中的元素并释放节点，不处理子节点
+template <class T, class Compare>
+void btree<T, Compare>::
+free_node(node_ptr x) noexcept
+{
+  data_allocator::destroy(x->values, x->values + x->count);
+  if (x->leaf)
+  {
+    leaf_allocator::deallocate(x, 1);
+  }
+  else
+  {
+    internal_allocator::deallocate(static_cast<internal_node_type*>(x), 1);
+  }
+}
+
+// 释放以 x 为根的子树
+template <class T, class Compare>
+void btree<T, Compare>::
+destroy_subtree(node_ptr x) noexcept
+{
+  if (!x->leaf)
+  {
+    for (size_type i = 0; i <= x->count; ++i)
+      destroy_subtree(x->child(i));
+  }
+  free_node(x);
+}
+
+// 复制以 x 为根的子树，新子树的父节点为 p
+template <class T, class Compare>
+typename btree<T, Compare>::node_ptr
+btree<T, Compare>::
+clone_subtree(node_ptr x, node_ptr p)
+{
+  node_ptr y = x->leaf ? new_leaf_node() : new_internal_node();
+  y->parent = p;
+  y->position = x->position;
+  size_type children = 0;
+  try
+  {
+    for (; y->count < x->count; ++y->count)
+      data_allocator::construct(y->values + y->count, x->values[y->count]);
+    if (!x->leaf)
+    {
+      for (; children <= x->count; ++children)
+        y->child(children) = clone_subtree(x->child(children), y);
+    }
+  }
+  catch (...)
+  {
+    for (size_type i = 0; i < children; ++i)
+      destroy_subtree(y->child(i));
+    free_node(y);
+    throw;
+  }
+  return y;
+}
+
+// 回到空树的状态，不释放节点
+template <class T, class Compare>
+void btree<T, Compare>::
+reset_empty() noexcept
+{
+  root_ = leftmost_ = rightmost_ = btree_empty_node<T>();
+  size_ = 0;
+}
+
+// 以 x 为根的子树占用的字节数
+template <class T, class Compare>
+typename btree<T, Compare>::size_type
+btree<T, Compare>::
+bytes_used(node_ptr x) const noexcept
+{
+  if (x->leaf)
+    return sizeof(node_type);
+  size_type n = sizeof(internal_node_type);
+  for (size_type i = 0; i <= x->count; ++i)
+    n += bytes_used(x->child(i));
+  return n;
+}
+
+// 节点内第一个不小于 key 的元素的下标：数出小于 key 的元素个数，循环中没有分支
+template <class T, class Compare>
+template <class K>
+typename btree<T, Compare>::size_type
+btree<T, Compare>::
+node_lower_bound(node_ptr x, const K& key, m_true_type) const
+{
+  size_type n = 0;
+  const size_type count = x->count;
+  for (size_type i = 0; i < count; ++i)
+    n += static_cast<size_type>(key_comp_(value_traits::get_key(x->values[i]), key));
+  return n;
+}
+
+// 节点内第一个不小于 key 的元素的下标：二分查找
+template <class T, class Compare>
+template <class K>
+typename btree<T, Compare>::size_type
+btree<T, Compare>::
+node_lower_bound(node_ptr x, const K& key, m_false_type) const
+{
+  size_type lo = 0, hi = x->count;
+  while (lo < hi)
+  {
+    const size_type mid = (lo + hi) / 2;
+    if (key_comp_(value_traits::get_key(x->values[mid]), key))
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+// 节点内第一个大于 key 的元素的下标：数出不大于 key 的元素个数
+template <class T, class Compare>
+template <class K>
+typename btree<T, Compare>::size_type
+btree<T, Compare>::
+node_upper_bound(node_ptr x, const K& key, m_true_type) const
+{
+  size_type n = 0;
+  const size_type count = x->count;
+  for (size_type i = 0; i < count; ++i)
+    n += static_cast<size_type>(!key_comp_(key, value_traits::get_key(x->values[i])));
+  return n;
+}
+
+// 节点内第一个大于 key 的元素的下标：二分查找
+template <class T, class Compare>
+template <class K>
+typename btree<T, Compare>::size_type
+btree<T, Compare>::
+node_upper_bound(node_ptr x, const K& key, m_false_type) const
+{
+  size_type lo = 0, hi = x->count;
+  while (lo < hi)
+  {
+    const size_type mid = (lo + hi) / 2;
+    if (key_comp_(key, value_traits::get_key(x->values[mid])))
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+  return lo;
+}
+
+// 自根节点向下走到叶节点，返回 lower_bound 在叶节点中对应的插入位置，下标可能等于节点的元素个数
+template <class T, class Compare>
+template <class K>
+typename btree<T, Compare>::iterator
+btree<T, Compare>::
+M_leaf_lower_bound(const K& key) const
+{
+  node_ptr x = root_;
+  while (true)
+  {
+    const size_type i = node_lower_bound(x, key);
+    if (x->leaf)
+      return iterator(x, i);
+    x = x->child(i);
+  }
+}
+
+// 自根节点向下走到叶节点，返回 upper_bound 在叶节点中对应的插入位置
+template <class T, class Compare>
+template <class K>
+typename btree<T, Compare>::iterator
+btree<T, Compare>::
+M_leaf_upper_bound(const K& key) const
+{
+  node_ptr x = root_;
+  while (true)
+  {
+    const size_type i = node_upper_bound(x, key);
+    if (x->leaf)
+      return iterator(x, i);
+    x = x->child(i);
+  }
+}
+
+// 叶节点中的插入位置位于节点末尾时，它对应的元素是第一个还有后继元素的祖先中的分隔元素，没有则为 end()
+template <class T, class Compare>
+typename btree<T, Compare>::iterator
+btree<T, Compare>::
+M_normalize(iterator it) const noexcept
+{
+  auto x = it.node;
+  auto i = it.position;
+  while (i == x->count && x->parent != nullptr)
+  {
+    i = x->position;
+    x = x->parent;
+  }
+  return i == x->count ? iterator(rightmost_, rightmost_->count) : iterator(x, i);
+}
+
+// 查找第一个键值等于 key 的元素
+template <class T, class Compare>
+template <class K>
+typename btree<T, Compare>::iterator
+btree<T, Compare>::
+M_find(const K& key) const
+{
+  auto it = M_lower_bound(key);
+  return (it.node == rightmost_ && it.position == rightmost_->count) ||
+    key_comp_(key, value_traits::get_key(*it))
+    ? iterator(rightmost_, rightmost_->count) : it;
+}
+
+// 键值不允许重复，第一个参数不是键值时先构造出元素
+template <class T, class Compare>
+template <class ...Args>
+mystl::pair<typename btree<T, Compare>::iterator, bool>
+btree<T, Compare>::
+M_emplace_unique(m_false_type, Args&& ...args)
+{
+  value_type tmp(mystl::forward<Args>(args)...);
+  return try_emplace_unique(value_traits::get_key(tmp), mystl::move(tmp));
+}
+
+// 在叶节点 x 的下标 pos 处构造元素，节点已满时先分裂
+template <class T, class Compare>
+template <class ...Args>
+typename btree<T, Compare>::iterator
+btree<T, Compare>::
+insert_at(node_ptr x, size_type pos, Args&& ...args)
+{
+  MYSTL_DEBUG(x->leaf);
+  if (size_ == 0)
+  { // 空树先分配根节点
+    x = root_ = leftmost_ = rightmost_ = new_leaf_node();
+    pos = 0;
+  }
+  else if (x->count == node_slots)
+  {
+    split(x, pos);
+  }
+  btree_relocate_backward(x->values + pos, x->values + x->count, x->values + x->count + 1);
+  try
+  {
+    data_allocator::construct(x->values + pos, mystl::forward<Args>(args)...);
+  }
+  catch (...)
+  {
+    btree_relocate(x->values + pos + 1, x->values + x->count + 1, x->values + pos);
+    if (size_ == 0)
+    {
+      free_node(x);
+      reset_empty();
+    }
+    throw;
+  }
+  ++x->count;
+  ++size_;
+  return iterator(x, pos);
+}
+
+// 在 position 之前插入元素，position 在内部节点中时改为插在它的前驱之后
+template <class T, class Compare>
+template <class ...Args>
+typename btree<T, Compare>::iterator
+btree<T, Compare>::
+insert_before(iterator position, Args&& ...args)
+{
+  if (!position.node->leaf)
+  {
+    --position;
+    ++position.position;
+  }
+  return insert_at(position.node, position.position, mystl::forward<Args>(args)...);
+}
+
+// 分裂已满的节点 x，并把插入位置 (x, pos) 调整到分裂后的节点中
+// 先分配新节点，父节点已满时先分裂父节点，都成功后再移动元素，移动元素不会失败
+// 在节点末尾插入时只移出一个元素，使按顺序插入时节点接近满，在开头插入时类似
+template <class T, class Compare>
+void btree<T, Compare>::
+split(node_ptr& x, size_type& pos)
+{
+  node_ptr sibling = x->leaf ? new_leaf_node() : new_internal_node();
+  try
+  {
+    if (x->parent == nullptr)
+    { // x 是根节点，树长高一层
+      node_ptr r = new_internal_node();
+      r->child(0) = x;
+      x->parent = r;
+      x->position = 0;
+      root_ = r;
+    }
+    else if (x->parent->count == node_slots)
+    {
+      node_ptr p = x->parent;
+      size_type ppos = x->position;
+      split(p, ppos);
+    }
+  }
+  catch (...)
+  {
+    free_node(sibling);
+    throw;
+  }
+
+  const size_type n = x->count;
+  const size_type keep = pos == 0 ? 1 : pos == n ? n - 2 : n / 2;
+  // x 保留 [0, keep)，keep 处的元素上移到父节点，其余的移到 sibling
+  btree_relocate(x->values + keep + 1, x->values + n, sibling->values);
+  sibling->count = static_cast<uint16_t>(n - keep - 1);
+  if (!x->leaf)
+    move_children(sibling, 0, x, keep + 1, n + 1);
+  x->count = static_cast<uint16_t>(keep);
+  insert_into_parent(x->parent, x->position, x->values + keep, sibling);
+  if (x == rightmost_)
+    rightmost_ = sibling;
+
+  if (pos > keep)
+  {
+    x = sibling;
+    pos -= keep + 1;
+  }
+}
+
+// 把 value 移到父节点 p 的下标 pos 处，child 成为它右侧的子节点
+template <class T, class Compare>
+void btree<T, Compare>::
+insert_into_parent(node_ptr p, size_type pos, T* value, node_ptr child) noexcept
+{
+  btree_relocate_backward(p->values + pos, p->values + p->count, p->values + p->count + 1);
+  btree_relocate(value, value + 1, p->values + pos);
+  for (size_type i = p->count + 1; i > pos + 1; --i)
+  {
+    p->child(i) = p->child(i - 1);
+    p->child(i)->position = static_cast<uint16_t>(i);
+  }
+  p->child(pos + 1) = child;
+  child->parent = p;
+  child->position = static_cast<uint16_t>(pos + 1);
+  ++p->count;
+}
+
+// 叶节点 x 中删除了下标 pos 处的元素后，自下而上合并或调整元素过少的节点
+// 返回原来 (x, pos) 处的元素（可能已移到别的节点）的迭代器
+template <class T, class Compare>
+typename btree<T, Compare>::iterator
+btree<T, Compare>::
+rebalance_after_erase(node_ptr x, size_type pos) noexcept
+{
+  iterator res(x, pos);
+  while (x != root_ && x->count < min_node_count)
+  {
+    node_ptr p = x->parent;
+    const size_type i = x->position;
+    if (i > 0)
+    {
+      node_ptr left = p->child(i - 1);
+      if (left->count + x->count + 1 <= node_slots)
+      {
+        if (res.node == x)
+        {
+          res.node = left;
+          res.position += left->count + 1;
+        }
+        merge_nodes(left, x);
+        x = p;
+        continue;
+      }
+    }
+    if (i < p->count)
+    {
+      node_ptr right = p->child(i + 1);
+      if (x->count + right->count + 1 <= node_slots)
+      {
+        merge_nodes(x, right);
+        x = p;
+        continue;
+      }
+    }
+    // 不能合并时兄弟节点的元素多于一半，借一个元素即可
+    if (i > 0)
+    {
+      rotate_right(p->child(i - 1), x);
+      if (res.node == x)
+        ++res.position;
+    }
+    else
+    {
+      rotate_left(x, p->child(i + 1));
+    }
+    break;
+  }
+
+  if (root_->count == 0)
+  {
+    if (root_->leaf)
+    { // 删除了最后一个元素
+      free_node(root_);
+      reset_empty();
+      return end();
+    }
+    // 根节点的元素已经合并到唯一的子节点中，树降低一层
+    node_ptr old = root_;
+    root_ = root_->child(0);
+    root_->parent = nullptr;
+    root_->position = 0;
+    free_node(old);
+  }
+  return M_normalize(res);
+}
+
+// 把父节点中的分隔元素与 right 的所有元素、子节点并入 left，并释放 right
+template <class T, class Compare>
+void btree<T, Compare>::
+merge_nodes(node_ptr left, node_ptr right) noexcept
+{
+  node_ptr p = left->parent;
+  const size_type i = left->position;
+  btree_relocate(p->values + i, p->values + i + 1, left->values + left->count);
+  btree_relocate(right->values, right->values + right->count, left->values + left->count + 1);
+  if (!left->leaf)
+    move_children(left, left->count + 1, right, 0, right->count + 1);
+  left->count = static_cast<uint16_t>(left->count + right->count + 1);
+  right->count = 0;
+
+  btree_relocate(p->values + i + 1, p->values + p->count, p->values + i);
+  for (size_type j = i + 1; j < p->count; ++j)
+  {
+    p->child(j) = p->child(j + 1);
+    p->child(j)->position = static_cast<uint16_t>(j);
+  }
+  --p->count;
+
+  if (right == rightmost_)
+    rightmost_ = left;
+  free_node(right);
+}
+
+// 把左兄弟的最后一个元素经父节点移到 x 的开头
+template <class T, class Compare>
+void btree<T, Compare>::
+rotate_right(node_ptr left, node_ptr x) noexcept
+{
+  node_ptr p = x->parent;
+  const size_type i = x->position;
+  btree_relocate_backward(x->values, x->values + x->count, x->values + x->count + 1);
+  btree_relocate(p->values + i - 1, p->values + i, x->values);
+  btree_relocate(left->values + left->count - 1, left->values + left->count, p->values + i - 1);
+  if (!x->leaf)
+  {
+    move_children(x, 1, x, 0, x->count + 1);
+    move_children(x, 0, left, left->count, left->count + 1);
+  }
+  --left->count;
+  ++x->count;
+}
+
+// 把右兄弟的第一个元素经父节点移到 x 的末尾
+template <class T, class Compare>
+void btree<T, Compare>::
+rotate_left(node_ptr x, node_ptr right) noexcept
+{
+  node_ptr p = x->parent;
+  const size_type i = x->position;
+  btree_relocate(p->values + i, p->values + i + 1, x->values + x->count);
+  btree_relocate(right->values, right->values + 1, p->values + i);
+  btree_relocate(right->values + 1, right->values + right->count, right->values);
+  if (!x->leaf)
+  {
+    move_children(x, x->count + 1, right, 0, 1);
+    move_children(right, 0, right, 1, right->count + 1);
+  }
+  ++x->count;
+  --right->count;
+}
+
+// 移动子节点指针并更新它们的父节点与下标，dst 与 src 相同时可以重叠
+template <class T, class Compare>
+void btree<T, Compare>::
+move_children(node_ptr dst, size_type d_first, node_ptr src, size_type first, size_type last) noexcept
+{
+  if (dst == src && d_first > first)
+  { // 向后移动，从后往前
+    for (size_type i = last; i > first; --i)
+    {
+      auto c = src->child(i - 1);
+      dst->child(d_first + (i - 1 - first)) = c;
+      c->position = static_cast<uint16_t>(d_first + (i - 1 - first));
+    }
+    return;
+  }
+  for (size_type i = first; i < last; ++i)
+  {
+    auto c = src->child(i);
+    dst->child(d_first + (i - first)) = c;
+    c->parent = dst;
+    c->position = static_cast<uint16_t>(d_first + (i - first));
+  }
+}
+
+// 重载比较操作符
+template <class T, class Compare>
+bool operator==(const btree<T, Compare>& lhs, const btree<T, Compare>& rhs)
+{
+  return lhs.size() == rhs.size() && mystl::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <class T, class Compare>
+bool operator<(const btree<T, Compare>& lhs, const btree<T, Compare>& rhs)
+{
+  return mystl::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <class T, class Compare>
+bool operator!=(const btree<T, Compare>& lhs, const btree<T, Compare>& rhs)
+{
+  return !(lhs == rhs);
+}
+
+template <class T, class Compare>
+bool operator>(const btree<T, Compare>& lhs, const btree<T, Compare>& rhs)
+{
+  return rhs < lhs;
+}
+
+template <class T, class Compare>
+bool operator<=(const btree<T, Compare>& lhs, const btree<T, Compare>& rhs)
+{
+  return !(rhs < lhs);
+}
+
+template <class T, class Compare>
+bool operator>=(const btree<T, Compare>& lhs, const btree<T, Compare>& rhs)
+{
+  return !(lhs < rhs);
+}
+
+// 重载 mystl 的 swap
+template <class T, class Compare>
+void swap(btree<T, Compare>& lhs, btree<T, Compare>& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+
+} // namespace mystl
+#endif // !MYTINYSTL_BTREE_H_
@@ -0,0 +1,201 @@
+﻿#ifndef MYTINYSTL_CI_STRING_H_
+#define MYTINYSTL_CI_STRING_H_
+
+// 这个头文件包含忽略 ASCII 大小写的 ci_char_traits、ci_string，
+// 与之配套的哈希函数和比较函数，以及原地转换大小写的函数
+
+// notes:
+//
+// 1. 只折叠 ASCII 字母 A-Z / a-z，其余字节（包括 UTF-8 多字节序列）按原值比较
+// 2. ci_string 的比较按折叠为小写后的无符号字节值进行，find 等查找函数仍然区分大小写
+// 3. ci_hash 与 ci_equal_to 可以作为 unordered_map<string, T> 的参数，让普通字符串按忽略大小写的方式作为键
+
+#include "astring.h"
+#include "string_view.h"
+#include "simd.h"
+
+namespace mystl
+{
+
+// 把一个 ASCII 字母折叠为小写
+inline unsigned char ascii_fold(unsigned char c) noexcept
+{
+  return static_cast<unsigned char>(c | ((static_cast<unsigned>(c - 'A') < 26u) << 5));
+}
+
+#ifdef MYSTL_HAS_SSE2
+
+// 16 个字节中在 [lo, hi] 内的字节置为 0xff，其余为 0，只用于 ASCII 范围
+inline __m128i simd_byte_in_range(__m128i v, char lo, char hi) noexcept
+{
+  return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(static_cast<char>(lo - 1))),
+                       _mm_cmplt_epi8(v, _mm_set1_epi8(static_cast<char>(hi + 1))));
+}
+
+// 把 16 个字节中的大写字母折叠为小写
+inline __m128i simd_ascii_fold(__m128i v) noexcept
+{
+  return _mm_or_si128(v, _mm_and_si128(simd_byte_in_range(v, 'A', 'Z'), _mm_set1_epi8(0x20)));
+}
+
+#endif // MYSTL_HAS_SSE2
+
+/*****************************************************************************************/
+// ci_compare
+// 忽略大小写比较 [s1, s1 + n) 和 [s2, s2 + n)，小于返回 -1，大于返回 1，等于返回 0
+/*****************************************************************************************/
+inline int ci_compare(const char* s1, const char* s2, size_t n) noexcept
+{
+  auto p1 = reinterpret_cast<const unsigned char*>(s1);
+  auto p2 = reinterpret_cast<const unsigned char*>(s2);
+  size_t i = 0;
+#ifdef MYSTL_HAS_SSE2
+  for (; i + 16 <= n; i += 16)
+  {
+    const __m128i a = simd_ascii_fold(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p1 + i)));
+    const __m128i b = simd_ascii_fold(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p2 + i)));
+    const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)));
+    if (mask != 0xffff)
+    {
+      const auto j = i + ctz32(~mask);
+      return ascii_fold(p1[j]) < ascii_fold(p2[j]) ? -1 : 1;
+    }
+  }
+#endif
+  for (; i < n; ++i)
+  {
+    const auto c1 = ascii_fold(p1[i]);
+    const auto c2 = ascii_fold(p2[i]);
+    if (c1 != c2)
+      return c1 < c2 ? -1 : 1;
+  }
+  return 0;
+}
+
+/*****************************************************************************************/
+// ascii_to_lower / ascii_to_upper
+// 原地把 [s, s + n) 中的 ASCII 字母转为小写 / 大写
+/*****************************************************************************************/
+inline void ascii_to_lower(char* s, size_t n) noexcept
+{
+  size_t i = 0;
+#ifdef MYSTL_HAS_SSE2
+  for (; i + 16 <= n; i += 16)
+  {
+    auto p = reinterpret_cast<__m128i*>(s + i);
+    _mm_storeu_si128(p, simd_ascii_fold(_mm_loadu_si128(p)));
+  }
+#endif
+  for (; i < n; ++i)
+    s[i] = static_cast<char>(ascii_fold(static_cast<unsigned char>(s[i])));
+}
+
+inline void ascii_to_upper(char* s, size_t n) noexcept
+{
+  size_t i = 0;
+#ifdef MYSTL_HAS_SSE2
+  const __m128i bit = _mm_set1_epi8(0x20);
+  for (; i + 16 <= n; i += 16)
+  {
+    auto p = reinterpret_cast<__m128i*>(s + i);
+    const __m128i v = _mm_loadu_si128(p);
+    _mm_storeu_si128(p, _mm_xor_si128(v, _mm_and_si128(simd_byte_in_range(v, 'a', 'z'), bit)));
+  }
+#endif
+  for (; i < n; ++i)
+  {
+    const auto c = static_cast<unsigned char>(s[i]);
+    s[i] = static_cast<char>(c ^ ((static_cast<unsigned>(c - 'a') < 26u) << 5));
+  }
+}
+
+template <class CharTraits>
+void to_lower(basic_string<char, CharTraits>& s) noexcept
+{
+  ascii_to_lower(s.begin(), s.size());
+}
+
+template <class CharTraits>
+void to_upper(basic_string<char, CharTraits>& s) noexcept
+{
+  ascii_to_upper(s.begin(), s.size());
+}
+
+// ci_char_traits
+// 与 char_traits<char> 相同，只是 compare 忽略 ASCII 大小写
+struct ci_char_traits : public char_traits<char>
+{
+  static int compare(const char_type* s1, const char_type* s2, size_t n) noexcept
+  { return ci_compare(s1, s2, n); }
+};
+
+using ci_string      = mystl::basic_string<char, ci_char_traits>;
+using ci_string_view = mystl::basic_string_view<char, ci_char_traits>;
+
+/*****************************************************************************************/
+// ci_hash / ci_equal_to
+// 忽略大小写的哈希函数与相等比较，大小写不同的字符串得到相同的哈希值
+/*****************************************************************************************/
+// 每次把至多 128 个字节折叠为小写放进栈上的缓冲区，再交给 bitwise_hash，
+// 更长的字符串分段计算，上一段的哈希值作为下一段的种子
+inline size_t ci_bitwise_hash(const char* first, size_t count) noexcept
+{
+  unsigned char buf[128];
+  if (count == 0)
+    return bitwise_hash(buf, 0, 0);
+  uint64_t seed = 0;
+  for (;;)
+  {
+    const size_t n = count < sizeof(buf) ? count : sizeof(buf);
+    for (size_t i = 0; i < n; ++i)
+      buf[i] = ascii_fold(static_cast<unsigned char>(first[i]));
+    const size_t result = bitwise_hash(buf, n, seed);
+    first += n;
+    count -= n;
+    if (count == 0)
+      return result;
+    seed = result;
+  }
+}
+
+struct ci_hash
+{
+  template <class CharTraits>
+  size_t operator()(const basic_string<char, CharTraits>& s) const noexcept
+  { return ci_bitwise_hash(s.begin(), s.size()); }
+
+  template <class CharTraits>
+  size_t operator()(basic_string_view<char, CharTraits> s) const noexcept
+  { return ci_bitwise_hash(s.data(), s.size()); }
+};
+
+struct ci_equal_to
+{
+  template <class CharTraits>
+  bool operator()(const basic_string<char, CharTraits>& lhs,
+                  const basic_string<char, CharTraits>& rhs) const noexcept
+  { return lhs.size() == rhs.size() && ci_compare(lhs.begin(), rhs.begin(), lhs.size()) == 0; }
+
+  template <class CharTraits>
+  bool operator()(basic_string_view<char, CharTraits> lhs,
+                  basic_string_view<char, CharTraits> rhs) const noexcept
+  { return lhs.size() == rhs.size() && ci_compare(lhs.data(), rhs.data(), lhs.size()) == 0; }
+};
+
+// 特化 mystl::hash，使 ci_string 可以直接作为无序容器的键
+template <>
+struct hash<ci_string>
+{
+  size_t operator()(const ci_string& s) const noexcept
+  { return ci_bitwise_hash(s.begin(), s.size()); }
+};
+
+template <>
+struct hash<ci_string_view>
+{
+  size_t operator()(const ci_string_view& s) const noexcept
+  { return ci_bitwise_hash(s.data(), s.size()); }
+};
+
+} // namespace mystl
+#endif // !MYTINYSTL_CI_STRING_H_
@@ -0,0 +1,500 @@
+﻿#ifndef MYTINYSTL_CONCURRENT_UNORDERED_MAP_H_
+#define MYTINYSTL_CONCURRENT_UNORDERED_MAP_H_
+
+// 这个头文件包含一个模板类 concurrent_unordered_map
+// 可以被多个线程同时读写的哈希表，元素按哈希值分散到若干个分片中，每个分片是一个 hashtable 并有自己的读写锁
+
+// notes:
+//
+// 1. 不提供迭代器，也不返回元素的引用：锁释放之后引用随时可能失效
+//    查找用 find(key, value) 把值复制出来，遍历用 for_each 或 snapshot
+// 2. compute / insert_or_assign 在分片的写锁内完成，对同一个键值是原子的
+// 3. for_each / snapshot / size 逐个分片加读锁，每个分片内部是一致的，但各分片之间不是同一时刻的快照
+// 4. 分片个数是 2 的幂，构造后不再改变，各分片独立 rehash
+// 5. 不可复制，不可移动
+//
+// 异常保证：
+// mystl::concurrent_unordered_map<Key, T> 满足基本异常保证，对以下等函数做强异常安全保证：
+//   * emplace
+//   * insert
+//   * insert_or_assign
+
+#include <atomic>
+#include <thread>
+
+#include "hashtable.h"
+#include "vector.h"
+
+namespace mystl
+{
+
+// 分片之间的间隔，避免相邻分片的锁落在同一条缓存行上
+static constexpr size_t cmap_cache_line = 64;
+
+// 读写自旋锁
+// 低位记录持有读锁的线程数，最高位表示写锁被持有，次高位表示有写者在等待
+// 有写者等待时新的读者不再进入，写者不会被源源不断的读者饿死
+class cmap_rw_lock
+{
+private:
+  static constexpr unsigned writer  = 1u << 31;
+  static constexpr unsigned waiting = 1u << 30;
+
+  std::atomic<unsigned> state_;
+  std::atomic<size_t>   contended_;  // 第一次尝试没有拿到锁的次数
+
+public:
+  cmap_rw_lock() noexcept :state_(0), contended_(0) {}
+
+  cmap_rw_lock(const cmap_rw_lock&) = delete;
+  cmap_rw_lock& operator=(const cmap_rw_lock&) = delete;
+
+  void lock_shared() noexcept
+  {
+    if (try_lock_shared())
+      return;
+    contended_.fetch_add(1, std::memory_order_relaxed);
+    while (!try_lock_shared())
+      std::this_thread::yield();
+  }
+
+  bool try_lock_shared() noexcept
+  {
+    unsigned s = state_.load(std::memory_order_relaxed);
+    return (s & (writer | waiting)) == 0 &&
+      state_.compare_exchange_weak(s, s + 1, std::memory_order_acquire,
+                                   std::memory_order_relaxed);
+  }
+
+  void unlock_shared() noexcept
+  {
+    state_.fetch_sub(1, std::memory_order_release);
+  }
+
+  void lock() noexcept
+  {
+    if (try_lock())
+      return;
+    contended_.fetch_add(1, std::memory_order_relaxed);
+    while (!try_lock())
+    {
+      // 拿不到锁时挂上等待标记，拦住后来的读者
+      state_.fetch_or(waiting, std::memory_order_relaxed);
+      std::this_thread::yield();
+    }
+  }
+
+  bool try_lock() noexcept
+  {
+    unsigned s = state_.load(std::memory_order_relaxed);
+    // 只剩等待标记时可以拿锁，拿到后清掉等待标记，其余等待的写者会重新挂上
+    return (s & ~waiting) == 0 &&
+      state_.compare_exchange_weak(s, writer, std::memory_order_acquire,
+                                   std::memory_order_relaxed);
+  }
+
+  void unlock() noexcept
+  {
+    state_.fetch_and(~writer, std::memory_order_release);
+  }
+
+  size_t contended() const noexcept
+  {
+    return contended_.load(std::memory_order_relaxed);
+  }
+};
+
+// 加读锁 / 写锁的守卫
+class cmap_read_guard
+{
+private:
+  cmap_rw_lock& lock_;
+
+public:
+  explicit cmap_read_guard(cmap_rw_lock& lock) noexcept :lock_(lock) { lock_.lock_shared(); }
+  ~cmap_read_guard() { lock_.unlock_shared(); }
+
+  cmap_read_guard(const cmap_read_guard&) = delete;
+  cmap_read_guard& operator=(const cmap_read_guard&) = delete;
+};
+
+class cmap_write_guard
+{
+private:
+  cmap_rw_lock& lock_;
+
+public:
+  explicit cmap_write_guard(cmap_rw_lock& lock) noexcept :lock_(lock) { lock_.lock(); }
+  ~cmap_write_guard() { lock_.unlock(); }
+
+  cmap_write_guard(const cmap_write_guard&) = delete;
+  cmap_write_guard& operator=(const cmap_write_guard&) = delete;
+};
+
+// 单个分片的统计信息
+struct cmap_shard_stats
+{
+  size_t size;          // 元素个数
+  size_t bucket_count;  // bucket 个数
+  float  load_factor;   // 负载系数
+  size_t contended;     // 加锁时发生等待的次数
+};
+
+// 模板类 concurrent_unordered_map，键值不允许重复
+// 参数一代表键值类型，参数二代表实值类型，参数三代表哈希函数，缺省使用 mystl::hash
+// 参数四代表键值比较方式，缺省使用 mystl::equal_to
+template <class Key, class T, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>>
+class concurrent_unordered_map
+{
+private:
+  // 每个分片使用 hashtable 作为底层机制
+  typedef hashtable<mystl::pair<const Key, T>, Hash, KeyEqual> table_type;
+
+  struct shard
+  {
+    mutable cmap_rw_lock lock;
+    table_type           table;
+    char                 padding[cmap_cache_line];
+
+    shard(const Hash& hash, const KeyEqual& equal)
+      :table(0, hash, equal)
+    {
+    }
+  };
+
+  typedef mystl::allocator<shard> shard_allocator;
+
+public:
+  typedef typename table_type::key_type             key_type;
+  typedef typename table_type::mapped_type          mapped_type;
+  typedef typename table_type::value_type           value_type;
+  typedef typename table_type::hasher               hasher;
+  typedef typename table_type::key_equal            key_equal;
+  typedef typename table_type::size_type            size_type;
+  typedef cmap_shard_stats                          shard_stats;
+
+  // snapshot 返回的元素类型，键值不再是 const，可以存放在 vector 中
+  typedef mystl::pair<Key, T>                       snapshot_value_type;
+
+private:
+  shard*    shards_;
+  size_type shard_count_;
+  size_type shard_bits_;  // shard_count_ == 1 << shard_bits_
+  hasher    hash_;
+
+public:
+  // 构造、析构函数
+
+  // shard_count 为 0 时取硬件线程数的四倍，总会向上取到 2 的幂
+  explicit concurrent_unordered_map(size_type shard_count = 0,
+                                    const Hash& hash = Hash(),
+                                    const KeyEqual& equal = KeyEqual())
+    :shards_(nullptr), shard_count_(0), shard_bits_(0), hash_(hash)
+  {
+    init(shard_count, equal);
+  }
+
+  concurrent_unordered_map(const concurrent_unordered_map&) = delete;
+  concurrent_unordered_map& operator=(const concurrent_unordered_map&) = delete;
+
+  ~concurrent_unordered_map()
+  {
+    for (size_type i = 0; i < shard_count_; ++i)
+      mystl::destroy(shards_ + i);
+    shard_allocator::deallocate(shards_, shard_count_);
+  }
+
+  // 容量相关
+
+  bool      empty() const;
+  size_type size()  const;
+
+  // 修改容器操作
+
+  // 插入成功返回 true，键值已存在返回 false
+  template <class ...Args>
+  bool emplace(Args&& ...args);
+
+  bool insert(const value_type& value)
+  { return emplace(value); }
+  bool insert(value_type&& value)
+  { return emplace(mystl::move(value)); }
+
+  // 键值不存在时插入，存在时赋值，插入返回 true
+  template <class M>
+  bool insert_or_assign(const key_type& key, M&& obj);
+
+  // 持有写锁调用 f(mapped_type&)，键值不存在时先插入一个值初始化的元素，插入返回 true
+  template <class F>
+  bool compute(const key_type& key, F f);
+
+  // 键值存在时持有写锁调用 f(mapped_type&)，返回键值是否存在
+  template <class F>
+  bool compute_if_present(const key_type& key, F f);
+
+  size_type erase(const key_type& key);
+  void      clear();
+
+  // 查找相关
+
+  // 找到时把实值复制到 value 中并返回 true
+  bool      find(const key_type& key, mapped_type& value) const;
+  size_type count(const key_type& key) const;
+
+  // 遍历相关
+
+  // 逐个分片持有读锁调用 f(const value_type&)
+  template <class F>
+  void for_each(F f) const;
+
+  // 复制出所有元素
+  mystl::vector<snapshot_value_type> snapshot() const;
+
+  // 分片相关
+
+  size_type   shard_count() const noexcept { return shard_count_; }
+  shard_stats stats(size_type n) const;
+
+  // hash policy
+
+  // 把 count 个元素所需的 bucket 平均分给各个分片
+  void      reserve(size_type count);
+
+  hasher    hash_fcn() const { return hash_; }
+  key_equal key_eq()   const { return shards_[0].table.key_eq(); }
+
+private:
+  void   init(size_type n, const KeyEqual& equal);
+
+  // 用哈希值的高位选择分片，低位留给分片内的 bucket
+  shard& shard_of(const key_type& key) const
+  {
+    const size_t h = hash_mix(hash_(key));
+    return shards_[h >> (sizeof(size_t) * 8 - 1 - shard_bits_) >> 1];
+  }
+};
+
+/*****************************************************************************************/
+
+template <class Key, class T, class Hash, class KeyEqual>
+bool concurrent_unordered_map<Key, T, Hash, KeyEqual>::
+empty() const
+{
+  for (size_type i = 0; i < shard_count_; ++i)
+  {
+    cmap_read_guard guard(shards_[i].lock);
+    if (!shards_[i].table.empty())
+      return false;
+  }
+  return true;
+}
+
+template <class Key, class T, class Hash, class KeyEqual>
+typename concurrent_unordered_map<Key, T, Hash, KeyEqual>::size_type
+concurrent_unordered_map<Key, T, Hash, KeyEqual>::
+size() const
+{
+  size_type n = 0;
+  for (size_type i = 0; i < shard_count_; ++i)
+  {
+    cmap_read_guard guard(shards_[i].lock);
+    n += shards_[i].table.size();
+  }
+  return n;
+}
+
+// 在锁外构造元素，缩短持锁时间
+template <class Key, class T, class Hash, class KeyEqual>
+template <class ...Args>
+bool concurrent_unordered_map<Key, T, Hash, KeyEqual>::
+emplace(Args&& ...args)
+{
+  value_type value(mystl::forward<Args>(args)...);
+  shard& s = shard_of(value.first);
+  cmap_write_guard guard(s.lock);
+  return s.table.insert_unique(mystl::move(value)).second;
+}
+
+template <class Key, class T, class Hash, class KeyEqual>
+template <class M>
+bool concurrent_unordered_map<Key, T, Hash, KeyEqual>::
+insert_or_assign(const key_type& key, M&& obj)
+{
+  shard& s = shard_of(key);
+  cmap_write_guard guard(s.lock);
+  auto it = s.table.find(key);
+  if (it != s.table.end())
+  {
+    it->second = mystl::forward<M>(obj);
+    return false;
+  }
+  s.table.emplace_unique(key, mystl::forward<M>(obj));
+  return true;
+}
+
+template <class Key, class T, class Hash, class KeyEqual>
+template <class F>
+bool concurrent_unordered_map<Key, T, Hash, KeyEqual>::
+compute(const key_type& key, F f)
+{
+  shard& s = shard_of(key);
+  cmap_write_guard guard(s.lock);
+  auto it = s.table.find(key);
+  if (it != s.table.end())
+  {
+    f(it->second);
+    return false;
+  }
+  it = s.table.emplace_unique(key, T{}).first;
+  f(it->second);
+  return true;
+}
+
+template <class Key, class T, class Hash, class KeyEqual>
+template <class F>
+bool concurrent_unordered_map<Key, T, Hash, KeyEqual>::
+compute_if_present(const key_type& key, F f)
+{
+  shard& s = shard_of(key);
+  cmap_write_guard guard(s.lock);
+  auto it = s.table.find(key);
+  if (it == s.table.end())
+    return false;
+  f(it->second);
+  return true;
+}
+
+template <class Key, class T, class Hash, class KeyEqual>
+typename concurrent_unordered_map<Key, T, Hash, KeyEqual>::size_type
+concurrent_unordered_map<Key, T, Hash, KeyEqual>::
+erase(const key_type& key)
+{
+  shard& s = shard_of(key);
+  cmap_write_guard guard(s.lock);
+  return s.table.erase_unique(key);
+}
+
+template <class Key, class T, class Hash, class KeyEqual>
+void concurrent_unordered_map<Key, T, Hash, KeyEqual>::
+clear()
+{
+  for (size_type i = 0; i < shard_count_; ++i)
+  {
+    cmap_write_guard guard(shards_[i].lock);
+    shards_[i].table.clear();
+  }
+}
+
+template <class Key, class T, class Hash, class KeyEqual>
+bool concurrent_unordered_map<Key, T, Hash, KeyEqual>::
+find(const key_type& key, mapped_type& value) const
+{
+  const shard& s = shard_of(key);
+  cmap_read_guard guard(s.lock);
+  auto it = s.table.find(key);
+  if (it == s.table.end())
+    return false;
+  value = it->second;
+  return true;
+}
+
+template <class Key, class T, class Hash, class KeyEqual>
+typename concurrent_unordered_map<Key, T, Hash, KeyEqual>::size_type
+concurrent_unordered_map<Key, T, Hash, KeyEqual>::
+count(const key_type& key) const
+{
+  const shard& s = shard_of(key);
+  cmap_read_guard guard(s.lock);
+  return s.table.count(key);
+}
+
+template <class Key, class T, class Hash, class KeyEqual>
+template <class F>
+void concurrent_unordered_map<Key, T, Hash, KeyEqual>::
+for_each(F f) const
+{
+  for (size_type i = 0; i < shard_count_; ++i)
+  {
+    cmap_read_guard guard(shards_[i].lock);
+    for (const auto& value : shards_[i].table)
+      f(value);
+  }
+}
+
+template <class Key, class T, class Hash, class KeyEqual>
+mystl::vector<typename concurrent_unordered_map<Key, T, Hash, KeyEqual>::snapshot_value_type>
+concurrent_unordered_map<Key, T, Hash, KeyEqual>::
+snapshot() const
+{
+  mystl::vector<snapshot_value_type> result;
+  for (size_type i = 0; i < shard_count_; ++i)
+  {
+    cmap_read_guard guard(shards_[i].lock);
+    result.reserve(result.size() + shards_[i].table.size());
+    for (const auto& value : shards_[i].table)
+      result.emplace_back(value.first, value.second);
+  }
+  return result;
+}
+
+template <class Key, class T, class Hash, class KeyEqual>
+typename concurrent_unordered_map<Key, T, Hash, KeyEqual>::shard_stats
+concurrent_unordered_map<Key, T, Hash, KeyEqual>::
+stats(size_type n) const
+{
+  THROW_OUT_OF_RANGE_IF(n >= shard_count_, "concurrent_unordered_map<Key, T> shard index out of range");
+  const shard& s = shards_[n];
+  cmap_read_guard guard(s.lock);
+  shard_stats result;
+  result.size = s.table.size();
+  result.bucket_count = s.table.bucket_count();
+  result.load_factor = s.table.load_factor();
+  result.contended = s.lock.contended();
+  return result;
+}
+
+template <class Key, class T, class Hash, class KeyEqual>
+void concurrent_unordered_map<Key, T, Hash, KeyEqual>::
+reserve(size_type count)
+{
+  const size_type per_shard = count / shard_count_ + 1;
+  for (size_type i = 0; i < shard_count_; ++i)
+  {
+    cmap_write_guard guard(shards_[i].lock);
+    shards_[i].table.reserve(per_shard);
+  }
+}
+
+/*****************************************************************************************/
+// helper function
+
+// init 函数
+template <class Key, class T, class Hash, class KeyEqual>
+void concurrent_unordered_map<Key, T, Hash, KeyEqual>::
+init(size_type n, const KeyEqual& equal)
+{
+  if (n == 0)
+    n = static_cast<size_type>(std::thread::hardware_concurrency()) * 4;
+  size_type bits = 0;
+  while ((static_cast<size_type>(1) << bits) < n && bits + 1 < sizeof(size_t) * 8)
+    ++bits;
+  shards_ = shard_allocator::allocate(static_cast<size_type>(1) << bits);
+  size_type i = 0;
+  try
+  {
+    for (; i < (static_cast<size_type>(1) << bits); ++i)
+      mystl::construct(shards_ + i, hash_, equal);
+  }
+  catch (...)
+  {
+    for (size_type j = 0; j < i; ++j)
+      mystl::destroy(shards_ + j);
+    shard_allocator::deallocate(shards_, static_cast<size_type>(1) << bits);
+    throw;
+  }
+  shard_count_ = static_cast<size_type>(1) << bits;
+  shard_bits_ = bits;
+}
+
+} // namespace mystl
+#endif // !MYTINYSTL_CONCURRENT_UNORDERED_MAP_H_
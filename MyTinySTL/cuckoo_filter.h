@@ -0,0 +1,466 @@
+﻿#ifndef MYTINYSTL_CUCKOO_FILTER_H_
+#define MYTINYSTL_CUCKOO_FILTER_H_
+
+// 这个头文件包含一个模板类 cuckoo_filter
+// cuckoo_filter : 布谷鸟过滤器，与布隆过滤器一样用于快速排除不存在的键值，不同的是支持删除
+
+// notes:
+//
+// 1. 表由 2 的幂个桶组成，每个桶 4 个槽位，每个槽位保存键值的一个不为 0 的 f 位指纹（0 表示空槽位），
+//    f 为 4 ~ 16 之间的偶数，一个桶占 4f 位即 f / 2 个字节，桶与桶之间紧密排列，不跨越字节；
+//    读写一个桶时取从桶的起点开始的 8 个字节，只使用其中的 4f 位
+// 2. 键值先用 Hash（缺省为 mystl::hash）求哈希值，再用 wy_mix 派生出 64 位值：低位选第一个桶 i1，
+//    高位给出指纹 f；第二个桶为 i2 = i1 ^ mix(f)，只凭指纹和所在的桶就能算出另一个桶，所以删除与搬迁
+//    都不需要原来的键值
+// 3. 在桶内查找指纹与空槽位使用字内并行（SWAR）的比较：一次减法、与、非就得到 4 个槽位的比较结果，
+//    槽位的宽度在构造时确定，比较用的常数由 f 算出
+// 4. 两个桶都满时随机踢出一个指纹，搬到它的另一个桶，最多搬 max_kicks 次；仍然失败时把最后一个
+//    被踢出的指纹放进 victim，过滤器视为已满；之后的插入先尝试把 victim 搬回表中，仍然失败时返回 false
+// 5. 按目标假阳性率构造时，指纹位数取 ceil(log2(8 / fpp))（每次查询最多比较 8 个槽位）向上取偶数，
+//    范围为 4 ~ 16 位，所以占用的内存随目标假阳性率变化；按装载率 95% 选桶数，每个键值约占 f / 0.95 位
+// 6. 同一个键值插入 k 次要删除 k 次；删除从未插入的键值可能删掉别的键值的指纹，调用方需要保证
+//    只删除插入过的键值
+// 7. 形状（桶数与指纹位数）相同的两个过滤器可以合并，合并就是把另一个过滤器的指纹逐个插入
+//
+// 异常保证：
+// 合并形状不同的过滤器时抛出 std::runtime_error，过滤器不变
+
+#include <cmath>
+#include <cstring>
+
+#include "functional.h"
+#include "memory.h"
+#include "exceptdef.h"
+#include "simd.h"
+#include "util.h"
+
+namespace mystl
+{
+
+// 模板类 cuckoo_filter
+// 参数一代表键值类型，参数二代表哈希函数，缺省使用 mystl::hash
+template <class Key, class Hash = mystl::hash<Key>>
+class cuckoo_filter
+{
+public:
+  // cuckoo_filter 的型别定义
+  typedef Key                          key_type;
+  typedef Hash                         hasher;
+  typedef size_t                       size_type;
+  typedef uint64_t                     bucket_type;    // 4 个 f 位的槽位，放在低 4f 位
+  typedef uint16_t                     fingerprint_type;
+  typedef mystl::allocator<uint64_t>   word_allocator;
+
+  static constexpr size_type bucket_slots = 4;
+  static constexpr size_type max_kicks    = 500;
+
+private:
+  uint64_t*        table_;          // 紧密排列的桶，末尾多留一个字，读写最后一个桶时不越界
+  size_type        bucket_count_;   // 桶数，2 的幂
+  size_type        size_;           // 保存的指纹个数，包括 victim
+  unsigned         fp_bits_;        // 指纹的位数
+  bool             has_victim_;
+  size_type        victim_index_;
+  fingerprint_type victim_fp_;
+  uint64_t         rng_;            // 踢出指纹时使用的 xorshift 状态
+  hasher           hash_;
+
+public:
+  // 构造、复制、移动、析构函数
+
+  // 按预计的元素个数与目标假阳性率确定桶数与指纹位数
+  explicit cuckoo_filter(size_type expected = 0, double fpp = 0.001, const Hash& hash = Hash())
+    :table_(nullptr), bucket_count_(0), size_(0), fp_bits_(0), has_victim_(false),
+     victim_index_(0), victim_fp_(0), rng_(0x9e3779b97f4a7c15ull), hash_(hash)
+  {
+    THROW_RUNTIME_ERROR_IF(!(fpp > 0.0 && fpp < 1.0),
+                           "cuckoo_filter<Key>'s false positive rate must be in (0, 1)");
+    fp_bits_ = bits_for(fpp);
+    allocate_buckets(buckets_for(expected));
+  }
+
+  cuckoo_filter(const cuckoo_filter& rhs)
+    :table_(nullptr), bucket_count_(0), size_(rhs.size_), fp_bits_(rhs.fp_bits_),
+     has_victim_(rhs.has_victim_), victim_index_(rhs.victim_index_), victim_fp_(rhs.victim_fp_),
+     rng_(rhs.rng_), hash_(rhs.hash_)
+  {
+    allocate_buckets(rhs.bucket_count_);
+    std::memcpy(table_, rhs.table_, word_count() * sizeof(uint64_t));
+  }
+  // 被移动的过滤器换成只有一个空桶的过滤器，仍然可以插入、查询与删除
+  cuckoo_filter(cuckoo_filter&& rhs)
+    :table_(nullptr), bucket_count_(0), size_(0), fp_bits_(rhs.fp_bits_), has_victim_(false),
+     victim_index_(0), victim_fp_(0), rng_(rhs.rng_), hash_(rhs.hash_)
+  {
+    allocate_buckets(1);
+    swap(rhs);
+  }
+
+  cuckoo_filter& operator=(const cuckoo_filter& rhs)
+  {
+    if (this != &rhs)
+    {
+      cuckoo_filter tmp(rhs);
+      swap(tmp);
+    }
+    return *this;
+  }
+  cuckoo_filter& operator=(cuckoo_filter&& rhs) noexcept
+  {
+    swap(rhs);
+    return *this;
+  }
+
+  ~cuckoo_filter()
+  {
+    if (table_ != nullptr)
+      word_allocator::deallocate(table_, word_count());
+  }
+
+public:
+  // 容量相关
+  bool      empty()            const noexcept { return size_ == 0; }
+  size_type size()             const noexcept { return size_; }
+  size_type capacity()         const noexcept { return bucket_count_ * bucket_slots; }
+  size_type bucket_count()     const noexcept { return bucket_count_; }
+  size_type bytes()            const noexcept { return word_count() * sizeof(uint64_t); }
+  unsigned  fingerprint_bits() const noexcept { return fp_bits_; }
+  bool      full()             const noexcept { return has_victim_; }
+  double    load_factor()      const noexcept
+  { return static_cast<double>(size_) / static_cast<double>(capacity()); }
+
+  // 插入、查询与删除，contains 返回 false 时键值一定不存在，返回 true 时可能是假阳性
+  // 过滤器已满时 insert 返回 false
+  bool insert(const key_type& key)         { return insert_hash(hash_(key)); }
+  bool contains(const key_type& key) const noexcept { return contains_hash(hash_(key)); }
+  bool erase(const key_type& key)          noexcept { return erase_hash(hash_(key)); }
+
+  bool insert_hash(size_t h);
+  bool contains_hash(size_t h) const noexcept;
+  bool erase_hash(size_t h) noexcept;
+
+  // 合并形状相同的过滤器，过滤器满了返回 false
+  bool merge(const cuckoo_filter& other);
+
+  void clear() noexcept
+  {
+    std::memset(table_, 0, word_count() * sizeof(uint64_t));
+    size_ = 0;
+    has_victim_ = false;
+  }
+
+  void swap(cuckoo_filter& rhs) noexcept
+  {
+    mystl::swap(table_, rhs.table_);
+    mystl::swap(bucket_count_, rhs.bucket_count_);
+    mystl::swap(size_, rhs.size_);
+    mystl::swap(fp_bits_, rhs.fp_bits_);
+    mystl::swap(has_victim_, rhs.has_victim_);
+    mystl::swap(victim_index_, rhs.victim_index_);
+    mystl::swap(victim_fp_, rhs.victim_fp_);
+    mystl::swap(rng_, rhs.rng_);
+    mystl::swap(hash_, rhs.hash_);
+  }
+
+  // 以当前的装载率估计的假阳性率：两个桶里平均有 2 * size / bucket_count 个指纹，
+  // 每个与查询的指纹相同的概率为 1 / (2^f - 1)
+  double estimated_fpp() const noexcept
+  {
+    const double per_fp = 1.0 / static_cast<double>((uint64_t(1) << fp_bits_) - 1);
+    return 1.0 - std::pow(1.0 - per_fp,
+                          2.0 * static_cast<double>(size_) / static_cast<double>(bucket_count_));
+  }
+
+  hasher hash_fcn() const { return hash_; }
+
+  // 目标假阳性率所需的指纹位数与预计元素个数所需的桶数
+  static unsigned  bits_for(double fpp) noexcept;
+  static size_type buckets_for(size_type expected) noexcept;
+
+private:
+  // helper functions
+
+  void allocate_buckets(size_type count);
+
+  // 一个桶占的字节数与整张表占的字数
+  size_type bucket_bytes() const noexcept { return bucket_slots * fp_bits_ / 8; }
+  size_type word_count()   const noexcept
+  { return (bucket_count_ * bucket_bytes() + sizeof(uint64_t) - 1) / sizeof(uint64_t) + 1; }
+
+  // 每个槽位的最低位、最高位，以及一个桶的 4f 位
+  uint64_t lane_low()    const noexcept
+  { return 1 | (uint64_t(1) << fp_bits_) | (uint64_t(1) << 2 * fp_bits_) | (uint64_t(1) << 3 * fp_bits_); }
+  uint64_t lane_high()   const noexcept { return lane_low() << (fp_bits_ - 1); }
+  uint64_t bucket_mask() const noexcept
+  { return fp_bits_ == 16 ? ~uint64_t(0) : (uint64_t(1) << bucket_slots * fp_bits_) - 1; }
+
+  // 8 字节窗口按小端字节序解释，桶 i 的 f / 2 个字节总在低位
+  static uint64_t little_endian(uint64_t v) noexcept
+  {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return __builtin_bswap64(v);
+#else
+    return v;
+#endif
+  }
+
+  // 读写桶 i，写入时保留 8 字节窗口中属于其它桶的位
+  bucket_type load(size_type i) const noexcept
+  {
+    uint64_t v;
+    std::memcpy(&v, reinterpret_cast<const unsigned char*>(table_) + i * bucket_bytes(), 8);
+    return little_endian(v) & bucket_mask();
+  }
+  void store(size_type i, bucket_type b) noexcept
+  {
+    const auto p = reinterpret_cast<unsigned char*>(table_) + i * bucket_bytes();
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    v = little_endian((little_endian(v) & ~bucket_mask()) | b);
+    std::memcpy(p, &v, 8);
+  }
+
+  static uint64_t key_hash(size_t h) noexcept
+  { return wy_mix(static_cast<uint64_t>(h) ^ wy_secret[0], wy_secret[1]); }
+
+  // 指纹取哈希值的高位，为 0 时改为 1，0 留给空槽位
+  fingerprint_type fingerprint(uint64_t k) const noexcept
+  {
+    const auto f = static_cast<fingerprint_type>((k >> 32) & ((uint64_t(1) << fp_bits_) - 1));
+    return f != 0 ? f : fingerprint_type(1);
+  }
+
+  size_type index1(uint64_t k) const noexcept
+  { return static_cast<size_type>(k) & (bucket_count_ - 1); }
+
+  // 另一个桶，对同一个指纹调用两次回到原来的桶
+  size_type alt_index(size_type i, fingerprint_type f) const noexcept
+  { return (i ^ static_cast<size_type>(static_cast<uint64_t>(f) * 0x5bd1e995ull)) & (bucket_count_ - 1); }
+
+  // 每个为 0 的槽位的最高位置 1；最低的一个一定准确，更高的槽位可能因借位误报
+  uint64_t zero_lanes(bucket_type x) const noexcept
+  { return (x - lane_low()) & ~x & lane_high(); }
+
+  uint64_t match_lanes(bucket_type b, fingerprint_type f) const noexcept
+  { return zero_lanes(b ^ (lane_low() * f)); }
+
+  // 最低的一个被置位的槽位在桶内的位移
+  static unsigned lowest_shift(uint64_t lanes, unsigned bits) noexcept
+  { return ctz64(lanes) / bits * bits; }
+
+  bool has(size_type i, fingerprint_type f) const noexcept
+  { return match_lanes(load(i), f) != 0; }
+
+  // 放入桶 i 的空槽位，没有空槽位时返回 false
+  bool put(size_type i, fingerprint_type f) noexcept
+  {
+    const auto b = load(i);
+    const auto lanes = zero_lanes(b);
+    if (lanes == 0)
+      return false;
+    store(i, b | static_cast<uint64_t>(f) << lowest_shift(lanes, fp_bits_));
+    return true;
+  }
+
+  // 从桶 i 中删除一个指纹 f
+  bool remove(size_type i, fingerprint_type f) noexcept
+  {
+    const auto b = load(i);
+    const auto lanes = match_lanes(b, f);
+    if (lanes == 0)
+      return false;
+    store(i, b & ~(static_cast<uint64_t>(slot_mask()) << lowest_shift(lanes, fp_bits_)));
+    return true;
+  }
+
+  fingerprint_type slot_mask() const noexcept
+  { return static_cast<fingerprint_type>((uint64_t(1) << fp_bits_) - 1); }
+
+  uint64_t next_random() noexcept
+  {
+    rng_ ^= rng_ << 13;
+    rng_ ^= rng_ >> 7;
+    rng_ ^= rng_ << 17;
+    return rng_;
+  }
+
+  bool insert_fingerprint(size_type i, fingerprint_type f);
+};
+
+/*****************************************************************************************/
+
+template <class Key, class Hash>
+constexpr typename cuckoo_filter<Key, Hash>::size_type cuckoo_filter<Key, Hash>::bucket_slots;
+
+template <class Key, class Hash>
+constexpr typename cuckoo_filter<Key, Hash>::size_type cuckoo_filter<Key, Hash>::max_kicks;
+
+// 插入一个哈希值
+template <class Key, class Hash>
+bool cuckoo_filter<Key, Hash>::
+insert_hash(size_t h)
+{
+  const auto k = key_hash(h);
+  return insert_fingerprint(index1(k), fingerprint(k));
+}
+
+// 查询一个哈希值，两个桶与 victim 中有相同的指纹就可能存在
+template <class Key, class Hash>
+bool cuckoo_filter<Key, Hash>::
+contains_hash(size_t h) const noexcept
+{
+  const auto k = key_hash(h);
+  const auto f = fingerprint(k);
+  const auto i1 = index1(k);
+  const auto i2 = alt_index(i1, f);
+  if (has(i1, f) || has(i2, f))
+    return true;
+  return has_victim_ && victim_fp_ == f && (victim_index_ == i1 || victim_index_ == i2);
+}
+
+// 删除一个哈希值对应的指纹，删除后若有 victim 则把它放回表中
+template <class Key, class Hash>
+bool cuckoo_filter<Key, Hash>::
+erase_hash(size_t h) noexcept
+{
+  const auto k = key_hash(h);
+  const auto f = fingerprint(k);
+  const auto i1 = index1(k);
+  const auto i2 = alt_index(i1, f);
+  if (remove(i1, f) || remove(i2, f))
+  {
+    --size_;
+    if (has_victim_)
+    { // 刚腾出的槽位不一定是 victim 能用的，放不下时仍保留在 victim 中
+      if (put(victim_index_, victim_fp_) || put(alt_index(victim_index_, victim_fp_), victim_fp_))
+        has_victim_ = false;
+    }
+    return true;
+  }
+  if (has_victim_ && victim_fp_ == f && (victim_index_ == i1 || victim_index_ == i2))
+  {
+    has_victim_ = false;
+    --size_;
+    return true;
+  }
+  return false;
+}
+
+// 把桶 i 的指纹 f 放入表中，两个桶都满时随机踢出指纹
+template <class Key, class Hash>
+bool cuckoo_filter<Key, Hash>::
+insert_fingerprint(size_type i, fingerprint_type f)
+{
+  if (has_victim_)
+  { // 先把 victim 搬回表中，删除腾出的位置可能不在它的两个桶里，需要再踢一次
+    has_victim_ = false;
+    --size_;
+    insert_fingerprint(victim_index_, victim_fp_);
+    if (has_victim_)
+      return false;
+  }
+  if (put(i, f))
+  {
+    ++size_;
+    return true;
+  }
+  i = alt_index(i, f);
+  if (put(i, f))
+  {
+    ++size_;
+    return true;
+  }
+  for (size_type n = 0; n < max_kicks; ++n)
+  {
+    const auto r = next_random();
+    if (r & 1)
+      i = alt_index(i, f);
+    const unsigned shift = static_cast<unsigned>(fp_bits_ * ((r >> 1) % bucket_slots));
+    const auto b = load(i);
+    const auto victim = static_cast<fingerprint_type>((b >> shift) & slot_mask());
+    store(i, (b & ~(static_cast<uint64_t>(slot_mask()) << shift)) | (static_cast<uint64_t>(f) << shift));
+    f = victim;
+    i = alt_index(i, f);
+    if (put(i, f))
+    {
+      ++size_;
+      return true;
+    }
+  }
+  // 搬迁失败，最后被踢出的指纹留在 victim 中，它仍然能被查到
+  has_victim_ = true;
+  victim_index_ = i;
+  victim_fp_ = f;
+  ++size_;
+  return true;
+}
+
+// 合并形状相同的过滤器
+template <class Key, class Hash>
+bool cuckoo_filter<Key, Hash>::
+merge(const cuckoo_filter& other)
+{
+  THROW_RUNTIME_ERROR_IF(bucket_count_ != other.bucket_count_ || fp_bits_ != other.fp_bits_,
+                         "cuckoo_filter<Key>'s merge needs filters of the same shape");
+  if (this == &other)
+  {
+    const cuckoo_filter tmp(other);
+    return merge(tmp);
+  }
+  for (size_type i = 0; i < other.bucket_count_; ++i)
+  {
+    for (auto b = other.load(i); b != 0; b >>= fp_bits_)
+    {
+      const auto f = static_cast<fingerprint_type>(b & slot_mask());
+      if (f != 0 && !insert_fingerprint(i, f))
+        return false;
+    }
+  }
+  if (other.has_victim_)
+    return insert_fingerprint(other.victim_index_, other.victim_fp_);
+  return true;
+}
+
+// 每次查询最多比较 2 * 4 个指纹，假阳性率约为 8 / 2^f，f 向上取偶数，使桶占整数个字节
+template <class Key, class Hash>
+unsigned cuckoo_filter<Key, Hash>::
+bits_for(double fpp) noexcept
+{
+  const double bits = std::ceil(std::log2(2.0 * bucket_slots / fpp));
+  const unsigned f = bits < 4.0 ? 4u : bits > 16.0 ? 16u : static_cast<unsigned>(bits);
+  return (f + 1) & ~1u;
+}
+
+// 按 95% 的装载率取桶数，向上取 2 的幂
+template <class Key, class Hash>
+typename cuckoo_filter<Key, Hash>::size_type
+cuckoo_filter<Key, Hash>::
+buckets_for(size_type expected) noexcept
+{
+  const auto need = static_cast<size_type>(
+    std::ceil(static_cast<double>(expected) / (0.95 * bucket_slots)));
+  size_type n = 1;
+  while (n < need)
+    n <<= 1;
+  return n;
+}
+
+// 申请 count 个清零的桶，指纹位数需要先确定
+template <class Key, class Hash>
+void cuckoo_filter<Key, Hash>::
+allocate_buckets(size_type count)
+{
+  bucket_count_ = count;
+  table_ = word_allocator::allocate(word_count());
+  std::memset(table_, 0, word_count() * sizeof(uint64_t));
+}
+
+// 重载 mystl 的 swap
+template <class Key, class Hash>
+void swap(cuckoo_filter<Key, Hash>& lhs, cuckoo_filter<Key, Hash>& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+
+} // namespace mystl
+#endif // !MYTINYSTL_CUCKOO_FILTER_H_
@@ -0,0 +1,936 @@
+﻿#ifndef MYTINYSTL_FLAT_HASHTABLE_H_
+#define MYTINYSTL_FLAT_HASHTABLE_H_
+
+// 这个头文件包含了一个模板类 flat_hashtable
+// flat_hashtable : 开放寻址的哈希表，元素直接存放在一段连续的槽位中，用控制字节按组探测
+
+// notes:
+//
+// 1. 每个槽位对应一个控制字节：空（empty）、已删除（deleted）或者哈希值的低 7 位（H2），
+//    末尾有一个哨兵字节（sentinel）用于迭代器停止
+// 2. 槽位按 16 个一组，查找时一次比较一组控制字节（有 SSE2 时用一条指令），只有 H2 相同的槽位才比较键值，
+//    遇到含有空槽位的组即可停止；组之间按三角数序列探测，容量为 2 的幂，保证能访问到所有组
+// 3. 最大装载因子固定为 7/8
+// 4. 删除元素时，若所在的组中还有空槽位，则直接置为空，否则才留下墓碑（deleted），
+//    因为任何查找在这个组都已经会停下；墓碑过多时在下一次扩容时原地重建
+// 5. 插入元素或者 rehash 可能移动元素，使所有迭代器、指针和引用失效；删除元素不会移动其他元素
+// 6. 不提供 bucket 接口，bucket_count 返回槽位的个数
+//
+// 异常保证：
+// mystl::flat_hashtable<T> 满足基本异常保证，若元素的移动构造函数不抛出异常，插入操作满足强异常安全保证
+
+#include <initializer_list>
+#include <cstring>
+
+#include "hashtable.h"
+#include "simd.h"
+
+namespace mystl
+{
+
+// 控制字节
+typedef signed char flat_ctrl_t;
+
+static constexpr flat_ctrl_t flat_ctrl_empty    = -128;  // 0b10000000
+static constexpr flat_ctrl_t flat_ctrl_deleted  = -2;    // 0b11111110
+static constexpr flat_ctrl_t flat_ctrl_sentinel = -1;    // 0b11111111
+
+static constexpr size_t flat_group_width = 16;
+
+// 所有空表共用的控制字节，只含哨兵，迭代时立即停止
+inline flat_ctrl_t* flat_ht_empty_ctrl() noexcept
+{
+  alignas(16) static const flat_ctrl_t ctrl[flat_group_width] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+  };
+  return const_cast<flat_ctrl_t*>(ctrl);
+}
+
+/*****************************************************************************************/
+// flat_ht_group
+// 一组 16 个控制字节，match 系列函数返回一个位掩码，第 i 位为 1 表示第 i 个字节满足条件
+/*****************************************************************************************/
+struct flat_ht_group
+{
+#ifdef MYSTL_HAS_SSE2
+  __m128i ctrl;
+
+  explicit flat_ht_group(const flat_ctrl_t* p) noexcept
+    :ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)))
+  {
+  }
+
+  // H2 等于 h2 的槽位
+  uint32_t match(flat_ctrl_t h2) const noexcept
+  { return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl))); }
+
+  // 空槽位
+  uint32_t match_empty() const noexcept
+  { return match(flat_ctrl_empty); }
+
+  // 空槽位或墓碑，二者都小于哨兵
+  uint32_t match_empty_or_deleted() const noexcept
+  {
+    return static_cast<uint32_t>(_mm_movemask_epi8(
+      _mm_cmpgt_epi8(_mm_set1_epi8(flat_ctrl_sentinel), ctrl)));
+  }
+
+  // 有元素的槽位或哨兵，二者都大于墓碑
+  uint32_t match_full_or_sentinel() const noexcept
+  {
+    return static_cast<uint32_t>(_mm_movemask_epi8(
+      _mm_cmpgt_epi8(ctrl, _mm_set1_epi8(flat_ctrl_deleted))));
+  }
+#else
+  const flat_ctrl_t* ctrl;
+
+  explicit flat_ht_group(const flat_ctrl_t* p) noexcept :ctrl(p) {}
+
+  uint32_t match(flat_ctrl_t h2) const noexcept
+  {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < flat_group_width; ++i)
+      mask |= static_cast<uint32_t>(ctrl[i] == h2) << i;
+    return mask;
+  }
+
+  uint32_t match_empty() const noexcept
+  { return match(flat_ctrl_empty); }
+
+  uint32_t match_empty_or_deleted() const noexcept
+  {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < flat_group_width; ++i)
+      mask |= static_cast<uint32_t>(ctrl[i] < flat_ctrl_sentinel) << i;
+    return mask;
+  }
+
+  uint32_t match_full_or_sentinel() const noexcept
+  {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < flat_group_width; ++i)
+      mask |= static_cast<uint32_t>(ctrl[i] > flat_ctrl_deleted) << i;
+    return mask;
+  }
+#endif
+};
+
+// forward declaration
+
+template <class T, class Hash, class KeyEqual>
+class flat_hashtable;
+
+template <class T>
+struct flat_ht_iterator;
+
+template <class T>
+struct flat_ht_const_iterator;
+
+// flat_ht_iterator
+
+template <class T>
+struct flat_ht_iterator_base :public mystl::iterator<mystl::forward_iterator_tag, T>
+{
+  typedef flat_ht_iterator_base<T>         base;
+  typedef mystl::flat_ht_iterator<T>       iterator;
+  typedef mystl::flat_ht_const_iterator<T> const_iterator;
+
+  typedef size_t                           size_type;
+  typedef ptrdiff_t                        difference_type;
+
+  flat_ctrl_t* ctrl;  // 当前槽位的控制字节
+  T*           slot;  // 当前槽位
+
+  flat_ht_iterator_base() = default;
+  flat_ht_iterator_base(flat_ctrl_t* c, T* s) :ctrl(c), slot(s) {}
+
+  bool operator==(const base& rhs) const { return ctrl == rhs.ctrl; }
+  bool operator!=(const base& rhs) const { return ctrl != rhs.ctrl; }
+
+  // 前进到下一个有元素的槽位，没有则停在哨兵处
+  void skip_empty_slots()
+  {
+    for (;;)
+    {
+      const auto mask = flat_ht_group(ctrl).match_full_or_sentinel();
+      if (mask != 0)
+      {
+        const auto n = ctz32(mask);
+        ctrl += n;
+        slot += n;
+        return;
+      }
+      ctrl += flat_group_width;
+      slot += flat_group_width;
+    }
+  }
+
+  void incr()
+  {
+    MYSTL_DEBUG(*ctrl >= 0);
+    ++ctrl;
+    ++slot;
+    skip_empty_slots();
+  }
+};
+
+template <class T>
+struct flat_ht_iterator :public flat_ht_iterator_base<T>
+{
+  typedef flat_ht_iterator_base<T>      base;
+  typedef typename base::iterator       iterator;
+  typedef typename base::const_iterator const_iterator;
+
+  typedef T                             value_type;
+  typedef value_type*                   pointer;
+  typedef value_type&                   reference;
+
+  using base::ctrl;
+  using base::slot;
+
+  flat_ht_iterator() = default;
+  flat_ht_iterator(flat_ctrl_t* c, T* s) :base(c, s) {}
+
+  reference operator*()  const { return *slot; }
+  pointer   operator->() const { return slot; }
+
+  iterator& operator++()
+  {
+    this->incr();
+    return *this;
+  }
+  iterator operator++(int)
+  {
+    iterator tmp = *this;
+    this->incr();
+    return tmp;
+  }
+};
+
+template <class T>
+struct flat_ht_const_iterator :public flat_ht_iterator_base<T>
+{
+  typedef flat_ht_iterator_base<T>      base;
+  typedef typename base::iterator       iterator;
+  typedef typename base::const_iterator const_iterator;
+
+  typedef T                             value_type;
+  typedef const value_type*             pointer;
+  typedef const value_type&             reference;
+
+  using base::ctrl;
+  using base::slot;
+
+  flat_ht_const_iterator() = default;
+  flat_ht_const_iterator(flat_ctrl_t* c, T* s) :base(c, s) {}
+  flat_ht_const_iterator(const iterator& rhs) :base(rhs.ctrl, rhs.slot) {}
+
+  reference operator*()  const { return *slot; }
+  pointer   operator->() const { return slot; }
+
+  const_iterator& operator++()
+  {
+    this->incr();
+    return *this;
+  }
+  const_iterator operator++(int)
+  {
+    const_iterator tmp = *this;
+    this->incr();
+    return tmp;
+  }
+};
+
+// 模板类 flat_hashtable
+// 参数一代表数据类型，参数二代表哈希函数，参数三代表键值相等的比较函数
+template <class T, class Hash, class KeyEqual>
+class flat_hashtable
+{
+public:
+  // flat_hashtable 的型别定义
+  typedef ht_value_traits<T>                       value_traits;
+  typedef typename value_traits::key_type          key_type;
+  typedef typename value_traits::mapped_type       mapped_type;
+  typedef typename value_traits::value_type        value_type;
+  typedef Hash                                     hasher;
+  typedef KeyEqual                                 key_equal;
+
+  typedef mystl::allocator<T>                      allocator_type;
+  typedef mystl::allocator<T>                      data_allocator;
+  typedef mystl::allocator<char>                   byte_allocator;
+
+  typedef typename allocator_type::pointer         pointer;
+  typedef typename allocator_type::const_pointer   const_pointer;
+  typedef typename allocator_type::reference       reference;
+  typedef typename allocator_type::const_reference const_reference;
+  typedef typename allocator_type::size_type       size_type;
+  typedef typename allocator_type::difference_type difference_type;
+
+  typedef mystl::flat_ht_iterator<T>               iterator;
+  typedef mystl::flat_ht_const_iterator<T>         const_iterator;
+
+  allocator_type get_allocator() const { return allocator_type(); }
+
+private:
+  // 控制字节与槽位放在同一块内存中：[ctrl_ .. ctrl_ + capacity_ + 16) 之后按 T 对齐放置槽位
+  flat_ctrl_t* ctrl_;
+  T*           slots_;
+  size_type    capacity_;     // 槽位个数，为 0 或不小于 16 的 2 的幂
+  size_type    size_;
+  size_type    growth_left_;  // 不需要扩容还能占用的空槽位个数
+  hasher       hash_;
+  key_equal    equal_;
+
+public:
+  // 构造、复制、移动、析构函数
+  explicit flat_hashtable(size_type bucket_count = 0,
+                          const Hash& hash = Hash(),
+                          const KeyEqual& equal = KeyEqual())
+    :ctrl_(flat_ht_empty_ctrl()), slots_(nullptr), capacity_(0), size_(0), growth_left_(0),
+     hash_(hash), equal_(equal)
+  {
+    if (bucket_count != 0)
+      resize(normalize_capacity(bucket_count));
+  }
+
+  flat_hashtable(const flat_hashtable& rhs)
+    :ctrl_(flat_ht_empty_ctrl()), slots_(nullptr), capacity_(0), size_(0), growth_left_(0),
+     hash_(rhs.hash_), equal_(rhs.equal_)
+  {
+    copy_init(rhs);
+  }
+  flat_hashtable(flat_hashtable&& rhs) noexcept
+    :ctrl_(rhs.ctrl_), slots_(rhs.slots_), capacity_(rhs.capacity_), size_(rhs.size_),
+     growth_left_(rhs.growth_left_), hash_(rhs.hash_), equal_(rhs.equal_)
+  {
+    rhs.reset_empty();
+  }
+
+  flat_hashtable& operator=(const flat_hashtable& rhs)
+  {
+    if (this != &rhs)
+    {
+      flat_hashtable tmp(rhs);
+      swap(tmp);
+    }
+    return *this;
+  }
+  flat_hashtable& operator=(flat_hashtable&& rhs) noexcept
+  {
+    flat_hashtable tmp(mystl::move(rhs));
+    swap(tmp);
+    return *this;
+  }
+
+  ~flat_hashtable()
+  {
+    destroy_slots();
+    deallocate(ctrl_, capacity_);
+  }
+
+  // 迭代器相关操作
+  iterator       begin()        noexcept
+  {
+    iterator it(ctrl_, slots_);
+    it.skip_empty_slots();
+    return it;
+  }
+  const_iterator begin()  const noexcept
+  {
+    const_iterator it(ctrl_, slots_);
+    it.skip_empty_slots();
+    return it;
+  }
+  iterator       end()          noexcept
+  { return iterator(ctrl_ + capacity_, slots_ + capacity_); }
+  const_iterator end()    const noexcept
+  { return const_iterator(ctrl_ + capacity_, slots_ + capacity_); }
+
+  const_iterator cbegin() const noexcept
+  { return begin(); }
+  const_iterator cend()   const noexcept
+  { return end(); }
+
+  // 容量相关操作
+  bool      empty()    const noexcept { return size_ == 0; }
+  size_type size()     const noexcept { return size_; }
+  size_type max_size() const noexcept { return static_cast<size_type>(-1) / (sizeof(T) + 1); }
+
+  // 修改容器相关操作
+
+  // emplace / emplace_hint
+
+  template <class ...Args>
+  pair<iterator, bool> emplace_unique(Args&& ...args);
+
+  // [note]: hint 对于开放寻址的哈希表没有意义，忽略
+  template <class ...Args>
+  iterator emplace_unique_use_hint(const_iterator /*hint*/, Args&& ...args)
+  { return emplace_unique(mystl::forward<Args>(args)...).first; }
+
+  // 键值为 key 的元素不存在时才用 args 构造元素，key 须与构造出的元素的键值相等
+  template <class ...Args>
+  pair<iterator, bool> emplace_key_unique(const key_type& key, Args&& ...args);
+
+  // insert
+
+  pair<iterator, bool> insert_unique(const value_type& value)
+  { return emplace_key_unique(value_traits::get_key(value), value); }
+  pair<iterator, bool> insert_unique(value_type&& value)
+  { return emplace_key_unique(value_traits::get_key(value), mystl::move(value)); }
+
+  iterator insert_unique_use_hint(const_iterator /*hint*/, const value_type& value)
+  { return insert_unique(value).first; }
+  iterator insert_unique_use_hint(const_iterator /*hint*/, value_type&& value)
+  { return insert_unique(mystl::move(value)).first; }
+
+  template <class InputIter>
+  void insert_unique(InputIter first, InputIter last)
+  { copy_insert_unique(first, last, iterator_category(first)); }
+
+  // erase / clear
+
+  void      erase(const_iterator position);
+  void      erase(const_iterator first, const_iterator last);
+
+  size_type erase_unique(const key_type& key);
+
+  void      clear();
+
+  void      swap(flat_hashtable& rhs) noexcept;
+
+  // 查找相关操作
+
+  size_type count(const key_type& key) const
+  { return find_index(key, hash_mix(hash_(key))) != capacity_ ? 1 : 0; }
+
+  iterator       find(const key_type& key)
+  {
+    const auto i = find_index(key, hash_mix(hash_(key)));
+    return iterator(ctrl_ + i, slots_ + i);
+  }
+  const_iterator find(const key_type& key) const
+  {
+    const auto i = find_index(key, hash_mix(hash_(key)));
+    return const_iterator(ctrl_ + i, slots_ + i);
+  }
+
+  pair<iterator, iterator> equal_range_unique(const key_type& key);
+  pair<const_iterator, const_iterator> equal_range_unique(const key_type& key) const;
+
+  // 槽位相关操作
+  size_type bucket_count()     const noexcept { return capacity_; }
+  size_type max_bucket_count() const noexcept { return max_size(); }
+
+  // hash policy
+
+  float load_factor() const noexcept
+  { return capacity_ != 0 ? static_cast<float>(size_) / static_cast<float>(capacity_) : 0.0f; }
+
+  // [note]: 最大装载因子固定为 0.875，设置的值被忽略
+  float max_load_factor() const noexcept
+  { return 0.875f; }
+  void  max_load_factor(float /*ml*/)
+  {
+  }
+
+  void rehash(size_type count);
+  void reserve(size_type count);
+
+  hasher    hash_fcn() const { return hash_; }
+  key_equal key_eq()   const { return equal_; }
+
+public:
+  bool equal_to_unique(const flat_hashtable& other) const;
+
+private:
+  // flat_hashtable 成员函数
+
+  // hash 相关
+  static size_t    hash_mix(size_t h) noexcept;
+  static size_t    h1(size_t h) noexcept { return h >> 7; }
+  static flat_ctrl_t h2(size_t h) noexcept { return static_cast<flat_ctrl_t>(h & 0x7f); }
+
+  // 容量相关
+  static size_type growth_of(size_type capacity) noexcept { return capacity - capacity / 8; }
+  static size_type normalize_capacity(size_type n) noexcept;
+  static size_type capacity_for(size_type n) noexcept;
+  static size_type slot_offset(size_type capacity) noexcept;
+
+  // 内存相关
+  void      allocate(size_type capacity);
+  static void deallocate(flat_ctrl_t* ctrl, size_type capacity) noexcept;
+  void      destroy_slots() noexcept;
+  void      reset_empty() noexcept;
+  void      copy_init(const flat_hashtable& rhs);
+
+  // 探测相关
+  size_type find_index(const key_type& key, size_t hash) const;
+  size_type find_first_non_full(size_t hash) const noexcept;
+  size_type prepare_insert(size_t hash);
+  void      commit_insert(size_type index, size_t hash) noexcept;
+  void      erase_at(size_type index) noexcept;
+
+  // rehash
+  void      resize(size_type new_capacity);
+  void      grow_for_insert();
+
+  template <class InputIter>
+  void copy_insert_unique(InputIter first, InputIter last, mystl::input_iterator_tag);
+  template <class ForwardIter>
+  void copy_insert_unique(ForwardIter first, ForwardIter last, mystl::forward_iterator_tag);
+};
+
+/*****************************************************************************************/
+
+// 就地构造元素，键值不允许重复
+template <class T, class Hash, class KeyEqual>
+template <class ...Args>
+pair<typename flat_hashtable<T, Hash, KeyEqual>::iterator, bool>
+flat_hashtable<T, Hash, KeyEqual>::
+emplace_unique(Args&& ...args)
+{ // 先构造出元素才能取得键值
+  value_type value(mystl::forward<Args>(args)...);
+  return emplace_key_unique(value_traits::get_key(value), mystl::move(value));
+}
+
+// 键值不存在时才构造元素
+template <class T, class Hash, class KeyEqual>
+template <class ...Args>
+pair<typename flat_hashtable<T, Hash, KeyEqual>::iterator, bool>
+flat_hashtable<T, Hash, KeyEqual>::
+emplace_key_unique(const key_type& key, Args&& ...args)
+{
+  const auto hash = hash_mix(hash_(key));
+  auto i = find_index(key, hash);
+  if (i != capacity_)
+    return mystl::make_pair(iterator(ctrl_ + i, slots_ + i), false);
+  i = prepare_insert(hash);
+  data_allocator::construct(slots_ + i, mystl::forward<Args>(args)...);
+  commit_insert(i, hash);
+  return mystl::make_pair(iterator(ctrl_ + i, slots_ + i), true);
+}
+
+// 删除迭代器所指的元素
+template <class T, class Hash, class KeyEqual>
+void flat_hashtable<T, Hash, KeyEqual>::
+erase(const_iterator position)
+{
+  MYSTL_DEBUG(position != cend());
+  erase_at(static_cast<size_type>(position.ctrl - ctrl_));
+}
+
+// 删除[first, last)内的元素，删除不会移动其他元素，所以可以边删边前进
+template <class T, class Hash, class KeyEqual>
+void flat_hashtable<T, Hash, KeyEqual>::
+erase(const_iterator first, const_iterator last)
+{
+  while (first != last)
+  {
+    const auto index = static_cast<size_type>(first.ctrl - ctrl_);
+    ++first;
+    erase_at(index);
+  }
+}
+
+// 删除键值为 key 的元素
+template <class T, class Hash, class KeyEqual>
+typename flat_hashtable<T, Hash, KeyEqual>::size_type
+flat_hashtable<T, Hash, KeyEqual>::
+erase_unique(const key_type& key)
+{
+  const auto i = find_index(key, hash_mix(hash_(key)));
+  if (i == capacity_)
+    return 0;
+  erase_at(i);
+  return 1;
+}
+
+// 清空所有元素，保留内存
+template <class T, class Hash, class KeyEqual>
+void flat_hashtable<T, Hash, KeyEqual>::
+clear()
+{
+  if (capacity_ == 0)
+    return;
+  destroy_slots();
+  std::memset(ctrl_, flat_ctrl_empty, capacity_);
+  size_ = 0;
+  growth_left_ = growth_of(capacity_);
+}
+
+// 在某些情况下，会重新对元素进行一遍哈希，插入到新的位置
+template <class T, class Hash, class KeyEqual>
+void flat_hashtable<T, Hash, KeyEqual>::
+rehash(size_type count)
+{
+  auto n = mystl::max(normalize_capacity(count), capacity_for(size_));
+  if (size_ == 0 && count == 0)
+    n = 0;
+  if (n != capacity_ || growth_left_ + size_ != growth_of(capacity_))
+    resize(n);
+}
+
+// 预留至少能放下 count 个元素的空间
+template <class T, class Hash, class KeyEqual>
+void flat_hashtable<T, Hash, KeyEqual>::
+reserve(size_type count)
+{
+  if (count > size_ + growth_left_)
+    resize(capacity_for(count));
+}
+
+// 交换 flat_hashtable
+template <class T, class Hash, class KeyEqual>
+void flat_hashtable<T, Hash, KeyEqual>::
+swap(flat_hashtable& rhs) noexcept
+{
+  if (this != &rhs)
+  {
+    mystl::swap(ctrl_, rhs.ctrl_);
+    mystl::swap(slots_, rhs.slots_);
+    mystl::swap(capacity_, rhs.capacity_);
+    mystl::swap(size_, rhs.size_);
+    mystl::swap(growth_left_, rhs.growth_left_);
+    mystl::swap(hash_, rhs.hash_);
+    mystl::swap(equal_, rhs.equal_);
+  }
+}
+
+// 查找与键值 key 相等的区间，返回一个 pair，指向相等区间的首尾
+template <class T, class Hash, class KeyEqual>
+pair<typename flat_hashtable<T, Hash, KeyEqual>::iterator,
+     typename flat_hashtable<T, Hash, KeyEqual>::iterator>
+flat_hashtable<T, Hash, KeyEqual>::
+equal_range_unique(const key_type& key)
+{
+  auto first = find(key);
+  if (first == end())
+    return mystl::make_pair(first, first);
+  auto last = first;
+  return mystl::make_pair(first, ++last);
+}
+
+template <class T, class Hash, class KeyEqual>
+pair<typename flat_hashtable<T, Hash, KeyEqual>::const_iterator,
+     typename flat_hashtable<T, Hash, KeyEqual>::const_iterator>
+flat_hashtable<T, Hash, KeyEqual>::
+equal_range_unique(const key_type& key) const
+{
+  auto first = find(key);
+  if (first == cend())
+    return mystl::make_pair(first, first);
+  auto last = first;
+  return mystl::make_pair(first, ++last);
+}
+
+// 两个表含有相同的元素时相等，与元素的排列顺序无关
+template <class T, class Hash, class KeyEqual>
+bool flat_hashtable<T, Hash, KeyEqual>::
+equal_to_unique(const flat_hashtable& other) const
+{
+  if (size_ != other.size_)
+    return false;
+  for (auto it = begin(), last = end(); it != last; ++it)
+  {
+    auto res = other.find(value_traits::get_key(*it));
+    if (res == other.end() || !(*res == *it))
+      return false;
+  }
+  return true;
+}
+
+/*****************************************************************************************/
+// helper function
+
+// 打散哈希值，使 H1 与 H2 都分布均匀，整数的哈希值等于自身时也能正常工作
+template <class T, class Hash, class KeyEqual>
+size_t flat_hashtable<T, Hash, KeyEqual>::
+hash_mix(size_t h) noexcept
+{
+#ifdef SYSTEM_64
+  h *= 0x9e3779b97f4a7c15ull;
+  return h ^ (h >> 32);
+#else
+  h *= 0x9e3779b9u;
+  return h ^ (h >> 16);
+#endif
+}
+
+// 把 n 调整为合法的容量：0，或者不小于 n 与 16 的 2 的幂
+template <class T, class Hash, class KeyEqual>
+typename flat_hashtable<T, Hash, KeyEqual>::size_type
+flat_hashtable<T, Hash, KeyEqual>::
+normalize_capacity(size_type n) noexcept
+{
+  if (n == 0)
+    return 0;
+  size_type capacity = flat_group_width;
+  while (capacity < n)
+    capacity <<= 1;
+  return capacity;
+}
+
+// 放下 n 个元素所需的最小容量
+template <class T, class Hash, class KeyEqual>
+typename flat_hashtable<T, Hash, KeyEqual>::size_type
+flat_hashtable<T, Hash, KeyEqual>::
+capacity_for(size_type n) noexcept
+{
+  if (n == 0)
+    return 0;
+  size_type capacity = flat_group_width;
+  while (growth_of(capacity) < n)
+    capacity <<= 1;
+  return capacity;
+}
+
+// 槽位相对于内存起点的偏移：控制字节之后按 T 对齐
+template <class T, class Hash, class KeyEqual>
+typename flat_hashtable<T, Hash, KeyEqual>::size_type
+flat_hashtable<T, Hash, KeyEqual>::
+slot_offset(size_type capacity) noexcept
+{
+  const size_type align = alignof(T);
+  return (capacity + flat_group_width + align - 1) / align * align;
+}
+
+// 分配 capacity 个槽位，所有控制字节置为空，不改变 size_
+template <class T, class Hash, class KeyEqual>
+void flat_hashtable<T, Hash, KeyEqual>::
+allocate(size_type capacity)
+{
+  const auto offset = slot_offset(capacity);
+  auto mem = byte_allocator::allocate(offset + capacity * sizeof(T));
+  ctrl_ = reinterpret_cast<flat_ctrl_t*>(mem);
+  slots_ = reinterpret_cast<T*>(mem + offset);
+  capacity_ = capacity;
+  growth_left_ = growth_of(capacity);
+  std::memset(ctrl_, flat_ctrl_empty, capacity);
+  std::memset(ctrl_ + capacity, flat_ctrl_sentinel, flat_group_width);
+}
+
+template <class T, class Hash, class KeyEqual>
+void flat_hashtable<T, Hash, KeyEqual>::
+deallocate(flat_ctrl_t* ctrl, size_type capacity) noexcept
+{
+  if (capacity != 0)
+    byte_allocator::deallocate(reinterpret_cast<char*>(ctrl));
+}
+
+// 析构所有元素，不改变控制字节
+template <class T, class Hash, class KeyEqual>
+void flat_hashtable<T, Hash, KeyEqual>::
+destroy_slots() noexcept
+{
+  if (size_ == 0)
+    return;
+  for (size_type i = 0; i < capacity_; ++i)
+  {
+    if (ctrl_[i] >= 0)
+      data_allocator::destroy(slots_ + i);
+  }
+}
+
+// 变为不占用内存的空表，不释放原来的内存
+template <class T, class Hash, class KeyEqual>
+void flat_hashtable<T, Hash, KeyEqual>::
+reset_empty() noexcept
+{
+  ctrl_ = flat_ht_empty_ctrl();
+  slots_ = nullptr;
+  capacity_ = 0;
+  size_ = 0;
+  growth_left_ = 0;
+}
+
+// 复制 rhs 的元素，rhs 中没有重复的键值，可以跳过查找
+template <class T, class Hash, class KeyEqual>
+void flat_hashtable<T, Hash, KeyEqual>::
+copy_init(const flat_hashtable& rhs)
+{
+  if (rhs.size_ == 0)
+    return;
+  allocate(capacity_for(rhs.size_));
+  try
+  {
+    for (auto it = rhs.begin(), last = rhs.end(); it != last; ++it)
+    {
+      const auto hash = hash_mix(hash_(value_traits::get_key(*it)));
+      const auto i = find_first_non_full(hash);
+      data_allocator::construct(slots_ + i, *it);
+      commit_insert(i, hash);
+    }
+  }
+  catch (...)
+  {
+    destroy_slots();
+    deallocate(ctrl_, capacity_);
+    reset_empty();
+    throw;
+  }
+}
+
+// 查找键值为 key 的元素所在的槽位，没有则返回 capacity_
+template <class T, class Hash, class KeyEqual>
+typename flat_hashtable<T, Hash, KeyEqual>::size_type
+flat_hashtable<T, Hash, KeyEqual>::
+find_index(const key_type& key, size_t hash) const
+{
+  if (capacity_ == 0)
+    return 0;
+  const auto mask = capacity_ - 1;
+  const auto tag = h2(hash);
+  auto pos = (h1(hash) * flat_group_width) & mask;
+  for (size_type step = flat_group_width; ; step += flat_group_width)
+  {
+    const flat_ht_group group(ctrl_ + pos);
+    for (auto m = group.match(tag); m != 0; m &= m - 1)
+    {
+      const auto i = pos + ctz32(m);
+      if (equal_(value_traits::get_key(slots_[i]), key))
+        return i;
+    }
+    if (group.match_empty() != 0)
+      return capacity_;
+    pos = (pos + step) & mask;
+  }
+}
+
+// 找到探测序列上第一个空槽位或墓碑
+template <class T, class Hash, class KeyEqual>
+typename flat_hashtable<T, Hash, KeyEqual>::size_type
+flat_hashtable<T, Hash, KeyEqual>::
+find_first_non_full(size_t hash) const noexcept
+{
+  const auto mask = capacity_ - 1;
+  auto pos = (h1(hash) * flat_group_width) & mask;
+  for (size_type step = flat_group_width; ; step += flat_group_width)
+  {
+    const auto m = flat_ht_group(ctrl_ + pos).match_empty_or_deleted();
+    if (m != 0)
+      return pos + ctz32(m);
+    pos = (pos + step) & mask;
+  }
+}
+
+// 为哈希值为 hash 的新元素找到槽位，必要时先扩容
+template <class T, class Hash, class KeyEqual>
+typename flat_hashtable<T, Hash, KeyEqual>::size_type
+flat_hashtable<T, Hash, KeyEqual>::
+prepare_insert(size_t hash)
+{
+  if (capacity_ != 0)
+  {
+    const auto i = find_first_non_full(hash);
+    if (growth_left_ != 0 || ctrl_[i] == flat_ctrl_deleted)
+      return i;
+  }
+  grow_for_insert();
+  return find_first_non_full(hash);
+}
+
+// 元素已经构造在槽位 index 中，更新控制字节与计数
+template <class T, class Hash, class KeyEqual>
+void flat_hashtable<T, Hash, KeyEqual>::
+commit_insert(size_type index, size_t hash) noexcept
+{
+  if (ctrl_[index] == flat_ctrl_empty)
+    --growth_left_;
+  ctrl_[index] = h2(hash);
+  ++size_;
+}
+
+// 删除槽位 index 中的元素，所在的组中还有空槽位时不需要留下墓碑
+template <class T, class Hash, class KeyEqual>
+void flat_hashtable<T, Hash, KeyEqual>::
+erase_at(size_type index) noexcept
+{
+  MYSTL_DEBUG(ctrl_[index] >= 0);
+  data_allocator::destroy(slots_ + index);
+  --size_;
+  const auto group = index & ~(flat_group_width - 1);
+  if (flat_ht_group(ctrl_ + group).match_empty() != 0)
+  {
+    ctrl_[index] = flat_ctrl_empty;
+    ++growth_left_;
+  }
+  else
+  {
+    ctrl_[index] = flat_ctrl_deleted;
+  }
+}
+
+// 把所有元素移动到容量为 new_capacity 的新内存中，同时清除墓碑
+template <class T, class Hash, class KeyEqual>
+void flat_hashtable<T, Hash, KeyEqual>::
+resize(size_type new_capacity)
+{
+  auto old_ctrl = ctrl_;
+  auto old_slots = slots_;
+  const auto old_capacity = capacity_;
+  const auto n = size_;
+  if (new_capacity == 0)
+    reset_empty();
+  else
+    allocate(new_capacity);
+  size_ = 0;
+  for (size_type i = 0; i < old_capacity; ++i)
+  {
+    if (old_ctrl[i] >= 0)
+    {
+      const auto hash = hash_mix(hash_(value_traits::get_key(old_slots[i])));
+      const auto index = find_first_non_full(hash);
+      data_allocator::construct(slots_ + index, mystl::move(old_slots[i]));
+      data_allocator::destroy(old_slots + i);
+      commit_insert(index, hash);
+    }
+  }
+  MYSTL_DEBUG(size_ == n);
+  (void)n;
+  deallocate(old_ctrl, old_capacity);
+}
+
+// 空槽位用完时：墓碑较多则原地重建，否则容量翻倍
+template <class T, class Hash, class KeyEqual>
+void flat_hashtable<T, Hash, KeyEqual>::
+grow_for_insert()
+{
+  if (capacity_ == 0)
+    resize(flat_group_width);
+  else if (capacity_ > flat_group_width && size_ * 32 <= capacity_ * 25)
+    resize(capacity_);
+  else
+    resize(capacity_ * 2);
+}
+
+// 插入 [first, last) 内的元素
+template <class T, class Hash, class KeyEqual>
+template <class InputIter>
+void flat_hashtable<T, Hash, KeyEqual>::
+copy_insert_unique(InputIter first, InputIter last, mystl::input_iterator_tag)
+{
+  for (; first != last; ++first)
+    insert_unique(*first);
+}
+
+template <class T, class Hash, class KeyEqual>
+template <class ForwardIter>
+void flat_hashtable<T, Hash, KeyEqual>::
+copy_insert_unique(ForwardIter first, ForwardIter last, mystl::forward_iterator_tag)
+{
+  reserve(size_ + static_cast<size_type>(mystl::distance(first, last)));
+  for (; first != last; ++first)
+    insert_unique(*first);
+}
+
+// 重载 mystl 的 swap
+template <class T, class Hash, class KeyEqual>
+void swap(flat_hashtable<T, Hash, KeyEqual>& lhs,
+          flat_hashtable<T, Hash, KeyEqual>& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+
+} // namespace mystl
+#endif // !MYTINYSTL_FLAT_HASHTABLE_H_
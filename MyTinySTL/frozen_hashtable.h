@@ -0,0 +1,630 @@
+﻿#ifndef MYTINYSTL_FROZEN_HASHTABLE_H_
+#define MYTINYSTL_FROZEN_HASHTABLE_H_
+
+// 这个头文件包含了一个模板类 frozen_hashtable
+// frozen_hashtable : 元素个数在编译期固定、构造后不能修改的哈希表，用常量表达式构造，查找也可以在常量表达式中进行
+
+// notes:
+//
+// 1. 构造时为全部键值计算一个完美哈希（hash and displace）：槽位个数 S 为不小于 N 的 2 的幂，
+//    键值先按哈希值分到 S 个桶中，从大桶开始，为每个桶寻找一个位移值，使桶内的键值经过二次混合后
+//    落到互不相同的空槽位上；只有一个键值的桶直接记下一个空槽位
+// 2. 查找只计算一次哈希值，读一次位移表和一次槽位表，最多比较一次键值，没有探测序列
+// 3. 元素与两张表都存放在对象内部，不申请堆内存；用 constexpr 变量保存时，整个表在编译期生成，
+//    没有启动时的构造开销；在运行期构造时结果相同，但每放置一个桶都要复制整张表，只适合较小的表
+// 4. C++11 的 constexpr 函数体只能有一条 return 语句，构造过程中的循环都写成递归，
+//    对区间的遍历用二分递归，使递归深度为 O(log S)，N 为几百以内时不会超出编译器的常量求值深度
+// 5. 键值重复时无法构造完美哈希：在常量表达式中会导致编译错误，在运行期抛出 std::logic_error
+// 6. 哈希函数与比较函数需要能在常量表达式中调用，缺省的 frozen_hash 与 frozen_equal
+//    支持整数、枚举、basic_string_view 以及由它们组成的 mystl::pair
+
+#include <stdexcept>
+#include <cstdint>
+
+#include "string_view.h"
+#include "util.h"
+
+namespace mystl
+{
+
+/*****************************************************************************************/
+// 编译期使用的辅助工具
+/*****************************************************************************************/
+
+// 下标序列，按二分拼接生成，模板实例化深度为 O(log N)
+template <size_t... I>
+struct frozen_index_seq {};
+
+template <class Seq1, class Seq2>
+struct frozen_concat_seq;
+
+template <size_t... I1, size_t... I2>
+struct frozen_concat_seq<frozen_index_seq<I1...>, frozen_index_seq<I2...>>
+{
+  typedef frozen_index_seq<I1..., (sizeof...(I1) + I2)...> type;
+};
+
+template <size_t N>
+struct frozen_make_seq
+  :public frozen_concat_seq<typename frozen_make_seq<N / 2>::type,
+                            typename frozen_make_seq<N - N / 2>::type>
+{
+};
+
+template <>
+struct frozen_make_seq<0>
+{
+  typedef frozen_index_seq<> type;
+};
+
+template <>
+struct frozen_make_seq<1>
+{
+  typedef frozen_index_seq<0> type;
+};
+
+// 定长数组，可以作为 constexpr 函数的返回值
+template <class T, size_t N>
+struct frozen_array
+{
+  T v[N];
+};
+
+static constexpr size_t   frozen_npos      = static_cast<size_t>(-1);
+static constexpr size_t   frozen_direct    = ~(frozen_npos >> 1);  // 位移值的最高位：直接给出槽位
+static constexpr size_t   frozen_max_disp  = 128;                   // 每个桶最多尝试的位移值个数
+static constexpr uint64_t frozen_max_seed  = 16;                    // 最多尝试的哈希种子个数
+static constexpr uint64_t frozen_golden    = 0x9e3779b97f4a7c15ull;
+
+// 不小于 n 的 2 的幂
+constexpr size_t frozen_table_size(size_t n, size_t s = 1)
+{
+  return s >= n ? s : frozen_table_size(n, s << 1);
+}
+
+// splitmix64 的终结步骤，把 64 位的值充分混合
+constexpr uint64_t frozen_xorshift(uint64_t x, unsigned shift)
+{
+  return x ^ (x >> shift);
+}
+
+constexpr uint64_t frozen_mix(uint64_t x)
+{
+  return frozen_xorshift(frozen_xorshift(frozen_xorshift(x, 30) * 0xbf58476d1ce4e5b9ull, 27)
+                         * 0x94d049bb133111ebull, 31);
+}
+
+// 键值所在的桶与使用位移值 d 时落到的槽位
+constexpr size_t frozen_bucket(uint64_t h, size_t mask)
+{
+  return static_cast<size_t>(h) & mask;
+}
+
+constexpr size_t frozen_slot(uint64_t h, size_t d, size_t mask)
+{
+  return static_cast<size_t>(frozen_mix(h ^ (d * frozen_golden))) & mask;
+}
+
+// 由桶的位移值得到键值的槽位
+constexpr size_t frozen_lookup_slot(uint64_t h, size_t d, size_t mask)
+{
+  return (d & frozen_direct) ? (d & ~frozen_direct) : frozen_slot(h, d, mask);
+}
+
+/*****************************************************************************************/
+// 可在常量表达式中使用的哈希函数与比较函数
+/*****************************************************************************************/
+
+// 整数与枚举：与种子异或后混合
+template <class Key>
+struct frozen_hash
+{
+  constexpr uint64_t operator()(const Key& key, uint64_t seed) const noexcept
+  {
+    return frozen_mix(static_cast<uint64_t>(key) ^ seed);
+  }
+};
+
+// 把 K 个字符按小端拼成一个 64 位的字，展开后编译器可以合并成一次读取
+template <class CharType, size_t K>
+struct frozen_load
+{
+  static constexpr uint64_t get(const CharType* p) noexcept
+  {
+    return static_cast<uint64_t>(static_cast<typename std::make_unsigned<CharType>::type>(*p)) |
+           (frozen_load<CharType, K - 1>::get(p + 1) << (8 * sizeof(CharType)));
+  }
+};
+
+template <class CharType>
+struct frozen_load<CharType, 0>
+{
+  static constexpr uint64_t get(const CharType*) noexcept { return 0; }
+};
+
+// 字符串视图：每次吸收一个字（8 字节）的字符，不足一个字的尾部逐个字符拼接，最后再混合一次
+template <class CharType, class CharTraits>
+struct frozen_hash<basic_string_view<CharType, CharTraits>>
+{
+  constexpr uint64_t operator()(const basic_string_view<CharType, CharTraits>& str,
+                                uint64_t seed) const noexcept
+  {
+    return frozen_mix(words(str.data(), str.size(), seed ^ (str.size() * frozen_golden)));
+  }
+
+private:
+  static constexpr size_t chunk = sizeof(uint64_t) / sizeof(CharType);
+
+  static constexpr uint64_t step(uint64_t h, uint64_t w) noexcept
+  {
+    return frozen_xorshift((h ^ w) * 0xff51afd7ed558ccdull, 29);
+  }
+
+  static constexpr uint64_t tail(const CharType* p, size_t n) noexcept
+  {
+    return n == 0 ? 0
+      : static_cast<uint64_t>(static_cast<typename std::make_unsigned<CharType>::type>(*p)) |
+        (tail(p + 1, n - 1) << (8 * sizeof(CharType)));
+  }
+
+  static constexpr uint64_t words(const CharType* p, size_t n, uint64_t h) noexcept
+  {
+    return n >= chunk ? words(p + chunk, n - chunk, step(h, frozen_load<CharType, chunk>::get(p)))
+      : n == 0 ? h : step(h, tail(p, n));
+  }
+};
+
+// pair：两个成员的哈希值不对称地组合
+template <class Ty1, class Ty2>
+struct frozen_hash<mystl::pair<Ty1, Ty2>>
+{
+  constexpr uint64_t operator()(const mystl::pair<Ty1, Ty2>& p, uint64_t seed) const noexcept
+  {
+    return frozen_mix(frozen_hash<Ty1>()(p.first, seed) * frozen_golden
+                      ^ frozen_hash<Ty2>()(p.second, seed));
+  }
+};
+
+template <class Key>
+struct frozen_equal
+{
+  constexpr bool operator()(const Key& lhs, const Key& rhs) const noexcept
+  {
+    return lhs == rhs;
+  }
+};
+
+template <class CharType, class CharTraits>
+struct frozen_equal<basic_string_view<CharType, CharTraits>>
+{
+  constexpr bool operator()(const basic_string_view<CharType, CharTraits>& lhs,
+                            const basic_string_view<CharType, CharTraits>& rhs) const noexcept
+  {
+    return lhs.size() == rhs.size() && same(lhs.data(), rhs.data(), lhs.size());
+  }
+
+private:
+  static constexpr bool same(const CharType* p, const CharType* q, size_t n) noexcept
+  {
+    return n == 0 || (*p == *q && same(p + 1, q + 1, n - 1));
+  }
+};
+
+template <class Ty1, class Ty2>
+struct frozen_equal<mystl::pair<Ty1, Ty2>>
+{
+  constexpr bool operator()(const mystl::pair<Ty1, Ty2>& lhs,
+                            const mystl::pair<Ty1, Ty2>& rhs) const noexcept
+  {
+    return frozen_equal<Ty1>()(lhs.first, rhs.first) &&
+           frozen_equal<Ty2>()(lhs.second, rhs.second);
+  }
+};
+
+/*****************************************************************************************/
+// 完美哈希的构造
+// 所有函数都只依赖键值的哈希值 h（前 n 个有效），S 为槽位个数，mask = S - 1
+/*****************************************************************************************/
+
+// 桶内元素按桶号排列后的布局：count 为每个桶的元素个数，first 为每个桶在 order 中的起点，
+// order 为按（桶号，下标）排序后的元素下标
+template <size_t S>
+struct frozen_layout
+{
+  frozen_array<size_t, S> count;
+  frozen_array<size_t, S> first;
+  frozen_array<size_t, S> order;
+};
+
+// 构造中的表：disp 为每个桶的位移值，slot 为每个槽位上的元素下标，ok 为到目前为止是否成功
+template <size_t S>
+struct frozen_table
+{
+  uint64_t seed;
+  size_t   disp[S];
+  size_t   slot[S];
+  bool     ok;
+};
+
+// [lo, hi) 中桶号等于（less 为 true 时小于）g 的元素个数
+template <size_t S>
+constexpr size_t frozen_count(const frozen_array<uint64_t, S>& h, size_t g, bool less,
+                              size_t lo, size_t hi)
+{
+  return hi - lo == 0 ? 0
+    : hi - lo == 1
+      ? ((less ? frozen_bucket(h.v[lo], S - 1) < g : frozen_bucket(h.v[lo], S - 1) == g) ? 1 : 0)
+      : frozen_count(h, g, less, lo, lo + (hi - lo) / 2) +
+        frozen_count(h, g, less, lo + (hi - lo) / 2, hi);
+}
+
+// 元素 i 在 order 中的位置
+template <size_t S>
+constexpr size_t frozen_rank(const frozen_array<uint64_t, S>& h, size_t n, size_t i)
+{
+  return i >= n ? frozen_npos
+    : frozen_count(h, frozen_bucket(h.v[i], S - 1), true, 0, n) +
+      frozen_count(h, frozen_bucket(h.v[i], S - 1), false, 0, i);
+}
+
+constexpr size_t frozen_min(size_t a, size_t b)
+{
+  return a < b ? a : b;
+}
+
+// [lo, hi) 中 rank 等于 k 的元素下标
+template <size_t S>
+constexpr size_t frozen_find_rank(const frozen_array<size_t, S>& rank, size_t k,
+                                  size_t lo, size_t hi)
+{
+  return hi - lo == 1 ? (rank.v[lo] == k ? lo : frozen_npos)
+    : frozen_min(frozen_find_rank(rank, k, lo, lo + (hi - lo) / 2),
+                 frozen_find_rank(rank, k, lo + (hi - lo) / 2, hi));
+}
+
+template <size_t S, size_t... I>
+constexpr frozen_array<size_t, S>
+frozen_make_rank(const frozen_array<uint64_t, S>& h, size_t n, frozen_index_seq<I...>)
+{
+  return frozen_array<size_t, S>{ { frozen_rank(h, n, I)... } };
+}
+
+template <size_t S, size_t... I>
+constexpr frozen_array<size_t, S>
+frozen_make_order(const frozen_array<size_t, S>& rank, frozen_index_seq<I...>)
+{
+  return frozen_array<size_t, S>{ { frozen_find_rank(rank, I, 0, S)... } };
+}
+
+template <size_t S, size_t... I>
+constexpr frozen_layout<S>
+frozen_make_layout(const frozen_array<uint64_t, S>& h, size_t n, frozen_index_seq<I...> seq)
+{
+  return frozen_layout<S>{
+    frozen_array<size_t, S>{ { frozen_count(h, I, false, 0, n)... } },
+    frozen_array<size_t, S>{ { frozen_count(h, I, true, 0, n)... } },
+    frozen_make_order(frozen_make_rank(h, n, seq), seq)
+  };
+}
+
+// 最大的桶的元素个数
+template <size_t S>
+constexpr size_t frozen_max_count(const frozen_layout<S>& lay, size_t lo, size_t hi)
+{
+  return hi - lo == 1 ? lay.count.v[lo]
+    : frozen_max_count(lay, lo, lo + (hi - lo) / 2) > frozen_max_count(lay, lo + (hi - lo) / 2, hi)
+      ? frozen_max_count(lay, lo, lo + (hi - lo) / 2)
+      : frozen_max_count(lay, lo + (hi - lo) / 2, hi);
+}
+
+// order 中 [q, e) 的元素用位移值 d 时是否有落到槽位 s 的
+template <size_t S>
+constexpr bool frozen_hits(const frozen_array<uint64_t, S>& h, const frozen_layout<S>& lay,
+                           size_t d, size_t s, size_t q, size_t e)
+{
+  return q != e &&
+    (frozen_slot(h.v[lay.order.v[q]], d, S - 1) == s || frozen_hits(h, lay, d, s, q + 1, e));
+}
+
+// order 中 [p, e) 的元素用位移值 d 时都落到空槽位上，且彼此不冲突
+template <size_t S>
+constexpr bool frozen_fits(const frozen_table<S>& t, const frozen_array<uint64_t, S>& h,
+                           const frozen_layout<S>& lay, size_t d, size_t p, size_t e)
+{
+  return p == e ||
+    (t.slot[frozen_slot(h.v[lay.order.v[p]], d, S - 1)] == frozen_npos &&
+     !frozen_hits(h, lay, d, frozen_slot(h.v[lay.order.v[p]], d, S - 1), p + 1, e) &&
+     frozen_fits(t, h, lay, d, p + 1, e));
+}
+
+// 为桶 g 寻找可用的位移值，找不到时返回 0
+template <size_t S>
+constexpr size_t frozen_find_disp(const frozen_table<S>& t, const frozen_array<uint64_t, S>& h,
+                                  const frozen_layout<S>& lay, size_t g, size_t d)
+{
+  return d > frozen_max_disp ? 0
+    : frozen_fits(t, h, lay, d, lay.first.v[g], lay.first.v[g] + lay.count.v[g]) ? d
+    : frozen_find_disp(t, h, lay, g, d + 1);
+}
+
+// [lo, hi) 中第一个空槽位
+template <size_t S>
+constexpr size_t frozen_free_slot(const frozen_table<S>& t, size_t lo, size_t hi)
+{
+  return hi - lo == 1 ? (t.slot[lo] == frozen_npos ? lo : frozen_npos)
+    : frozen_min(frozen_free_slot(t, lo, lo + (hi - lo) / 2),
+                 frozen_free_slot(t, lo + (hi - lo) / 2, hi));
+}
+
+// 桶 g 用位移值 d 时落到槽位 s 的元素下标，没有则返回 old
+template <size_t S>
+constexpr size_t frozen_member_at(const frozen_array<uint64_t, S>& h, const frozen_layout<S>& lay,
+                                  size_t d, size_t s, size_t q, size_t e, size_t old)
+{
+  return q == e ? old
+    : frozen_slot(h.v[lay.order.v[q]], d, S - 1) == s ? lay.order.v[q]
+    : frozen_member_at(h, lay, d, s, q + 1, e, old);
+}
+
+// 记下桶 g 的位移值 d，并把桶内元素放入各自的槽位
+template <size_t S, size_t... I>
+constexpr frozen_table<S>
+frozen_place_hashed(const frozen_table<S>& t, const frozen_array<uint64_t, S>& h,
+                    const frozen_layout<S>& lay, size_t g, size_t d, frozen_index_seq<I...>)
+{
+  return frozen_table<S>{
+    t.seed,
+    { (I == g ? d : t.disp[I])... },
+    { frozen_member_at(h, lay, d, I, lay.first.v[g], lay.first.v[g] + lay.count.v[g],
+                       t.slot[I])... },
+    d != 0
+  };
+}
+
+// 只有一个元素的桶 g 直接占用空槽位 s
+template <size_t S, size_t... I>
+constexpr frozen_table<S>
+frozen_place_direct(const frozen_table<S>& t, const frozen_layout<S>& lay,
+                    size_t g, size_t s, frozen_index_seq<I...>)
+{
+  return frozen_table<S>{
+    t.seed,
+    { (I == g ? (s | frozen_direct) : t.disp[I])... },
+    { (I == s ? lay.order.v[lay.first.v[g]] : t.slot[I])... },
+    s != frozen_npos
+  };
+}
+
+// 若桶 g 的元素个数为 k，放置这个桶
+template <size_t S>
+constexpr frozen_table<S>
+frozen_place_bucket(const frozen_table<S>& t, const frozen_array<uint64_t, S>& h,
+                    const frozen_layout<S>& lay, size_t k, size_t g)
+{
+  return !t.ok || lay.count.v[g] != k ? t
+    : k == 1
+      ? frozen_place_direct(t, lay, g, frozen_free_slot(t, 0, S),
+                            typename frozen_make_seq<S>::type())
+      : frozen_place_hashed(t, h, lay, g, frozen_find_disp(t, h, lay, g, 1),
+                            typename frozen_make_seq<S>::type());
+}
+
+// 依次放置 [lo, hi) 中元素个数为 k 的桶
+template <size_t S>
+constexpr frozen_table<S>
+frozen_place_range(const frozen_table<S>& t, const frozen_array<uint64_t, S>& h,
+                   const frozen_layout<S>& lay, size_t k, size_t lo, size_t hi)
+{
+  return hi - lo == 1 ? frozen_place_bucket(t, h, lay, k, lo)
+    : frozen_place_range(frozen_place_range(t, h, lay, k, lo, lo + (hi - lo) / 2),
+                         h, lay, k, lo + (hi - lo) / 2, hi);
+}
+
+// 按元素个数从大到小放置所有的桶
+template <size_t S>
+constexpr frozen_table<S>
+frozen_place_all(const frozen_table<S>& t, const frozen_array<uint64_t, S>& h,
+                 const frozen_layout<S>& lay, size_t k)
+{
+  return k == 0 ? t : frozen_place_all(frozen_place_range(t, h, lay, k, 0, S), h, lay, k - 1);
+}
+
+constexpr size_t frozen_fill(size_t, size_t value)
+{
+  return value;
+}
+
+template <size_t S, size_t... I>
+constexpr frozen_table<S> frozen_empty_table(uint64_t seed, frozen_index_seq<I...>)
+{
+  return frozen_table<S>{ seed, { frozen_fill(I, 0)... }, { frozen_fill(I, frozen_npos)... }, true };
+}
+
+template <size_t S>
+constexpr frozen_table<S>
+frozen_try_build(const frozen_array<uint64_t, S>& h, const frozen_layout<S>& lay, uint64_t seed)
+{
+  return frozen_place_all(frozen_empty_table<S>(seed, typename frozen_make_seq<S>::type()),
+                          h, lay, frozen_max_count(lay, 0, S));
+}
+
+// 构造成功后把空槽位指向元素 0，查找时不必判断槽位是否为空，比较一次键值即可
+template <size_t S, size_t... I>
+constexpr frozen_table<S> frozen_finish(const frozen_table<S>& t, frozen_index_seq<I...>)
+{
+  return frozen_table<S>{
+    t.seed,
+    { t.disp[I]... },
+    { (t.slot[I] == frozen_npos ? 0 : t.slot[I])... },
+    true
+  };
+}
+
+/*****************************************************************************************/
+// frozen_hashtable
+/*****************************************************************************************/
+
+// 从元素中取出键值，参数 IsMap 为 true 时元素为 pair，键值为 first
+template <class T, bool IsMap>
+struct frozen_value_traits
+{
+  typedef T key_type;
+  typedef T mapped_type;
+  typedef T value_type;
+
+  static constexpr const key_type& get_key(const value_type& value) noexcept
+  { return value; }
+};
+
+template <class T>
+struct frozen_value_traits<T, true>
+{
+  typedef typename T::first_type  key_type;
+  typedef typename T::second_type mapped_type;
+  typedef T                       value_type;
+
+  static constexpr const key_type& get_key(const value_type& value) noexcept
+  { return value.first; }
+};
+
+// 模板类 frozen_hashtable
+// 参数一代表数据类型，参数二代表元素个数，参数三代表哈希函数，参数四代表键值相等的比较函数，
+// 参数五代表元素是否为 (键值, 实值) 的 pair
+template <class T, size_t N, class Hash, class KeyEqual, bool IsMap>
+class frozen_hashtable
+{
+  static_assert(N > 0, "frozen_hashtable needs at least one element");
+
+public:
+  // frozen_hashtable 的型别定义
+  typedef frozen_value_traits<T, IsMap>            value_traits;
+  typedef typename value_traits::key_type          key_type;
+  typedef typename value_traits::mapped_type       mapped_type;
+  typedef typename value_traits::value_type        value_type;
+  typedef Hash                                     hasher;
+  typedef KeyEqual                                 key_equal;
+
+  typedef const value_type*                        pointer;
+  typedef const value_type*                        const_pointer;
+  typedef const value_type&                        reference;
+  typedef const value_type&                        const_reference;
+  typedef size_t                                   size_type;
+  typedef ptrdiff_t                                difference_type;
+
+  typedef const value_type*                        iterator;
+  typedef const value_type*                        const_iterator;
+
+  static constexpr size_type table_size = frozen_table_size(N);
+
+private:
+  typedef frozen_table<table_size>                 table_type;
+  typedef frozen_array<uint64_t, table_size>       hash_array;
+  typedef typename frozen_make_seq<N>::type          item_seq;
+  typedef typename frozen_make_seq<table_size>::type table_seq;
+
+  value_type items_[N];  // 元素按给出的顺序存放
+  table_type table_;
+  hasher     hash_;
+  key_equal  equal_;
+
+public:
+  // 构造函数，可用于常量表达式
+  constexpr frozen_hashtable(const value_type (&items)[N], const Hash& hash, const KeyEqual& equal)
+    :frozen_hashtable(items, hash, equal, item_seq())
+  {
+  }
+
+  // 迭代器相关
+  constexpr const_iterator begin()  const noexcept { return items_; }
+  constexpr const_iterator end()    const noexcept { return items_ + N; }
+
+  // 容量相关
+  constexpr bool      empty()    const noexcept { return false; }
+  constexpr size_type size()     const noexcept { return N; }
+  constexpr size_type max_size() const noexcept { return N; }
+
+  // 查找相关
+  constexpr const_iterator find(const key_type& key) const noexcept
+  {
+    return find_at(key, table_.slot[slot_of(hash_(key, table_.seed))]);
+  }
+
+  constexpr size_type count(const key_type& key) const noexcept
+  {
+    return find(key) != end() ? 1 : 0;
+  }
+
+  constexpr mystl::pair<const_iterator, const_iterator>
+  equal_range(const key_type& key) const noexcept
+  {
+    return range_at(find(key));
+  }
+
+  // bucket 相关
+  constexpr size_type bucket_count() const noexcept { return table_size; }
+  constexpr float     load_factor()  const noexcept
+  { return static_cast<float>(N) / static_cast<float>(table_size); }
+  constexpr uint64_t  seed()         const noexcept { return table_.seed; }
+
+  hasher    hash_fcn() const { return hash_; }
+  key_equal key_eq()   const { return equal_; }
+
+private:
+  template <size_t... I>
+  constexpr frozen_hashtable(const value_type (&items)[N], const Hash& hash,
+                             const KeyEqual& equal, frozen_index_seq<I...>)
+    :items_{ items[I]... },
+     table_(build(items, hash, 0)),
+     hash_(hash), equal_(equal)
+  {
+  }
+
+  constexpr size_type slot_of(uint64_t h) const noexcept
+  {
+    return frozen_lookup_slot(h, table_.disp[frozen_bucket(h, table_size - 1)], table_size - 1);
+  }
+
+  constexpr const_iterator find_at(const key_type& key, size_type i) const noexcept
+  {
+    return equal_(value_traits::get_key(items_[i]), key) ? items_ + i : items_ + N;
+  }
+
+  constexpr mystl::pair<const_iterator, const_iterator> range_at(const_iterator it) const noexcept
+  {
+    return mystl::pair<const_iterator, const_iterator>(it, it == end() ? it : it + 1);
+  }
+
+  // 用种子 seed 计算全部键值的哈希值，槽位多于元素的部分补 0
+  template <size_t... I>
+  static constexpr hash_array
+  hash_all(const value_type (&items)[N], const Hash& hash, uint64_t seed, frozen_index_seq<I...>)
+  {
+    return hash_array{ { (I < N ? hash(value_traits::get_key(items[I < N ? I : 0]), seed)
+                                : uint64_t(0))... } };
+  }
+
+  // 依次尝试各个种子，直到构造成功
+  static constexpr table_type
+  build(const value_type (&items)[N], const Hash& hash, uint64_t seed)
+  {
+    return seed == frozen_max_seed
+      ? throw std::logic_error("frozen_hashtable: cannot build a perfect hash, duplicate keys?")
+      : build_with(items, hash, seed, hash_all(items, hash, seed, table_seq()));
+  }
+
+  static constexpr table_type
+  build_with(const value_type (&items)[N], const Hash& hash, uint64_t seed, const hash_array& h)
+  {
+    return check(items, hash, seed,
+                 frozen_try_build(h, frozen_make_layout(h, N, table_seq()), seed));
+  }
+
+  static constexpr table_type
+  check(const value_type (&items)[N], const Hash& hash, uint64_t seed, const table_type& t)
+  {
+    return t.ok ? frozen_finish(t, table_seq()) : build(items, hash, seed + 1);
+  }
+};
+
+} // namespace mystl
+#endif // !MYTINYSTL_FROZEN_HASHTABLE_H_
@@ -0,0 +1,119 @@
+﻿#ifndef MYTINYSTL_FROZEN_MAP_H_
+#define MYTINYSTL_FROZEN_MAP_H_
+
+// 这个头文件包含一个模板类 frozen_map
+// 功能与 unordered_map 的查找接口类似，不同的是元素个数在编译期固定，构造后不能修改，
+// 使用 frozen_hashtable 作为底层实现机制，可以作为 constexpr 变量在编译期生成
+
+// notes:
+//
+// 1. 用一个元素数组构造，可以用 make_frozen_map 从数组推导元素个数，键值不允许重复
+// 2. 迭代器按构造时给出的顺序遍历元素，迭代器、指针和引用在对象的生命期内一直有效
+// 3. 键值为字符串时使用 mystl::string_view，字符串字面量可以写成 "if"_sv
+// 4. 不提供修改容器的接口与 operator[]，at 在键值不存在时抛出 std::out_of_range
+
+#include "frozen_hashtable.h"
+
+namespace mystl
+{
+
+// 模板类 frozen_map，键值不允许重复
+// 参数一代表键值类型，参数二代表实值类型，参数三代表元素个数，
+// 参数四代表哈希函数，缺省使用 mystl::frozen_hash，参数五代表键值比较方式，缺省使用 mystl::frozen_equal
+template <class Key, class T, size_t N,
+          class Hash = mystl::frozen_hash<Key>, class KeyEqual = mystl::frozen_equal<Key>>
+class frozen_map
+{
+private:
+  // 使用 frozen_hashtable 作为底层机制
+  typedef frozen_hashtable<mystl::pair<Key, T>, N, Hash, KeyEqual, true> base_type;
+  base_type ht_;
+
+public:
+  // 使用 frozen_hashtable 的型别
+
+  typedef typename base_type::key_type             key_type;
+  typedef typename base_type::mapped_type          mapped_type;
+  typedef typename base_type::value_type           value_type;
+  typedef typename base_type::hasher               hasher;
+  typedef typename base_type::key_equal            key_equal;
+
+  typedef typename base_type::size_type            size_type;
+  typedef typename base_type::difference_type      difference_type;
+  typedef typename base_type::pointer              pointer;
+  typedef typename base_type::const_pointer        const_pointer;
+  typedef typename base_type::reference            reference;
+  typedef typename base_type::const_reference      const_reference;
+
+  typedef typename base_type::iterator             iterator;
+  typedef typename base_type::const_iterator       const_iterator;
+
+public:
+  // 构造函数，可用于常量表达式
+
+  constexpr frozen_map(const value_type (&items)[N],
+                       const Hash& hash = Hash(),
+                       const KeyEqual& equal = KeyEqual())
+    :ht_(items, hash, equal)
+  {
+  }
+
+  // 迭代器相关
+
+  constexpr const_iterator begin()  const noexcept
+  { return ht_.begin(); }
+  constexpr const_iterator end()    const noexcept
+  { return ht_.end(); }
+
+  constexpr const_iterator cbegin() const noexcept
+  { return ht_.begin(); }
+  constexpr const_iterator cend()   const noexcept
+  { return ht_.end(); }
+
+  // 容量相关
+
+  constexpr bool      empty()    const noexcept { return ht_.empty(); }
+  constexpr size_type size()     const noexcept { return ht_.size(); }
+  constexpr size_type max_size() const noexcept { return ht_.max_size(); }
+
+  // 查找相关
+
+  constexpr const mapped_type& at(const key_type& key) const
+  {
+    return at_iter(ht_.find(key));
+  }
+
+  constexpr size_type      count(const key_type& key) const noexcept
+  { return ht_.count(key); }
+
+  constexpr const_iterator find(const key_type& key)  const noexcept
+  { return ht_.find(key); }
+
+  constexpr pair<const_iterator, const_iterator> equal_range(const key_type& key) const noexcept
+  { return ht_.equal_range(key); }
+
+  // bucket 相关
+
+  constexpr size_type bucket_count() const noexcept { return ht_.bucket_count(); }
+  constexpr float     load_factor()  const noexcept { return ht_.load_factor(); }
+
+  hasher    hash_fcn() const { return ht_.hash_fcn(); }
+  key_equal key_eq()   const { return ht_.key_eq(); }
+
+private:
+  constexpr const mapped_type& at_iter(const_iterator it) const
+  {
+    return it != ht_.end() ? it->second
+      : throw std::out_of_range("frozen_map<Key, T, N> no such element exists");
+  }
+};
+
+// 由元素数组构造 frozen_map，元素个数由数组推导
+template <class Key, class T, size_t N>
+constexpr frozen_map<Key, T, N> make_frozen_map(const mystl::pair<Key, T> (&items)[N])
+{
+  return frozen_map<Key, T, N>(items);
+}
+
+} // namespace mystl
+#endif // !MYTINYSTL_FROZEN_MAP_H_
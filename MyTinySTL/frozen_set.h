@@ -0,0 +1,105 @@
+﻿#ifndef MYTINYSTL_FROZEN_SET_H_
+#define MYTINYSTL_FROZEN_SET_H_
+
+// 这个头文件包含一个模板类 frozen_set
+// 功能与 unordered_set 的查找接口类似，不同的是元素个数在编译期固定，构造后不能修改，
+// 使用 frozen_hashtable 作为底层实现机制，可以作为 constexpr 变量在编译期生成
+
+// notes:
+//
+// 1. 用一个元素数组构造，可以用 make_frozen_set 从数组推导元素个数，元素不允许重复
+// 2. 迭代器按构造时给出的顺序遍历元素，迭代器、指针和引用在对象的生命期内一直有效
+// 3. 元素为字符串时使用 mystl::string_view，字符串字面量可以写成 "if"_sv
+
+#include "frozen_hashtable.h"
+
+namespace mystl
+{
+
+// 模板类 frozen_set，元素不允许重复
+// 参数一代表元素类型，参数二代表元素个数，
+// 参数三代表哈希函数，缺省使用 mystl::frozen_hash，参数四代表元素比较方式，缺省使用 mystl::frozen_equal
+template <class Key, size_t N,
+          class Hash = mystl::frozen_hash<Key>, class KeyEqual = mystl::frozen_equal<Key>>
+class frozen_set
+{
+private:
+  // 使用 frozen_hashtable 作为底层机制
+  typedef frozen_hashtable<Key, N, Hash, KeyEqual, false> base_type;
+  base_type ht_;
+
+public:
+  // 使用 frozen_hashtable 的型别
+
+  typedef typename base_type::key_type             key_type;
+  typedef typename base_type::value_type           value_type;
+  typedef typename base_type::hasher               hasher;
+  typedef typename base_type::key_equal            key_equal;
+
+  typedef typename base_type::size_type            size_type;
+  typedef typename base_type::difference_type      difference_type;
+  typedef typename base_type::pointer              pointer;
+  typedef typename base_type::const_pointer        const_pointer;
+  typedef typename base_type::reference            reference;
+  typedef typename base_type::const_reference      const_reference;
+
+  typedef typename base_type::iterator             iterator;
+  typedef typename base_type::const_iterator       const_iterator;
+
+public:
+  // 构造函数，可用于常量表达式
+
+  constexpr frozen_set(const value_type (&items)[N],
+                       const Hash& hash = Hash(),
+                       const KeyEqual& equal = KeyEqual())
+    :ht_(items, hash, equal)
+  {
+  }
+
+  // 迭代器相关
+
+  constexpr const_iterator begin()  const noexcept
+  { return ht_.begin(); }
+  constexpr const_iterator end()    const noexcept
+  { return ht_.end(); }
+
+  constexpr const_iterator cbegin() const noexcept
+  { return ht_.begin(); }
+  constexpr const_iterator cend()   const noexcept
+  { return ht_.end(); }
+
+  // 容量相关
+
+  constexpr bool      empty()    const noexcept { return ht_.empty(); }
+  constexpr size_type size()     const noexcept { return ht_.size(); }
+  constexpr size_type max_size() const noexcept { return ht_.max_size(); }
+
+  // 查找相关
+
+  constexpr size_type      count(const key_type& key) const noexcept
+  { return ht_.count(key); }
+
+  constexpr const_iterator find(const key_type& key)  const noexcept
+  { return ht_.find(key); }
+
+  constexpr pair<const_iterator, const_iterator> equal_range(const key_type& key) const noexcept
+  { return ht_.equal_range(key); }
+
+  // bucket 相关
+
+  constexpr size_type bucket_count() const noexcept { return ht_.bucket_count(); }
+  constexpr float     load_factor()  const noexcept { return ht_.load_factor(); }
+
+  hasher    hash_fcn() const { return ht_.hash_fcn(); }
+  key_equal key_eq()   const { return ht_.key_eq(); }
+};
+
+// 由元素数组构造 frozen_set，元素个数由数组推导
+template <class Key, size_t N>
+constexpr frozen_set<Key, N> make_frozen_set(const Key (&items)[N])
+{
+  return frozen_set<Key, N>(items);
+}
+
+} // namespace mystl
+#endif // !MYTINYSTL_FROZEN_SET_H_
@@ -4,6 +4,12 @@
 // 这个头文件包含了 mystl 的函数对象与哈希函数
 
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
 
 namespace mystl
 {
@@ -234,29 +240,158 @@ MYSTL_TRIVIAL_HASH_FCN(unsigned long long)
 
 #undef MYSTL_TRIVIAL_HASH_FCN
 
-// 对于浮点数，逐位哈希
-inline size_t bitwise_hash(const unsigned char* first, size_t count)
+/*****************************************************************************************/
+// bitwise_hash
+// 对一段字节计算哈希值，用于字符串与浮点数
+// 采用 wyhash 的做法：每次读入 8 / 16 字节，用 64 x 64 -> 128 位乘法把高低两半异或起来混合，
+// 长度不超过 16 字节时只做两次乘法，超过 48 字节时用三路互不依赖的乘法链并行处理
+// 结果按小端序读取字节，大端平台上的哈希值不同，但分布性质相同
+/*****************************************************************************************/
+
+// 哈希使用的常数，每个都是奇数且 32 个位为 1
+static constexpr uint64_t wy_secret[4] = {
+  0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull,
+  0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull
+};
+
+// 128 位乘积的低 64 位写回 a，高 64 位写回 b
+inline void wy_mum(uint64_t& a, uint64_t& b) noexcept
 {
-#if (_MSC_VER && _WIN64) || ((__GNUC__ || __clang__) &&__SIZEOF_POINTER__ == 8)
-  const size_t fnv_offset = 14695981039346656037ull;
-  const size_t fnv_prime = 1099511628211ull;
+#if defined(__SIZEOF_INT128__)
+  const unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+  a = static_cast<uint64_t>(r);
+  b = static_cast<uint64_t>(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+  a = _umul128(a, b, &b);
 #else
-  const size_t fnv_offset = 2166136261u;
-  const size_t fnv_prime = 16777619u;
+  const uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<uint32_t>(a), lb = static_cast<uint32_t>(b);
+  const uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+  const uint64_t t = rl + (rm0 << 32);
+  uint64_t c = t < rl;
+  const uint64_t lo = t + (rm1 << 32);
+  c += lo < t;
+  const uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+  a = lo;
+  b = hi;
 #endif
-  size_t result = fnv_offset;
-  for (size_t i = 0; i < count; ++i)
+}
+
+inline uint64_t wy_mix(uint64_t a, uint64_t b) noexcept
+{
+  wy_mum(a, b);
+  return a ^ b;
+}
+
+inline uint64_t wy_read8(const unsigned char* p) noexcept
+{
+  uint64_t v;
+  std::memcpy(&v, p, 8);
+  return v;
+}
+
+inline uint64_t wy_read4(const unsigned char* p) noexcept
+{
+  uint32_t v;
+  std::memcpy(&v, p, 4);
+  return v;
+}
+
+// 读入 1 ~ 3 个字节
+inline uint64_t wy_read3(const unsigned char* p, size_t k) noexcept
+{
+  return (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[k >> 1]) << 8) | p[k - 1];
+}
+
+// 带种子的版本，不同的种子得到互不相关的哈希函数
+inline size_t bitwise_hash(const unsigned char* first, size_t count, uint64_t seed) noexcept
+{
+  const unsigned char* p = first;
+  seed ^= wy_mix(seed ^ wy_secret[0], wy_secret[1]);
+  uint64_t a, b;
+  if (count <= 16)
+  {
+    if (count >= 4)
+    { // 两次 4 字节读取覆盖 [4, 16] 字节，中间可能重叠
+      const size_t mid = (count >> 3) << 2;
+      a = (wy_read4(p) << 32) | wy_read4(p + mid);
+      b = (wy_read4(p + count - 4) << 32) | wy_read4(p + count - 4 - mid);
+    }
+    else if (count > 0)
+    {
+      a = wy_read3(p, count);
+      b = 0;
+    }
+    else
+    {
+      a = b = 0;
+    }
+  }
+  else
   {
-    result ^= (size_t)first[i];
-    result *= fnv_prime;
+    size_t i = count;
+    if (i > 48)
+    {
+      uint64_t see1 = seed, see2 = seed;
+      do
+      {
+        seed = wy_mix(wy_read8(p) ^ wy_secret[1], wy_read8(p + 8) ^ seed);
+        see1 = wy_mix(wy_read8(p + 16) ^ wy_secret[2], wy_read8(p + 24) ^ see1);
+        see2 = wy_mix(wy_read8(p + 32) ^ wy_secret[3], wy_read8(p + 40) ^ see2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= see1 ^ see2;
+    }
+    while (i > 16)
+    {
+      seed = wy_mix(wy_read8(p) ^ wy_secret[1], wy_read8(p + 8) ^ seed);
+      p += 16;
+      i -= 16;
+    }
+    // 最后 16 个字节，可能与已经处理过的字节重叠
+    a = wy_read8(p + i - 16);
+    b = wy_read8(p + i - 8);
   }
-  return result;
+  a ^= wy_secret[1];
+  b ^= seed;
+  wy_mum(a, b);
+  return static_cast<size_t>(wy_mix(a ^ wy_secret[0] ^ count, b ^ wy_secret[1]));
 }
 
+inline size_t bitwise_hash(const unsigned char* first, size_t count) noexcept
+{
+  return bitwise_hash(first, count, 0);
+}
+
+// hash_mix
+// 打散一个整数，使输入的每一位都影响输出的每一位
+// mystl::hash 对整数返回原值，配合需要高质量低位或高位的容器时可以先经过 hash_mix
+inline size_t hash_mix(size_t h) noexcept
+{
+#if (_MSC_VER && _WIN64) || ((__GNUC__ || __clang__) &&__SIZEOF_POINTER__ == 8)
+  return static_cast<size_t>(wy_mix(h ^ wy_secret[0], wy_secret[1]));
+#else
+  h ^= h >> 16;
+  h *= 0x85ebca6bu;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35u;
+  return h ^ (h >> 16);
+#endif
+}
+
+// mixed_hash
+// 先用 mystl::hash 计算哈希值，再经过 hash_mix 打散，适合以整数为键值、bucket 个数为 2 的幂的容器
+template <class Key>
+struct mixed_hash
+{
+  size_t operator()(const Key& key) const noexcept
+  { return hash_mix(mystl::hash<Key>()(key)); }
+};
+
 template <>
 struct hash<float>
 {
-  size_t operator()(const float& val)
+  size_t operator()(const float& val) const noexcept
   { 
     return val == 0.0f ? 0 : bitwise_hash((const unsigned char*)&val, sizeof(float));
   }
@@ -265,7 +400,7 @@ struct hash<float>
 template <>
 struct hash<double>
 {
-  size_t operator()(const double& val)
+  size_t operator()(const double& val) const noexcept
   {
     return val == 0.0f ? 0 : bitwise_hash((const unsigned char*)&val, sizeof(double));
   }
@@ -274,7 +409,7 @@ struct hash<double>
 template <>
 struct hash<long double>
 {
-  size_t operator()(const long double& val)
+  size_t operator()(const long double& val) const noexcept
   {
     return val == 0.0f ? 0 : bitwise_hash((const unsigned char*)&val, sizeof(long double));
   }
@@ -4,35 +4,35 @@
 // 这个头文件包含了一个模板类 hashtable
 // hashtable : 哈希表，使用开链法处理冲突
 
+// notes:
+//
+// 1. 打开 incremental_rehash 后，插入时需要扩容不再一次搬完所有节点，而是新旧两个 bucket 数组同时存在，
+//    之后每次插入搬运 ht_rehash_step 个旧 bucket，查找与删除同时查看两个数组，直到搬运完毕
+// 2. 搬运期间 bucket 接口（begin(n)、bucket_size(n)、bucket(key)）只反映新的 bucket 数组
+// 3. find_batch / count_batch / insert_*_batch 以流水线方式处理键值：先算出哈希值并预取 bucket，
+//    每隔 ht_prefetch_distance 个键值再依次预取前驱节点、链表的首节点，最后才比较，多个键值的缓存缺失可以同时等待
+// 4. 所有节点串成一条全局的单向链表，before_begin_ 相当于链表头部之前的哨兵节点的 next，
+//    同一个 bucket 的节点在链表中相邻，bucket 中保存的是指向该 bucket 首节点的那个指针的地址（前驱的 next），
+//    空 bucket 为 nullptr。因此 begin() 是 O(1)，遍历与 clear() 只经过存在的节点，与 bucket 个数无关
+// 5. extract / merge / 以节点句柄 insert 只改变节点的链接，不分配也不释放节点，
+//    节点插入时用本容器的哈希函数重新计算哈希值
+// 6. stats() 返回 bucket 的占用分布、链表长度、内存占用与 rehash 次数，用于诊断性能问题；
+//    编译时定义 MYSTL_HASHTABLE_STATS 后还会统计查找次数、经过的节点数与键值比较次数，默认不统计
+
 #include <initializer_list>
 
 #include "algo.h"
 #include "functional.h"
 #include "memory.h"
+#include "node_handle.h"
 #include "vector.h"
 #include "util.h"
 #include "exceptdef.h"
+#include "simd.h"
 
 namespace mystl
 {
 
-// hashtable 的节点定义
-template <class T>
-struct hashtable_node
-{
-  hashtable_node* next;   // 指向下一个节点
-  T               value;  // 储存实值
-
-  hashtable_node() = default;
-  hashtable_node(const T& n) :next(nullptr), value(n) {}
-
-  hashtable_node(const hashtable_node& node) :next(node.next), value(node.value) {}
-  hashtable_node(hashtable_node&& node) :next(node.next), value(mystl::move(node.value))
-  {
-    node.next = nullptr;
-  }
-};
-
 // value traits
 template <class T, bool>
 struct ht_value_traits_imp
@@ -98,16 +98,70 @@ struct ht_value_traits
   }
 };
 
+// 是否在节点中缓存键值的哈希值
+// 算术类型、指针与枚举的哈希值计算代价很低，不缓存；其余类型（如字符串）缓存，
+// 使 rehash 和判断节点属于哪个 bucket 时不必重新计算哈希值，查找时也可以先比较哈希值再调用 KeyEqual
+// 可以为自定义的键值类型特化这个模板来改变选择
+template <class Key>
+struct ht_cache_hash
+  :public m_bool_constant<!(std::is_arithmetic<Key>::value ||
+                            std::is_pointer<Key>::value ||
+                            std::is_enum<Key>::value)>
+{
+};
+
+// 节点中缓存的哈希值，不缓存时为空基类
+template <bool Cache>
+struct ht_hash_code
+{
+  size_t hash_code;
+
+  void set_hash(size_t h) noexcept                   { hash_code = h; }
+  void copy_hash(const ht_hash_code& rhs) noexcept   { hash_code = rhs.hash_code; }
+  bool same_hash(size_t h) const noexcept            { return hash_code == h; }
+};
+
+template <>
+struct ht_hash_code<false>
+{
+  void set_hash(size_t) noexcept                     {}
+  void copy_hash(const ht_hash_code&) noexcept       {}
+  bool same_hash(size_t) const noexcept              { return true; }
+};
+
+// hashtable 的节点定义
+template <class T>
+struct hashtable_node
+  :public ht_hash_code<ht_cache_hash<typename ht_value_traits<T>::key_type>::value>
+{
+  hashtable_node* next;   // 指向下一个节点
+  T               value;  // 储存实值
+
+  hashtable_node() = default;
+  hashtable_node(const T& n) :next(nullptr), value(n) {}
+
+  // 复制与移动时连同缓存的哈希值一起复制
+  hashtable_node(const hashtable_node& node) :next(node.next), value(node.value)
+  {
+    this->copy_hash(node);
+  }
+  hashtable_node(hashtable_node&& node) :next(node.next), value(mystl::move(node.value))
+  {
+    this->copy_hash(node);
+    node.next = nullptr;
+  }
+};
+
 
 // forward declaration
 
-template <class T, class HashFun, class KeyEqual>
+template <class T, class HashFun, class KeyEqual, class BucketPolicy>
 class hashtable;
 
-template <class T, class HashFun, class KeyEqual>
+template <class T, class HashFun, class KeyEqual, class BucketPolicy>
 struct ht_iterator;
 
-template <class T, class HashFun, class KeyEqual>
+template <class T, class HashFun, class KeyEqual, class BucketPolicy>
 struct ht_const_iterator;
 
 template <class T>
@@ -118,20 +172,20 @@ struct ht_const_local_iterator;
 
 // ht_iterator
 
-template <class T, class Hash, class KeyEqual>
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
 struct ht_iterator_base :public mystl::iterator<mystl::forward_iterator_tag, T>
 {
-  typedef mystl::hashtable<T, Hash, KeyEqual>         hashtable;
-  typedef ht_iterator_base<T, Hash, KeyEqual>         base;
-  typedef mystl::ht_iterator<T, Hash, KeyEqual>       iterator;
-  typedef mystl::ht_const_iterator<T, Hash, KeyEqual> const_iterator;
-  typedef hashtable_node<T>*                          node_ptr;
-  typedef hashtable*                                  contain_ptr;
-  typedef const node_ptr                              const_node_ptr;
-  typedef const contain_ptr                           const_contain_ptr;
-
-  typedef size_t                                      size_type;
-  typedef ptrdiff_t                                   difference_type;
+  typedef mystl::hashtable<T, Hash, KeyEqual, BucketPolicy>         hashtable;
+  typedef ht_iterator_base<T, Hash, KeyEqual, BucketPolicy>         base;
+  typedef mystl::ht_iterator<T, Hash, KeyEqual, BucketPolicy>       iterator;
+  typedef mystl::ht_const_iterator<T, Hash, KeyEqual, BucketPolicy> const_iterator;
+  typedef hashtable_node<T>*                                        node_ptr;
+  typedef hashtable*                                                contain_ptr;
+  typedef const node_ptr                                            const_node_ptr;
+  typedef const contain_ptr                                         const_contain_ptr;
+
+  typedef size_t                                                    size_type;
+  typedef ptrdiff_t                                                 difference_type;
 
   node_ptr    node;  // 迭代器当前所指节点
   contain_ptr ht;    // 保持与容器的连结
@@ -142,10 +196,10 @@ struct ht_iterator_base :public mystl::iterator<mystl::forward_iterator_tag, T>
   bool operator!=(const base& rhs) const { return node != rhs.node; }
 };
 
-template <class T, class Hash, class KeyEqual>
-struct ht_iterator :public ht_iterator_base<T, Hash, KeyEqual>
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+struct ht_iterator :public ht_iterator_base<T, Hash, KeyEqual, BucketPolicy>
 {
-  typedef ht_iterator_base<T, Hash, KeyEqual> base;
+  typedef ht_iterator_base<T, Hash, KeyEqual, BucketPolicy> base;
   typedef typename base::hashtable            hashtable;
   typedef typename base::iterator             iterator;
   typedef typename base::const_iterator       const_iterator;
@@ -202,14 +256,7 @@ struct ht_iterator :public ht_iterator_base<T, Hash, KeyEqual>
   iterator& operator++()
   {
     MYSTL_DEBUG(node != nullptr);
-    const node_ptr old = node;
     node = node->next;
-    if (node == nullptr)
-    { // 如果下一个位置为空，跳到下一个 bucket 的起始处
-      auto index = ht->hash(value_traits::get_key(old->value));
-      while (!node && ++index < ht->bucket_size_)
-        node = ht->buckets_[index];
-    }
     return *this;
   }
   iterator operator++(int)
@@ -220,10 +267,10 @@ struct ht_iterator :public ht_iterator_base<T, Hash, KeyEqual>
   }
 };
 
-template <class T, class Hash, class KeyEqual>
-struct ht_const_iterator :public ht_iterator_base<T, Hash, KeyEqual>
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+struct ht_const_iterator :public ht_iterator_base<T, Hash, KeyEqual, BucketPolicy>
 {
-  typedef ht_iterator_base<T, Hash, KeyEqual> base;
+  typedef ht_iterator_base<T, Hash, KeyEqual, BucketPolicy> base;
   typedef typename base::hashtable            hashtable;
   typedef typename base::iterator             iterator;
   typedef typename base::const_iterator       const_iterator;
@@ -280,16 +327,7 @@ struct ht_const_iterator :public ht_iterator_base<T, Hash, KeyEqual>
   const_iterator& operator++()
   {
     MYSTL_DEBUG(node != nullptr);
-    const node_ptr old = node;
     node = node->next;
-    if (node == nullptr)
-    { // 如果下一个位置为空，跳到下一个 bucket 的起始处
-      auto index = ht->hash(value_traits::get_key(old->value));
-      while (!node && ++index < ht->bucket_size_)
-      {
-        node = ht->buckets_[index];
-      }
-    }
     return *this;
   }
   const_iterator operator++(int)
@@ -467,14 +505,157 @@ inline size_t ht_next_prime(size_t n)
   return pos == last ? *(last - 1) : *pos;
 }
 
+// 渐进式 rehash 时每次插入搬运的旧 bucket 个数
+static constexpr size_t ht_rehash_step = 4;
+
+// 批量操作的预取距离，同时在途的预取不宜超过 CPU 能跟踪的缓存缺失数
+static constexpr size_t ht_prefetch_distance = 8;
+
+// hashtable 统计信息中链表长度分布的组数
+static constexpr size_t ht_stats_bins = 8;
+
+// hashtable 的统计信息，由 stats() 返回
+// 渐进式 rehash 期间，旧数组中尚未搬运的 bucket 也计算在内
+struct ht_stats
+{
+  size_t size;                       // 元素个数
+  size_t bucket_count;               // bucket 个数
+  size_t empty_buckets;              // 空 bucket 的个数
+  size_t max_chain;                  // 最长的链表长度
+  double mean_chain;                 // 非空 bucket 的平均链表长度
+  size_t chain_hist[ht_stats_bins];  // 第 i 项为恰有 i 个节点的 bucket 个数，最后一项包括更长的链表
+  size_t bucket_bytes;               // bucket 数组占用的字节数
+  size_t node_bytes;                 // 节点占用的字节数
+  size_t rehash_count;               // rehash 的次数
+  size_t lookups;                    // 查找次数，以下三项只在定义 MYSTL_HASHTABLE_STATS 时统计
+  size_t probes;                     // 查找时经过的节点数
+  size_t compares;                   // 调用键值比较函数的次数
+};
+
+// 查找计数器，没有定义 MYSTL_HASHTABLE_STATS 时是空操作
+struct ht_probe_counter
+{
+#ifdef MYSTL_HASHTABLE_STATS
+  size_t lookups = 0;
+  size_t probes = 0;
+  size_t compares = 0;
+
+  void lookup()  noexcept { ++lookups; }
+  void probe()   noexcept { ++probes; }
+  void compare() noexcept { ++compares; }
+  void reset()   noexcept { lookups = probes = compares = 0; }
+
+  void get(ht_stats& s) const noexcept
+  {
+    s.lookups = lookups;
+    s.probes = probes;
+    s.compares = compares;
+  }
+#else
+  void lookup()  noexcept {}
+  void probe()   noexcept {}
+  void compare() noexcept {}
+  void reset()   noexcept {}
+
+  void get(ht_stats& s) const noexcept
+  {
+    s.lookups = s.probes = s.compares = 0;
+  }
+#endif
+};
+
+/*****************************************************************************************/
+// bucket policy
+// 决定 bucket 的个数以及哈希值到 bucket 下标的映射，需要提供以下接口：
+//   static size_t next_size(size_t n) : 不小于 n 的 bucket 个数
+//   static size_t max_size()          : 最大的 bucket 个数
+//   void   reset(size_t n)            : bucket 个数变为 n 时调用
+//   size_t index(size_t h) const      : 哈希值 h 所在的 bucket，范围为 [0, n)
+/*****************************************************************************************/
+
+// ht_prime_policy
+// bucket 个数取质数表中的值，对哈希值的分布没有要求
+// 64 位平台上用 Lemire 的 fastmod 代替除法：reset 时预先算出 2^128 / n 的近似倒数，
+// index 只需要三次乘法
+struct ht_prime_policy
+{
+#if defined(SYSTEM_64) && defined(__SIZEOF_INT128__)
+  size_t            n_ = 1;
+  unsigned __int128 m_ = 0;
+
+  void reset(size_t n) noexcept
+  {
+    n_ = n == 0 ? 1 : n;
+    m_ = static_cast<unsigned __int128>(-1) / n_ + 1;
+  }
+
+  size_t index(size_t h) const noexcept
+  {
+    typedef unsigned __int128 u128;
+    const u128 low = m_ * h;
+    const u128 bottom = ((low & static_cast<size_t>(-1)) * n_) >> 64;
+    const u128 top = (low >> 64) * n_;
+    return static_cast<size_t>((bottom + top) >> 64);
+  }
+#else
+  size_t n_ = 1;
+
+  void   reset(size_t n) noexcept       { n_ = n == 0 ? 1 : n; }
+  size_t index(size_t h) const noexcept { return h % n_; }
+#endif
+
+  static size_t next_size(size_t n) noexcept { return ht_next_prime(n); }
+  static size_t max_size() noexcept          { return ht_prime_list[PRIME_NUM - 1]; }
+};
+
+// ht_power2_policy
+// bucket 个数取 2 的幂，用 Fibonacci 哈希（乘以 2^w / φ 后取高位）得到下标，
+// 即使 hash<int> 这类恒等哈希在低位有规律，元素也能均匀分布到各个 bucket
+struct ht_power2_policy
+{
+  static constexpr size_t min_bucket = 8;
+
+  unsigned shift_ = sizeof(size_t) * 8 - 3;
+
+  void reset(size_t n) noexcept
+  {
+    unsigned bits = 0;
+    while ((static_cast<size_t>(1) << bits) < n)
+      ++bits;
+    shift_ = static_cast<unsigned>(sizeof(size_t) * 8) - bits;
+  }
+
+  size_t index(size_t h) const noexcept
+  {
+#ifdef SYSTEM_64
+    const size_t golden = 0x9e3779b97f4a7c15ull;
+#else
+    const size_t golden = 0x9e3779b9u;
+#endif
+    // shift_ 等于字长时（只有一个 bucket）右移是未定义行为，这里分两步移位
+    return (h * golden) >> (shift_ - 1) >> 1;
+  }
+
+  static size_t next_size(size_t n) noexcept
+  {
+    size_t size = min_bucket;
+    while (size < n && size < max_size())
+      size <<= 1;
+    return size;
+  }
+  static size_t max_size() noexcept
+  { return static_cast<size_t>(1) << (sizeof(size_t) * 8 - 1); }
+};
+
 // 模板类 hashtable
-// 参数一代表数据类型，参数二代表哈希函数，参数三代表键值相等的比较函数
-template <class T, class Hash, class KeyEqual>
+// 参数一代表数据类型，参数二代表哈希函数，参数三代表键值相等的比较函数，
+// 参数四代表把哈希值映射到 bucket 的策略，缺省使用 ht_prime_policy
+template <class T, class Hash, class KeyEqual, class BucketPolicy = ht_prime_policy>
 class hashtable
 {  
 
-  friend struct mystl::ht_iterator<T, Hash, KeyEqual>;
-  friend struct mystl::ht_const_iterator<T, Hash, KeyEqual>;
+  friend struct mystl::ht_iterator<T, Hash, KeyEqual, BucketPolicy>;
+  friend struct mystl::ht_const_iterator<T, Hash, KeyEqual, BucketPolicy>;
 
 public:
   // hashtable 的型别定义
@@ -484,10 +665,13 @@ public:
   typedef typename value_traits::value_type           value_type;
   typedef Hash                                        hasher;
   typedef KeyEqual                                    key_equal;
+  typedef BucketPolicy                                bucket_policy;
 
   typedef hashtable_node<T>                           node_type;
   typedef node_type*                                  node_ptr;
-  typedef mystl::vector<node_ptr>                     bucket_type;
+  typedef m_bool_constant<
+    ht_cache_hash<key_type>::value>                   cache_hash_type;
+  typedef mystl::vector<node_ptr*>                    bucket_type;
 
   typedef mystl::allocator<T>                         allocator_type;
   typedef mystl::allocator<T>                         data_allocator;
@@ -500,30 +684,46 @@ public:
   typedef typename allocator_type::size_type          size_type;
   typedef typename allocator_type::difference_type    difference_type;
 
-  typedef mystl::ht_iterator<T, Hash, KeyEqual>       iterator;
-  typedef mystl::ht_const_iterator<T, Hash, KeyEqual> const_iterator;
+  typedef mystl::ht_iterator<T, Hash, KeyEqual,
+                             BucketPolicy>            iterator;
+  typedef mystl::ht_const_iterator<T, Hash, KeyEqual,
+                                   BucketPolicy>      const_iterator;
   typedef mystl::ht_local_iterator<T>                 local_iterator;
   typedef mystl::ht_const_local_iterator<T>           const_local_iterator;
 
+  typedef mystl::node_handle<node_type, value_traits> node_handle_type;
+  typedef mystl::node_insert_return<
+    iterator, node_handle_type>                       insert_return_type;
+
   allocator_type get_allocator() const { return allocator_type(); }
 
 private:
-  // 用以下六个参数来表现 hashtable
-  bucket_type buckets_;
-  size_type   bucket_size_;
-  size_type   size_;
-  float       mlf_;
-  hasher      hash_;
-  key_equal   equal_;
+  // 用以下八个参数来表现 hashtable
+  node_ptr      before_begin_;  // 全局链表的首节点
+  bucket_type   buckets_;
+  size_type     bucket_size_;
+  size_type     size_;
+  float         mlf_;
+  hasher        hash_;
+  key_equal     equal_;
+  bucket_policy policy_;
+
+  // 渐进式 rehash 的状态，old_buckets_ 非空表示正在搬运，
+  // 旧数组中下标不小于 migrate_ 的 bucket 还没有搬到 buckets_ 中
+  bucket_type   old_buckets_;
+  bucket_policy old_policy_;
+  size_type     migrate_;
+  bool          incremental_;
+
+  // 诊断信息，见 stats()
+  size_type                rehash_count_;
+  mutable ht_probe_counter probe_;
 
 private:
-  bool is_equal(const key_type& key1, const key_type& key2)
-  {
-    return equal_(key1, key2);
-  }
-
-  bool is_equal(const key_type& key1, const key_type& key2) const
+  template <class K>
+  bool is_equal(const key_type& key1, const K& key2) const
   {
+    probe_.compare();
     return equal_(key1, key2);
   }
 
@@ -534,22 +734,12 @@ private:
 
   iterator M_begin() noexcept
   {
-    for (size_type n = 0; n < bucket_size_; ++n)
-    {
-      if (buckets_[n])  // 找到第一个有节点的位置就返回
-        return iterator(buckets_[n], this);
-    }
-    return iterator(nullptr, this);
+    return iterator(before_begin_, this);
   }
 
   const_iterator M_begin() const noexcept
   {
-    for (size_type n = 0; n < bucket_size_; ++n)
-    {
-      if (buckets_[n])  // 找到第一个有节点的位置就返回
-        return M_cit(buckets_[n]);
-    }
-    return M_cit(nullptr);
+    return M_cit(before_begin_);
   }
 
 public:
@@ -557,7 +747,8 @@ public:
   explicit hashtable(size_type bucket_count,
                      const Hash& hash = Hash(),
                      const KeyEqual& equal = KeyEqual())
-    :size_(0), mlf_(1.0f), hash_(hash), equal_(equal)
+    :before_begin_(nullptr), size_(0), mlf_(1.0f), hash_(hash), equal_(equal),
+    migrate_(0), incremental_(false), rehash_count_(0)
   {
     init(bucket_count);
   }
@@ -568,27 +759,36 @@ public:
               size_type bucket_count,
               const Hash& hash = Hash(),
               const KeyEqual& equal = KeyEqual())
-    :size_(mystl::distance(first, last)), mlf_(1.0f), hash_(hash), equal_(equal)
+    :before_begin_(nullptr), size_(mystl::distance(first, last)), mlf_(1.0f),
+    hash_(hash), equal_(equal), migrate_(0), incremental_(false), rehash_count_(0)
   {
     init(mystl::max(bucket_count, static_cast<size_type>(mystl::distance(first, last))));
   }
 
   hashtable(const hashtable& rhs)
-    :hash_(rhs.hash_), equal_(rhs.equal_)
+    :before_begin_(nullptr), hash_(rhs.hash_), equal_(rhs.equal_), rehash_count_(0)
   {
     copy_init(rhs);
   }
   hashtable(hashtable&& rhs) noexcept
-    : bucket_size_(rhs.bucket_size_), 
+    : before_begin_(rhs.before_begin_),
+    bucket_size_(rhs.bucket_size_),
     size_(rhs.size_),
     mlf_(rhs.mlf_),
     hash_(rhs.hash_),
-    equal_(rhs.equal_)
+    equal_(rhs.equal_),
+    policy_(rhs.policy_),
+    old_policy_(rhs.old_policy_),
+    migrate_(rhs.migrate_),
+    incremental_(rhs.incremental_),
+    rehash_count_(rhs.rehash_count_)
   {
     buckets_ = mystl::move(rhs.buckets_);
+    old_buckets_ = mystl::move(rhs.old_buckets_);
+    fix_before_begin();
+    rhs.before_begin_ = nullptr;
     rhs.bucket_size_ = 0;
     rhs.size_ = 0;
-    rhs.mlf_ = 0.0f;
   }
 
   hashtable& operator=(const hashtable& rhs);
@@ -623,8 +823,17 @@ public:
   template <class ...Args>
   iterator emplace_multi(Args&& ...args);
 
+  // 第一个参数就是键值时先查找，键值已存在就不分配节点
   template <class ...Args>
-  pair<iterator, bool> emplace_unique(Args&& ...args);
+  pair<iterator, bool> emplace_unique(Args&& ...args)
+  {
+    return M_emplace_unique(mystl::is_key_first<key_type, Args...>(),
+                            mystl::forward<Args>(args)...);
+  }
+
+  // 按 key 查找，不存在时才用 args 构造节点插入
+  template <class ...Args>
+  pair<iterator, bool> try_emplace_unique(const key_type& key, Args&& ...args);
 
   // [note]: hint 对于 hash_table 其实没有意义，因为即使提供了 hint，也要做一次 hash，
   // 来确保 hash_table 的性质，所以选择忽略它
@@ -677,6 +886,12 @@ public:
   void insert_unique(InputIter first, InputIter last)
   { copy_insert_unique(first, last, iterator_category(first)); }
 
+  // 批量插入，先为整个区间扩容，再分组预取后插入
+  template <class ForwardIter>
+  void insert_multi_batch(ForwardIter first, ForwardIter last);
+  template <class ForwardIter>
+  void insert_unique_batch(ForwardIter first, ForwardIter last);
+
   // erase / clear
 
   void      erase(const_iterator position);
@@ -689,57 +904,115 @@ public:
 
   void      swap(hashtable& rhs) noexcept;
 
-  // 查找相关操作
+  // node handle
+
+  node_handle_type   extract(const_iterator position);
+  node_handle_type   extract(const key_type& key);
 
-  size_type                            count(const key_type& key) const;
+  iterator           insert_multi(node_handle_type&& nh);
+  insert_return_type insert_unique(node_handle_type&& nh);
 
-  iterator                             find(const key_type& key);
-  const_iterator                       find(const key_type& key) const;
+  // 把 other 的节点直接链接到本容器，不分配也不释放节点
+  void               merge_multi(hashtable& other);
+  void               merge_unique(hashtable& other);
 
-  pair<iterator, iterator>             equal_range_multi(const key_type& key);
-  pair<const_iterator, const_iterator> equal_range_multi(const key_type& key) const;
+  // 查找相关操作
 
-  pair<iterator, iterator>             equal_range_unique(const key_type& key);
-  pair<const_iterator, const_iterator> equal_range_unique(const key_type& key) const;
+  size_type                            count(const key_type& key) const
+  { return M_count(key); }
+
+  iterator                             find(const key_type& key)
+  { return iterator(M_find(key), this); }
+  const_iterator                       find(const key_type& key) const
+  { return M_cit(M_find(key)); }
+
+  pair<iterator, iterator>             equal_range_multi(const key_type& key)
+  { return M_range(M_equal_range_multi(key)); }
+  pair<const_iterator, const_iterator> equal_range_multi(const key_type& key) const
+  { return M_range(M_equal_range_multi(key)); }
+
+  pair<iterator, iterator>             equal_range_unique(const key_type& key)
+  { return M_range(M_equal_range_unique(key)); }
+  pair<const_iterator, const_iterator> equal_range_unique(const key_type& key) const
+  { return M_range(M_equal_range_unique(key)); }
+
+  // 透明查找：哈希函数与比较函数都定义了 is_transparent 时，接受任意能与键值比较的类型，
+  // 不构造 key_type 的临时对象
+
+  template <class K, class H = Hash, mystl::enable_if_transparent<H, KeyEqual> = 0>
+  size_type                            count(const K& key) const
+  { return M_count(key); }
+
+  template <class K, class H = Hash, mystl::enable_if_transparent<H, KeyEqual> = 0>
+  iterator                             find(const K& key)
+  { return iterator(M_find(key), this); }
+  template <class K, class H = Hash, mystl::enable_if_transparent<H, KeyEqual> = 0>
+  const_iterator                       find(const K& key) const
+  { return M_cit(M_find(key)); }
+
+  template <class K, class H = Hash, mystl::enable_if_transparent<H, KeyEqual> = 0>
+  pair<iterator, iterator>             equal_range_multi(const K& key)
+  { return M_range(M_equal_range_multi(key)); }
+  template <class K, class H = Hash, mystl::enable_if_transparent<H, KeyEqual> = 0>
+  pair<const_iterator, const_iterator> equal_range_multi(const K& key) const
+  { return M_range(M_equal_range_multi(key)); }
+
+  template <class K, class H = Hash, mystl::enable_if_transparent<H, KeyEqual> = 0>
+  pair<iterator, iterator>             equal_range_unique(const K& key)
+  { return M_range(M_equal_range_unique(key)); }
+  template <class K, class H = Hash, mystl::enable_if_transparent<H, KeyEqual> = 0>
+  pair<const_iterator, const_iterator> equal_range_unique(const K& key) const
+  { return M_range(M_equal_range_unique(key)); }
+
+  // 批量查找，依次把每个键值的查找结果写到 result，返回写完后的 result
+
+  template <class ForwardIter, class OutputIter>
+  OutputIter find_batch(ForwardIter first, ForwardIter last, OutputIter result);
+  template <class ForwardIter, class OutputIter>
+  OutputIter find_batch(ForwardIter first, ForwardIter last, OutputIter result) const;
+  template <class ForwardIter, class OutputIter>
+  OutputIter count_batch(ForwardIter first, ForwardIter last, OutputIter result) const;
 
   // bucket interface
 
+  // 同一个 bucket 的节点在全局链表中相邻，end(n) 是该 bucket 之后的第一个节点
+
   local_iterator       begin(size_type n)        noexcept
   { 
-    MYSTL_DEBUG(n < size_);
-    return buckets_[n];
+    MYSTL_DEBUG(n < bucket_size_);
+    return bucket_first(n);
   }
   const_local_iterator begin(size_type n)  const noexcept
   { 
-    MYSTL_DEBUG(n < size_);
-    return buckets_[n];
+    MYSTL_DEBUG(n < bucket_size_);
+    return bucket_first(n);
   }
   const_local_iterator cbegin(size_type n) const noexcept
   { 
-    MYSTL_DEBUG(n < size_);
-    return buckets_[n];
+    MYSTL_DEBUG(n < bucket_size_);
+    return bucket_first(n);
   }
 
   local_iterator       end(size_type n)          noexcept
   { 
-    MYSTL_DEBUG(n < size_);
-    return nullptr; 
+    MYSTL_DEBUG(n < bucket_size_);
+    return bucket_last(n);
   }
   const_local_iterator end(size_type n)    const noexcept
   { 
-    MYSTL_DEBUG(n < size_);
-    return nullptr; 
+    MYSTL_DEBUG(n < bucket_size_);
+    return bucket_last(n);
   }
   const_local_iterator cend(size_type n)   const noexcept
   {
-    MYSTL_DEBUG(n < size_);
-    return nullptr; 
+    MYSTL_DEBUG(n < bucket_size_);
+    return bucket_last(n);
   }
 
   size_type bucket_count()                 const noexcept
   { return bucket_size_; }
   size_type max_bucket_count()             const noexcept
-  { return ht_prime_list[PRIME_NUM - 1]; }
+  { return bucket_policy::max_size(); }
 
   size_type bucket_size(size_type n)       const noexcept;
   size_type bucket(const key_type& key)    const
@@ -754,18 +1027,37 @@ public:
   { return mlf_; }
   void max_load_factor(float ml)
   {
-    THROW_OUT_OF_RANGE_IF(ml != ml || ml < 0, "invalid hash load factor");
+    THROW_OUT_OF_RANGE_IF(!(ml > 0.0f), "invalid hash load factor");  // 同时排除 NaN
     mlf_ = ml;
   }
 
   void rehash(size_type count);
 
   void reserve(size_type count)
-  { rehash(static_cast<size_type>((float)count / max_load_factor() + 0.5f)); }
+  { rehash(bucket_count_for(count)); }
+
+  // 渐进式 rehash，关闭时立即搬运完剩余的节点
+  bool incremental_rehash() const noexcept
+  { return incremental_; }
+  void incremental_rehash(bool on)
+  {
+    if (!on)
+      finish_rehash();
+    incremental_ = on;
+  }
 
   hasher    hash_fcn() const { return hash_; }
   key_equal key_eq()   const { return equal_; }
 
+  // 诊断信息
+
+  ht_stats  stats() const;
+  void      reset_stats() noexcept
+  {
+    rehash_count_ = 0;
+    probe_.reset();
+  }
+
 private:
   // hashtable 成员函数
 
@@ -780,10 +1072,66 @@ private:
 
   // hash
   size_type next_size(size_type n) const;
-  size_type hash(const key_type& key, size_type n) const;
+  size_type bucket_count_for(size_type n) const;
   size_type hash(const key_type& key) const;
   void      rehash_if_need(size_type n);
 
+  // incremental rehash
+  bool      rehashing() const noexcept { return !old_buckets_.empty(); }
+  node_ptr*&      bucket_prev(size_t code);
+  node_ptr*       bucket_prev(size_t code) const;
+  node_ptr* const* bucket_addr(size_t code) const;
+  bool      in_bucket(const hashtable_node<T>* np, node_ptr* const* slot) const
+  { return bucket_addr(node_hash(np)) == slot; }
+  void      start_rehash(size_type count);
+  void      rehash_step(size_type count);
+  void      finish_rehash()   { rehash_step(old_buckets_.size()); }
+
+  size_t    node_hash(const hashtable_node<T>* np) const;
+  size_t    node_hash(const hashtable_node<T>* np, m_true_type) const;
+  size_t    node_hash(const hashtable_node<T>* np, m_false_type) const;
+  template <class K>
+  bool      node_equal(const hashtable_node<T>* np, size_t code, const K& key) const
+  { return np->same_hash(code) && is_equal(value_traits::get_key(np->value), key); }
+
+  // find
+  template <class K>
+  node_ptr  M_find(const K& key) const
+  { return M_find(key, hash_(key)); }
+  template <class K>
+  node_ptr  M_find(const K& key, size_t code) const
+  {
+    const auto prev = M_find_prev(key, code);
+    return prev ? *prev : nullptr;
+  }
+  template <class K>
+  node_ptr* M_find_prev(const K& key, size_t code) const;
+  template <class K>
+  size_type M_count(const K& key) const
+  { return M_count(key, hash_(key)); }
+  template <class K>
+  size_type M_count(const K& key, size_t code) const;
+
+  // batch
+  template <class ForwardIter, class HashOf, class Fn>
+  void      M_batch(ForwardIter first, ForwardIter last, HashOf hash_of, Fn fn) const;
+  template <class K>
+  pair<node_ptr, node_ptr> M_equal_range_multi(const K& key) const;
+  template <class K>
+  pair<node_ptr, node_ptr> M_equal_range_unique(const K& key) const;
+
+  pair<iterator, iterator> M_range(const pair<node_ptr, node_ptr>& p)
+  { return mystl::make_pair(iterator(p.first, this), iterator(p.second, this)); }
+  pair<const_iterator, const_iterator> M_range(const pair<node_ptr, node_ptr>& p) const
+  { return mystl::make_pair(M_cit(p.first), M_cit(p.second)); }
+
+  // emplace
+  template <class ...Args>
+  pair<iterator, bool> M_emplace_unique(m_false_type, Args&& ...args);
+  template <class K, class ...Args>
+  pair<iterator, bool> M_emplace_unique(m_true_type, K&& key, Args&& ...args)
+  { return try_emplace_unique(key, mystl::forward<K>(key), mystl::forward<Args>(args)...); }
+
   // insert
   template <class InputIter>
   void copy_insert_multi(InputIter first, InputIter last, mystl::input_iterator_tag);
@@ -794,14 +1142,27 @@ private:
   template <class ForwardIter>
   void copy_insert_unique(ForwardIter first, ForwardIter last, mystl::forward_iterator_tag);
 
+  // insert with hash code
+  pair<iterator, bool> insert_unique_noresize(const value_type& value, size_t code);
+  iterator             insert_multi_noresize(const value_type& value, size_t code);
+
   // insert node
   pair<iterator, bool> insert_node_unique(node_ptr np);
   iterator             insert_node_multi(node_ptr np);
 
+  // list operator
+  void      link_node(node_ptr np, size_t code);
+  void      link_after(node_ptr pos, node_ptr np);
+  void      unlink_node(node_ptr* prev, node_ptr np);
+  node_ptr* find_prev(node_ptr np);
+  void      fix_before_begin() noexcept;
+  node_ptr  bucket_first(size_type n) const noexcept
+  { return buckets_[n] ? *buckets_[n] : nullptr; }
+  node_ptr  bucket_last(size_type n) const;
+
   // bucket operator
+  void copy_list(const hashtable& ht);
   void replace_bucket(size_type bucket_count);
-  void erase_bucket(size_type n, node_ptr first, node_ptr last);
-  void erase_bucket(size_type n, node_ptr last);
 
   // comparision
   bool equal_to_multi(const hashtable& other);
@@ -811,9 +1172,9 @@ private:
 /*****************************************************************************************/
 
 // 复制赋值运算符
-template <class T, class Hash, class KeyEqual>
-hashtable<T, Hash, KeyEqual>&
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+hashtable<T, Hash, KeyEqual, BucketPolicy>&
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
 operator=(const hashtable& rhs)
 {
   if (this != &rhs)
@@ -825,9 +1186,9 @@ operator=(const hashtable& rhs)
 }
 
 // 移动赋值运算符
-template <class T, class Hash, class KeyEqual>
-hashtable<T, Hash, KeyEqual>&
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+hashtable<T, Hash, KeyEqual, BucketPolicy>&
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
 operator=(hashtable&& rhs) noexcept
 {
   hashtable tmp(mystl::move(rhs));
@@ -837,17 +1198,17 @@ operator=(hashtable&& rhs) noexcept
 
 // 就地构造元素，键值允许重复
 // 强异常安全保证
-template <class T, class Hash, class KeyEqual>
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
 template <class ...Args>
-typename hashtable<T, Hash, KeyEqual>::iterator
-hashtable<T, Hash, KeyEqual>::
+typename hashtable<T, Hash, KeyEqual, BucketPolicy>::iterator
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
 emplace_multi(Args&& ...args)
 {
   auto np = create_node(mystl::forward<Args>(args)...);
   try
   {
-    if ((float)(size_ + 1) > (float)bucket_size_ * max_load_factor())
-      rehash(size_ + 1);
+    np->set_hash(hash_(value_traits::get_key(np->value)));
+    rehash_if_need(1);
   }
   catch (...)
   {
@@ -857,19 +1218,19 @@ emplace_multi(Args&& ...args)
   return insert_node_multi(np);
 }
 
-// 就地构造元素，键值允许重复
+// 就地构造元素，键值不允许重复
 // 强异常安全保证
-template <class T, class Hash, class KeyEqual>
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
 template <class ...Args>
-pair<typename hashtable<T, Hash, KeyEqual>::iterator, bool> 
-hashtable<T, Hash, KeyEqual>::
-emplace_unique(Args&& ...args)
+pair<typename hashtable<T, Hash, KeyEqual, BucketPolicy>::iterator, bool> 
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
+M_emplace_unique(m_false_type, Args&& ...args)
 {
   auto np = create_node(mystl::forward<Args>(args)...);
   try
   {
-    if ((float)(size_ + 1) > (float)bucket_size_ * max_load_factor())
-      rehash(size_ + 1);
+    np->set_hash(hash_(value_traits::get_key(np->value)));
+    rehash_if_need(1);
   }
   catch (...)
   {
@@ -879,216 +1240,326 @@ emplace_unique(Args&& ...args)
   return insert_node_unique(np);
 }
 
+// 先按 key 查找，键值不存在时才构造节点，键值已存在时不分配内存
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+template <class ...Args>
+pair<typename hashtable<T, Hash, KeyEqual, BucketPolicy>::iterator, bool>
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
+try_emplace_unique(const key_type& key, Args&& ...args)
+{
+  const auto code = hash_(key);
+  const auto cur = M_find(key, code);
+  if (cur)
+    return mystl::make_pair(iterator(cur, this), false);
+  rehash_if_need(1);
+  auto np = create_node(mystl::forward<Args>(args)...);
+  np->set_hash(code);
+  link_node(np, code);
+  ++size_;
+  return mystl::make_pair(iterator(np, this), true);
+}
+
 // 在不需要重建表格的情况下插入新节点，键值不允许重复
-template <class T, class Hash, class KeyEqual>
-pair<typename hashtable<T, Hash, KeyEqual>::iterator, bool>
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+pair<typename hashtable<T, Hash, KeyEqual, BucketPolicy>::iterator, bool>
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
 insert_unique_noresize(const value_type& value)
 {
-  const auto n = hash(value_traits::get_key(value));
-  auto first = buckets_[n];
-  for (auto cur = first; cur; cur = cur->next)
-  {
-    if (is_equal(value_traits::get_key(cur->value), value_traits::get_key(value)))
-      return mystl::make_pair(iterator(cur, this), false);
-  }
-  // 让新节点成为链表的第一个节点
+  return insert_unique_noresize(value, hash_(value_traits::get_key(value)));
+}
+
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+pair<typename hashtable<T, Hash, KeyEqual, BucketPolicy>::iterator, bool>
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
+insert_unique_noresize(const value_type& value, size_t code)
+{
+  const auto cur = M_find(value_traits::get_key(value), code);
+  if (cur)
+    return mystl::make_pair(iterator(cur, this), false);
+  // 让新节点成为 bucket 的第一个节点
   auto tmp = create_node(value);  
-  tmp->next = first;
-  buckets_[n] = tmp;
+  tmp->set_hash(code);
+  link_node(tmp, code);
   ++size_;
   return mystl::make_pair(iterator(tmp, this), true);
 }
 
 // 在不需要重建表格的情况下插入新节点，键值允许重复
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::iterator
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, BucketPolicy>::iterator
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
 insert_multi_noresize(const value_type& value)
 {
-  const auto n = hash(value_traits::get_key(value));
-  auto first = buckets_[n];
+  return insert_multi_noresize(value, hash_(value_traits::get_key(value)));
+}
+
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, BucketPolicy>::iterator
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
+insert_multi_noresize(const value_type& value, size_t code)
+{
+  const auto cur = M_find(value_traits::get_key(value), code);
   auto tmp = create_node(value);
-  for (auto cur = first; cur; cur = cur->next)
-  {
-    if (is_equal(value_traits::get_key(cur->value), value_traits::get_key(value)))
-    { // 如果链表中存在相同键值的节点就马上插入，然后返回
-      tmp->next = cur->next;
-      cur->next = tmp;
-      ++size_;
-      return iterator(tmp, this);
-    }
+  tmp->set_hash(code);
+  if (cur)
+  { // 如果存在相同键值的节点就插入在它的后面
+    link_after(cur, tmp);
+  }
+  else
+  { // 否则插入在 bucket 的头部
+    link_node(tmp, code);
   }
-  // 否则插入在链表头部
-  tmp->next = first;
-  buckets_[n] = tmp;
   ++size_;
   return iterator(tmp, this);
 }
 
 // 删除迭代器所指的节点
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, BucketPolicy>::
 erase(const_iterator position)
 {
   auto p = position.node;
   if (p)
   {
-    const auto n = hash(value_traits::get_key(p->value));
-    auto cur = buckets_[n];
-    if (cur == p)
-    { // p 位于链表头部
-      buckets_[n] = cur->next;
-      destroy_node(cur);
-      --size_;
-    }
-    else
-    {
-      auto next = cur->next;
-      while (next)
-      {
-        if (next == p)
-        {
-          cur->next = next->next;
-          destroy_node(next);
-          --size_;
-          break;
-        }
-        else
-        {
-          cur = next;
-          next = cur->next;
-        }
-      }
-    }
+    unlink_node(find_prev(p), p);
+    destroy_node(p);
+    --size_;
   }
 }
 
 // 删除[first, last)内的节点
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, BucketPolicy>::
 erase(const_iterator first, const_iterator last)
 {
   if (first.node == last.node)
     return;
-  auto first_bucket = first.node 
-    ? hash(value_traits::get_key(first.node->value)) 
-    : bucket_size_;
-  auto last_bucket = last.node 
-    ? hash(value_traits::get_key(last.node->value))
-    : bucket_size_;
-  if (first_bucket == last_bucket)
-  { // 如果在 bucket 在同一个位置
-    erase_bucket(first_bucket, first.node, last.node);
-  }
-  else
+  // [first, last) 在全局链表中是连续的一段，找到 first 的前驱后逐个摘下
+  auto prev = find_prev(first.node);
+  while (*prev != last.node)
   {
-    erase_bucket(first_bucket, first.node, nullptr);
-    for (auto n = first_bucket + 1; n < last_bucket; ++n)
-    {
-      if(buckets_[n] != nullptr)
-        erase_bucket(n, nullptr);
-    }
-    if (last_bucket != bucket_size_)
-    {
-      erase_bucket(last_bucket, last.node);
-    }
+    auto p = *prev;
+    unlink_node(prev, p);
+    destroy_node(p);
+    --size_;
   }
 }
 
 // 删除键值为 key 的节点
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::size_type
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, BucketPolicy>::size_type
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
 erase_multi(const key_type& key)
 {
   auto p = equal_range_multi(key);
   if (p.first.node != nullptr)
-  {
+  { // 先计数再删除，删除后区间内的节点已被释放
+    const auto n = static_cast<size_type>(mystl::distance(p.first, p.second));
     erase(p.first, p.second);
-    return mystl::distance(p.first, p.second);
+    return n;
   }
   return 0;
 }
 
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::size_type
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, BucketPolicy>::size_type
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
 erase_unique(const key_type& key)
 {
-  const auto n = hash(key);
-  auto first = buckets_[n];
-  if (first)
+  const auto prev = M_find_prev(key, hash_(key));
+  if (prev)
   {
-    if (is_equal(value_traits::get_key(first->value), key))
-    {
-      buckets_[n] = first->next;
-      destroy_node(first);
-      --size_;
-      return 1;
-    }
-    else
-    {
-      auto next = first->next;
-      while (next)
-      {
-        if (is_equal(value_traits::get_key(next->value), key))
-        {
-          first->next = next->next;
-          destroy_node(next);
-          --size_;
-          return 1;
-        }
-        first = next;
-        next = first->next;
-      }
-    }
+    auto p = *prev;
+    unlink_node(prev, p);
+    destroy_node(p);
+    --size_;
+    return 1;
   }
   return 0;
 }
 
+// 把迭代器所指的节点从链表中摘下，交给节点句柄
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, BucketPolicy>::node_handle_type
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
+extract(const_iterator position)
+{
+  auto p = position.node;
+  MYSTL_DEBUG(p != nullptr);
+  unlink_node(find_prev(p), p);
+  p->next = nullptr;
+  --size_;
+  return node_handle_type(p);
+}
+
+// 摘下键值为 key 的第一个节点，没有时返回空的句柄
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, BucketPolicy>::node_handle_type
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
+extract(const key_type& key)
+{
+  const auto prev = M_find_prev(key, hash_(key));
+  if (prev == nullptr)
+    return node_handle_type();
+  auto p = *prev;
+  unlink_node(prev, p);
+  p->next = nullptr;
+  --size_;
+  return node_handle_type(p);
+}
+
+// 插入句柄持有的节点，键值允许重复，句柄为空时返回 end()
+// 节点可能来自哈希函数状态不同的容器，因此重新计算哈希值
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, BucketPolicy>::iterator
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
+insert_multi(node_handle_type&& nh)
+{
+  if (nh.empty())
+    return end();
+  nh.node_->set_hash(hash_(value_traits::get_key(nh.node_->value)));
+  rehash_if_need(1);
+  return insert_node_multi(nh.release());
+}
+
+// 插入句柄持有的节点，键值不允许重复，键值已存在时节点留在返回值的 node 中
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, BucketPolicy>::insert_return_type
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
+insert_unique(node_handle_type&& nh)
+{
+  if (nh.empty())
+    return insert_return_type{ end(), false, node_handle_type() };
+  const auto& key = value_traits::get_key(nh.node_->value);
+  const auto code = hash_(key);
+  const auto cur = M_find(key, code);
+  if (cur)
+    return insert_return_type{ iterator(cur, this), false, mystl::move(nh) };
+  rehash_if_need(1);
+  auto np = nh.release();
+  np->set_hash(code);
+  link_node(np, code);
+  ++size_;
+  return insert_return_type{ iterator(np, this), true, node_handle_type() };
+}
+
+// 把 other 的所有节点移到本容器中，键值允许重复
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, BucketPolicy>::
+merge_multi(hashtable& other)
+{
+  if (this == &other || other.size_ == 0)
+    return;
+  rehash_if_need(other.size_);
+  while (other.before_begin_)
+  {
+    auto np = other.before_begin_;
+    other.unlink_node(&other.before_begin_, np);
+    --other.size_;
+    np->set_hash(hash_(value_traits::get_key(np->value)));
+    insert_node_multi(np);
+  }
+}
+
+// 把 other 中键值在本容器中不存在的节点移到本容器中，其余节点留在 other 中
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, BucketPolicy>::
+merge_unique(hashtable& other)
+{
+  if (this == &other)
+    return;
+  auto prev = &other.before_begin_;
+  while (*prev)
+  {
+    auto np = *prev;
+    const auto& key = value_traits::get_key(np->value);
+    const auto code = hash_(key);
+    if (M_find(key, code))
+    { // 键值已存在，节点留在 other 中
+      prev = &np->next;
+      continue;
+    }
+    rehash_if_need(1);
+    other.unlink_node(prev, np);  // 摘下后 *prev 指向下一个节点
+    --other.size_;
+    np->set_hash(code);
+    link_node(np, code);
+    ++size_;
+  }
+}
+
 // 清空 hashtable
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, BucketPolicy>::
 clear()
 {
-  if (size_ != 0)
+  // 只沿全局链表经过存在的节点，顺便把节点所在的 bucket 置空
+  for (node_ptr cur = before_begin_; cur != nullptr; )
   {
-    for (size_type i = 0; i < bucket_size_; ++i)
-    {
-      node_ptr cur = buckets_[i];
-      while (cur != nullptr)
-      {
-        node_ptr next = cur->next;
-        destroy_node(cur);
-        cur = next;
-      }
-      buckets_[i] = nullptr;
-    }
-    size_ = 0;
+    node_ptr next = cur->next;
+    bucket_prev(node_hash(cur)) = nullptr;
+    destroy_node(cur);
+    cur = next;
   }
+  before_begin_ = nullptr;
+  size_ = 0;
+  bucket_type().swap(old_buckets_);
+  migrate_ = 0;
 }
 
 // 在某个 bucket 节点的个数
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::size_type
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, BucketPolicy>::size_type
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
 bucket_size(size_type n) const noexcept
 {
   size_type result = 0;
-  for (auto cur = buckets_[n]; cur; cur = cur->next)
+  const auto last = bucket_last(n);
+  for (auto cur = bucket_first(n); cur != last; cur = cur->next)
   {
     ++result;
   }
   return result;
 }
 
+// 统计 bucket 的占用情况，同一个 bucket 的节点在全局链表中相邻，遍历一遍链表即可
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+ht_stats hashtable<T, Hash, KeyEqual, BucketPolicy>::
+stats() const
+{
+  ht_stats s;
+  s.size = size_;
+  s.bucket_count = bucket_size_ + (rehashing() ? old_buckets_.size() - migrate_ : 0);
+  s.max_chain = 0;
+  for (size_t i = 0; i < ht_stats_bins; ++i)
+    s.chain_hist[i] = 0;
+  size_type used = 0;
+  for (node_ptr cur = before_begin_; cur;)
+  { // 每次数出一个 bucket 的节点个数
+    const auto slot = bucket_addr(node_hash(cur));
+    size_type len = 0;
+    for (; cur && bucket_addr(node_hash(cur)) == slot; cur = cur->next)
+      ++len;
+    ++used;
+    s.max_chain = mystl::max(s.max_chain, len);
+    ++s.chain_hist[mystl::min(len, ht_stats_bins - 1)];
+  }
+  s.empty_buckets = s.bucket_count - used;
+  s.chain_hist[0] = s.empty_buckets;
+  s.mean_chain = used != 0 ? static_cast<double>(size_) / used : 0.0;
+  s.bucket_bytes = (buckets_.capacity() + old_buckets_.capacity()) * sizeof(node_ptr*);
+  s.node_bytes = size_ * sizeof(node_type);
+  s.rehash_count = rehash_count_;
+  probe_.get(s);
+  return s;
+}
+
 // 重新对元素进行一遍哈希，插入到新的位置
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, BucketPolicy>::
 rehash(size_type count)
 {
-  auto n = ht_next_prime(count);
+  auto n = next_size(count);
   if (n > bucket_size_)
   {
     replace_bucket(n);
@@ -1103,161 +1574,100 @@ rehash(size_type count)
   }
 }
 
-// 查找键值为 key 的节点，返回其迭代器
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::iterator
-hashtable<T, Hash, KeyEqual>::
-find(const key_type& key)
-{
-  const auto n = hash(key);
-  node_ptr first = buckets_[n];
-  for (; first && !is_equal(value_traits::get_key(first->value), key); first = first->next) {}
-  return iterator(first, this);
-}
-
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::const_iterator
-hashtable<T, Hash, KeyEqual>::
-find(const key_type& key) const
+// 批量查找 [first, last) 中的每个键值，把迭代器依次写到 result
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+template <class ForwardIter, class OutputIter>
+OutputIter hashtable<T, Hash, KeyEqual, BucketPolicy>::
+find_batch(ForwardIter first, ForwardIter last, OutputIter result)
 {
-  const auto n = hash(key);
-  node_ptr first = buckets_[n];
-  for (; first && !is_equal(value_traits::get_key(first->value), key); first = first->next) {}
-  return M_cit(first);
+  M_batch(first, last,
+          [this](ForwardIter it) { return hash_(*it); },
+          [this, &result](ForwardIter it, size_t code)
+          {
+            *result = iterator(M_find(*it, code), this);
+            ++result;
+          });
+  return result;
 }
 
-// 查找键值为 key 出现的次数
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::size_type
-hashtable<T, Hash, KeyEqual>::
-count(const key_type& key) const
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+template <class ForwardIter, class OutputIter>
+OutputIter hashtable<T, Hash, KeyEqual, BucketPolicy>::
+find_batch(ForwardIter first, ForwardIter last, OutputIter result) const
 {
-  const auto n = hash(key);
-  size_type result = 0;
-  for (node_ptr cur = buckets_[n]; cur; cur = cur->next)
-  {
-    if (is_equal(value_traits::get_key(cur->value), key))
-      ++result;
-  }
+  M_batch(first, last,
+          [this](ForwardIter it) { return hash_(*it); },
+          [this, &result](ForwardIter it, size_t code)
+          {
+            *result = M_cit(M_find(*it, code));
+            ++result;
+          });
   return result;
 }
 
-// 查找与键值 key 相等的区间，返回一个 pair，指向相等区间的首尾
-template <class T, class Hash, class KeyEqual>
-pair<typename hashtable<T, Hash, KeyEqual>::iterator,
-  typename hashtable<T, Hash, KeyEqual>::iterator>
-hashtable<T, Hash, KeyEqual>::
-equal_range_multi(const key_type& key)
-{
-  const auto n = hash(key);
-  for (node_ptr first = buckets_[n]; first; first = first->next)
-  {
-    if (is_equal(value_traits::get_key(first->value), key))
-    { // 如果出现相等的键值
-      for (node_ptr second = first->next; second; second = second->next)
-      {
-        if (!is_equal(value_traits::get_key(second->value), key))
-          return mystl::make_pair(iterator(first, this), iterator(second, this));
-      }
-      for (auto m = n + 1; m < bucket_size_; ++m)
-      { // 整个链表都相等，查找下一个链表出现的位置
-        if (buckets_[m])
-          return mystl::make_pair(iterator(first, this), iterator(buckets_[m], this));
-      }
-      return mystl::make_pair(iterator(first, this), end());
-    }
-  }
-  return mystl::make_pair(end(), end());
-}
-
-template <class T, class Hash, class KeyEqual>
-pair<typename hashtable<T, Hash, KeyEqual>::const_iterator,
-  typename hashtable<T, Hash, KeyEqual>::const_iterator>
-hashtable<T, Hash, KeyEqual>::
-equal_range_multi(const key_type& key) const
+// 批量统计 [first, last) 中每个键值出现的次数，依次写到 result
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+template <class ForwardIter, class OutputIter>
+OutputIter hashtable<T, Hash, KeyEqual, BucketPolicy>::
+count_batch(ForwardIter first, ForwardIter last, OutputIter result) const
 {
-  const auto n = hash(key);
-  for (node_ptr first = buckets_[n]; first; first = first->next)
-  {
-    if (is_equal(value_traits::get_key(first->value), key))
-    {
-      for (node_ptr second = first->next; second; second = second->next)
-      {
-        if (!is_equal(value_traits::get_key(second->value), key))
-          return mystl::make_pair(M_cit(first), M_cit(second));
-      }
-      for (auto m = n + 1; m < bucket_size_; ++m)
-      { // 整个链表都相等，查找下一个链表出现的位置
-        if (buckets_[m])
-          return mystl::make_pair(M_cit(first), M_cit(buckets_[m]));
-      }
-      return mystl::make_pair(M_cit(first), cend());
-    }
-  }
-  return mystl::make_pair(cend(), cend());
+  M_batch(first, last,
+          [this](ForwardIter it) { return hash_(*it); },
+          [this, &result](ForwardIter it, size_t code)
+          {
+            *result = M_count(*it, code);
+            ++result;
+          });
+  return result;
 }
 
-template <class T, class Hash, class KeyEqual>
-pair<typename hashtable<T, Hash, KeyEqual>::iterator,
-  typename hashtable<T, Hash, KeyEqual>::iterator>
-hashtable<T, Hash, KeyEqual>::
-equal_range_unique(const key_type& key)
+// 批量插入 [first, last) 中的元素，键值允许重复
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+template <class ForwardIter>
+void hashtable<T, Hash, KeyEqual, BucketPolicy>::
+insert_multi_batch(ForwardIter first, ForwardIter last)
 {
-  const auto n = hash(key);
-  for (node_ptr first = buckets_[n]; first; first = first->next)
-  {
-    if (is_equal(value_traits::get_key(first->value), key))
-    {
-      if (first->next)
-        return mystl::make_pair(iterator(first, this), iterator(first->next, this));
-      for (auto m = n + 1; m < bucket_size_; ++m)
-      { // 整个链表都相等，查找下一个链表出现的位置
-        if (buckets_[m])
-          return mystl::make_pair(iterator(first, this), iterator(buckets_[m], this));
-      }
-      return mystl::make_pair(iterator(first, this), end());
-    }
-  }
-  return mystl::make_pair(end(), end());
+  rehash_if_need(mystl::distance(first, last));
+  M_batch(first, last,
+          [this](ForwardIter it) { return hash_(value_traits::get_key(*it)); },
+          [this](ForwardIter it, size_t code) { insert_multi_noresize(*it, code); });
 }
 
-template <class T, class Hash, class KeyEqual>
-pair<typename hashtable<T, Hash, KeyEqual>::const_iterator,
-  typename hashtable<T, Hash, KeyEqual>::const_iterator>
-hashtable<T, Hash, KeyEqual>::
-equal_range_unique(const key_type& key) const
+// 批量插入 [first, last) 中的元素，键值不允许重复
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+template <class ForwardIter>
+void hashtable<T, Hash, KeyEqual, BucketPolicy>::
+insert_unique_batch(ForwardIter first, ForwardIter last)
 {
-  const auto n = hash(key);
-  for (node_ptr first = buckets_[n]; first; first = first->next)
-  {
-    if (is_equal(value_traits::get_key(first->value), key))
-    {
-      if (first->next)
-        return mystl::make_pair(M_cit(first), M_cit(first->next));
-      for (auto m = n + 1; m < bucket_size_; ++m)
-      { // 整个链表都相等，查找下一个链表出现的位置
-        if (buckets_[m])
-          return mystl::make_pair(M_cit(first), M_cit(buckets_[m]));
-      }
-      return mystl::make_pair(M_cit(first), cend());
-    }
-  }
-  return mystl::make_pair(cend(), cend());
+  rehash_if_need(mystl::distance(first, last));
+  M_batch(first, last,
+          [this](ForwardIter it) { return hash_(value_traits::get_key(*it)); },
+          [this](ForwardIter it, size_t code) { insert_unique_noresize(*it, code); });
 }
 
 // 交换 hashtable
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, BucketPolicy>::
 swap(hashtable& rhs) noexcept
 {
   if (this != &rhs)
   {
+    mystl::swap(before_begin_, rhs.before_begin_);
     buckets_.swap(rhs.buckets_);
     mystl::swap(bucket_size_, rhs.bucket_size_);
     mystl::swap(size_, rhs.size_);
     mystl::swap(mlf_, rhs.mlf_);
     mystl::swap(hash_, rhs.hash_);
     mystl::swap(equal_, rhs.equal_);
+    mystl::swap(policy_, rhs.policy_);
+    old_buckets_.swap(rhs.old_buckets_);
+    mystl::swap(old_policy_, rhs.old_policy_);
+    mystl::swap(migrate_, rhs.migrate_);
+    mystl::swap(incremental_, rhs.incremental_);
+    mystl::swap(rehash_count_, rhs.rehash_count_);
+    mystl::swap(probe_, rhs.probe_);
+    fix_before_begin();
+    rhs.fix_before_begin();
   }
 }
 
@@ -1265,8 +1675,8 @@ swap(hashtable& rhs) noexcept
 // helper function
 
 // init 函数
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, BucketPolicy>::
 init(size_type n)
 {
   const auto bucket_nums = next_size(n);
@@ -1282,36 +1692,28 @@ init(size_type n)
     throw;
   }
   bucket_size_ = buckets_.size();
+  policy_.reset(bucket_size_);
 }
 
 // copy_init 函数
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, BucketPolicy>::
 copy_init(const hashtable& ht)
 {
   bucket_size_ = 0;
+  migrate_ = ht.migrate_;
+  incremental_ = ht.incremental_;
   buckets_.reserve(ht.bucket_size_);
   buckets_.assign(ht.bucket_size_, nullptr);
   try
   {
-    for (size_type i = 0; i < ht.bucket_size_; ++i)
-    {
-      node_ptr cur = ht.buckets_[i];
-      if (cur)
-      { // 如果某 bucket 存在链表
-        auto copy = create_node(cur->value);
-        buckets_[i] = copy;
-        for (auto next = cur->next; next; cur = next, next = cur->next)
-        {  //复制链表
-          copy->next = create_node(next->value);
-          copy = copy->next;
-        }
-        copy->next = nullptr;
-      }
-    }
+    // 正在搬运时按原样保留旧的 bucket 数组，节点在两个数组中的分布与 ht 相同
+    old_buckets_.assign(ht.old_buckets_.size(), nullptr);
+    old_policy_ = ht.old_policy_;
     bucket_size_ = ht.bucket_size_;
+    policy_ = ht.policy_;
     mlf_ = ht.mlf_;
-    size_ = ht.size_;
+    copy_list(ht);
   }
   catch (...)
   {
@@ -1320,10 +1722,10 @@ copy_init(const hashtable& ht)
 }
 
 // create_node 函数
-template <class T, class Hash, class KeyEqual>
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
 template <class ...Args>
-typename hashtable<T, Hash, KeyEqual>::node_ptr
-hashtable<T, Hash, KeyEqual>::
+typename hashtable<T, Hash, KeyEqual, BucketPolicy>::node_ptr
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
 create_node(Args&& ...args)
 {
   node_ptr tmp = node_allocator::allocate(1);
@@ -1341,8 +1743,8 @@ create_node(Args&& ...args)
 }
 
 // destroy_node 函数
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, BucketPolicy>::
 destroy_node(node_ptr node)
 {
   data_allocator::destroy(mystl::address_of(node->value));
@@ -1351,53 +1753,315 @@ destroy_node(node_ptr node)
 }
 
 // next_size 函数
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::size_type
-hashtable<T, Hash, KeyEqual>::next_size(size_type n) const
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, BucketPolicy>::size_type
+hashtable<T, Hash, KeyEqual, BucketPolicy>::next_size(size_type n) const
 {
-  return ht_next_prime(n);
+  return bucket_policy::next_size(n);
 }
 
-// hash 函数
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::size_type
-hashtable<T, Hash, KeyEqual>::
-hash(const key_type& key, size_type n) const
+// 查找键值与 key 相等的第一个节点，返回指向它的那个指针（前驱的 next）的地址，没有时返回 nullptr
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+template <class K>
+typename hashtable<T, Hash, KeyEqual, BucketPolicy>::node_ptr*
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
+M_find_prev(const K& key, size_t code) const
+{
+  // 被移动过的表格没有 bucket，不能计算 bucket 的位置
+  if (bucket_size_ == 0)
+    return nullptr;
+  probe_.lookup();
+  const auto slot = bucket_addr(code);
+  auto prev = *slot;
+  if (prev == nullptr)
+    return nullptr;
+  for (auto cur = *prev; ; prev = &cur->next, cur = cur->next)
+  {
+    probe_.probe();
+    if (node_equal(cur, code, key))
+      return prev;
+    // 到达链表末尾或者下一个节点属于其它 bucket
+    if (cur->next == nullptr || !in_bucket(cur->next, slot))
+      return nullptr;
+  }
+}
+
+// 查找键值为 key 出现的次数，键值相同的节点是相邻的
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+template <class K>
+typename hashtable<T, Hash, KeyEqual, BucketPolicy>::size_type
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
+M_count(const K& key, size_t code) const
+{
+  size_type result = 0;
+  for (node_ptr cur = M_find(key, code); cur && node_equal(cur, code, key); cur = cur->next)
+    ++result;
+  return result;
+}
+
+// 查找与键值 key 相等的区间，返回一个 pair，指向相等区间的首尾
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+template <class K>
+pair<typename hashtable<T, Hash, KeyEqual, BucketPolicy>::node_ptr,
+  typename hashtable<T, Hash, KeyEqual, BucketPolicy>::node_ptr>
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
+M_equal_range_multi(const K& key) const
+{
+  const auto code = hash_(key);
+  const node_ptr first = M_find(key, code);
+  if (first == nullptr)
+    return mystl::make_pair(first, first);
+  // 键值相同的节点是相邻的，区间的尾端是第一个不相等的节点
+  node_ptr second = first->next;
+  for (; second && node_equal(second, code, key); second = second->next) {}
+  return mystl::make_pair(first, second);
+}
+
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+template <class K>
+pair<typename hashtable<T, Hash, KeyEqual, BucketPolicy>::node_ptr,
+  typename hashtable<T, Hash, KeyEqual, BucketPolicy>::node_ptr>
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
+M_equal_range_unique(const K& key) const
 {
-  return hash_(key) % n;
+  const node_ptr first = M_find(key);
+  if (first == nullptr)
+    return mystl::make_pair(first, first);
+  // 键值唯一，区间的尾端是下一个节点
+  return mystl::make_pair(first, first->next);
 }
 
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::size_type
-hashtable<T, Hash, KeyEqual>::
+// hash 函数
+
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, BucketPolicy>::size_type
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
 hash(const key_type& key) const
 {
-  return hash_(key) % bucket_size_;
+  return policy_.index(hash_(key));
+}
+
+// bucket_count_for 函数
+// 按装载因子换算出容纳 n 个元素需要的 bucket 个数，换算结果超出 bucket 个数的上限时取上限，
+// 避免把过大的浮点数转换成 size_type
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, BucketPolicy>::size_type
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
+bucket_count_for(size_type n) const
+{
+  MYSTL_DEBUG(mlf_ > 0.0f);
+  const float count = (float)n / mlf_ + 0.5f;
+  if (!(count < (float)max_bucket_count()))
+    return max_bucket_count();
+  return static_cast<size_type>(count);
 }
 
 // rehash_if_need 函数
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, BucketPolicy>::
 rehash_if_need(size_type n)
 {
+  if (rehashing())
+    rehash_step(ht_rehash_step);
   if (static_cast<float>(size_ + n) > (float)bucket_size_ * max_load_factor())
-    rehash(size_ + n);
+  { // 按装载因子换算成 bucket 个数，一次插入多个元素时直接完成 rehash，之后不会再触发 rehash
+    const auto count = bucket_count_for(size_ + n);
+    if (incremental_ && n == 1)
+      start_rehash(count);
+    else
+      rehash(count);
+  }
+}
+
+// node_hash 函数
+// 取得节点中键值的哈希值，缓存了就直接读取，否则重新计算
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+size_t hashtable<T, Hash, KeyEqual, BucketPolicy>::
+node_hash(const hashtable_node<T>* np) const
+{
+  return node_hash(np, cache_hash_type());
+}
+
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+size_t hashtable<T, Hash, KeyEqual, BucketPolicy>::
+node_hash(const hashtable_node<T>* np, m_true_type) const
+{
+  return np->hash_code;
+}
+
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+size_t hashtable<T, Hash, KeyEqual, BucketPolicy>::
+node_hash(const hashtable_node<T>* np, m_false_type) const
+{
+  return hash_(value_traits::get_key(np->value));
+}
+
+// bucket_prev 函数
+// 哈希值为 code 的节点所在 bucket 保存的前驱指针：旧数组中对应的 bucket 还没有搬运时在旧数组中，否则在新数组中
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, BucketPolicy>::node_ptr*&
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
+bucket_prev(size_t code)
+{
+  if (rehashing())
+  {
+    const auto i = old_policy_.index(code);
+    if (i >= migrate_)
+      return old_buckets_[i];
+  }
+  return buckets_[policy_.index(code)];
+}
+
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, BucketPolicy>::node_ptr*
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
+bucket_prev(size_t code) const
+{
+  return *bucket_addr(code);
+}
+
+// bucket_addr 函数
+// bucket 在数组中的位置，用于预取，也用来判断两个节点是否属于同一个 bucket
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, BucketPolicy>::node_ptr* const*
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
+bucket_addr(size_t code) const
+{
+  if (rehashing())
+  {
+    const auto i = old_policy_.index(code);
+    if (i >= migrate_)
+      return &old_buckets_[i];
+  }
+  return &buckets_[policy_.index(code)];
+}
+
+// M_batch 函数
+// 流水线处理 [first, last)：第 i 个键值算出哈希值并预取 bucket，每隔 ht_prefetch_distance 步
+// 依次读出前驱指针并预取它、读出链表的首节点并预取它、调用 fn(it, code)，同一时刻有三组键值的预取在途
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+template <class ForwardIter, class HashOf, class Fn>
+void hashtable<T, Hash, KeyEqual, BucketPolicy>::
+M_batch(ForwardIter first, ForwardIter last, HashOf hash_of, Fn fn) const
+{
+  static constexpr size_type ring = ht_prefetch_distance * 4;
+  size_t            codes[ring];
+  node_ptr* const*  slots[ring];
+  if (bucket_size_ == 0)
+  { // 没有 bucket 可以预取，逐个处理
+    for (; first != last; ++first)
+      fn(first, hash_of(first));
+    return;
+  }
+  ForwardIter back = first;         // 下一个调用 fn 的位置
+  size_type hashed = 0, loaded = 0, headed = 0, done = 0;
+  while (done != hashed || first != last)
+  {
+    if (first != last)
+    { // 第一步：计算哈希值，预取 bucket
+      const auto i = hashed++ % ring;
+      codes[i] = hash_of(first);
+      slots[i] = bucket_addr(codes[i]);
+      MYSTL_PREFETCH(slots[i]);
+      ++first;
+    }
+    if (loaded < hashed && (hashed - loaded > ht_prefetch_distance || first == last))
+    { // 第二步：bucket 应该已经到达，预取前驱指针所在的节点
+      const auto prev = *slots[loaded++ % ring];
+      if (prev)
+        MYSTL_PREFETCH(prev);
+    }
+    if (headed < loaded && (loaded - headed > ht_prefetch_distance || first == last))
+    { // 第三步：预取链表的首节点
+      const auto prev = *slots[headed++ % ring];
+      if (prev && *prev)
+        MYSTL_PREFETCH(*prev);
+    }
+    if (done < headed && (headed - done > ht_prefetch_distance || first == last))
+    { // 第四步：处理键值
+      fn(back, codes[done++ % ring]);
+      ++back;
+    }
+  }
+}
+
+// start_rehash 函数
+// 分配 count 个 bucket 的新数组，原来的数组成为旧数组，之后逐步搬运
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, BucketPolicy>::
+start_rehash(size_type count)
+{
+  const auto n = next_size(count);
+  if (n <= bucket_size_)
+    return;
+  finish_rehash();
+  bucket_type bucket(n, nullptr);
+  old_buckets_.swap(buckets_);
+  buckets_.swap(bucket);
+  old_policy_ = policy_;
+  policy_.reset(n);
+  bucket_size_ = n;
+  migrate_ = 0;
+  ++rehash_count_;
+  rehash_step(ht_rehash_step);
+}
+
+// rehash_step 函数
+// 从旧数组中搬运至多 count 个 bucket 到新数组，搬运完毕后释放旧数组
+// 搬运一个 bucket 时先把它的节点整段从全局链表中摘下，再逐个链接到新数组的 bucket 中
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, BucketPolicy>::
+rehash_step(size_type count)
+{
+  const auto old_size = old_buckets_.size();
+  for (; count > 0 && migrate_ < old_size; --count)
+  {
+    const auto prev = old_buckets_[migrate_];
+    if (prev == nullptr)
+    {
+      ++migrate_;
+      continue;
+    }
+    const auto slot = &old_buckets_[migrate_];
+    auto first = *prev;
+    auto last = first;
+    while (last->next && in_bucket(last->next, slot))
+      last = last->next;
+    if (last->next)
+    { // 下一个 bucket 的前驱变为 prev
+      bucket_prev(node_hash(last->next)) = prev;
+    }
+    *prev = last->next;
+    last->next = nullptr;
+    old_buckets_[migrate_++] = nullptr;
+    while (first)
+    {
+      auto tmp = first;
+      first = first->next;
+      link_node(tmp, node_hash(tmp));
+    }
+  }
+  if (migrate_ == old_size)
+  {
+    bucket_type().swap(old_buckets_);
+    migrate_ = 0;
+  }
 }
 
 // copy_insert
-template <class T, class Hash, class KeyEqual>
+// 前向迭代器先求出区间长度，只 rehash 一次，之后的插入不再检查装载因子
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
 template <class InputIter>
-void hashtable<T, Hash, KeyEqual>::
+void hashtable<T, Hash, KeyEqual, BucketPolicy>::
 copy_insert_multi(InputIter first, InputIter last, mystl::input_iterator_tag)
-{
-  rehash_if_need(mystl::distance(first, last));
+{ // 单趟迭代器不能预先求出长度，逐个插入
   for (; first != last; ++first)
-    insert_multi_noresize(*first);
+    insert_multi(*first);
 }
 
-template <class T, class Hash, class KeyEqual>
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
 template <class ForwardIter>
-void hashtable<T, Hash, KeyEqual>::
+void hashtable<T, Hash, KeyEqual, BucketPolicy>::
 copy_insert_multi(ForwardIter first, ForwardIter last, mystl::forward_iterator_tag)
 {
   size_type n = mystl::distance(first, last);
@@ -1406,19 +2070,18 @@ copy_insert_multi(ForwardIter first, ForwardIter last, mystl::forward_iterator_t
     insert_multi_noresize(*first);
 }
 
-template <class T, class Hash, class KeyEqual>
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
 template <class InputIter>
-void hashtable<T, Hash, KeyEqual>::
+void hashtable<T, Hash, KeyEqual, BucketPolicy>::
 copy_insert_unique(InputIter first, InputIter last, mystl::input_iterator_tag)
-{
-  rehash_if_need(mystl::distance(first, last));
+{ // 单趟迭代器不能预先求出长度，逐个插入
   for (; first != last; ++first)
-    insert_unique_noresize(*first);
+    insert_unique(*first);
 }
 
-template <class T, class Hash, class KeyEqual>
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
 template <class ForwardIter>
-void hashtable<T, Hash, KeyEqual>::
+void hashtable<T, Hash, KeyEqual, BucketPolicy>::
 copy_insert_unique(ForwardIter first, ForwardIter last, mystl::forward_iterator_tag)
 {
   size_type n = mystl::distance(first, last);
@@ -1428,145 +2091,205 @@ copy_insert_unique(ForwardIter first, ForwardIter last, mystl::forward_iterator_
 }
 
 // insert_node 函数
-template <class T, class Hash, class KeyEqual>
-typename hashtable<T, Hash, KeyEqual>::iterator
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, BucketPolicy>::iterator
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
 insert_node_multi(node_ptr np)
 {
-  const auto n = hash(value_traits::get_key(np->value));
-  auto cur = buckets_[n];
-  if (cur == nullptr)
-  {
-    buckets_[n] = np;
-    ++size_;
-    return iterator(np, this);
-  }
-  for (; cur; cur = cur->next)
-  {
-    if (is_equal(value_traits::get_key(cur->value), value_traits::get_key(np->value)))
-    {
-      np->next = cur->next;
-      cur->next = np;
-      ++size_;
-      return iterator(np, this);
-    }
-  }
-  np->next = buckets_[n];
-  buckets_[n] = np;
+  const auto code = node_hash(np);
+  const auto cur = M_find(value_traits::get_key(np->value), code);
+  if (cur)
+    link_after(cur, np);
+  else
+    link_node(np, code);
   ++size_;
   return iterator(np, this);
 }
 
 // insert_node_unique 函数
-template <class T, class Hash, class KeyEqual>
-pair<typename hashtable<T, Hash, KeyEqual>::iterator, bool>
-hashtable<T, Hash, KeyEqual>::
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+pair<typename hashtable<T, Hash, KeyEqual, BucketPolicy>::iterator, bool>
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
 insert_node_unique(node_ptr np)
 {
-  const auto n = hash(value_traits::get_key(np->value));
-  auto cur = buckets_[n];
-  if (cur == nullptr)
-  {
-    buckets_[n] = np;
-    ++size_;
-    return mystl::make_pair(iterator(np, this), true);
-  }
-  for (; cur; cur = cur->next)
-  {
-    if (is_equal(value_traits::get_key(cur->value), value_traits::get_key(np->value)))
-    {
-      return mystl::make_pair(iterator(cur, this), false);
-    }
+  const auto code = node_hash(np);
+  const auto cur = M_find(value_traits::get_key(np->value), code);
+  if (cur)
+  { // 键值已存在，释放新节点
+    destroy_node(np);
+    return mystl::make_pair(iterator(cur, this), false);
   }
-  np->next = buckets_[n];
-  buckets_[n] = np;
+  link_node(np, code);
   ++size_;
   return mystl::make_pair(iterator(np, this), true);
 }
 
-// replace_bucket 函数
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
-replace_bucket(size_type bucket_count)
+// link_node 函数
+// 把节点 np 链接为哈希值 code 所在 bucket 的首节点，bucket 为空时放到全局链表的头部
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, BucketPolicy>::
+link_node(node_ptr np, size_t code)
 {
-  bucket_type bucket(bucket_count);
-  if (size_ != 0)
+  auto& prev = bucket_prev(code);
+  if (prev)
   {
-    for (size_type i = 0; i < bucket_size_; ++i)
-    {
-      for (auto first = buckets_[i]; first; first = first->next)
-      {
-        auto tmp = create_node(first->value);
-        const auto n = hash(value_traits::get_key(first->value), bucket_count);
-        auto f = bucket[n];
-        bool is_inserted = false;
-        for (auto cur = f; cur; cur = cur->next)
-        {
-          if (is_equal(value_traits::get_key(cur->value), value_traits::get_key(first->value)))
-          {
-            tmp->next = cur->next;
-            cur->next = tmp;
-            is_inserted = true;
-            break;
-          }
-        }
-        if (!is_inserted)
-        {
-          tmp->next = f;
-          bucket[n] = tmp;
-        }
-      }
+    np->next = *prev;
+    *prev = np;
+  }
+  else
+  {
+    np->next = before_begin_;
+    if (before_begin_)
+    { // 原来的首节点所在 bucket 的前驱变为 np
+      bucket_prev(node_hash(before_begin_)) = &np->next;
     }
+    before_begin_ = np;
+    prev = &before_begin_;
   }
-  buckets_.swap(bucket);
-  bucket_size_ = buckets_.size();
 }
 
-// erase_bucket 函数
-// 在第 n 个 bucket 内，删除 [first, last) 的节点
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
-erase_bucket(size_type n, node_ptr first, node_ptr last)
+// link_after 函数
+// 把节点 np 链接到同一个 bucket 的节点 pos 之后
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, BucketPolicy>::
+link_after(node_ptr pos, node_ptr np)
 {
-  auto cur = buckets_[n];
-  if (cur == first)
-  {
-    erase_bucket(n, last);
+  np->next = pos->next;
+  pos->next = np;
+  if (np->next)
+  { // pos 原来是 bucket 的最后一个节点时，下一个 bucket 的前驱变为 np
+    auto& next_prev = bucket_prev(node_hash(np->next));
+    if (next_prev == &pos->next)
+      next_prev = &np->next;
   }
-  else
-  {
-    node_ptr next = cur->next;
-    for (; next != first; cur = next, next = cur->next) {}
-    while (next != last)
-    {
-      cur->next = next->next;
-      destroy_node(next);
-      next = cur->next;
-      --size_;
-    }
+}
+
+// unlink_node 函数
+// 把节点 np 从全局链表中摘下，prev 指向 np，并维护相关 bucket 的前驱指针
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, BucketPolicy>::
+unlink_node(node_ptr* prev, node_ptr np)
+{
+  auto& slot = bucket_prev(node_hash(np));
+  const auto next = np->next;
+  bool last = true;  // np 是否为所在 bucket 的最后一个节点
+  if (next)
+  {
+    auto& next_slot = bucket_prev(node_hash(next));
+    if (&next_slot != &slot)
+      next_slot = prev;
+    else
+      last = false;
   }
+  if (last && slot == prev)
+  { // np 是 bucket 中唯一的节点
+    slot = nullptr;
+  }
+  *prev = next;
 }
 
-// erase_bucket 函数
-// 在第 n 个 bucket 内，删除 [buckets_[n], last) 的节点
-template <class T, class Hash, class KeyEqual>
-void hashtable<T, Hash, KeyEqual>::
-erase_bucket(size_type n, node_ptr last)
+// find_prev 函数
+// 返回指向 np 的那个指针的地址，从 np 所在 bucket 的前驱开始找
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, BucketPolicy>::node_ptr*
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
+find_prev(node_ptr np)
 {
-  auto cur = buckets_[n];
-  while (cur != last)
+  auto prev = bucket_prev(node_hash(np));
+  MYSTL_DEBUG(prev != nullptr);
+  while (*prev != np)
+    prev = &(*prev)->next;
+  return prev;
+}
+
+// fix_before_begin 函数
+// before_begin_ 的地址随 hashtable 对象改变，移动或交换后修正首节点所在 bucket 的前驱
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, BucketPolicy>::
+fix_before_begin() noexcept
+{
+  if (before_begin_)
+    bucket_prev(node_hash(before_begin_)) = &before_begin_;
+}
+
+// bucket_last 函数
+// 第 n 个 bucket 之后的第一个节点，即 end(n)
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+typename hashtable<T, Hash, KeyEqual, BucketPolicy>::node_ptr
+hashtable<T, Hash, KeyEqual, BucketPolicy>::
+bucket_last(size_type n) const
+{
+  auto cur = bucket_first(n);
+  const auto slot = &buckets_[n];
+  while (cur && in_bucket(cur, slot))
+    cur = cur->next;
+  return cur;
+}
+
+// copy_list 函数
+// 按 ht 的全局链表顺序复制节点，bucket 数组的大小与策略已经与 ht 相同且全部为空
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, BucketPolicy>::
+copy_list(const hashtable& ht)
+{
+  size_ = 0;
+  node_ptr* tail = &before_begin_;
+  for (auto cur = ht.before_begin_; cur; cur = cur->next)
+  {
+    auto copy = create_node(cur->value);
+    copy->copy_hash(*cur);
+    *tail = copy;
+    auto& prev = bucket_prev(node_hash(copy));
+    if (prev == nullptr)  // 这是所在 bucket 的第一个节点
+      prev = tail;
+    tail = &copy->next;
+    ++size_;
+  }
+}
+
+// replace_bucket 函数
+// 沿全局链表把原有的节点重新链接到新的 bucket 中，不复制节点，缓存了哈希值时也不重新计算
+// 键值相同的节点在链表中相邻，依次插入到同一个 bucket 的头部后仍然相邻
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+void hashtable<T, Hash, KeyEqual, BucketPolicy>::
+replace_bucket(size_type bucket_count)
+{
+  finish_rehash();
+  bucket_type bucket(bucket_count, nullptr);
+  bucket_policy policy;
+  policy.reset(bucket_count);
+  ++rehash_count_;
+  auto cur = before_begin_;
+  before_begin_ = nullptr;
+  size_type begin_bucket = 0;  // 当前链表首节点所在的 bucket
+  while (cur)
   {
     auto next = cur->next;
-    destroy_node(cur);
+    const auto n = policy.index(node_hash(cur));
+    if (bucket[n])
+    {
+      cur->next = *bucket[n];
+      *bucket[n] = cur;
+    }
+    else
+    {
+      cur->next = before_begin_;
+      if (before_begin_)
+        bucket[begin_bucket] = &cur->next;
+      before_begin_ = cur;
+      bucket[n] = &before_begin_;
+      begin_bucket = n;
+    }
     cur = next;
-    --size_;
   }
-  buckets_[n] = last;
+  buckets_.swap(bucket);
+  bucket_size_ = buckets_.size();
+  policy_ = policy;
 }
 
 // equal_to 函数
-template <class T, class Hash, class KeyEqual>
-bool hashtable<T, Hash, KeyEqual>::equal_to_multi(const hashtable& other)
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+bool hashtable<T, Hash, KeyEqual, BucketPolicy>::equal_to_multi(const hashtable& other)
 {
   if (size_ != other.size_)
     return false;
@@ -1582,8 +2305,8 @@ bool hashtable<T, Hash, KeyEqual>::equal_to_multi(const hashtable& other)
   return true;
 }
 
-template <class T, class Hash, class KeyEqual>
-bool hashtable<T, Hash, KeyEqual>::equal_to_unique(const hashtable& other)
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+bool hashtable<T, Hash, KeyEqual, BucketPolicy>::equal_to_unique(const hashtable& other)
 {
   if (size_ != other.size_)
     return false;
@@ -1597,9 +2320,9 @@ bool hashtable<T, Hash, KeyEqual>::equal_to_unique(const hashtable& other)
 }
 
 // 重载 mystl 的 swap
-template <class T, class Hash, class KeyEqual>
-void swap(hashtable<T, Hash, KeyEqual>& lhs,
-          hashtable<T, Hash, KeyEqual>& rhs) noexcept
+template <class T, class Hash, class KeyEqual, class BucketPolicy>
+void swap(hashtable<T, Hash, KeyEqual, BucketPolicy>& lhs,
+          hashtable<T, Hash, KeyEqual, BucketPolicy>& rhs) noexcept
 {
   lhs.swap(rhs);
 }
@@ -12,15 +12,24 @@
 //   * emplace
 //   * emplace_hint
 //   * insert
+//   * try_emplace
+//
+// try_emplace / insert_or_assign 以及第一个参数为键值的 emplace 先按键值查找，键值已存在时不分配节点
 
 #include "rb_tree.h"
 
 namespace mystl
 {
 
+// forward declaration
+
+template <class Key, class T, class Compare, bool OrderStat>
+class multimap;
+
 // 模板类 map，键值不允许重复
-// 参数一代表键值类型，参数二代表实值类型，参数三代表键值的比较方式，缺省使用 mystl::less
-template <class Key, class T, class Compare = mystl::less<Key>>
+// 参数一代表键值类型，参数二代表实值类型，参数三代表键值的比较方式，缺省使用 mystl::less，
+// 参数四表示是否维护顺序统计，为 true 时支持 find_by_order 与 order_of_key
+template <class Key, class T, class Compare = mystl::less<Key>, bool OrderStat = false>
 class map
 {
 public:
@@ -33,7 +42,7 @@ public:
   // 定义一个 functor，用来进行元素比较
   class value_compare : public binary_function <value_type, value_type, bool>
   {
-    friend class map<Key, T, Compare>;
+    friend class map<Key, T, Compare, OrderStat>;
   private:
     Compare comp;
     value_compare(Compare c) : comp(c) {}
@@ -46,12 +55,15 @@ public:
 
 private:
   // 以 mystl::rb_tree 作为底层机制
-  typedef mystl::rb_tree<value_type, key_compare>  base_type;
+  typedef mystl::rb_tree<value_type, key_compare, OrderStat> base_type;
   base_type tree_;
 
+  friend class multimap<Key, T, Compare, OrderStat>;
+
 public:
   // 使用 rb_tree 的型别
-  typedef typename base_type::node_type              node_type;
+  typedef typename base_type::node_handle_type       node_type;
+  typedef typename base_type::insert_return_type     insert_return_type;
   typedef typename base_type::pointer                pointer;
   typedef typename base_type::const_pointer          const_pointer;
   typedef typename base_type::reference              reference;
@@ -167,19 +179,11 @@ public:
 
   mapped_type& operator[](const key_type& key)
   {
-    iterator it = lower_bound(key);
-    // it->first >= key
-    if (it == end() || key_comp()(key, it->first))
-      it = emplace_hint(it, key, T{});
-    return it->second;
+    return try_emplace(key).first->second;
   }
   mapped_type& operator[](key_type&& key)
   {
-    iterator it = lower_bound(key);
-    // it->first >= key
-    if (it == end() || key_comp()(key, it->first))
-      it = emplace_hint(it, mystl::move(key), T{});
-    return it->second;
+    return try_emplace(mystl::move(key)).first->second;
   }
 
   // 插入删除相关
@@ -196,6 +200,35 @@ public:
     return tree_.emplace_unique_use_hint(hint, mystl::forward<Args>(args)...);
   }
 
+  template <class ...Args>
+  pair<iterator, bool> try_emplace(const key_type& key, Args&& ...args)
+  {
+    return tree_.try_emplace_unique(key, mystl::emplace_key, key, mystl::forward<Args>(args)...);
+  }
+  template <class ...Args>
+  pair<iterator, bool> try_emplace(key_type&& key, Args&& ...args)
+  {
+    return tree_.try_emplace_unique(key, mystl::emplace_key, mystl::move(key),
+                                    mystl::forward<Args>(args)...);
+  }
+
+  template <class M>
+  pair<iterator, bool> insert_or_assign(const key_type& key, M&& obj)
+  {
+    auto res = try_emplace(key, mystl::forward<M>(obj));
+    if (!res.second)
+      res.first->second = mystl::forward<M>(obj);
+    return res;
+  }
+  template <class M>
+  pair<iterator, bool> insert_or_assign(key_type&& key, M&& obj)
+  {
+    auto res = try_emplace(mystl::move(key), mystl::forward<M>(obj));
+    if (!res.second)
+      res.first->second = mystl::forward<M>(obj);
+    return res;
+  }
+
   pair<iterator, bool> insert(const value_type& value)
   {
     return tree_.insert_unique(value);
@@ -226,6 +259,42 @@ public:
 
   void      clear()                              { tree_.clear(); }
 
+  // 节点句柄，摘下、重新插入节点与合并容器都不分配也不释放节点
+
+  node_type          extract(iterator position)   { return tree_.extract(position); }
+  node_type          extract(const key_type& key) { return tree_.extract(key); }
+
+  insert_return_type insert(node_type&& nh)
+  {
+    return tree_.insert_unique(mystl::move(nh));
+  }
+  iterator           insert(iterator /*hint*/, node_type&& nh)
+  {
+    return tree_.insert_unique(mystl::move(nh)).position;
+  }
+
+  void merge(map& other)                                  { tree_.merge_unique(other.tree_); }
+  void merge(multimap<Key, T, Compare, OrderStat>& other) { tree_.merge_unique(other.tree_); }
+
+  // 分割与拼接，只改变 O(log n) 个节点的链接，
+  // OrderStat 为 false 时还要数一遍被分出或删除的元素
+
+  // 把键值不小于 key 的元素移出，作为一个新的 map 返回
+  map       split(const key_type& key)
+  {
+    map right;
+    tree_.split(key, right.tree_);
+    return right;
+  }
+  // 把 other 的元素全部接到末尾，other 中的键值必须都大于本 map 中的键值
+  void      append_greater(map& other)
+  {
+    MYSTL_DEBUG(empty() || other.empty() || key_comp()(rbegin()->first, other.begin()->first));
+    tree_.join(other.tree_);
+  }
+  // 删除键值小于 key 的元素，返回删除的个数
+  size_type erase_before(const key_type& key) { return tree_.erase_before(key); }
+
   // map 相关操作
 
   iterator       find(const key_type& key)              { return tree_.find(key); }
@@ -247,6 +316,45 @@ public:
     equal_range(const key_type& key) const 
   { return tree_.equal_range_unique(key); }
 
+  // 顺序统计，OrderStat 为 true 时可用，时间复杂度为 O(log n)
+
+  // 第 k 小的元素（从 0 开始），k >= size() 时返回 end()
+  iterator       find_by_order(size_type k)              { return tree_.select(k); }
+  const_iterator find_by_order(size_type k)        const { return tree_.select(k); }
+
+  // 键值小于 key 的元素个数
+  size_type      order_of_key(const key_type& key) const { return tree_.rank(key); }
+
+  // 透明查找，Compare 定义了 is_transparent 时可用
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  iterator       find(const K& key)              { return tree_.find(key); }
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  const_iterator find(const K& key)        const { return tree_.find(key); }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  size_type      count(const K& key)       const { return tree_.count_unique(key); }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  iterator       lower_bound(const K& key)       { return tree_.lower_bound(key); }
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  const_iterator lower_bound(const K& key) const { return tree_.lower_bound(key); }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  iterator       upper_bound(const K& key)       { return tree_.upper_bound(key); }
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  const_iterator upper_bound(const K& key) const { return tree_.upper_bound(key); }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  pair<iterator, iterator>
+    equal_range(const K& key)
+  { return tree_.equal_range_unique(key); }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  pair<const_iterator, const_iterator>
+    equal_range(const K& key) const
+  { return tree_.equal_range_unique(key); }
+
   void           swap(map& rhs) noexcept
   { tree_.swap(rhs.tree_); }
 
@@ -256,45 +364,45 @@ public:
 };
 
 // 重载比较操作符
-template <class Key, class T, class Compare>
-bool operator==(const map<Key, T, Compare>& lhs, const map<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, bool OrderStat>
+bool operator==(const map<Key, T, Compare, OrderStat>& lhs, const map<Key, T, Compare, OrderStat>& rhs)
 {
   return lhs == rhs;
 }
 
-template <class Key, class T, class Compare>
-bool operator<(const map<Key, T, Compare>& lhs, const map<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, bool OrderStat>
+bool operator<(const map<Key, T, Compare, OrderStat>& lhs, const map<Key, T, Compare, OrderStat>& rhs)
 {
   return lhs < rhs;
 }
 
-template <class Key, class T, class Compare>
-bool operator!=(const map<Key, T, Compare>& lhs, const map<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, bool OrderStat>
+bool operator!=(const map<Key, T, Compare, OrderStat>& lhs, const map<Key, T, Compare, OrderStat>& rhs)
 {
   return !(lhs == rhs);
 }
 
-template <class Key, class T, class Compare>
-bool operator>(const map<Key, T, Compare>& lhs, const map<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, bool OrderStat>
+bool operator>(const map<Key, T, Compare, OrderStat>& lhs, const map<Key, T, Compare, OrderStat>& rhs)
 {
   return rhs < lhs;
 }
 
-template <class Key, class T, class Compare>
-bool operator<=(const map<Key, T, Compare>& lhs, const map<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, bool OrderStat>
+bool operator<=(const map<Key, T, Compare, OrderStat>& lhs, const map<Key, T, Compare, OrderStat>& rhs)
 {
   return !(rhs < lhs);
 }
 
-template <class Key, class T, class Compare>
-bool operator>=(const map<Key, T, Compare>& lhs, const map<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, bool OrderStat>
+bool operator>=(const map<Key, T, Compare, OrderStat>& lhs, const map<Key, T, Compare, OrderStat>& rhs)
 {
   return !(lhs < rhs);
 }
 
 // 重载 mystl 的 swap
-template <class Key, class T, class Compare>
-void swap(map<Key, T, Compare>& lhs, map<Key, T, Compare>& rhs) noexcept
+template <class Key, class T, class Compare, bool OrderStat>
+void swap(map<Key, T, Compare, OrderStat>& lhs, map<Key, T, Compare, OrderStat>& rhs) noexcept
 {
   lhs.swap(rhs);
 }
@@ -302,8 +410,9 @@ void swap(map<Key, T, Compare>& lhs, map<Key, T, Compare>& rhs) noexcept
 /*****************************************************************************************/
 
 // 模板类 multimap，键值允许重复
-// 参数一代表键值类型，参数二代表实值类型，参数三代表键值的比较方式，缺省使用 mystl::less
-template <class Key, class T, class Compare = mystl::less<Key>>
+// 参数一代表键值类型，参数二代表实值类型，参数三代表键值的比较方式，缺省使用 mystl::less，
+// 参数四表示是否维护顺序统计，为 true 时支持 find_by_order 与 order_of_key
+template <class Key, class T, class Compare = mystl::less<Key>, bool OrderStat = false>
 class multimap
 {
 public:
@@ -316,7 +425,7 @@ public:
   // 定义一个 functor，用来进行元素比较
   class value_compare : public binary_function <value_type, value_type, bool>
   {
-    friend class multimap<Key, T, Compare>;
+    friend class multimap<Key, T, Compare, OrderStat>;
   private:
     Compare comp;
     value_compare(Compare c) : comp(c) {}
@@ -329,12 +438,14 @@ public:
 
 private:
   // 用 mystl::rb_tree 作为底层机制
-  typedef mystl::rb_tree<value_type, key_compare>  base_type;
+  typedef mystl::rb_tree<value_type, key_compare, OrderStat> base_type;
   base_type tree_;
 
+  friend class map<Key, T, Compare, OrderStat>;
+
 public:
   // 使用 rb_tree 的型别
-  typedef typename base_type::node_type              node_type;
+  typedef typename base_type::node_handle_type       node_type;
   typedef typename base_type::pointer                pointer;
   typedef typename base_type::const_pointer          const_pointer;
   typedef typename base_type::reference              reference;
@@ -471,6 +582,42 @@ public:
 
   void           clear() { tree_.clear(); }
 
+  // 节点句柄，摘下、重新插入节点与合并容器都不分配也不释放节点
+
+  node_type      extract(iterator position)   { return tree_.extract(position); }
+  node_type      extract(const key_type& key) { return tree_.extract(key); }
+
+  iterator       insert(node_type&& nh)
+  {
+    return tree_.insert_multi(mystl::move(nh));
+  }
+  iterator       insert(iterator /*hint*/, node_type&& nh)
+  {
+    return tree_.insert_multi(mystl::move(nh));
+  }
+
+  void merge(multimap& other)                        { tree_.merge_multi(other.tree_); }
+  void merge(map<Key, T, Compare, OrderStat>& other) { tree_.merge_multi(other.tree_); }
+
+  // 分割与拼接，只改变 O(log n) 个节点的链接，
+  // OrderStat 为 false 时还要数一遍被分出或删除的元素
+
+  // 把键值不小于 key 的元素移出，作为一个新的 multimap 返回
+  multimap  split(const key_type& key)
+  {
+    multimap right;
+    tree_.split(key, right.tree_);
+    return right;
+  }
+  // 把 other 的元素全部接到末尾，other 中的键值都不能小于本 multimap 中的键值
+  void      append_greater(multimap& other)
+  {
+    MYSTL_DEBUG(empty() || other.empty() || !key_comp()(other.begin()->first, rbegin()->first));
+    tree_.join(other.tree_);
+  }
+  // 删除键值小于 key 的元素，返回删除的个数
+  size_type erase_before(const key_type& key) { return tree_.erase_before(key); }
+
   // multimap 相关操作
 
   iterator       find(const key_type& key)              { return tree_.find(key); }
@@ -492,6 +639,45 @@ public:
     equal_range(const key_type& key) const 
   { return tree_.equal_range_multi(key); }
 
+  // 顺序统计，OrderStat 为 true 时可用，时间复杂度为 O(log n)
+
+  // 第 k 小的元素（从 0 开始），k >= size() 时返回 end()
+  iterator       find_by_order(size_type k)              { return tree_.select(k); }
+  const_iterator find_by_order(size_type k)        const { return tree_.select(k); }
+
+  // 键值小于 key 的元素个数
+  size_type      order_of_key(const key_type& key) const { return tree_.rank(key); }
+
+  // 透明查找，Compare 定义了 is_transparent 时可用
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  iterator       find(const K& key)              { return tree_.find(key); }
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  const_iterator find(const K& key)        const { return tree_.find(key); }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  size_type      count(const K& key)       const { return tree_.count_multi(key); }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  iterator       lower_bound(const K& key)       { return tree_.lower_bound(key); }
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  const_iterator lower_bound(const K& key) const { return tree_.lower_bound(key); }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  iterator       upper_bound(const K& key)       { return tree_.upper_bound(key); }
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  const_iterator upper_bound(const K& key) const { return tree_.upper_bound(key); }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  pair<iterator, iterator>
+    equal_range(const K& key)
+  { return tree_.equal_range_multi(key); }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  pair<const_iterator, const_iterator>
+    equal_range(const K& key) const
+  { return tree_.equal_range_multi(key); }
+
   void swap(multimap& rhs) noexcept
   { tree_.swap(rhs.tree_); }
 
@@ -501,45 +687,45 @@ public:
 };
 
 // 重载比较操作符
-template <class Key, class T, class Compare>
-bool operator==(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, bool OrderStat>
+bool operator==(const multimap<Key, T, Compare, OrderStat>& lhs, const multimap<Key, T, Compare, OrderStat>& rhs)
 {
   return lhs == rhs;
 }
 
-template <class Key, class T, class Compare>
-bool operator<(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, bool OrderStat>
+bool operator<(const multimap<Key, T, Compare, OrderStat>& lhs, const multimap<Key, T, Compare, OrderStat>& rhs)
 {
   return lhs < rhs;
 }
 
-template <class Key, class T, class Compare>
-bool operator!=(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, bool OrderStat>
+bool operator!=(const multimap<Key, T, Compare, OrderStat>& lhs, const multimap<Key, T, Compare, OrderStat>& rhs)
 {
   return !(lhs == rhs);
 }
 
-template <class Key, class T, class Compare>
-bool operator>(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, bool OrderStat>
+bool operator>(const multimap<Key, T, Compare, OrderStat>& lhs, const multimap<Key, T, Compare, OrderStat>& rhs)
 {
   return rhs < lhs;
 }
 
-template <class Key, class T, class Compare>
-bool operator<=(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, bool OrderStat>
+bool operator<=(const multimap<Key, T, Compare, OrderStat>& lhs, const multimap<Key, T, Compare, OrderStat>& rhs)
 {
   return !(rhs < lhs);
 }
 
-template <class Key, class T, class Compare>
-bool operator>=(const multimap<Key, T, Compare>& lhs, const multimap<Key, T, Compare>& rhs)
+template <class Key, class T, class Compare, bool OrderStat>
+bool operator>=(const multimap<Key, T, Compare, OrderStat>& lhs, const multimap<Key, T, Compare, OrderStat>& rhs)
 {
   return !(lhs < rhs);
 }
 
 // 重载 mystl 的 swap
-template <class Key, class T, class Compare>
-void swap(multimap<Key, T, Compare>& lhs, multimap<Key, T, Compare>& rhs) noexcept
+template <class Key, class T, class Compare, bool OrderStat>
+void swap(multimap<Key, T, Compare, OrderStat>& lhs, multimap<Key, T, Compare, OrderStat>& rhs) noexcept
 {
   lhs.swap(rhs);
 }
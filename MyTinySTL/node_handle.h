@@ -0,0 +1,144 @@
+﻿#ifndef MYTINYSTL_NODE_HANDLE_H_
+#define MYTINYSTL_NODE_HANDLE_H_
+
+// 这个头文件包含了关联式容器共用的节点句柄 node_handle 与 node_insert_return
+// node_handle : 持有一个从 rb_tree 或 hashtable 中摘下的节点，可以再插入同类型的容器而不重新分配内存
+
+// notes:
+//
+// 1. 句柄只能移动不能复制，析构时若仍持有节点，就析构节点的值并释放节点
+// 2. 对 map 类容器的节点，key() 返回非 const 的引用，可以在重新插入之前修改键值
+
+#include "exceptdef.h"
+#include "memory.h"
+#include "util.h"
+
+namespace mystl
+{
+
+// forward declaration
+
+template <class T, class Compare, bool OrderStat>
+class rb_tree;
+
+template <class T, class HashFun, class KeyEqual, class BucketPolicy>
+class hashtable;
+
+// 模板类 node_handle
+// 参数一代表容器的节点类型，参数二代表容器的 value traits
+template <class Node, class ValueTraits>
+class node_handle
+{
+  template <class T, class Compare, bool OrderStat>
+  friend class mystl::rb_tree;
+  template <class T, class HashFun, class KeyEqual, class BucketPolicy>
+  friend class mystl::hashtable;
+
+public:
+  typedef typename ValueTraits::key_type    key_type;
+  typedef typename ValueTraits::mapped_type mapped_type;
+  typedef typename ValueTraits::value_type  value_type;
+  typedef mystl::allocator<value_type>      allocator_type;
+
+private:
+  typedef mystl::allocator<Node>            node_allocator;
+
+  Node* node_;
+
+public:
+  // 构造、移动、析构函数
+  constexpr node_handle() noexcept :node_(nullptr) {}
+
+  node_handle(node_handle&& rhs) noexcept
+    :node_(rhs.node_)
+  {
+    rhs.node_ = nullptr;
+  }
+
+  node_handle& operator=(node_handle&& rhs) noexcept
+  {
+    if (this != &rhs)
+    {
+      reset();
+      node_ = rhs.node_;
+      rhs.node_ = nullptr;
+    }
+    return *this;
+  }
+
+  node_handle(const node_handle&) = delete;
+  node_handle& operator=(const node_handle&) = delete;
+
+  ~node_handle() { reset(); }
+
+public:
+  bool empty() const noexcept { return node_ == nullptr; }
+  explicit operator bool() const noexcept { return node_ != nullptr; }
+
+  allocator_type get_allocator() const { return allocator_type(); }
+
+  // set 类容器的节点使用 value()，map 类容器的节点使用 key() 与 mapped()
+  value_type& value() const
+  {
+    MYSTL_DEBUG(node_ != nullptr);
+    return node_->value;
+  }
+  key_type& key() const
+  {
+    static_assert(ValueTraits::is_map, "key() is only available for map node handles");
+    MYSTL_DEBUG(node_ != nullptr);
+    return const_cast<key_type&>(node_->value.first);
+  }
+  mapped_type& mapped() const
+  {
+    static_assert(ValueTraits::is_map, "mapped() is only available for map node handles");
+    MYSTL_DEBUG(node_ != nullptr);
+    return node_->value.second;
+  }
+
+  void swap(node_handle& rhs) noexcept
+  {
+    mystl::swap(node_, rhs.node_);
+  }
+
+private:
+  // 只有容器能用节点构造句柄，或者从句柄中取回节点
+  explicit node_handle(Node* np) noexcept :node_(np) {}
+
+  Node* release() noexcept
+  {
+    auto np = node_;
+    node_ = nullptr;
+    return np;
+  }
+
+  void reset() noexcept
+  {
+    if (node_)
+    {
+      allocator_type::destroy(mystl::address_of(node_->value));
+      node_allocator::deallocate(node_);
+      node_ = nullptr;
+    }
+  }
+};
+
+// 重载 mystl 的 swap
+template <class Node, class ValueTraits>
+void swap(node_handle<Node, ValueTraits>& lhs, node_handle<Node, ValueTraits>& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+
+// 模板类 node_insert_return
+// 以句柄插入不允许重复的容器时的返回值，插入失败时句柄交还给 node
+template <class Iterator, class NodeHandle>
+struct node_insert_return
+{
+  Iterator   position;
+  bool       inserted;
+  NodeHandle node;
+};
+
+} // namespace mystl
+#endif // !MYTINYSTL_NODE_HANDLE_H_
@@ -11,6 +11,7 @@
 #include "functional.h"
 #include "iterator.h"
 #include "memory.h"
+#include "node_handle.h"
 #include "type_traits.h"
 #include "exceptdef.h"
 
@@ -123,10 +124,21 @@ struct rb_tree_node_base
   typedef rb_tree_node_base<T>* base_ptr;
   typedef rb_tree_node<T>*      node_ptr;
 
-  base_ptr   parent;  // 父节点
-  base_ptr   left;    // 左子节点
-  base_ptr   right;   // 右子节点
-  color_type color;   // 节点颜色
+  uintptr_t  parent_color;  // 父节点的地址，节点至少按指针对齐，最低位空闲，用来存放颜色
+  base_ptr   left;          // 左子节点
+  base_ptr   right;         // 右子节点
+
+  base_ptr   parent() const noexcept
+  { return reinterpret_cast<base_ptr>(parent_color & ~static_cast<uintptr_t>(1)); }
+  color_type color()  const noexcept
+  { return static_cast<color_type>(parent_color & 1); }
+
+  void set_parent(base_ptr p) noexcept
+  { parent_color = reinterpret_cast<uintptr_t>(p) | (parent_color & 1); }
+  void set_color(color_type c) noexcept
+  { parent_color = (parent_color & ~static_cast<uintptr_t>(1)) | static_cast<uintptr_t>(c); }
+  void set_parent_color(base_ptr p, color_type c) noexcept
+  { parent_color = reinterpret_cast<uintptr_t>(p) | static_cast<uintptr_t>(c); }
 
   base_ptr get_base_ptr()
   {
@@ -163,6 +175,98 @@ struct rb_tree_node :public rb_tree_node_base<T>
   }
 };
 
+// 带子树大小的节点，用于顺序统计，值的偏移与 rb_tree_node 相同，迭代器不需要区分两种节点
+template <class T>
+struct rb_tree_size_node :public rb_tree_node<T>
+{
+  size_t size;  // 以该节点为根的子树的节点数
+};
+
+// rb tree 的节点附加信息，树在链接、摘下节点和旋转时调用，用以维护附加信息
+
+// 不维护任何附加信息，所有操作都是空操作
+struct rb_tree_no_augment
+{
+  template <class NodePtr>
+  static void update(NodePtr) noexcept {}
+  template <class NodePtr>
+  static void copy(NodePtr, NodePtr) noexcept {}
+  template <class NodePtr>
+  static void linked(NodePtr, NodePtr) noexcept {}
+  template <class NodePtr>
+  static void unlinking(NodePtr, NodePtr) noexcept {}
+  template <class NodePtr>
+  static void update_path(NodePtr, NodePtr) noexcept {}
+};
+
+// 维护子树大小，节点必须是 rb_tree_size_node
+template <class T>
+struct rb_tree_size_augment
+{
+  typedef rb_tree_node_base<T>* base_ptr;
+  typedef rb_tree_size_node<T>* size_node_ptr;
+
+  static size_t size(base_ptr x) noexcept
+  { return x == nullptr ? 0 : static_cast<size_node_ptr>(x)->size; }
+  static size_t& size_ref(base_ptr x) noexcept
+  { return static_cast<size_node_ptr>(x)->size; }
+
+  // 由左右子树重新计算 x 的子树大小
+  static void update(base_ptr x) noexcept
+  { size_ref(x) = size(x->left) + size(x->right) + 1; }
+
+  // x 顶替 y 的位置时，继承 y 的子树大小
+  static void copy(base_ptr x, base_ptr y) noexcept
+  { size_ref(x) = size_ref(y); }
+
+  // 新节点 x 已链接为叶子，x 的子树大小为一，x 的所有祖先加一
+  static void linked(base_ptr x, base_ptr root) noexcept
+  {
+    size_ref(x) = 1;
+    while (x != root)
+    {
+      x = x->parent();
+      ++size_ref(x);
+    }
+  }
+
+  // 节点 y 即将从树中摘下，y 的所有祖先减一
+  static void unlinking(base_ptr y, base_ptr root) noexcept
+  {
+    while (y != root)
+    {
+      y = y->parent();
+      --size_ref(y);
+    }
+  }
+
+  // x 的子树改变了，从 x 到 root 逐个重新计算
+  static void update_path(base_ptr x, base_ptr root) noexcept
+  {
+    update(x);
+    while (x != root)
+    {
+      x = x->parent();
+      update(x);
+    }
+  }
+};
+
+// 按是否维护顺序统计选择节点类型与附加信息
+template <class T, bool OrderStat>
+struct rb_tree_augment_traits
+{
+  typedef rb_tree_node<T>      alloc_node_type;
+  typedef rb_tree_no_augment   augment_type;
+};
+
+template <class T>
+struct rb_tree_augment_traits<T, true>
+{
+  typedef rb_tree_size_node<T>    alloc_node_type;
+  typedef rb_tree_size_augment<T> augment_type;
+};
+
 // rb tree traits
 
 template <class T>
@@ -206,11 +310,11 @@ struct rb_tree_iterator_base :public mystl::iterator<mystl::bidirectional_iterat
     }
     else
     {  // 如果没有右子节点
-      auto y = node->parent;
+      auto y = node->parent();
       while (y->right == node)
       {
         node = y;
-        y = y->parent;
+        y = y->parent();
       }
       if (node->right != y)  // 应对“寻找根节点的下一节点，而根节点没有右子节点”的特殊情况
         node = y;
@@ -220,7 +324,7 @@ struct rb_tree_iterator_base :public mystl::iterator<mystl::bidirectional_iterat
   // 使迭代器后退
   void dec()
   {
-    if (node->parent->parent == node && rb_tree_is_red(node))
+    if (node->parent()->parent() == node && rb_tree_is_red(node))
     { // 如果 node 为 header
       node = node->right;  // 指向整棵树的 max 节点
     }
@@ -230,11 +334,11 @@ struct rb_tree_iterator_base :public mystl::iterator<mystl::bidirectional_iterat
     }
     else
     {  // 非 header 节点，也无左子节点
-      auto y = node->parent;
+      auto y = node->parent();
       while (node == y->left)
       {
         node = y;
-        y = y->parent;
+        y = y->parent();
       }
       node = y;
     }
@@ -369,25 +473,25 @@ NodePtr rb_tree_max(NodePtr x) noexcept
 template <class NodePtr>
 bool rb_tree_is_lchild(NodePtr node) noexcept
 {
-  return node == node->parent->left;
+  return node == node->parent()->left;
 }
 
 template <class NodePtr>
 bool rb_tree_is_red(NodePtr node) noexcept
 {
-  return node->color == rb_tree_red;
+  return node->color() == rb_tree_red;
 }
 
 template <class NodePtr>
-void rb_tree_set_black(NodePtr& node) noexcept
+void rb_tree_set_black(NodePtr node) noexcept
 {
-  node->color = rb_tree_black;
+  node->set_color(rb_tree_black);
 }
 
 template <class NodePtr>
-void rb_tree_set_red(NodePtr& node) noexcept
+void rb_tree_set_red(NodePtr node) noexcept
 {
-  node->color = rb_tree_red;
+  node->set_color(rb_tree_red);
 }
 
 template <class NodePtr>
@@ -396,8 +500,8 @@ NodePtr rb_tree_next(NodePtr node) noexcept
   if (node->right != nullptr)
     return rb_tree_min(node->right);
   while (!rb_tree_is_lchild(node))
-    node = node->parent;
-  return node->parent;
+    node = node->parent();
+  return node->parent();
 }
 
 /*---------------------------------------*\
@@ -409,15 +513,15 @@ NodePtr rb_tree_next(NodePtr node) noexcept
 |      / \                   / \          |
 |     b   c                 a   b         |
 \*---------------------------------------*/
-// 左旋，参数一为左旋点，参数二为根节点
-template <class NodePtr>
-void rb_tree_rotate_left(NodePtr x, NodePtr& root) noexcept
+// 左旋，参数一为左旋点，参数二为根节点，参数三维护节点的附加信息
+template <class NodePtr, class Augment = rb_tree_no_augment>
+void rb_tree_rotate_left(NodePtr x, NodePtr& root, Augment aug = Augment()) noexcept
 {
   auto y = x->right;  // y 为 x 的右子节点
   x->right = y->left;
   if (y->left != nullptr)
-    y->left->parent = x;
-  y->parent = x->parent;
+    y->left->set_parent(x);
+  y->set_parent(x->parent());
 
   if (x == root)
   { // 如果 x 为根节点，让 y 顶替 x 成为根节点
@@ -425,15 +529,18 @@ void rb_tree_rotate_left(NodePtr x, NodePtr& root) noexcept
   }
   else if (rb_tree_is_lchild(x))
   { // 如果 x 是左子节点
-    x->parent->left = y;
+    x->parent()->left = y;
   }
   else
   { // 如果 x 是右子节点
-    x->parent->right = y;
+    x->parent()->right = y;
   }
   // 调整 x 与 y 的关系
   y->left = x;  
-  x->parent = y;
+  x->set_parent(y);
+  // x 成为 y 的子节点，先更新 x 再更新 y
+  aug.update(x);
+  aug.update(y);
 }
 
 /*----------------------------------------*\
@@ -445,15 +552,15 @@ void rb_tree_rotate_left(NodePtr x, NodePtr& root) noexcept
 |    / \                           / \     |
 |   b   c                         c   a    |
 \*----------------------------------------*/
-// 右旋，参数一为右旋点，参数二为根节点
-template <class NodePtr>
-void rb_tree_rotate_right(NodePtr x, NodePtr& root) noexcept
+// 右旋，参数一为右旋点，参数二为根节点，参数三维护节点的附加信息
+template <class NodePtr, class Augment = rb_tree_no_augment>
+void rb_tree_rotate_right(NodePtr x, NodePtr& root, Augment aug = Augment()) noexcept
 {
   auto y = x->left;
   x->left = y->right;
   if (y->right)
-    y->right->parent = x;
-  y->parent = x->parent;
+    y->right->set_parent(x);
+  y->set_parent(x->parent());
 
   if (x == root)
   { // 如果 x 为根节点，让 y 顶替 x 成为根节点
@@ -461,18 +568,21 @@ void rb_tree_rotate_right(NodePtr x, NodePtr& root) noexcept
   }
   else if (rb_tree_is_lchild(x))
   { // 如果 x 是右子节点
-    x->parent->left = y;
+    x->parent()->left = y;
   }
   else
   { // 如果 x 是左子节点
-    x->parent->right = y;
+    x->parent()->right = y;
   }
   // 调整 x 与 y 的关系
   y->right = x;                      
-  x->parent = y;
+  x->set_parent(y);
+  aug.update(x);
+  aug.update(y);
 }
 
-// 插入节点后使 rb tree 重新平衡，参数一为新增节点，参数二为根节点
+// 从红色节点 x 开始向上消除连续的红色节点，参数一为当前节点，参数二为根节点，参数三维护节点的附加信息，
+// x 的附加信息以及 x 到根的路径必须已经更新。case 3 一直传到根节点时树的黑高加一，此时返回 true
 //
 // case 1: 新增节点位于根节点，令新增节点为黑
 // case 2: 新增节点的父节点为黑，没有破坏平衡，直接返回
@@ -485,44 +595,43 @@ void rb_tree_rotate_right(NodePtr x, NodePtr& root) noexcept
 //
 // 参考博客: http://blog.csdn.net/v_JULY_v/article/details/6105630
 //          http://blog.csdn.net/v_JULY_v/article/details/6109153
-template <class NodePtr>
-void rb_tree_insert_rebalance(NodePtr x, NodePtr& root) noexcept
+template <class NodePtr, class Augment = rb_tree_no_augment>
+bool rb_tree_insert_fixup(NodePtr x, NodePtr& root, Augment aug = Augment()) noexcept
 {
-  rb_tree_set_red(x);  // 新增节点为红色
-  while (x != root && rb_tree_is_red(x->parent))
+  while (x != root && rb_tree_is_red(x->parent()))
   {
-    if (rb_tree_is_lchild(x->parent))
+    if (rb_tree_is_lchild(x->parent()))
     { // 如果父节点是左子节点
-      auto uncle = x->parent->parent->right;
+      auto uncle = x->parent()->parent()->right;
       if (uncle != nullptr && rb_tree_is_red(uncle))
       { // case 3: 父节点和叔叔节点都为红
-        rb_tree_set_black(x->parent);
+        rb_tree_set_black(x->parent());
         rb_tree_set_black(uncle);
-        x = x->parent->parent;
+        x = x->parent()->parent();
         rb_tree_set_red(x);
       }
       else
       { // 无叔叔节点或叔叔节点为黑
         if (!rb_tree_is_lchild(x))
         { // case 4: 当前节点 x 为右子节点
-          x = x->parent;
-          rb_tree_rotate_left(x, root);
+          x = x->parent();
+          rb_tree_rotate_left(x, root, aug);
         }
         // 都转换成 case 5： 当前节点为左子节点
-        rb_tree_set_black(x->parent);
-        rb_tree_set_red(x->parent->parent);
-        rb_tree_rotate_right(x->parent->parent, root);
+        rb_tree_set_black(x->parent());
+        rb_tree_set_red(x->parent()->parent());
+        rb_tree_rotate_right(x->parent()->parent(), root, aug);
         break;
       }
     }
     else  // 如果父节点是右子节点，对称处理
     { 
-      auto uncle = x->parent->parent->left;
+      auto uncle = x->parent()->parent()->left;
       if (uncle != nullptr && rb_tree_is_red(uncle))
       { // case 3: 父节点和叔叔节点都为红
-        rb_tree_set_black(x->parent);
+        rb_tree_set_black(x->parent());
         rb_tree_set_black(uncle);
-        x = x->parent->parent;
+        x = x->parent()->parent();
         rb_tree_set_red(x);
         // 此时祖父节点为红，可能会破坏红黑树的性质，令当前节点为祖父节点，继续处理
       }
@@ -530,29 +639,44 @@ void rb_tree_insert_rebalance(NodePtr x, NodePtr& root) noexcept
       { // 无叔叔节点或叔叔节点为黑
         if (rb_tree_is_lchild(x))
         { // case 4: 当前节点 x 为左子节点
-          x = x->parent;
-          rb_tree_rotate_right(x, root);
+          x = x->parent();
+          rb_tree_rotate_right(x, root, aug);
         }
         // 都转换成 case 5： 当前节点为左子节点
-        rb_tree_set_black(x->parent);
-        rb_tree_set_red(x->parent->parent);
-        rb_tree_rotate_left(x->parent->parent, root);
+        rb_tree_set_black(x->parent());
+        rb_tree_set_red(x->parent()->parent());
+        rb_tree_rotate_left(x->parent()->parent(), root, aug);
         break;
       }
     }
   }
+  const bool grow = rb_tree_is_red(root);
   rb_tree_set_black(root);  // 根节点永远为黑
+  return grow;
 }
 
-// 删除节点后使 rb tree 重新平衡，参数一为要删除的节点，参数二为根节点，参数三为最小节点，参数四为最大节点
+// 插入节点后使 rb tree 重新平衡，参数一为新增节点，参数二为根节点，参数三维护节点的附加信息
+template <class NodePtr, class Augment = rb_tree_no_augment>
+void rb_tree_insert_rebalance(NodePtr x, NodePtr& root, Augment aug = Augment()) noexcept
+{
+  aug.linked(x, root);
+  rb_tree_set_red(x);  // 新增节点为红色
+  rb_tree_insert_fixup(x, root, aug);
+}
+
+// 删除节点后使 rb tree 重新平衡，参数一为要删除的节点，参数二为根节点，参数三为最小节点，参数四为最大节点，
+// 参数五维护节点的附加信息
 // 
 // 参考博客: http://blog.csdn.net/v_JULY_v/article/details/6105630
 //          http://blog.csdn.net/v_JULY_v/article/details/6109153
-template <class NodePtr>
-NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, NodePtr& rightmost)
+template <class NodePtr, class Augment = rb_tree_no_augment>
+NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, NodePtr& rightmost,
+                                Augment aug = Augment())
 {
   // y 是可能的替换节点，指向最终要删除的节点
   auto y = (z->left == nullptr || z->right == nullptr) ? z : rb_tree_next(z);
+  // 实际离开原位置的是 y，在改变链接之前更新 y 的祖先
+  aug.unlinking(y, root);
   // x 是 y 的一个独子节点或 NIL 节点
   auto x = y->left != nullptr ? y->left : y->right;
   // xp 为 x 的父节点
@@ -562,19 +686,19 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
   // 用 y 顶替 z 的位置，用 x 顶替 y 的位置，最后用 y 指向 z
   if (y != z)
   {
-    z->left->parent = y;
+    z->left->set_parent(y);
     y->left = z->left;
 
     // 如果 y 不是 z 的右子节点，那么 z 的右子节点一定有左孩子
     if (y != z->right)
     { // x 替换 y 的位置
-      xp = y->parent;
+      xp = y->parent();
       if (x != nullptr)
-        x->parent = y->parent;
+        x->set_parent(y->parent());
 
-      y->parent->left = x;
+      y->parent()->left = x;
       y->right = z->right;
-      z->right->parent = y;
+      z->right->set_parent(y);
     }
     else
     {
@@ -585,27 +709,30 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
     if (root == z)
       root = y;
     else if (rb_tree_is_lchild(z))
-      z->parent->left = y;
+      z->parent()->left = y;
     else
-      z->parent->right = y;
-    y->parent = z->parent;
-    mystl::swap(y->color, z->color);
+      z->parent()->right = y;
+    y->set_parent(z->parent());
+    aug.copy(y, z);
+    const auto color = y->color();
+    y->set_color(z->color());
+    z->set_color(color);
     y = z;
   }
   // y == z 说明 z 至多只有一个孩子
   else
   { 
-    xp = y->parent;
+    xp = y->parent();
     if (x)  
-      x->parent = y->parent;
+      x->set_parent(y->parent());
 
     // 连接 x 与 z 的父节点
     if (root == z)
       root = x;
     else if (rb_tree_is_lchild(z))
-      z->parent->left = x;
+      z->parent()->left = x;
     else
-      z->parent->right = x;
+      z->parent()->right = x;
 
     // 此时 z 有可能是最左节点或最右节点，更新数据
     if (leftmost == z)
@@ -633,7 +760,7 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
         { // case 1
           rb_tree_set_black(brother);
           rb_tree_set_red(xp);
-          rb_tree_rotate_left(xp, root);
+          rb_tree_rotate_left(xp, root, aug);
           brother = xp->right;
         }
         // case 1 转为为了 case 2、3、4 中的一种
@@ -642,7 +769,7 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
         { // case 2
           rb_tree_set_red(brother);
           x = xp;
-          xp = xp->parent;
+          xp = xp->parent();
         }
         else
         { 
@@ -651,15 +778,15 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
             if (brother->left != nullptr)
               rb_tree_set_black(brother->left);
             rb_tree_set_red(brother);
-            rb_tree_rotate_right(brother, root);
+            rb_tree_rotate_right(brother, root, aug);
             brother = xp->right;
           }
           // 转为 case 4
-          brother->color = xp->color;
+          brother->set_color(xp->color());
           rb_tree_set_black(xp);
           if (brother->right != nullptr)  
             rb_tree_set_black(brother->right);
-          rb_tree_rotate_left(xp, root);
+          rb_tree_rotate_left(xp, root, aug);
           break;
         }
       }
@@ -670,7 +797,7 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
         { // case 1
           rb_tree_set_black(brother);
           rb_tree_set_red(xp);
-          rb_tree_rotate_right(xp, root);
+          rb_tree_rotate_right(xp, root, aug);
           brother = xp->left;
         }
         if ((brother->left == nullptr || !rb_tree_is_red(brother->left)) &&
@@ -678,7 +805,7 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
         { // case 2
           rb_tree_set_red(brother);
           x = xp;
-          xp = xp->parent;
+          xp = xp->parent();
         }
         else
         {
@@ -687,15 +814,15 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
             if (brother->right != nullptr)
               rb_tree_set_black(brother->right);
             rb_tree_set_red(brother);
-            rb_tree_rotate_left(brother, root);
+            rb_tree_rotate_left(brother, root, aug);
             brother = xp->left;
           }
           // 转为 case 4
-          brother->color = xp->color;
+          brother->set_color(xp->color());
           rb_tree_set_black(xp);
           if (brother->left != nullptr)  
             rb_tree_set_black(brother->left);
-          rb_tree_rotate_right(xp, root);
+          rb_tree_rotate_right(xp, root, aug);
           break;
         }
       }
@@ -706,9 +833,93 @@ NodePtr rb_tree_erase_rebalance(NodePtr z, NodePtr& root, NodePtr& leftmost, Nod
   return y;
 }
 
+// 子树的黑高：从 x 到空节点的任一路径上黑色节点的个数，x 为空时为 0
+template <class NodePtr>
+size_t rb_tree_black_height(NodePtr x) noexcept
+{
+  size_t h = 0;
+  for (; x != nullptr; x = x->left)
+  {
+    if (!rb_tree_is_red(x))
+      ++h;
+  }
+  return h;
+}
+
+// 用节点 k 连接两颗独立的子树 l 与 r，l 中的节点都不大于 k，r 中的节点都不小于 k，
+// l 与 r 的根为黑色或空、父节点为空，lh 与 rh 为它们的黑高，返回新树的根，新树的黑高写入 h
+//
+// 黑高相等时 k 直接成为新的根；否则沿较高一侧的右（左）链向下，找到黑高与另一侧相等的黑色节点 c，
+// 让红色的 k 顶替 c 的位置，c 与另一颗树成为 k 的两个子树，再按插入的方式消除连续的红色节点。
+// 只访问较高一侧链上的 |lh - rh| + 1 层，时间复杂度为 O(|lh - rh| + 1)
+template <class NodePtr, class Augment = rb_tree_no_augment>
+NodePtr rb_tree_join(NodePtr l, size_t lh, NodePtr k, NodePtr r, size_t rh, size_t& h,
+                     Augment aug = Augment()) noexcept
+{
+  if (lh == rh)
+  {
+    k->left = l;
+    k->right = r;
+    if (l != nullptr)
+      l->set_parent(k);
+    if (r != nullptr)
+      r->set_parent(k);
+    k->set_parent_color(nullptr, rb_tree_black);
+    aug.update(k);
+    h = lh + 1;
+    return k;
+  }
+  NodePtr root = nullptr;
+  NodePtr p = nullptr;
+  if (lh > rh)
+  { // 沿 l 的右链向下，红色节点不计入黑高，直接跳过
+    root = l;
+    auto c = l;
+    for (auto ch = lh; ch > rh; --ch)
+    {
+      p = c, c = c->right;
+      if (c != nullptr && rb_tree_is_red(c))
+        p = c, c = c->right;
+    }
+    k->left = c;
+    k->right = r;
+    if (c != nullptr)
+      c->set_parent(k);
+    if (r != nullptr)
+      r->set_parent(k);
+    p->right = k;
+    h = lh;
+  }
+  else
+  { // 沿 r 的左链向下，对称处理
+    root = r;
+    auto c = r;
+    for (auto ch = rh; ch > lh; --ch)
+    {
+      p = c, c = c->left;
+      if (c != nullptr && rb_tree_is_red(c))
+        p = c, c = c->left;
+    }
+    k->left = l;
+    k->right = c;
+    if (l != nullptr)
+      l->set_parent(k);
+    if (c != nullptr)
+      c->set_parent(k);
+    p->left = k;
+    h = rh;
+  }
+  k->set_parent_color(p, rb_tree_red);
+  aug.update_path(k, root);
+  if (rb_tree_insert_fixup(k, root, aug))
+    ++h;
+  return root;
+}
+
 // 模板类 rb_tree
-// 参数一代表数据类型，参数二代表键值比较类型
-template <class T, class Compare>
+// 参数一代表数据类型，参数二代表键值比较类型，
+// 参数三表示是否在节点中维护子树大小，为 true 时支持 O(log n) 的按序号查找与求序号
+template <class T, class Compare, bool OrderStat = false>
 class rb_tree
 {
 public:
@@ -726,10 +937,15 @@ public:
   typedef typename tree_traits::value_type         value_type;
   typedef Compare                                  key_compare;
 
+  // OrderStat 为 true 时实际分配的是带子树大小的节点
+  typedef rb_tree_augment_traits<T, OrderStat>     augment_traits;
+  typedef typename augment_traits::alloc_node_type alloc_node_type;
+  typedef typename augment_traits::augment_type    augment_type;
+
   typedef mystl::allocator<T>                      allocator_type;
   typedef mystl::allocator<T>                      data_allocator;
   typedef mystl::allocator<base_type>              base_allocator;
-  typedef mystl::allocator<node_type>              node_allocator;
+  typedef mystl::allocator<alloc_node_type>        node_allocator;
 
   typedef typename allocator_type::pointer         pointer;
   typedef typename allocator_type::const_pointer   const_pointer;
@@ -743,6 +959,9 @@ public:
   typedef mystl::reverse_iterator<iterator>        reverse_iterator;
   typedef mystl::reverse_iterator<const_iterator>  const_reverse_iterator;
 
+  typedef mystl::node_handle<alloc_node_type, value_traits>     node_handle_type;
+  typedef mystl::node_insert_return<iterator, node_handle_type> insert_return_type;
+
   allocator_type get_allocator() const { return node_allocator(); }
   key_compare    key_comp()      const { return key_comp_; }
 
@@ -754,10 +973,10 @@ private:
 
 private:
   // 以下三个函数用于取得根节点，最小节点和最大节点
-  base_ptr& root()      const { return header_->parent; }
+  base_ptr  root()      const { return header_->parent(); }
+  void      set_root(base_ptr x) const { header_->set_parent(x); }
   base_ptr& leftmost()  const { return header_->left; }
   base_ptr& rightmost() const { return header_->right; }
-
 public:
   // 构造、复制、析构函数
   rb_tree() { rb_tree_init(); }
@@ -813,8 +1032,17 @@ public:
   template <class ...Args>
   iterator  emplace_multi(Args&& ...args);
 
+  // 第一个参数就是键值时先查找，键值已存在就不分配节点
+  template <class ...Args>
+  mystl::pair<iterator, bool> emplace_unique(Args&& ...args)
+  {
+    return M_emplace_unique(mystl::is_key_first<key_type, Args...>(),
+                            mystl::forward<Args>(args)...);
+  }
+
+  // 按 key 查找，不存在时才用 args 构造节点插入
   template <class ...Args>
-  mystl::pair<iterator, bool> emplace_unique(Args&& ...args);
+  mystl::pair<iterator, bool> try_emplace_unique(const key_type& key, Args&& ...args);
 
   template <class ...Args>
   iterator  emplace_multi_use_hint(iterator hint, Args&& ...args);
@@ -839,13 +1067,11 @@ public:
     return emplace_multi_use_hint(hint, mystl::move(value));
   }
 
+  // 空树中插入已排序的前向迭代器区间时，直接建成平衡的树，时间复杂度为 O(n)
   template <class InputIterator>
   void      insert_multi(InputIterator first, InputIterator last)
   {
-    size_type n = mystl::distance(first, last);
-    THROW_LENGTH_ERROR_IF(node_count_ > max_size() - n, "rb_tree<T, Comp>'s size too big");
-    for (; n > 0; --n, ++first)
-      insert_multi(end(), *first);
+    copy_insert_multi(first, last, iterator_category(first));
   }
 
   mystl::pair<iterator, bool> insert_unique(const value_type& value);
@@ -863,13 +1089,11 @@ public:
     return emplace_unique_use_hint(hint, mystl::move(value));
   }
 
+  // 空树中插入已排序的前向迭代器区间时，直接建成平衡的树，时间复杂度为 O(n)
   template <class InputIterator>
   void      insert_unique(InputIterator first, InputIterator last)
   {
-    size_type n = mystl::distance(first, last);
-    THROW_LENGTH_ERROR_IF(node_count_ > max_size() - n, "rb_tree<T, Comp>'s size too big");
-    for (; n > 0; --n, ++first)
-      insert_unique(end(), *first);
+    copy_insert_unique(first, last, iterator_category(first));
   }
 
   // erase
@@ -883,26 +1107,59 @@ public:
 
   void      clear();
 
+  // node handle
+
+  node_handle_type   extract(iterator position);
+  node_handle_type   extract(const key_type& key)
+  {
+    auto it = find(key);
+    return it == end() ? node_handle_type() : extract(it);
+  }
+
+  iterator           insert_multi(node_handle_type&& nh);
+  insert_return_type insert_unique(node_handle_type&& nh);
+
+  // 把 other 的节点直接链接到本树中，不分配也不释放节点
+  void               merge_multi(rb_tree& other);
+  void               merge_unique(rb_tree& other);
+
+  // split / join，只沿树高移动指针，不分配节点，也不逐个重新平衡。
+  // 元素个数由 distance 求得，OrderStat 为 true 时整个操作为 O(log n)，
+  // 否则还要数一遍被分出的元素
+
+  // 把键值不小于 key 的元素移到空树 right 中
+  void               split(const key_type& key, rb_tree& right);
+  // 把 right 的元素全部接到本树的末尾，right 中的键值都不能小于本树中的键值
+  void               join(rb_tree& right);
+  // 删除键值小于 key 的元素，返回删除的个数
+  size_type          erase_before(const key_type& key);
+
   // rb_tree 相关操作
 
-  iterator       find(const key_type& key);
-  const_iterator find(const key_type& key) const;
+  iterator       find(const key_type& key)
+  { return iterator(M_find(key)); }
+  const_iterator find(const key_type& key) const
+  { return const_iterator(M_find(key)); }
 
   size_type      count_multi(const key_type& key) const
   {
     auto p = equal_range_multi(key);
-    return static_cast<size_type>(mystl::distance(p.first, p.second));
+    return distance(p.first, p.second);
   }
   size_type      count_unique(const key_type& key) const
   {
     return find(key) != end() ? 1 : 0;
   }
 
-  iterator       lower_bound(const key_type& key);
-  const_iterator lower_bound(const key_type& key) const;
+  iterator       lower_bound(const key_type& key)
+  { return iterator(M_lower_bound(key)); }
+  const_iterator lower_bound(const key_type& key) const
+  { return const_iterator(M_lower_bound(key)); }
 
-  iterator       upper_bound(const key_type& key);
-  const_iterator upper_bound(const key_type& key) const;
+  iterator       upper_bound(const key_type& key)
+  { return iterator(M_upper_bound(key)); }
+  const_iterator upper_bound(const key_type& key) const
+  { return const_iterator(M_upper_bound(key)); }
 
   mystl::pair<iterator, iterator>             
   equal_range_multi(const key_type& key)
@@ -930,6 +1187,93 @@ public:
     return it == end() ? mystl::make_pair(it, it) : mystl::make_pair(it, ++next);
   }
 
+  // 透明查找：比较函数定义了 is_transparent 时，接受任意能与键值比较的类型，
+  // 不构造 key_type 的临时对象
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  iterator       find(const K& key)
+  { return iterator(M_find(key)); }
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  const_iterator find(const K& key) const
+  { return const_iterator(M_find(key)); }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  size_type      count_multi(const K& key) const
+  {
+    return distance(const_iterator(M_lower_bound(key)), const_iterator(M_upper_bound(key)));
+  }
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  size_type      count_unique(const K& key) const
+  {
+    return M_find(key) != header_ ? 1 : 0;
+  }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  iterator       lower_bound(const K& key)
+  { return iterator(M_lower_bound(key)); }
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  const_iterator lower_bound(const K& key) const
+  { return const_iterator(M_lower_bound(key)); }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  iterator       upper_bound(const K& key)
+  { return iterator(M_upper_bound(key)); }
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  const_iterator upper_bound(const K& key) const
+  { return const_iterator(M_upper_bound(key)); }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  mystl::pair<iterator, iterator>
+  equal_range_multi(const K& key)
+  {
+    return mystl::pair<iterator, iterator>(lower_bound(key), upper_bound(key));
+  }
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  mystl::pair<const_iterator, const_iterator>
+  equal_range_multi(const K& key) const
+  {
+    return mystl::pair<const_iterator, const_iterator>(lower_bound(key), upper_bound(key));
+  }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  mystl::pair<iterator, iterator>
+  equal_range_unique(const K& key)
+  {
+    iterator it = find(key);
+    auto next = it;
+    return it == end() ? mystl::make_pair(it, it) : mystl::make_pair(it, ++next);
+  }
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  mystl::pair<const_iterator, const_iterator>
+  equal_range_unique(const K& key) const
+  {
+    const_iterator it = find(key);
+    auto next = it;
+    return it == end() ? mystl::make_pair(it, it) : mystl::make_pair(it, ++next);
+  }
+
+  // 顺序统计，OrderStat 为 true 时可用，时间复杂度为 O(log n)
+
+  // 中序的第 k 个元素（从 0 开始），k >= size() 时返回 end()
+  iterator       select(size_type k)
+  { return iterator(M_select(k)); }
+  const_iterator select(size_type k) const
+  { return const_iterator(M_select(k)); }
+
+  // 键值小于 key 的元素个数
+  size_type      rank(const key_type& key) const
+  { return M_rank(key); }
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  size_type      rank(const K& key) const
+  { return M_rank(key); }
+
+  // 位于 position 之前的元素个数，position 为 end() 时返回 size()
+  size_type      order_of(const_iterator position) const;
+
+  // [first, last) 中的元素个数，OrderStat 为 true 时为 O(log n)，否则为线性时间
+  size_type      distance(const_iterator first, const_iterator last) const
+  { return M_distance(first, last, mystl::m_bool_constant<OrderStat>()); }
+
   void swap(rb_tree& rhs) noexcept;
 
 private:
@@ -944,36 +1288,85 @@ private:
   void     rb_tree_init();
   void     reset();
 
+  // find
+  template <class K>
+  base_ptr M_find(const K& key) const;
+  template <class K>
+  base_ptr M_lower_bound(const K& key) const;
+  template <class K>
+  base_ptr M_upper_bound(const K& key) const;
+
+  // order statistic
+  base_ptr  M_select(size_type k) const;
+  template <class K>
+  size_type M_rank(const K& key) const;
+  size_type M_distance(const_iterator first, const_iterator last, m_true_type) const
+  { return order_of(last) - order_of(first); }
+  size_type M_distance(const_iterator first, const_iterator last, m_false_type) const
+  { return static_cast<size_type>(mystl::distance(first, last)); }
+
   // get insert pos
   mystl::pair<base_ptr, bool> 
            get_insert_multi_pos(const key_type& key);
   mystl::pair<mystl::pair<base_ptr, bool>, bool> 
            get_insert_unique_pos(const key_type& key);
 
+  // emplace
+  template <class ...Args>
+  mystl::pair<iterator, bool> M_emplace_unique(m_false_type, Args&& ...args);
+  template <class K, class ...Args>
+  mystl::pair<iterator, bool> M_emplace_unique(m_true_type, K&& key, Args&& ...args)
+  { return try_emplace_unique(key, mystl::forward<K>(key), mystl::forward<Args>(args)...); }
+
   // insert value / insert node
   iterator insert_value_at(base_ptr x, const value_type& value, bool add_to_left);
   iterator insert_node_at(base_ptr x, node_ptr node, bool add_to_left);
 
+  // unlink node
+  node_ptr unlink_node(base_ptr x);
+
   // insert use hint
   iterator insert_multi_use_hint(iterator hint, key_type key, node_ptr node);
   iterator insert_unique_use_hint(iterator hint, key_type key, node_ptr node);
 
+  // range insert
+  template <class InputIter>
+  void     copy_insert_multi(InputIter first, InputIter last, mystl::input_iterator_tag);
+  template <class ForwardIter>
+  void     copy_insert_multi(ForwardIter first, ForwardIter last, mystl::forward_iterator_tag);
+  template <class InputIter>
+  void     copy_insert_unique(InputIter first, InputIter last, mystl::input_iterator_tag);
+  template <class ForwardIter>
+  void     copy_insert_unique(ForwardIter first, ForwardIter last, mystl::forward_iterator_tag);
+
+  // build from sorted range
+  template <class ForwardIter>
+  bool     is_sorted_range(ForwardIter first, ForwardIter last) const;
+  template <class ForwardIter>
+  void     build_from_sorted(ForwardIter first, ForwardIter last, bool unique);
+  base_ptr link_sorted(base_ptr& list, size_type n, size_type depth, size_type red_depth);
+
   // copy tree / erase tree
   base_ptr copy_from(base_ptr x, base_ptr p);
-  void     erase_since(base_ptr x);
+  size_type erase_since(base_ptr x);
+
+  // split / join
+  void     M_split(base_ptr x, size_type h, const key_type& key,
+                   base_ptr& l, size_type& lh, base_ptr& r, size_type& rh);
+  void     attach_root(base_ptr x);
 };
 
 /*****************************************************************************************/
 
 // 复制构造函数
-template <class T, class Compare>
-rb_tree<T, Compare>::
+template <class T, class Compare, bool OrderStat>
+rb_tree<T, Compare, OrderStat>::
 rb_tree(const rb_tree& rhs)
 {
   rb_tree_init();
   if (rhs.node_count_ != 0)
   {
-    root() = copy_from(rhs.root(), header_);
+    set_root(copy_from(rhs.root(), header_));
     leftmost() = rb_tree_min(root());
     rightmost() = rb_tree_max(root());
   }
@@ -982,8 +1375,8 @@ rb_tree(const rb_tree& rhs)
 }
 
 // 移动构造函数
-template <class T, class Compare>
-rb_tree<T, Compare>::
+template <class T, class Compare, bool OrderStat>
+rb_tree<T, Compare, OrderStat>::
 rb_tree(rb_tree&& rhs) noexcept
   :header_(mystl::move(rhs.header_)),
   node_count_(rhs.node_count_),
@@ -993,9 +1386,9 @@ rb_tree(rb_tree&& rhs) noexcept
 }
 
 // 复制赋值操作符
-template <class T, class Compare>
-rb_tree<T, Compare>& 
-rb_tree<T, Compare>::
+template <class T, class Compare, bool OrderStat>
+rb_tree<T, Compare, OrderStat>& 
+rb_tree<T, Compare, OrderStat>::
 operator=(const rb_tree& rhs)
 {
   if (this != &rhs)
@@ -1004,7 +1397,7 @@ operator=(const rb_tree& rhs)
 
     if (rhs.node_count_ != 0)
     {
-      root() = copy_from(rhs.root(), header_);
+      set_root(copy_from(rhs.root(), header_));
       leftmost() = rb_tree_min(root());
       rightmost() = rb_tree_max(root());
     }
@@ -1016,9 +1409,9 @@ operator=(const rb_tree& rhs)
 }
 
 // 移动赋值操作符
-template <class T, class Compare>
-rb_tree<T, Compare>&
-rb_tree<T, Compare>::
+template <class T, class Compare, bool OrderStat>
+rb_tree<T, Compare, OrderStat>&
+rb_tree<T, Compare, OrderStat>::
 operator=(rb_tree&& rhs)
 {
   clear();
@@ -1030,10 +1423,10 @@ operator=(rb_tree&& rhs)
 }
 
 // 就地插入元素，键值允许重复
-template <class T, class Compare>
+template <class T, class Compare, bool OrderStat>
 template <class ...Args>
-typename rb_tree<T, Compare>::iterator 
-rb_tree<T, Compare>::
+typename rb_tree<T, Compare, OrderStat>::iterator 
+rb_tree<T, Compare, OrderStat>::
 emplace_multi(Args&& ...args)
 {
   THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
@@ -1043,11 +1436,11 @@ emplace_multi(Args&& ...args)
 }
 
 // 就地插入元素，键值不允许重复
-template <class T, class Compare>
+template <class T, class Compare, bool OrderStat>
 template <class ...Args>
-mystl::pair<typename rb_tree<T, Compare>::iterator, bool> 
-rb_tree<T, Compare>::
-emplace_unique(Args&& ...args)
+mystl::pair<typename rb_tree<T, Compare, OrderStat>::iterator, bool> 
+rb_tree<T, Compare, OrderStat>::
+M_emplace_unique(m_false_type, Args&& ...args)
 {
   THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
   node_ptr np = create_node(mystl::forward<Args>(args)...);
@@ -1060,11 +1453,26 @@ emplace_unique(Args&& ...args)
   return mystl::make_pair(iterator(res.first.first), false);
 }
 
+// 先按 key 查找插入位置，键值不存在时才构造节点，键值已存在时不分配内存
+template <class T, class Compare, bool OrderStat>
+template <class ...Args>
+mystl::pair<typename rb_tree<T, Compare, OrderStat>::iterator, bool>
+rb_tree<T, Compare, OrderStat>::
+try_emplace_unique(const key_type& key, Args&& ...args)
+{
+  THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
+  auto res = get_insert_unique_pos(key);
+  if (!res.second)
+    return mystl::make_pair(iterator(res.first.first), false);
+  node_ptr np = create_node(mystl::forward<Args>(args)...);
+  return mystl::make_pair(insert_node_at(res.first.first, np, res.first.second), true);
+}
+
 // 就地插入元素，键值允许重复，当 hint 位置与插入位置接近时，插入操作的时间复杂度可以降低
-template <class T, class Compare>
+template <class T, class Compare, bool OrderStat>
 template <class ...Args>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+typename rb_tree<T, Compare, OrderStat>::iterator
+rb_tree<T, Compare, OrderStat>::
 emplace_multi_use_hint(iterator hint, Args&& ...args)
 {
   THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
@@ -1102,10 +1510,10 @@ emplace_multi_use_hint(iterator hint, Args&& ...args)
 }
 
 // 就地插入元素，键值不允许重复，当 hint 位置与插入位置接近时，插入操作的时间复杂度可以降低
-template<class T, class Compare>
+template <class T, class Compare, bool OrderStat>
 template<class ...Args>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+typename rb_tree<T, Compare, OrderStat>::iterator
+rb_tree<T, Compare, OrderStat>::
 emplace_unique_use_hint(iterator hint, Args&& ...args)
 {
   THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
@@ -1153,9 +1561,9 @@ emplace_unique_use_hint(iterator hint, Args&& ...args)
 }
 
 // 插入元素，节点键值允许重复
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+template <class T, class Compare, bool OrderStat>
+typename rb_tree<T, Compare, OrderStat>::iterator
+rb_tree<T, Compare, OrderStat>::
 insert_multi(const value_type& value)
 {
   THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
@@ -1164,9 +1572,9 @@ insert_multi(const value_type& value)
 }
 
 // 插入新值，节点键值不允许重复，返回一个 pair，若插入成功，pair 的第二参数为 true，否则为 false
-template <class T, class Compare>
-mystl::pair<typename rb_tree<T, Compare>::iterator, bool>
-rb_tree<T, Compare>::
+template <class T, class Compare, bool OrderStat>
+mystl::pair<typename rb_tree<T, Compare, OrderStat>::iterator, bool>
+rb_tree<T, Compare, OrderStat>::
 insert_unique(const value_type& value)
 {
   THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
@@ -1179,37 +1587,33 @@ insert_unique(const value_type& value)
 }
 
 // 删除 hint 位置的节点
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+template <class T, class Compare, bool OrderStat>
+typename rb_tree<T, Compare, OrderStat>::iterator
+rb_tree<T, Compare, OrderStat>::
 erase(iterator hint)
 {
-  auto node = hint.node->get_node_ptr();
-  iterator next(node);
+  iterator next(hint.node);
   ++next;
-  
-  rb_tree_erase_rebalance(hint.node, root(), leftmost(), rightmost());
-  destroy_node(node);
-  --node_count_;
+  destroy_node(unlink_node(hint.node));
   return next;
 }
 
 // 删除键值等于 key 的元素，返回删除的个数
-template <class T, class Compare>
-typename rb_tree<T, Compare>::size_type
-rb_tree<T, Compare>::
+template <class T, class Compare, bool OrderStat>
+typename rb_tree<T, Compare, OrderStat>::size_type
+rb_tree<T, Compare, OrderStat>::
 erase_multi(const key_type& key)
 {
   auto p = equal_range_multi(key);
-  size_type n = mystl::distance(p.first, p.second);
+  size_type n = distance(p.first, p.second);
   erase(p.first, p.second);
   return n;
 }
 
 // 删除键值等于 key 的元素，返回删除的个数
-template <class T, class Compare>
-typename rb_tree<T, Compare>::size_type
-rb_tree<T, Compare>::
+template <class T, class Compare, bool OrderStat>
+typename rb_tree<T, Compare, OrderStat>::size_type
+rb_tree<T, Compare, OrderStat>::
 erase_unique(const key_type& key)
 {
   auto it = find(key);
@@ -1222,8 +1626,8 @@ erase_unique(const key_type& key)
 }
 
 // 删除[first, last)区间内的元素
-template <class T, class Compare>
-void rb_tree<T, Compare>::
+template <class T, class Compare, bool OrderStat>
+void rb_tree<T, Compare, OrderStat>::
 erase(iterator first, iterator last)
 {
   if (first == begin() && last == end())
@@ -1238,154 +1642,183 @@ erase(iterator first, iterator last)
 }
 
 // 清空 rb tree
-template <class T, class Compare>
-void rb_tree<T, Compare>::
+template <class T, class Compare, bool OrderStat>
+void rb_tree<T, Compare, OrderStat>::
 clear()
 {
   if (node_count_ != 0)
   {
     erase_since(root());
     leftmost() = header_;
-    root() = nullptr;
+    set_root(nullptr);
     rightmost() = header_;
     node_count_ = 0;
   }
 }
 
-// 查找键值为 k 的节点，返回指向它的迭代器
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
-find(const key_type& key)
+// 把 position 处的节点从树中摘下，交给节点句柄
+template <class T, class Compare, bool OrderStat>
+typename rb_tree<T, Compare, OrderStat>::node_handle_type
+rb_tree<T, Compare, OrderStat>::
+extract(iterator position)
 {
-  auto y = header_;  // 最后一个不小于 key 的节点
-  auto x = root();
-  while (x != nullptr)
-  {
-    if (!key_comp_(value_traits::get_key(x->get_node_ptr()->value), key))
-    { // key 小于等于 x 键值，向左走
-      y = x, x = x->left;
-    }
-    else
-    { // key 大于 x 键值，向右走
-      x = x->right;
-    }
-  }
-  iterator j = iterator(y);
-  return (j == end() || key_comp_(key, value_traits::get_key(*j))) ? end() : j;
+  MYSTL_DEBUG(position != end());
+  return node_handle_type(static_cast<alloc_node_type*>(unlink_node(position.node)));
 }
 
-template <class T, class Compare>
-typename rb_tree<T, Compare>::const_iterator
-rb_tree<T, Compare>::
-find(const key_type& key) const
+// 插入句柄持有的节点，键值允许重复，句柄为空时返回 end()
+template <class T, class Compare, bool OrderStat>
+typename rb_tree<T, Compare, OrderStat>::iterator
+rb_tree<T, Compare, OrderStat>::
+insert_multi(node_handle_type&& nh)
 {
-  auto y = header_;  // 最后一个不小于 key 的节点
-  auto x = root();
-  while (x != nullptr)
-  {
-    if (!key_comp_(value_traits::get_key(x->get_node_ptr()->value), key))
-    { // key 小于等于 x 键值，向左走
-      y = x, x = x->left;
-    }
-    else
-    { // key 大于 x 键值，向右走
-      x = x->right;
-    }
-  }
-  const_iterator j = const_iterator(y);
-  return (j == end() || key_comp_(key, value_traits::get_key(*j))) ? end() : j;
+  if (nh.empty())
+    return end();
+  THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
+  auto res = get_insert_multi_pos(value_traits::get_key(nh.node_->value));
+  return insert_node_at(res.first, nh.release(), res.second);
 }
 
-// 键值不小于 key 的第一个位置
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
-lower_bound(const key_type& key)
+// 插入句柄持有的节点，键值不允许重复，键值已存在时节点留在返回值的 node 中
+template <class T, class Compare, bool OrderStat>
+typename rb_tree<T, Compare, OrderStat>::insert_return_type
+rb_tree<T, Compare, OrderStat>::
+insert_unique(node_handle_type&& nh)
 {
-  auto y = header_;
-  auto x = root();
-  while (x != nullptr)
+  if (nh.empty())
+    return insert_return_type{ end(), false, node_handle_type() };
+  THROW_LENGTH_ERROR_IF(node_count_ > max_size() - 1, "rb_tree<T, Comp>'s size too big");
+  auto res = get_insert_unique_pos(value_traits::get_key(nh.node_->value));
+  if (!res.second)
+    return insert_return_type{ iterator(res.first.first), false, mystl::move(nh) };
+  auto it = insert_node_at(res.first.first, nh.release(), res.first.second);
+  return insert_return_type{ it, true, node_handle_type() };
+}
+
+// 把 other 的所有节点移到本树中，键值允许重复
+template <class T, class Compare, bool OrderStat>
+void rb_tree<T, Compare, OrderStat>::
+merge_multi(rb_tree& other)
+{
+  if (this == &other)
+    return;
+  THROW_LENGTH_ERROR_IF(node_count_ > max_size() - other.node_count_,
+                        "rb_tree<T, Comp>'s size too big");
+  // 摘下节点只改变指针的链接，指向其它节点的迭代器仍然有效
+  for (auto first = other.begin(); first != other.end();)
   {
-    if (!key_comp_(value_traits::get_key(x->get_node_ptr()->value), key))
-    { // key <= x
-      y = x, x = x->left;
-    }
-    else
-    {
-      x = x->right;
-    }
+    auto np = other.unlink_node((first++).node);
+    auto res = get_insert_multi_pos(value_traits::get_key(np->value));
+    insert_node_at(res.first, np, res.second);
   }
-  return iterator(y);
 }
 
-template <class T, class Compare>
-typename rb_tree<T, Compare>::const_iterator
-rb_tree<T, Compare>::
-lower_bound(const key_type& key) const
+// 把 other 中键值在本树中不存在的节点移到本树中，其余节点留在 other 中
+template <class T, class Compare, bool OrderStat>
+void rb_tree<T, Compare, OrderStat>::
+merge_unique(rb_tree& other)
 {
-  auto y = header_;
-  auto x = root();
-  while (x != nullptr)
+  if (this == &other)
+    return;
+  for (auto first = other.begin(); first != other.end();)
   {
-    if (!key_comp_(value_traits::get_key(x->get_node_ptr()->value), key))
-    { // key <= x
-      y = x, x = x->left;
-    }
-    else
+    auto res = get_insert_unique_pos(value_traits::get_key(*first));
+    if (!res.second)
     {
-      x = x->right;
+      ++first;
+      continue;
     }
+    auto np = other.unlink_node((first++).node);
+    insert_node_at(res.first.first, np, res.first.second);
   }
-  return const_iterator(y);
 }
 
-// 键值不小于 key 的最后一个位置
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
-upper_bound(const key_type& key)
+// 把键值不小于 key 的元素移到空树 right 中，本树保留键值小于 key 的元素
+template <class T, class Compare, bool OrderStat>
+void rb_tree<T, Compare, OrderStat>::
+split(const key_type& key, rb_tree& right)
+{
+  MYSTL_DEBUG(this != &right && right.node_count_ == 0);
+  right.key_comp_ = key_comp_;
+  const auto n = distance(cbegin(), const_iterator(M_lower_bound(key)));
+  if (n == node_count_)
+    return;
+  if (n == 0)
+  {
+    swap(right);
+    return;
+  }
+  auto t = root();
+  t->set_parent(nullptr);
+  base_ptr l = nullptr, r = nullptr;
+  size_type lh = 0, rh = 0;
+  M_split(t, rb_tree_black_height(t), key, l, lh, r, rh);
+  attach_root(l);
+  right.attach_root(r);
+  right.node_count_ = node_count_ - n;
+  node_count_ = n;
+}
+
+// 把 right 的元素全部接到本树的末尾，取出 right 的最小节点作为连接两颗树的节点
+template <class T, class Compare, bool OrderStat>
+void rb_tree<T, Compare, OrderStat>::
+join(rb_tree& right)
 {
-  auto y = header_;
-  auto x = root();
-  while (x != nullptr)
+  if (this == &right || right.node_count_ == 0)
+    return;
+  if (node_count_ == 0)
   {
-    if (key_comp_(key, value_traits::get_key(x->get_node_ptr()->value)))
-    { // key < x
-      y = x, x = x->left;
-    }
-    else
-    {
-      x = x->right;
-    }
-  }
-  return iterator(y);
+    swap(right);
+    return;
+  }
+  MYSTL_DEBUG(!key_comp_(value_traits::get_key(right.leftmost()->get_node_ptr()->value),
+                         value_traits::get_key(rightmost()->get_node_ptr()->value)));
+  THROW_LENGTH_ERROR_IF(node_count_ > max_size() - right.node_count_,
+                        "rb_tree<T, Comp>'s size too big");
+  base_ptr k = right.unlink_node(right.leftmost());
+  auto l = root();
+  auto r = right.root();
+  l->set_parent(nullptr);
+  if (r != nullptr)
+    r->set_parent(nullptr);
+  size_type h = 0;
+  auto t = rb_tree_join(l, rb_tree_black_height(l), k, r, rb_tree_black_height(r), h,
+                        augment_type());
+  attach_root(t);
+  node_count_ += right.node_count_ + 1;
+  right.attach_root(nullptr);
+  right.node_count_ = 0;
 }
 
-template <class T, class Compare>
-typename rb_tree<T, Compare>::const_iterator
-rb_tree<T, Compare>::
-upper_bound(const key_type& key) const
+// 删除键值小于 key 的元素，先把它们分成一颗独立的树，再整体释放，释放时顺便计数
+template <class T, class Compare, bool OrderStat>
+typename rb_tree<T, Compare, OrderStat>::size_type
+rb_tree<T, Compare, OrderStat>::
+erase_before(const key_type& key)
 {
-  auto y = header_;
-  auto x = root();
-  while (x != nullptr)
+  const auto pos = M_lower_bound(key);
+  if (pos == leftmost())
+    return 0;
+  if (pos == header_)
   {
-    if (key_comp_(key, value_traits::get_key(x->get_node_ptr()->value)))
-    { // key < x
-      y = x, x = x->left;
-    }
-    else
-    {
-      x = x->right;
-    }
-  }
-  return const_iterator(y);
+    const auto n = node_count_;
+    clear();
+    return n;
+  }
+  auto t = root();
+  t->set_parent(nullptr);
+  base_ptr l = nullptr, r = nullptr;
+  size_type lh = 0, rh = 0;
+  M_split(t, rb_tree_black_height(t), key, l, lh, r, rh);
+  const auto n = erase_since(l);
+  attach_root(r);
+  node_count_ -= n;
+  return n;
 }
 
 // 交换 rb tree
-template <class T, class Compare>
-void rb_tree<T, Compare>::
+template <class T, class Compare, bool OrderStat>
+void rb_tree<T, Compare, OrderStat>::
 swap(rb_tree& rhs) noexcept
 {
   if (this != &rhs)
@@ -1400,10 +1833,10 @@ swap(rb_tree& rhs) noexcept
 // helper function
 
 // 创建一个结点
-template <class T, class Compare>
+template <class T, class Compare, bool OrderStat>
 template <class ...Args>
-typename rb_tree<T, Compare>::node_ptr
-rb_tree<T, Compare>::
+typename rb_tree<T, Compare, OrderStat>::node_ptr
+rb_tree<T, Compare, OrderStat>::
 create_node(Args&&... args)
 {
   auto tmp = node_allocator::allocate(1);
@@ -1412,7 +1845,7 @@ create_node(Args&&... args)
     data_allocator::construct(mystl::address_of(tmp->value), mystl::forward<Args>(args)...);
     tmp->left = nullptr;
     tmp->right = nullptr;
-    tmp->parent = nullptr;
+    tmp->set_parent_color(nullptr, rb_tree_red);
   }
   catch (...)
   {
@@ -1423,52 +1856,199 @@ create_node(Args&&... args)
 }
 
 // 复制一个结点
-template <class T, class Compare>
-typename rb_tree<T, Compare>::node_ptr
-rb_tree<T, Compare>::
+template <class T, class Compare, bool OrderStat>
+typename rb_tree<T, Compare, OrderStat>::node_ptr
+rb_tree<T, Compare, OrderStat>::
 clone_node(base_ptr x)
 {
   node_ptr tmp = create_node(x->get_node_ptr()->value);
-  tmp->color = x->color;
+  tmp->set_color(x->color());
+  augment_type::copy(tmp->get_base_ptr(), x);
   tmp->left = nullptr;
   tmp->right = nullptr;
   return tmp;
 }
 
+// 把节点 x 从树中摘下并重新平衡，不释放节点
+template <class T, class Compare, bool OrderStat>
+typename rb_tree<T, Compare, OrderStat>::node_ptr
+rb_tree<T, Compare, OrderStat>::
+unlink_node(base_ptr x)
+{
+  auto r = root();
+  rb_tree_erase_rebalance(x, r, leftmost(), rightmost(), augment_type());
+  set_root(r);
+  --node_count_;
+  auto np = x->get_node_ptr();
+  np->left = nullptr;
+  np->right = nullptr;
+  np->set_parent(nullptr);
+  return np;
+}
+
 // 销毁一个结点
-template <class T, class Compare>
-void rb_tree<T, Compare>::
+template <class T, class Compare, bool OrderStat>
+void rb_tree<T, Compare, OrderStat>::
 destroy_node(node_ptr p)
 {
   data_allocator::destroy(&p->value);
-  node_allocator::deallocate(p);
+  node_allocator::deallocate(static_cast<alloc_node_type*>(p));
 }
 
 // 初始化容器
-template <class T, class Compare>
-void rb_tree<T, Compare>::
+template <class T, class Compare, bool OrderStat>
+void rb_tree<T, Compare, OrderStat>::
 rb_tree_init()
 {
   header_ = base_allocator::allocate(1);
-  header_->color = rb_tree_red;  // header_ 节点颜色为红，与 root 区分
-  root() = nullptr;
+  header_->set_parent_color(nullptr, rb_tree_red);  // header_ 节点颜色为红，与 root 区分
   leftmost() = header_;
   rightmost() = header_;
   node_count_ = 0;
 }
 
 // reset 函数
-template <class T, class Compare>
-void rb_tree<T, Compare>::reset()
+template <class T, class Compare, bool OrderStat>
+void rb_tree<T, Compare, OrderStat>::reset()
 {
   header_ = nullptr;
   node_count_ = 0;
 }
 
+// 查找键值与 key 相等的节点，没有时返回 header_
+template <class T, class Compare, bool OrderStat>
+template <class K>
+typename rb_tree<T, Compare, OrderStat>::base_ptr
+rb_tree<T, Compare, OrderStat>::
+M_find(const K& key) const
+{
+  auto y = M_lower_bound(key);
+  return (y == header_ || key_comp_(key, value_traits::get_key(y->get_node_ptr()->value)))
+    ? header_ : y;
+}
+
+// 键值不小于 key 的第一个节点
+template <class T, class Compare, bool OrderStat>
+template <class K>
+typename rb_tree<T, Compare, OrderStat>::base_ptr
+rb_tree<T, Compare, OrderStat>::
+M_lower_bound(const K& key) const
+{
+  auto y = header_;
+  auto x = root();
+  while (x != nullptr)
+  {
+    if (!key_comp_(value_traits::get_key(x->get_node_ptr()->value), key))
+    { // key 小于等于 x 键值，向左走
+      y = x, x = x->left;
+    }
+    else
+    { // key 大于 x 键值，向右走
+      x = x->right;
+    }
+  }
+  return y;
+}
+
+// 键值大于 key 的第一个节点
+template <class T, class Compare, bool OrderStat>
+template <class K>
+typename rb_tree<T, Compare, OrderStat>::base_ptr
+rb_tree<T, Compare, OrderStat>::
+M_upper_bound(const K& key) const
+{
+  auto y = header_;
+  auto x = root();
+  while (x != nullptr)
+  {
+    if (key_comp_(key, value_traits::get_key(x->get_node_ptr()->value)))
+    { // key < x
+      y = x, x = x->left;
+    }
+    else
+    {
+      x = x->right;
+    }
+  }
+  return y;
+}
+
+// 中序的第 k 个节点，没有时返回 header_
+template <class T, class Compare, bool OrderStat>
+typename rb_tree<T, Compare, OrderStat>::base_ptr
+rb_tree<T, Compare, OrderStat>::
+M_select(size_type k) const
+{
+  static_assert(OrderStat, "select requires rb_tree with OrderStat == true");
+  auto x = root();
+  while (x != nullptr)
+  {
+    const auto left_size = augment_type::size(x->left);
+    if (k < left_size)
+    {
+      x = x->left;
+    }
+    else if (k == left_size)
+    {
+      return x;
+    }
+    else
+    {
+      k -= left_size + 1;
+      x = x->right;
+    }
+  }
+  return header_;
+}
+
+// 键值小于 key 的节点个数，向右走时累加左子树与当前节点
+template <class T, class Compare, bool OrderStat>
+template <class K>
+typename rb_tree<T, Compare, OrderStat>::size_type
+rb_tree<T, Compare, OrderStat>::
+M_rank(const K& key) const
+{
+  static_assert(OrderStat, "rank requires rb_tree with OrderStat == true");
+  size_type n = 0;
+  auto x = root();
+  while (x != nullptr)
+  {
+    if (key_comp_(value_traits::get_key(x->get_node_ptr()->value), key))
+    { // x 小于 key，x 与它的左子树都计入
+      n += augment_type::size(x->left) + 1;
+      x = x->right;
+    }
+    else
+    {
+      x = x->left;
+    }
+  }
+  return n;
+}
+
+// 迭代器的序号，从节点向上走到根，每次从右子节点上来时累加父节点与它的左子树
+template <class T, class Compare, bool OrderStat>
+typename rb_tree<T, Compare, OrderStat>::size_type
+rb_tree<T, Compare, OrderStat>::
+order_of(const_iterator position) const
+{
+  static_assert(OrderStat, "order_of requires rb_tree with OrderStat == true");
+  auto x = position.node;
+  if (x == header_)
+    return node_count_;
+  size_type n = augment_type::size(x->left);
+  for (auto r = root(); x != r; x = x->parent())
+  {
+    if (!rb_tree_is_lchild(x))
+      n += augment_type::size(x->parent()->left) + 1;
+  }
+  return n;
+}
+
 // get_insert_multi_pos 函数
-template <class T, class Compare>
-mystl::pair<typename rb_tree<T, Compare>::base_ptr, bool>
-rb_tree<T, Compare>::get_insert_multi_pos(const key_type& key)
+template <class T, class Compare, bool OrderStat>
+mystl::pair<typename rb_tree<T, Compare, OrderStat>::base_ptr, bool>
+rb_tree<T, Compare, OrderStat>::get_insert_multi_pos(const key_type& key)
 {
   auto x = root();
   auto y = header_;
@@ -1483,9 +2063,9 @@ rb_tree<T, Compare>::get_insert_multi_pos(const key_type& key)
 }
 
 // get_insert_unique_pos 函数
-template <class T, class Compare>
-mystl::pair<mystl::pair<typename rb_tree<T, Compare>::base_ptr, bool>, bool>
-rb_tree<T, Compare>::get_insert_unique_pos(const key_type& key)
+template <class T, class Compare, bool OrderStat>
+mystl::pair<mystl::pair<typename rb_tree<T, Compare, OrderStat>::base_ptr, bool>, bool>
+rb_tree<T, Compare, OrderStat>::get_insert_unique_pos(const key_type& key)
 { // 返回一个 pair，第一个值为一个 pair，包含插入点的父节点和一个 bool 表示是否在左边插入，
   // 第二个值为一个 bool，表示是否插入成功
   auto x = root();
@@ -1513,23 +2093,23 @@ rb_tree<T, Compare>::get_insert_unique_pos(const key_type& key)
   { // 表明新节点没有重复
     return mystl::make_pair(mystl::make_pair(y, add_to_left), true);
   }
-  // 进行至此，表示新节点与现有节点键值重复
-  return mystl::make_pair(mystl::make_pair(y, add_to_left), false);
+  // 进行至此，表示新节点与现有节点键值重复，返回重复的节点
+  return mystl::make_pair(mystl::make_pair(j.node, add_to_left), false);
 }
 
 // insert_value_at 函数
 // x 为插入点的父节点， value 为要插入的值，add_to_left 表示是否在左边插入
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+template <class T, class Compare, bool OrderStat>
+typename rb_tree<T, Compare, OrderStat>::iterator
+rb_tree<T, Compare, OrderStat>::
 insert_value_at(base_ptr x, const value_type& value, bool add_to_left)
 {
   node_ptr node = create_node(value);
-  node->parent = x;
+  node->set_parent(x);
   auto base_node = node->get_base_ptr();
   if (x == header_)
   {
-    root() = base_node;
+    set_root(base_node);
     leftmost() = base_node;
     rightmost() = base_node;
   }
@@ -1545,23 +2125,25 @@ insert_value_at(base_ptr x, const value_type& value, bool add_to_left)
     if (rightmost() == x)
       rightmost() = base_node;
   }
-  rb_tree_insert_rebalance(base_node, root());
+  auto r = root();
+  rb_tree_insert_rebalance(base_node, r, augment_type());
+  set_root(r);
   ++node_count_;
   return iterator(node);
 }
 
 // 在 x 节点处插入新的节点
 // x 为插入点的父节点， node 为要插入的节点，add_to_left 表示是否在左边插入
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator
-rb_tree<T, Compare>::
+template <class T, class Compare, bool OrderStat>
+typename rb_tree<T, Compare, OrderStat>::iterator
+rb_tree<T, Compare, OrderStat>::
 insert_node_at(base_ptr x, node_ptr node, bool add_to_left)
 {
-  node->parent = x;
+  node->set_parent(x);
   auto base_node = node->get_base_ptr();
   if (x == header_)
   {
-    root() = base_node;
+    set_root(base_node);
     leftmost() = base_node;
     rightmost() = base_node;
   }
@@ -1577,15 +2159,17 @@ insert_node_at(base_ptr x, node_ptr node, bool add_to_left)
     if (rightmost() == x)
       rightmost() = base_node;
   }
-  rb_tree_insert_rebalance(base_node, root());
+  auto r = root();
+  rb_tree_insert_rebalance(base_node, r, augment_type());
+  set_root(r);
   ++node_count_;
   return iterator(node);
 }
 
 // 插入元素，键值允许重复，使用 hint
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator 
-rb_tree<T, Compare>::
+template <class T, class Compare, bool OrderStat>
+typename rb_tree<T, Compare, OrderStat>::iterator 
+rb_tree<T, Compare, OrderStat>::
 insert_multi_use_hint(iterator hint, key_type key, node_ptr node)
 {
   // 在 hint 附近寻找可插入的位置
@@ -1610,9 +2194,9 @@ insert_multi_use_hint(iterator hint, key_type key, node_ptr node)
 }
 
 // 插入元素，键值不允许重复，使用 hint
-template <class T, class Compare>
-typename rb_tree<T, Compare>::iterator 
-rb_tree<T, Compare>::
+template <class T, class Compare, bool OrderStat>
+typename rb_tree<T, Compare, OrderStat>::iterator 
+rb_tree<T, Compare, OrderStat>::
 insert_unique_use_hint(iterator hint, key_type key, node_ptr node)
 {
   // 在 hint 附近寻找可插入的位置
@@ -1641,14 +2225,162 @@ insert_unique_use_hint(iterator hint, key_type key, node_ptr node)
   return insert_node_at(pos.first.first, node, pos.first.second);
 }
 
+// copy_insert 函数
+// 单趟迭代器逐个插入，用 end() 作为 hint，输入有序时每次插入只需比较一次
+template <class T, class Compare, bool OrderStat>
+template <class InputIter>
+void rb_tree<T, Compare, OrderStat>::
+copy_insert_multi(InputIter first, InputIter last, mystl::input_iterator_tag)
+{
+  for (; first != last; ++first)
+    insert_multi(end(), *first);
+}
+
+template <class T, class Compare, bool OrderStat>
+template <class ForwardIter>
+void rb_tree<T, Compare, OrderStat>::
+copy_insert_multi(ForwardIter first, ForwardIter last, mystl::forward_iterator_tag)
+{
+  size_type n = mystl::distance(first, last);
+  THROW_LENGTH_ERROR_IF(node_count_ > max_size() - n, "rb_tree<T, Comp>'s size too big");
+  if (node_count_ == 0 && n > 1 && is_sorted_range(first, last))
+  {
+    build_from_sorted(first, last, false);
+    return;
+  }
+  for (; n > 0; --n, ++first)
+    insert_multi(end(), *first);
+}
+
+template <class T, class Compare, bool OrderStat>
+template <class InputIter>
+void rb_tree<T, Compare, OrderStat>::
+copy_insert_unique(InputIter first, InputIter last, mystl::input_iterator_tag)
+{
+  for (; first != last; ++first)
+    insert_unique(end(), *first);
+}
+
+template <class T, class Compare, bool OrderStat>
+template <class ForwardIter>
+void rb_tree<T, Compare, OrderStat>::
+copy_insert_unique(ForwardIter first, ForwardIter last, mystl::forward_iterator_tag)
+{
+  size_type n = mystl::distance(first, last);
+  THROW_LENGTH_ERROR_IF(node_count_ > max_size() - n, "rb_tree<T, Comp>'s size too big");
+  if (node_count_ == 0 && n > 1 && is_sorted_range(first, last))
+  {
+    build_from_sorted(first, last, true);
+    return;
+  }
+  for (; n > 0; --n, ++first)
+    insert_unique(end(), *first);
+}
+
+// is_sorted_range 函数
+// 区间内的键值是否非递减
+template <class T, class Compare, bool OrderStat>
+template <class ForwardIter>
+bool rb_tree<T, Compare, OrderStat>::
+is_sorted_range(ForwardIter first, ForwardIter last) const
+{
+  if (first == last)
+    return true;
+  auto next = first;
+  for (++next; next != last; ++first, ++next)
+  {
+    if (key_comp_(value_traits::get_key(*next), value_traits::get_key(*first)))
+      return false;
+  }
+  return true;
+}
+
+// build_from_sorted 函数
+// 用非递减的区间建成一颗平衡的树，树必须为空，unique 为 true 时相邻的相等键值只保留第一个
+// 先按顺序创建所有节点，用 right 串成链表，出现异常时销毁已创建的节点，树保持为空；
+// 再按中序把链表挂成树，这一步不会抛出异常
+template <class T, class Compare, bool OrderStat>
+template <class ForwardIter>
+void rb_tree<T, Compare, OrderStat>::
+build_from_sorted(ForwardIter first, ForwardIter last, bool unique)
+{
+  MYSTL_DEBUG(node_count_ == 0);
+  base_ptr head = nullptr;
+  base_ptr tail = nullptr;
+  size_type n = 0;
+  try
+  {
+    for (; first != last; ++first)
+    {
+      if (unique && tail != nullptr &&
+          !key_comp_(value_traits::get_key(tail->get_node_ptr()->value),
+                     value_traits::get_key(*first)))
+        continue;
+      auto np = create_node(*first);
+      if (tail == nullptr)
+        head = np;
+      else
+        tail->right = np;
+      tail = np;
+      ++n;
+    }
+  }
+  catch (...)
+  {
+    while (head != nullptr)
+    {
+      auto next = head->right;
+      destroy_node(head->get_node_ptr());
+      head = next;
+    }
+    throw;
+  }
+  // 按大小对半分的树中，深度小于 floor(log2(n)) 的各层都是满的，
+  // 把最深一层染成红色、其余染成黑色，每条路径上的黑色节点数相同
+  size_type red_depth = 0;
+  for (auto m = n; m > 1; m >>= 1)
+    ++red_depth;
+  set_root(link_sorted(head, n, 0, red_depth));
+  root()->set_parent(header_);
+  rb_tree_set_black(root());
+  leftmost() = rb_tree_min(root());
+  rightmost() = rb_tree_max(root());
+  node_count_ = n;
+}
+
+// link_sorted 函数
+// 从链表 list 中依次取出 n 个节点，按中序挂成一颗平衡的子树，返回子树的根，depth 为子树根的深度
+template <class T, class Compare, bool OrderStat>
+typename rb_tree<T, Compare, OrderStat>::base_ptr
+rb_tree<T, Compare, OrderStat>::
+link_sorted(base_ptr& list, size_type n, size_type depth, size_type red_depth)
+{
+  if (n == 0)
+    return nullptr;
+  const auto left_count = (n - 1) / 2;
+  auto left = link_sorted(list, left_count, depth + 1, red_depth);
+  auto x = list;
+  list = list->right;
+  x->left = left;
+  if (left != nullptr)
+    left->set_parent(x);
+  x->set_color(depth == red_depth ? rb_tree_red : rb_tree_black);
+  auto right = link_sorted(list, n - 1 - left_count, depth + 1, red_depth);
+  x->right = right;
+  if (right != nullptr)
+    right->set_parent(x);
+  augment_type::update(x);
+  return x;
+}
+
 // copy_from 函数
 // 递归复制一颗树，节点从 x 开始，p 为 x 的父节点
-template <class T, class Compare>
-typename rb_tree<T, Compare>::base_ptr
-rb_tree<T, Compare>::copy_from(base_ptr x, base_ptr p)
+template <class T, class Compare, bool OrderStat>
+typename rb_tree<T, Compare, OrderStat>::base_ptr
+rb_tree<T, Compare, OrderStat>::copy_from(base_ptr x, base_ptr p)
 {
   auto top = clone_node(x);
-  top->parent = p;
+  top->set_parent(p);
   try
   {
     if (x->right)
@@ -1659,7 +2391,7 @@ rb_tree<T, Compare>::copy_from(base_ptr x, base_ptr p)
     {
       auto y = clone_node(x);
       p->left = y;
-      y->parent = p;
+      y->set_parent(p);
       if (x->right)
         y->right = copy_from(x->right, y);
       p = y;
@@ -1674,61 +2406,140 @@ rb_tree<T, Compare>::copy_from(base_ptr x, base_ptr p)
   return top;
 }
 
+// M_split 函数
+// 把以 x 为根的独立子树（根为黑色或空，黑高为 h）分成两颗独立的子树，
+// 键值小于 key 的节点放入 l，其余放入 r，黑高分别写入 lh 与 rh。
+// 沿查找 key 的路径向下，把路径两侧摘下的子树依次与路径上的节点 join 起来，
+// 每次 join 的代价为两侧黑高之差，沿路径累加后总的时间复杂度为 O(log n)
+template <class T, class Compare, bool OrderStat>
+void rb_tree<T, Compare, OrderStat>::
+M_split(base_ptr x, size_type h, const key_type& key,
+        base_ptr& l, size_type& lh, base_ptr& r, size_type& rh)
+{
+  if (x == nullptr)
+  {
+    l = r = nullptr;
+    lh = rh = 0;
+    return;
+  }
+  // 摘下 x 的两个子树，红色的子树根染成黑色，黑高加一
+  base_ptr child[2] = { x->left, x->right };
+  size_type child_h[2] = { h - 1, h - 1 };
+  for (int i = 0; i < 2; ++i)
+  {
+    if (child[i] == nullptr)
+      continue;
+    child[i]->set_parent(nullptr);
+    if (rb_tree_is_red(child[i]))
+    {
+      rb_tree_set_black(child[i]);
+      child_h[i] = h;
+    }
+  }
+  if (key_comp_(value_traits::get_key(x->get_node_ptr()->value), key))
+  { // x 小于 key，x 与左子树都放入 l，继续分右子树
+    base_ptr rl = nullptr;
+    size_type rlh = 0;
+    M_split(child[1], child_h[1], key, rl, rlh, r, rh);
+    l = rb_tree_join(child[0], child_h[0], x, rl, rlh, lh, augment_type());
+  }
+  else
+  { // x 不小于 key，x 与右子树都放入 r，继续分左子树
+    base_ptr lr = nullptr;
+    size_type lrh = 0;
+    M_split(child[0], child_h[0], key, l, lh, lr, lrh);
+    r = rb_tree_join(lr, lrh, x, child[1], child_h[1], rh, augment_type());
+  }
+}
+
+// attach_root 函数
+// 让独立的子树 x 成为整颗树，x 可以为空
+template <class T, class Compare, bool OrderStat>
+void rb_tree<T, Compare, OrderStat>::
+attach_root(base_ptr x)
+{
+  set_root(x);
+  if (x == nullptr)
+  {
+    leftmost() = header_;
+    rightmost() = header_;
+    return;
+  }
+  x->set_parent(header_);
+  leftmost() = rb_tree_min(x);
+  rightmost() = rb_tree_max(x);
+}
+
 // erase_since 函数
-// 从 x 节点开始删除该节点及其子树
-template <class T, class Compare>
-void rb_tree<T, Compare>::
+// 从 x 节点开始删除该节点及其子树，返回删除的节点数
+// 有左子节点时先右旋，把左子树逐步转到右链上，节点按中序释放，不需要递归，
+// 按顺序插入的节点在内存中也大致按顺序排列，中序释放时访存更连续
+template <class T, class Compare, bool OrderStat>
+typename rb_tree<T, Compare, OrderStat>::size_type
+rb_tree<T, Compare, OrderStat>::
 erase_since(base_ptr x)
 {
+  size_type n = 0;
   while (x != nullptr)
   {
-    erase_since(x->right);
-    auto y = x->left;
-    destroy_node(x->get_node_ptr());
-    x = y;
+    if (x->left != nullptr)
+    {
+      auto y = x->left;
+      x->left = y->right;
+      y->right = x;
+      x = y;
+    }
+    else
+    {
+      auto y = x->right;
+      destroy_node(x->get_node_ptr());
+      x = y;
+      ++n;
+    }
   }
+  return n;
 }
 
 // 重载比较操作符
-template <class T, class Compare>
-bool operator==(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs)
+template <class T, class Compare, bool OrderStat>
+bool operator==(const rb_tree<T, Compare, OrderStat>& lhs, const rb_tree<T, Compare, OrderStat>& rhs)
 {
   return lhs.size() == rhs.size() && mystl::equal(lhs.begin(), lhs.end(), rhs.begin());
 }
 
-template <class T, class Compare>
-bool operator<(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs)
+template <class T, class Compare, bool OrderStat>
+bool operator<(const rb_tree<T, Compare, OrderStat>& lhs, const rb_tree<T, Compare, OrderStat>& rhs)
 {
   return mystl::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
 }
 
-template <class T, class Compare>
-bool operator!=(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs)
+template <class T, class Compare, bool OrderStat>
+bool operator!=(const rb_tree<T, Compare, OrderStat>& lhs, const rb_tree<T, Compare, OrderStat>& rhs)
 {
   return !(lhs == rhs);
 }
 
-template <class T, class Compare>
-bool operator>(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs)
+template <class T, class Compare, bool OrderStat>
+bool operator>(const rb_tree<T, Compare, OrderStat>& lhs, const rb_tree<T, Compare, OrderStat>& rhs)
 {
   return rhs < lhs;
 }
 
-template <class T, class Compare>
-bool operator<=(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs)
+template <class T, class Compare, bool OrderStat>
+bool operator<=(const rb_tree<T, Compare, OrderStat>& lhs, const rb_tree<T, Compare, OrderStat>& rhs)
 {
   return !(rhs < lhs);
 }
 
-template <class T, class Compare>
-bool operator>=(const rb_tree<T, Compare>& lhs, const rb_tree<T, Compare>& rhs)
+template <class T, class Compare, bool OrderStat>
+bool operator>=(const rb_tree<T, Compare, OrderStat>& lhs, const rb_tree<T, Compare, OrderStat>& rhs)
 {
   return !(lhs < rhs);
 }
 
 // 重载 mystl 的 swap
-template <class T, class Compare>
-void swap(rb_tree<T, Compare>& lhs, rb_tree<T, Compare>& rhs) noexcept
+template <class T, class Compare, bool OrderStat>
+void swap(rb_tree<T, Compare, OrderStat>& lhs, rb_tree<T, Compare, OrderStat>& rhs) noexcept
 {
   lhs.swap(rhs);
 }
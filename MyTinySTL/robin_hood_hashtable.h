@@ -0,0 +1,882 @@
+﻿#ifndef MYTINYSTL_ROBIN_HOOD_HASHTABLE_H_
+#define MYTINYSTL_ROBIN_HOOD_HASHTABLE_H_
+
+// 这个头文件包含了一个模板类 robin_hood_hashtable
+// robin_hood_hashtable : 使用 robin hood 线性探测的开放寻址哈希表，元素与它的探测距离一起存放在槽位中
+
+// notes:
+//
+// 1. 每个槽位记录元素到理想位置（home）的距离加一，0 表示空槽位；插入时若遇到距离比自己小的元素，
+//    就把新元素放在那里，后面的元素依次后移一格，使同一段连续槽位中的元素按理想位置有序
+// 2. 由于 1 的不变式，查找时一旦遇到距离比当前探测距离小的槽位（包括空槽位）就可以停止，不命中的查找也很短
+// 3. 删除元素时不留墓碑，而是把后面距离大于一的元素依次前移一格（backward shift），
+//    所以不会因为反复插入删除而变慢
+// 4. 容量为 2 的幂，在容量之后还有一段溢出区，探测不会绕回表头；探测距离的上限为溢出区的长度
+//    （不超过 128），插入时超过上限就提前扩容，所以最坏的探测长度是确定的
+// 5. 最大装载因子默认为 0.9，可以设置为 (0, 1] 之间的值
+// 6. 插入、删除元素或者 rehash 都可能移动其他元素，使所有迭代器、指针和引用失效
+// 7. 哈希函数很差（表已经很稀疏，探测距离仍然超过上限）时，插入会抛出 runtime_error
+//
+// 异常保证：
+// mystl::robin_hood_hashtable<T> 满足基本异常保证，若元素的移动构造函数不抛出异常，插入操作满足强异常安全保证
+
+#include <initializer_list>
+
+#include "hashtable.h"
+
+namespace mystl
+{
+
+// 探测距离的上限，也是溢出区长度的上限
+static constexpr size_t robin_ht_max_probe = 128;
+
+// 槽位：探测距离与元素放在一起，查找时只需读一个位置
+template <class T>
+struct robin_ht_slot
+{
+  uint8_t dist;  // 到理想位置的距离加一，0 表示空槽位
+  union
+  {
+    T value;
+  };
+
+  explicit robin_ht_slot(uint8_t d = 0) noexcept :dist(d) {}
+  ~robin_ht_slot() {}
+};
+
+// 所有空表共用的哨兵槽位，距离不为 0，迭代时立即停止
+template <class T>
+inline robin_ht_slot<T>* robin_ht_empty_slot() noexcept
+{
+  static robin_ht_slot<T> sentinel(1);
+  return &sentinel;
+}
+
+// forward declaration
+
+template <class T, class Hash, class KeyEqual>
+class robin_hood_hashtable;
+
+template <class T>
+struct robin_ht_iterator;
+
+template <class T>
+struct robin_ht_const_iterator;
+
+// robin_ht_iterator
+
+template <class T>
+struct robin_ht_iterator_base :public mystl::iterator<mystl::forward_iterator_tag, T>
+{
+  typedef robin_ht_iterator_base<T>         base;
+  typedef mystl::robin_ht_iterator<T>       iterator;
+  typedef mystl::robin_ht_const_iterator<T> const_iterator;
+  typedef robin_ht_slot<T>                  slot_type;
+
+  typedef size_t                            size_type;
+  typedef ptrdiff_t                         difference_type;
+
+  slot_type* slot;  // 当前槽位
+
+  robin_ht_iterator_base() = default;
+  explicit robin_ht_iterator_base(slot_type* s) :slot(s) {}
+
+  bool operator==(const base& rhs) const { return slot == rhs.slot; }
+  bool operator!=(const base& rhs) const { return slot != rhs.slot; }
+
+  // 前进到下一个有元素的槽位，没有则停在哨兵处
+  void skip_empty_slots()
+  {
+    while (slot->dist == 0)
+      ++slot;
+  }
+
+  void incr()
+  {
+    MYSTL_DEBUG(slot->dist != 0);
+    ++slot;
+    skip_empty_slots();
+  }
+};
+
+template <class T>
+struct robin_ht_iterator :public robin_ht_iterator_base<T>
+{
+  typedef robin_ht_iterator_base<T>     base;
+  typedef typename base::iterator       iterator;
+  typedef typename base::const_iterator const_iterator;
+  typedef typename base::slot_type      slot_type;
+
+  typedef T                             value_type;
+  typedef value_type*                   pointer;
+  typedef value_type&                   reference;
+
+  using base::slot;
+
+  robin_ht_iterator() = default;
+  explicit robin_ht_iterator(slot_type* s) :base(s) {}
+
+  reference operator*()  const { return slot->value; }
+  pointer   operator->() const { return &(operator*()); }
+
+  iterator& operator++()
+  {
+    this->incr();
+    return *this;
+  }
+  iterator operator++(int)
+  {
+    iterator tmp = *this;
+    this->incr();
+    return tmp;
+  }
+};
+
+template <class T>
+struct robin_ht_const_iterator :public robin_ht_iterator_base<T>
+{
+  typedef robin_ht_iterator_base<T>     base;
+  typedef typename base::iterator       iterator;
+  typedef typename base::const_iterator const_iterator;
+  typedef typename base::slot_type      slot_type;
+
+  typedef T                             value_type;
+  typedef const value_type*             pointer;
+  typedef const value_type&             reference;
+
+  using base::slot;
+
+  robin_ht_const_iterator() = default;
+  explicit robin_ht_const_iterator(slot_type* s) :base(s) {}
+  robin_ht_const_iterator(const iterator& rhs) :base(rhs.slot) {}
+
+  reference operator*()  const { return slot->value; }
+  pointer   operator->() const { return &(operator*()); }
+
+  const_iterator& operator++()
+  {
+    this->incr();
+    return *this;
+  }
+  const_iterator operator++(int)
+  {
+    const_iterator tmp = *this;
+    this->incr();
+    return tmp;
+  }
+};
+
+// 模板类 robin_hood_hashtable
+// 参数一代表数据类型，参数二代表哈希函数，参数三代表键值相等的比较函数
+template <class T, class Hash, class KeyEqual>
+class robin_hood_hashtable
+{
+public:
+  // robin_hood_hashtable 的型别定义
+  typedef ht_value_traits<T>                       value_traits;
+  typedef typename value_traits::key_type          key_type;
+  typedef typename value_traits::mapped_type       mapped_type;
+  typedef typename value_traits::value_type        value_type;
+  typedef Hash                                     hasher;
+  typedef KeyEqual                                 key_equal;
+
+  typedef robin_ht_slot<T>                         slot_type;
+  typedef mystl::allocator<T>                      allocator_type;
+  typedef mystl::allocator<T>                      data_allocator;
+  typedef mystl::allocator<slot_type>              slot_allocator;
+
+  typedef typename allocator_type::pointer         pointer;
+  typedef typename allocator_type::const_pointer   const_pointer;
+  typedef typename allocator_type::reference       reference;
+  typedef typename allocator_type::const_reference const_reference;
+  typedef typename allocator_type::size_type       size_type;
+  typedef typename allocator_type::difference_type difference_type;
+
+  typedef mystl::robin_ht_iterator<T>              iterator;
+  typedef mystl::robin_ht_const_iterator<T>        const_iterator;
+
+  allocator_type get_allocator() const { return allocator_type(); }
+
+private:
+  // 槽位为 [slots_, slots_ + capacity_ + overflow_)，之后是一个哨兵槽位
+  slot_type* slots_;
+  size_type  capacity_;  // 理想位置的个数，为 0 或不小于 16 的 2 的幂
+  size_type  overflow_;  // 溢出区的长度，也是探测距离的上限
+  size_type  size_;
+  float      mlf_;
+  hasher     hash_;
+  key_equal  equal_;
+
+public:
+  // 构造、复制、移动、析构函数
+  explicit robin_hood_hashtable(size_type bucket_count = 0,
+                                const Hash& hash = Hash(),
+                                const KeyEqual& equal = KeyEqual())
+    :slots_(robin_ht_empty_slot<T>()), capacity_(0), overflow_(0), size_(0), mlf_(0.9f),
+     hash_(hash), equal_(equal)
+  {
+    if (bucket_count != 0)
+      resize(normalize_capacity(bucket_count));
+  }
+
+  robin_hood_hashtable(const robin_hood_hashtable& rhs)
+    :slots_(robin_ht_empty_slot<T>()), capacity_(0), overflow_(0), size_(0), mlf_(rhs.mlf_),
+     hash_(rhs.hash_), equal_(rhs.equal_)
+  {
+    copy_init(rhs);
+  }
+  robin_hood_hashtable(robin_hood_hashtable&& rhs) noexcept
+    :slots_(rhs.slots_), capacity_(rhs.capacity_), overflow_(rhs.overflow_), size_(rhs.size_),
+     mlf_(rhs.mlf_), hash_(rhs.hash_), equal_(rhs.equal_)
+  {
+    rhs.reset_empty();
+  }
+
+  robin_hood_hashtable& operator=(const robin_hood_hashtable& rhs)
+  {
+    if (this != &rhs)
+    {
+      robin_hood_hashtable tmp(rhs);
+      swap(tmp);
+    }
+    return *this;
+  }
+  robin_hood_hashtable& operator=(robin_hood_hashtable&& rhs) noexcept
+  {
+    robin_hood_hashtable tmp(mystl::move(rhs));
+    swap(tmp);
+    return *this;
+  }
+
+  ~robin_hood_hashtable()
+  {
+    destroy_slots();
+    deallocate(slots_, capacity_);
+  }
+
+  // 迭代器相关操作
+  iterator       begin()        noexcept
+  {
+    iterator it(slots_);
+    it.skip_empty_slots();
+    return it;
+  }
+  const_iterator begin()  const noexcept
+  {
+    const_iterator it(slots_);
+    it.skip_empty_slots();
+    return it;
+  }
+  iterator       end()          noexcept
+  { return iterator(slots_ + slot_count()); }
+  const_iterator end()    const noexcept
+  { return const_iterator(slots_ + slot_count()); }
+
+  const_iterator cbegin() const noexcept
+  { return begin(); }
+  const_iterator cend()   const noexcept
+  { return end(); }
+
+  // 容量相关操作
+  bool      empty()    const noexcept { return size_ == 0; }
+  size_type size()     const noexcept { return size_; }
+  size_type max_size() const noexcept { return static_cast<size_type>(-1) / sizeof(slot_type) / 2; }
+
+  // 修改容器相关操作
+
+  // emplace / emplace_hint
+
+  template <class ...Args>
+  pair<iterator, bool> emplace_unique(Args&& ...args);
+
+  // [note]: hint 对于开放寻址的哈希表没有意义，忽略
+  template <class ...Args>
+  iterator emplace_unique_use_hint(const_iterator /*hint*/, Args&& ...args)
+  { return emplace_unique(mystl::forward<Args>(args)...).first; }
+
+  // 键值为 key 的元素不存在时才用 args 构造元素，key 须与构造出的元素的键值相等
+  template <class ...Args>
+  pair<iterator, bool> emplace_key_unique(const key_type& key, Args&& ...args);
+
+  // insert
+
+  pair<iterator, bool> insert_unique(const value_type& value)
+  { return emplace_key_unique(value_traits::get_key(value), value); }
+  pair<iterator, bool> insert_unique(value_type&& value)
+  { return emplace_key_unique(value_traits::get_key(value), mystl::move(value)); }
+
+  iterator insert_unique_use_hint(const_iterator /*hint*/, const value_type& value)
+  { return insert_unique(value).first; }
+  iterator insert_unique_use_hint(const_iterator /*hint*/, value_type&& value)
+  { return insert_unique(mystl::move(value)).first; }
+
+  template <class InputIter>
+  void insert_unique(InputIter first, InputIter last)
+  { copy_insert_unique(first, last, iterator_category(first)); }
+
+  // erase / clear
+
+  void      erase(const_iterator position);
+  void      erase(const_iterator first, const_iterator last);
+
+  size_type erase_unique(const key_type& key);
+
+  void      clear();
+
+  void      swap(robin_hood_hashtable& rhs) noexcept;
+
+  // 查找相关操作
+
+  size_type count(const key_type& key) const
+  { return find_index(key, hash_mix(hash_(key))) != slot_count() ? 1 : 0; }
+
+  iterator       find(const key_type& key)
+  { return iterator(slots_ + find_index(key, hash_mix(hash_(key)))); }
+  const_iterator find(const key_type& key) const
+  { return const_iterator(slots_ + find_index(key, hash_mix(hash_(key)))); }
+
+  pair<iterator, iterator> equal_range_unique(const key_type& key);
+  pair<const_iterator, const_iterator> equal_range_unique(const key_type& key) const;
+
+  // 槽位相关操作
+  size_type bucket_count()     const noexcept { return capacity_; }
+  size_type max_bucket_count() const noexcept { return max_size(); }
+
+  // 命中的查找最多需要比较的槽位数
+  size_type max_probe_length() const noexcept;
+
+  // hash policy
+
+  float load_factor() const noexcept
+  { return capacity_ != 0 ? static_cast<float>(size_) / static_cast<float>(capacity_) : 0.0f; }
+
+  float max_load_factor() const noexcept
+  { return mlf_; }
+  void  max_load_factor(float ml)
+  {
+    THROW_OUT_OF_RANGE_IF(ml != ml || ml <= 0.0f || ml > 1.0f, "invalid hash load factor");
+    mlf_ = ml;
+    if (size_ > max_elements(capacity_))
+      resize(capacity_for(size_));
+  }
+
+  void rehash(size_type count);
+  void reserve(size_type count);
+
+  hasher    hash_fcn() const { return hash_; }
+  key_equal key_eq()   const { return equal_; }
+
+public:
+  bool equal_to_unique(const robin_hood_hashtable& other) const;
+
+private:
+  // robin_hood_hashtable 成员函数
+
+  // hash 相关
+  static size_t hash_mix(size_t h) noexcept;
+  size_type     home_of(size_t hash) const noexcept { return hash & (capacity_ - 1); }
+
+  // 容量相关
+  size_type slot_count() const noexcept { return capacity_ + overflow_; }
+  size_type max_elements(size_type capacity) const noexcept
+  { return static_cast<size_type>(static_cast<double>(capacity) * mlf_); }
+  static size_type normalize_capacity(size_type n) noexcept;
+  size_type capacity_for(size_type n) const noexcept;
+
+  // 内存相关
+  void      allocate(size_type capacity);
+  static void deallocate(slot_type* slots, size_type capacity) noexcept;
+  void      destroy_slots() noexcept;
+  void      reset_empty() noexcept;
+  void      copy_init(const robin_hood_hashtable& rhs);
+
+  // 探测相关
+  size_type find_index(const key_type& key, size_t hash) const;
+  template <class ...Args>
+  size_type place(size_t hash, Args&& ...args);
+  template <class ...Args>
+  size_type place_or_grow(size_t hash, Args&& ...args);
+  size_type shift_back(size_type hole) noexcept;
+  size_type erase_at(size_type index) noexcept;
+
+  // rehash
+  void      resize(size_type new_capacity);
+
+  template <class InputIter>
+  void copy_insert_unique(InputIter first, InputIter last, mystl::input_iterator_tag);
+  template <class ForwardIter>
+  void copy_insert_unique(ForwardIter first, ForwardIter last, mystl::forward_iterator_tag);
+};
+
+/*****************************************************************************************/
+
+// 就地构造元素，键值不允许重复
+template <class T, class Hash, class KeyEqual>
+template <class ...Args>
+pair<typename robin_hood_hashtable<T, Hash, KeyEqual>::iterator, bool>
+robin_hood_hashtable<T, Hash, KeyEqual>::
+emplace_unique(Args&& ...args)
+{ // 先构造出元素才能取得键值
+  value_type value(mystl::forward<Args>(args)...);
+  return emplace_key_unique(value_traits::get_key(value), mystl::move(value));
+}
+
+// 键值不存在时才构造元素
+template <class T, class Hash, class KeyEqual>
+template <class ...Args>
+pair<typename robin_hood_hashtable<T, Hash, KeyEqual>::iterator, bool>
+robin_hood_hashtable<T, Hash, KeyEqual>::
+emplace_key_unique(const key_type& key, Args&& ...args)
+{
+  const auto hash = hash_mix(hash_(key));
+  auto i = find_index(key, hash);
+  if (i != slot_count())
+    return mystl::make_pair(iterator(slots_ + i), false);
+  if (size_ + 1 > max_elements(capacity_))
+    resize(capacity_ == 0 ? 16 : capacity_ * 2);
+  i = place_or_grow(hash, mystl::forward<Args>(args)...);
+  return mystl::make_pair(iterator(slots_ + i), true);
+}
+
+// 删除迭代器所指的元素
+template <class T, class Hash, class KeyEqual>
+void robin_hood_hashtable<T, Hash, KeyEqual>::
+erase(const_iterator position)
+{
+  MYSTL_DEBUG(position != cend());
+  erase_at(static_cast<size_type>(position.slot - slots_));
+}
+
+// 删除[first, last)内的元素
+// 每次删除后，后面的元素可能前移一格：被删除的槽位可能又放入了区间内的下一个元素，
+// last 所指的元素也可能前移，所以要跟着调整区间的终点
+template <class T, class Hash, class KeyEqual>
+void robin_hood_hashtable<T, Hash, KeyEqual>::
+erase(const_iterator first, const_iterator last)
+{
+  auto i = static_cast<size_type>(first.slot - slots_);
+  auto e = static_cast<size_type>(last.slot - slots_);
+  while (i < e)
+  {
+    if (slots_[i].dist == 0)
+    {
+      ++i;
+      continue;
+    }
+    const auto hole = erase_at(i);
+    if (e <= hole)
+      --e;
+  }
+}
+
+// 删除键值为 key 的元素
+template <class T, class Hash, class KeyEqual>
+typename robin_hood_hashtable<T, Hash, KeyEqual>::size_type
+robin_hood_hashtable<T, Hash, KeyEqual>::
+erase_unique(const key_type& key)
+{
+  const auto i = find_index(key, hash_mix(hash_(key)));
+  if (i == slot_count())
+    return 0;
+  erase_at(i);
+  return 1;
+}
+
+// 清空所有元素，保留内存
+template <class T, class Hash, class KeyEqual>
+void robin_hood_hashtable<T, Hash, KeyEqual>::
+clear()
+{
+  destroy_slots();
+  for (size_type i = 0, n = slot_count(); i < n; ++i)
+    slots_[i].dist = 0;
+  size_ = 0;
+}
+
+// 在某些情况下，会重新对元素进行一遍哈希，插入到新的位置
+template <class T, class Hash, class KeyEqual>
+void robin_hood_hashtable<T, Hash, KeyEqual>::
+rehash(size_type count)
+{
+  auto n = mystl::max(normalize_capacity(count), capacity_for(size_));
+  if (size_ == 0 && count == 0)
+    n = 0;
+  if (n != capacity_)
+    resize(n);
+}
+
+// 预留至少能放下 count 个元素的空间
+template <class T, class Hash, class KeyEqual>
+void robin_hood_hashtable<T, Hash, KeyEqual>::
+reserve(size_type count)
+{
+  if (count > max_elements(capacity_))
+    resize(capacity_for(count));
+}
+
+// 交换 robin_hood_hashtable
+template <class T, class Hash, class KeyEqual>
+void robin_hood_hashtable<T, Hash, KeyEqual>::
+swap(robin_hood_hashtable& rhs) noexcept
+{
+  if (this != &rhs)
+  {
+    mystl::swap(slots_, rhs.slots_);
+    mystl::swap(capacity_, rhs.capacity_);
+    mystl::swap(overflow_, rhs.overflow_);
+    mystl::swap(size_, rhs.size_);
+    mystl::swap(mlf_, rhs.mlf_);
+    mystl::swap(hash_, rhs.hash_);
+    mystl::swap(equal_, rhs.equal_);
+  }
+}
+
+// 查找与键值 key 相等的区间，返回一个 pair，指向相等区间的首尾
+template <class T, class Hash, class KeyEqual>
+pair<typename robin_hood_hashtable<T, Hash, KeyEqual>::iterator,
+     typename robin_hood_hashtable<T, Hash, KeyEqual>::iterator>
+robin_hood_hashtable<T, Hash, KeyEqual>::
+equal_range_unique(const key_type& key)
+{
+  auto first = find(key);
+  if (first == end())
+    return mystl::make_pair(first, first);
+  auto last = first;
+  return mystl::make_pair(first, ++last);
+}
+
+template <class T, class Hash, class KeyEqual>
+pair<typename robin_hood_hashtable<T, Hash, KeyEqual>::const_iterator,
+     typename robin_hood_hashtable<T, Hash, KeyEqual>::const_iterator>
+robin_hood_hashtable<T, Hash, KeyEqual>::
+equal_range_unique(const key_type& key) const
+{
+  auto first = find(key);
+  if (first == cend())
+    return mystl::make_pair(first, first);
+  auto last = first;
+  return mystl::make_pair(first, ++last);
+}
+
+// 所有元素中最大的探测距离
+template <class T, class Hash, class KeyEqual>
+typename robin_hood_hashtable<T, Hash, KeyEqual>::size_type
+robin_hood_hashtable<T, Hash, KeyEqual>::
+max_probe_length() const noexcept
+{
+  size_type result = 0;
+  for (size_type i = 0, n = slot_count(); i < n; ++i)
+    result = mystl::max(result, static_cast<size_type>(slots_[i].dist));
+  return result;
+}
+
+// 两个表含有相同的元素时相等，与元素的排列顺序无关
+template <class T, class Hash, class KeyEqual>
+bool robin_hood_hashtable<T, Hash, KeyEqual>::
+equal_to_unique(const robin_hood_hashtable& other) const
+{
+  if (size_ != other.size_)
+    return false;
+  for (auto it = begin(), last = end(); it != last; ++it)
+  {
+    auto res = other.find(value_traits::get_key(*it));
+    if (res == other.end() || !(*res == *it))
+      return false;
+  }
+  return true;
+}
+
+/*****************************************************************************************/
+// helper function
+
+// 打散哈希值，使低位分布均匀，整数的哈希值等于自身时也能正常工作
+// 线性探测对聚集很敏感，64 位时用 128 位乘积的两半异或，每一位都与输入的所有位有关
+template <class T, class Hash, class KeyEqual>
+size_t robin_hood_hashtable<T, Hash, KeyEqual>::
+hash_mix(size_t h) noexcept
+{
+#ifdef SYSTEM_64
+  return static_cast<size_t>(mystl::wy_mix(h, 0x9e3779b97f4a7c15ull));
+#else
+  h *= 0x9e3779b9u;
+  return h ^ (h >> 16);
+#endif
+}
+
+// 把 n 调整为合法的容量：0，或者不小于 n 与 16 的 2 的幂
+template <class T, class Hash, class KeyEqual>
+typename robin_hood_hashtable<T, Hash, KeyEqual>::size_type
+robin_hood_hashtable<T, Hash, KeyEqual>::
+normalize_capacity(size_type n) noexcept
+{
+  if (n == 0)
+    return 0;
+  size_type capacity = 16;
+  while (capacity < n)
+    capacity <<= 1;
+  return capacity;
+}
+
+// 按当前的最大装载因子，放下 n 个元素所需的最小容量
+template <class T, class Hash, class KeyEqual>
+typename robin_hood_hashtable<T, Hash, KeyEqual>::size_type
+robin_hood_hashtable<T, Hash, KeyEqual>::
+capacity_for(size_type n) const noexcept
+{
+  if (n == 0)
+    return 0;
+  size_type capacity = 16;
+  while (max_elements(capacity) < n)
+    capacity <<= 1;
+  return capacity;
+}
+
+// 分配 capacity 个理想位置与溢出区，所有槽位置为空，不改变 size_
+// 溢出区不短于容量时，任何元素都放得下，所以小表不会因为探测距离而扩容
+template <class T, class Hash, class KeyEqual>
+void robin_hood_hashtable<T, Hash, KeyEqual>::
+allocate(size_type capacity)
+{
+  const auto overflow = mystl::min(capacity, static_cast<size_type>(robin_ht_max_probe));
+  const auto n = capacity + overflow;
+  slots_ = slot_allocator::allocate(n + 1);
+  capacity_ = capacity;
+  overflow_ = overflow;
+  for (size_type i = 0; i < n; ++i)
+    slots_[i].dist = 0;
+  slots_[n].dist = 1;
+}
+
+template <class T, class Hash, class KeyEqual>
+void robin_hood_hashtable<T, Hash, KeyEqual>::
+deallocate(slot_type* slots, size_type capacity) noexcept
+{
+  if (capacity != 0)
+    slot_allocator::deallocate(slots);
+}
+
+// 析构所有元素，不改变槽位的距离
+template <class T, class Hash, class KeyEqual>
+void robin_hood_hashtable<T, Hash, KeyEqual>::
+destroy_slots() noexcept
+{
+  if (size_ == 0)
+    return;
+  for (size_type i = 0, n = slot_count(); i < n; ++i)
+  {
+    if (slots_[i].dist != 0)
+      data_allocator::destroy(&slots_[i].value);
+  }
+}
+
+// 变为不占用内存的空表，不释放原来的内存
+template <class T, class Hash, class KeyEqual>
+void robin_hood_hashtable<T, Hash, KeyEqual>::
+reset_empty() noexcept
+{
+  slots_ = robin_ht_empty_slot<T>();
+  capacity_ = 0;
+  overflow_ = 0;
+  size_ = 0;
+}
+
+// 复制 rhs 的元素，容量相同时每个元素都放在原来的槽位上，不需要重新探测
+template <class T, class Hash, class KeyEqual>
+void robin_hood_hashtable<T, Hash, KeyEqual>::
+copy_init(const robin_hood_hashtable& rhs)
+{
+  if (rhs.size_ == 0)
+    return;
+  allocate(rhs.capacity_);
+  try
+  {
+    for (size_type i = 0, n = slot_count(); i < n; ++i)
+    {
+      if (rhs.slots_[i].dist != 0)
+      {
+        data_allocator::construct(&slots_[i].value, rhs.slots_[i].value);
+        slots_[i].dist = rhs.slots_[i].dist;
+        ++size_;
+      }
+    }
+  }
+  catch (...)
+  {
+    destroy_slots();
+    deallocate(slots_, capacity_);
+    reset_empty();
+    throw;
+  }
+}
+
+// 查找键值为 key 的元素所在的槽位，没有则返回 slot_count()
+// 槽位中的距离小于当前的探测距离时，key 不可能出现在更后面，可以提前结束
+template <class T, class Hash, class KeyEqual>
+typename robin_hood_hashtable<T, Hash, KeyEqual>::size_type
+robin_hood_hashtable<T, Hash, KeyEqual>::
+find_index(const key_type& key, size_t hash) const
+{
+  if (size_ == 0)
+    return slot_count();
+  auto i = home_of(hash);
+  for (size_type dist = 1; dist <= slots_[i].dist; ++i, ++dist)
+  {
+    if (slots_[i].dist == dist && equal_(value_traits::get_key(slots_[i].value), key))
+      return i;
+  }
+  return slot_count();
+}
+
+// 用 args 构造一个哈希值为 hash 的新元素，不检查键值是否已经存在，返回元素所在的槽位
+// 探测距离会超过上限时不做任何修改，返回 slot_count()
+template <class T, class Hash, class KeyEqual>
+template <class ...Args>
+typename robin_hood_hashtable<T, Hash, KeyEqual>::size_type
+robin_hood_hashtable<T, Hash, KeyEqual>::
+place(size_t hash, Args&& ...args)
+{
+  const auto n = slot_count();
+  // 第一个距离比新元素小的槽位就是新元素的位置
+  auto i = home_of(hash);
+  size_type dist = 1;
+  for (; dist <= slots_[i].dist; ++i, ++dist)
+  {
+  }
+  if (dist > overflow_)
+    return n;
+  // 从 i 开始到下一个空槽位之前的元素都要后移一格，距离加一
+  auto j = i;
+  for (; slots_[j].dist != 0; ++j)
+  {
+    if (slots_[j].dist >= overflow_)
+      return n;
+  }
+  MYSTL_DEBUG(j < n);
+  for (; j != i; --j)
+  {
+    data_allocator::construct(&slots_[j].value, mystl::move(slots_[j - 1].value));
+    slots_[j].dist = static_cast<uint8_t>(slots_[j - 1].dist + 1);
+    data_allocator::destroy(&slots_[j - 1].value);
+  }
+  slots_[i].dist = 0;
+  try
+  {
+    data_allocator::construct(&slots_[i].value, mystl::forward<Args>(args)...);
+  }
+  catch (...)
+  { // 把后移的元素移回去
+    shift_back(i);
+    throw;
+  }
+  slots_[i].dist = static_cast<uint8_t>(dist);
+  ++size_;
+  return i;
+}
+
+// 放入新元素，探测距离超过上限时扩容后重试
+template <class T, class Hash, class KeyEqual>
+template <class ...Args>
+typename robin_hood_hashtable<T, Hash, KeyEqual>::size_type
+robin_hood_hashtable<T, Hash, KeyEqual>::
+place_or_grow(size_t hash, Args&& ...args)
+{
+  for (;;)
+  {
+    const auto i = place(hash, mystl::forward<Args>(args)...);
+    if (i != slot_count())
+      return i;
+    THROW_RUNTIME_ERROR_IF(size_ < capacity_ / 8,
+                           "robin_hood_hashtable's probe length overflows, the hash function is too poor");
+    resize(capacity_ * 2);
+  }
+}
+
+// 槽位 hole 已经空出，把后面距离大于一的元素依次前移一格，返回最后空出的槽位
+template <class T, class Hash, class KeyEqual>
+typename robin_hood_hashtable<T, Hash, KeyEqual>::size_type
+robin_hood_hashtable<T, Hash, KeyEqual>::
+shift_back(size_type hole) noexcept
+{
+  for (; slots_[hole + 1].dist > 1; ++hole)
+  {
+    data_allocator::construct(&slots_[hole].value, mystl::move(slots_[hole + 1].value));
+    slots_[hole].dist = static_cast<uint8_t>(slots_[hole + 1].dist - 1);
+    data_allocator::destroy(&slots_[hole + 1].value);
+  }
+  slots_[hole].dist = 0;
+  return hole;
+}
+
+// 删除槽位 index 中的元素，返回最后空出的槽位
+template <class T, class Hash, class KeyEqual>
+typename robin_hood_hashtable<T, Hash, KeyEqual>::size_type
+robin_hood_hashtable<T, Hash, KeyEqual>::
+erase_at(size_type index) noexcept
+{
+  MYSTL_DEBUG(slots_[index].dist != 0);
+  data_allocator::destroy(&slots_[index].value);
+  --size_;
+  return shift_back(index);
+}
+
+// 把所有元素移动到容量为 new_capacity 的新内存中
+// 新表中的探测距离超过上限时，先把已经移过去的元素再移到更大的表中，然后继续
+template <class T, class Hash, class KeyEqual>
+void robin_hood_hashtable<T, Hash, KeyEqual>::
+resize(size_type new_capacity)
+{
+  auto old_slots = slots_;
+  const auto old_capacity = capacity_;
+  const auto old_count = slot_count();
+  const auto n = size_;
+  if (new_capacity == 0)
+    reset_empty();
+  else
+    allocate(new_capacity);
+  size_ = 0;
+  for (size_type i = 0; i < old_count; ++i)
+  {
+    if (old_slots[i].dist != 0)
+    {
+      auto& value = old_slots[i].value;
+      const auto hash = hash_mix(hash_(value_traits::get_key(value)));
+      while (place(hash, mystl::move(value)) == slot_count())
+        resize(capacity_ * 2);
+      data_allocator::destroy(&value);
+    }
+  }
+  MYSTL_DEBUG(size_ == n);
+  (void)n;
+  deallocate(old_slots, old_capacity);
+}
+
+// 插入 [first, last) 内的元素
+template <class T, class Hash, class KeyEqual>
+template <class InputIter>
+void robin_hood_hashtable<T, Hash, KeyEqual>::
+copy_insert_unique(InputIter first, InputIter last, mystl::input_iterator_tag)
+{
+  for (; first != last; ++first)
+    insert_unique(*first);
+}
+
+template <class T, class Hash, class KeyEqual>
+template <class ForwardIter>
+void robin_hood_hashtable<T, Hash, KeyEqual>::
+copy_insert_unique(ForwardIter first, ForwardIter last, mystl::forward_iterator_tag)
+{
+  reserve(size_ + static_cast<size_type>(mystl::distance(first, last)));
+  for (; first != last; ++first)
+    insert_unique(*first);
+}
+
+// 重载 mystl 的 swap
+template <class T, class Hash, class KeyEqual>
+void swap(robin_hood_hashtable<T, Hash, KeyEqual>& lhs,
+          robin_hood_hashtable<T, Hash, KeyEqual>& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+
+} // namespace mystl
+#endif // !MYTINYSTL_ROBIN_HOOD_HASHTABLE_H_
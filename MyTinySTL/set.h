@@ -18,9 +18,15 @@
 namespace mystl
 {
 
+// forward declaration
+
+template <class Key, class Compare, bool OrderStat>
+class multiset;
+
 // 模板类 set，键值不允许重复
-// 参数一代表键值类型，参数二代表键值比较方式，缺省使用 mystl::less 
-template <class Key, class Compare = mystl::less<Key>>
+// 参数一代表键值类型，参数二代表键值比较方式，缺省使用 mystl::less，
+// 参数三表示是否维护顺序统计，为 true 时支持 find_by_order 与 order_of_key
+template <class Key, class Compare = mystl::less<Key>, bool OrderStat = false>
 class set
 {
 public:
@@ -31,12 +37,15 @@ public:
 
 private:
   // 以 mystl::rb_tree 作为底层机制
-  typedef mystl::rb_tree<value_type, key_compare>  base_type;
+  typedef mystl::rb_tree<value_type, key_compare, OrderStat> base_type;
   base_type tree_;
 
+  friend class multiset<Key, Compare, OrderStat>;
+
 public:
   // 使用 rb_tree 定义的型别
-  typedef typename base_type::node_type              node_type;
+  typedef typename base_type::node_handle_type       node_type;
+  typedef typename base_type::insert_return_type     insert_return_type;
   typedef typename base_type::const_pointer          pointer;
   typedef typename base_type::const_pointer          const_pointer;
   typedef typename base_type::const_reference        reference;
@@ -171,6 +180,23 @@ public:
 
   void      clear() { tree_.clear(); }
 
+  // 节点句柄，摘下、重新插入节点与合并容器都不分配也不释放节点
+
+  node_type          extract(iterator position)   { return tree_.extract(position); }
+  node_type          extract(const key_type& key) { return tree_.extract(key); }
+
+  insert_return_type insert(node_type&& nh)
+  {
+    return tree_.insert_unique(mystl::move(nh));
+  }
+  iterator           insert(iterator /*hint*/, node_type&& nh)
+  {
+    return tree_.insert_unique(mystl::move(nh)).position;
+  }
+
+  void merge(set& other)                               { tree_.merge_unique(other.tree_); }
+  void merge(multiset<Key, Compare, OrderStat>& other) { tree_.merge_unique(other.tree_); }
+
   // set 相关操作
 
   iterator       find(const key_type& key)              { return tree_.find(key); }
@@ -192,6 +218,45 @@ public:
     equal_range(const key_type& key) const
   { return tree_.equal_range_unique(key); }
 
+  // 顺序统计，OrderStat 为 true 时可用，时间复杂度为 O(log n)
+
+  // 第 k 小的元素（从 0 开始），k >= size() 时返回 end()
+  iterator       find_by_order(size_type k)              { return tree_.select(k); }
+  const_iterator find_by_order(size_type k)        const { return tree_.select(k); }
+
+  // 键值小于 key 的元素个数
+  size_type      order_of_key(const key_type& key) const { return tree_.rank(key); }
+
+  // 透明查找，Compare 定义了 is_transparent 时可用
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  iterator       find(const K& key)              { return tree_.find(key); }
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  const_iterator find(const K& key)        const { return tree_.find(key); }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  size_type      count(const K& key)       const { return tree_.count_unique(key); }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  iterator       lower_bound(const K& key)       { return tree_.lower_bound(key); }
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  const_iterator lower_bound(const K& key) const { return tree_.lower_bound(key); }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  iterator       upper_bound(const K& key)       { return tree_.upper_bound(key); }
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  const_iterator upper_bound(const K& key) const { return tree_.upper_bound(key); }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  pair<iterator, iterator>
+    equal_range(const K& key)
+  { return tree_.equal_range_unique(key); }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  pair<const_iterator, const_iterator>
+    equal_range(const K& key) const
+  { return tree_.equal_range_unique(key); }
+
   void swap(set& rhs) noexcept
   { tree_.swap(rhs.tree_); }
 
@@ -201,45 +266,45 @@ public:
 };
 
 // 重载比较操作符
-template <class Key, class Compare>
-bool operator==(const set<Key, Compare>& lhs, const set<Key, Compare>& rhs)
+template <class Key, class Compare, bool OrderStat>
+bool operator==(const set<Key, Compare, OrderStat>& lhs, const set<Key, Compare, OrderStat>& rhs)
 {
   return lhs == rhs;
 }
 
-template <class Key, class Compare>
-bool operator<(const set<Key, Compare>& lhs, const set<Key, Compare>& rhs)
+template <class Key, class Compare, bool OrderStat>
+bool operator<(const set<Key, Compare, OrderStat>& lhs, const set<Key, Compare, OrderStat>& rhs)
 {
   return lhs < rhs;
 }
 
-template <class Key, class Compare>
-bool operator!=(const set<Key, Compare>& lhs, const set<Key, Compare>& rhs)
+template <class Key, class Compare, bool OrderStat>
+bool operator!=(const set<Key, Compare, OrderStat>& lhs, const set<Key, Compare, OrderStat>& rhs)
 {
   return !(lhs == rhs);
 }
 
-template <class Key, class Compare>
-bool operator>(const set<Key, Compare>& lhs, const set<Key, Compare>& rhs)
+template <class Key, class Compare, bool OrderStat>
+bool operator>(const set<Key, Compare, OrderStat>& lhs, const set<Key, Compare, OrderStat>& rhs)
 {
   return rhs < lhs;
 }
 
-template <class Key, class Compare>
-bool operator<=(const set<Key, Compare>& lhs, const set<Key, Compare>& rhs)
+template <class Key, class Compare, bool OrderStat>
+bool operator<=(const set<Key, Compare, OrderStat>& lhs, const set<Key, Compare, OrderStat>& rhs)
 {
   return !(rhs < lhs);
 }
 
-template <class Key, class Compare>
-bool operator>=(const set<Key, Compare>& lhs, const set<Key, Compare>& rhs)
+template <class Key, class Compare, bool OrderStat>
+bool operator>=(const set<Key, Compare, OrderStat>& lhs, const set<Key, Compare, OrderStat>& rhs)
 {
   return !(lhs < rhs);
 }
 
 // 重载 mystl 的 swap
-template <class Key, class Compare>
-void swap(set<Key, Compare>& lhs, set<Key, Compare>& rhs) noexcept
+template <class Key, class Compare, bool OrderStat>
+void swap(set<Key, Compare, OrderStat>& lhs, set<Key, Compare, OrderStat>& rhs) noexcept
 {
   lhs.swap(rhs);
 }
@@ -247,8 +312,9 @@ void swap(set<Key, Compare>& lhs, set<Key, Compare>& rhs) noexcept
 /*****************************************************************************************/
 
 // 模板类 multiset，键值允许重复
-// 参数一代表键值类型，参数二代表键值比较方式，缺省使用 mystl::less 
-template <class Key, class Compare = mystl::less<Key>>
+// 参数一代表键值类型，参数二代表键值比较方式，缺省使用 mystl::less，
+// 参数三表示是否维护顺序统计，为 true 时支持 find_by_order 与 order_of_key
+template <class Key, class Compare = mystl::less<Key>, bool OrderStat = false>
 class multiset
 {
 public:
@@ -259,12 +325,14 @@ public:
 
 private:
   // 以 mystl::rb_tree 作为底层机制
-  typedef mystl::rb_tree<value_type, key_compare>  base_type;
+  typedef mystl::rb_tree<value_type, key_compare, OrderStat> base_type;
   base_type tree_;  // 以 rb_tree 表现 multiset
 
+  friend class set<Key, Compare, OrderStat>;
+
 public:
   // 使用 rb_tree 定义的型别
-  typedef typename base_type::node_type              node_type;
+  typedef typename base_type::node_handle_type       node_type;
   typedef typename base_type::const_pointer          pointer;
   typedef typename base_type::const_pointer          const_pointer;
   typedef typename base_type::const_reference        reference;
@@ -399,6 +467,23 @@ public:
 
   void           clear() { tree_.clear(); }
 
+  // 节点句柄，摘下、重新插入节点与合并容器都不分配也不释放节点
+
+  node_type      extract(iterator position)   { return tree_.extract(position); }
+  node_type      extract(const key_type& key) { return tree_.extract(key); }
+
+  iterator       insert(node_type&& nh)
+  {
+    return tree_.insert_multi(mystl::move(nh));
+  }
+  iterator       insert(iterator /*hint*/, node_type&& nh)
+  {
+    return tree_.insert_multi(mystl::move(nh));
+  }
+
+  void merge(multiset& other)                     { tree_.merge_multi(other.tree_); }
+  void merge(set<Key, Compare, OrderStat>& other) { tree_.merge_multi(other.tree_); }
+
   // multiset 相关操作
 
   iterator       find(const key_type& key)              { return tree_.find(key); }
@@ -420,6 +505,45 @@ public:
     equal_range(const key_type& key) const
   { return tree_.equal_range_multi(key); }
 
+  // 顺序统计，OrderStat 为 true 时可用，时间复杂度为 O(log n)
+
+  // 第 k 小的元素（从 0 开始），k >= size() 时返回 end()
+  iterator       find_by_order(size_type k)              { return tree_.select(k); }
+  const_iterator find_by_order(size_type k)        const { return tree_.select(k); }
+
+  // 键值小于 key 的元素个数
+  size_type      order_of_key(const key_type& key) const { return tree_.rank(key); }
+
+  // 透明查找，Compare 定义了 is_transparent 时可用
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  iterator       find(const K& key)              { return tree_.find(key); }
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  const_iterator find(const K& key)        const { return tree_.find(key); }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  size_type      count(const K& key)       const { return tree_.count_multi(key); }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  iterator       lower_bound(const K& key)       { return tree_.lower_bound(key); }
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  const_iterator lower_bound(const K& key) const { return tree_.lower_bound(key); }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  iterator       upper_bound(const K& key)       { return tree_.upper_bound(key); }
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  const_iterator upper_bound(const K& key) const { return tree_.upper_bound(key); }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  pair<iterator, iterator>
+    equal_range(const K& key)
+  { return tree_.equal_range_multi(key); }
+
+  template <class K, class C = Compare, mystl::enable_if_transparent<C> = 0>
+  pair<const_iterator, const_iterator>
+    equal_range(const K& key) const
+  { return tree_.equal_range_multi(key); }
+
   void swap(multiset& rhs) noexcept
   { tree_.swap(rhs.tree_); }
 
@@ -429,45 +553,45 @@ public:
 };
 
 // 重载比较操作符
-template <class Key, class Compare>
-bool operator==(const multiset<Key, Compare>& lhs, const multiset<Key, Compare>& rhs)
+template <class Key, class Compare, bool OrderStat>
+bool operator==(const multiset<Key, Compare, OrderStat>& lhs, const multiset<Key, Compare, OrderStat>& rhs)
 {
   return lhs == rhs;
 }
 
-template <class Key, class Compare>
-bool operator<(const multiset<Key, Compare>& lhs, const multiset<Key, Compare>& rhs)
+template <class Key, class Compare, bool OrderStat>
+bool operator<(const multiset<Key, Compare, OrderStat>& lhs, const multiset<Key, Compare, OrderStat>& rhs)
 {
   return lhs < rhs;
 }
 
-template <class Key, class Compare>
-bool operator!=(const multiset<Key, Compare>& lhs, const multiset<Key, Compare>& rhs)
+template <class Key, class Compare, bool OrderStat>
+bool operator!=(const multiset<Key, Compare, OrderStat>& lhs, const multiset<Key, Compare, OrderStat>& rhs)
 {
   return !(lhs == rhs);
 }
 
-template <class Key, class Compare>
-bool operator>(const multiset<Key, Compare>& lhs, const multiset<Key, Compare>& rhs)
+template <class Key, class Compare, bool OrderStat>
+bool operator>(const multiset<Key, Compare, OrderStat>& lhs, const multiset<Key, Compare, OrderStat>& rhs)
 {
   return rhs < lhs;
 }
 
-template <class Key, class Compare>
-bool operator<=(const multiset<Key, Compare>& lhs, const multiset<Key, Compare>& rhs)
+template <class Key, class Compare, bool OrderStat>
+bool operator<=(const multiset<Key, Compare, OrderStat>& lhs, const multiset<Key, Compare, OrderStat>& rhs)
 {
   return !(rhs < lhs);
 }
 
-template <class Key, class Compare>
-bool operator>=(const multiset<Key, Compare>& lhs, const multiset<Key, Compare>& rhs)
+template <class Key, class Compare, bool OrderStat>
+bool operator>=(const multiset<Key, Compare, OrderStat>& lhs, const multiset<Key, Compare, OrderStat>& rhs)
 {
   return !(lhs < rhs);
 }
 
 // 重载 mystl 的 swap
-template <class Key, class Compare>
-void swap(multiset<Key, Compare>& lhs, multiset<Key, Compare>& rhs) noexcept
+template <class Key, class Compare, bool OrderStat>
+void swap(multiset<Key, Compare, OrderStat>& lhs, multiset<Key, Compare, OrderStat>& rhs) noexcept
 {
   lhs.swap(rhs);
 }
@@ -0,0 +1,201 @@
+﻿#ifndef MYTINYSTL_SIMD_H_
+#define MYTINYSTL_SIMD_H_
+
+// 这个头文件包含一些 SIMD 相关的宏与辅助函数，以及 char16_t / char32_t 字符串的向量化内核
+
+// notes:
+//
+// 1. 定义了 MYSTL_HAS_SSE2 表示可以使用 SSE2 指令，定义 MYSTL_NO_SIMD 可以关闭所有向量化路径
+// 2. 没有 SSE2 时，所有内核都退化为普通的循环
+// 3. length 使用对齐的 16 字节读取，读取不会跨越页边界，但可能会读到字符串起点之前与结尾之后、
+//    同一个 16 字节块内的字节，所以在 AddressSanitizer 下关闭对 length 的检测
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if !defined(MYSTL_NO_SIMD) && \
+  (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define MYSTL_HAS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// 开启 AddressSanitizer 时定义 MYSTL_HAS_ASAN
+#if defined(__SANITIZE_ADDRESS__)
+#define MYSTL_HAS_ASAN 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define MYSTL_HAS_ASAN 1
+#endif
+#endif
+
+// 关闭一个函数的 AddressSanitizer 检测
+#if defined(MYSTL_HAS_ASAN) && (defined(__GNUC__) || defined(__clang__))
+#define MYSTL_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#elif defined(MYSTL_HAS_ASAN) && defined(_MSC_VER)
+#define MYSTL_NO_SANITIZE_ADDRESS __declspec(no_sanitize_address)
+#else
+#define MYSTL_NO_SANITIZE_ADDRESS
+#endif
+
+// 预取一个地址所在的缓存行
+#if defined(__GNUC__) || defined(__clang__)
+#define MYSTL_PREFETCH(addr) __builtin_prefetch(static_cast<const void*>(addr))
+#elif defined(MYSTL_HAS_SSE2)
+#define MYSTL_PREFETCH(addr) _mm_prefetch(reinterpret_cast<const char*>(addr), _MM_HINT_T0)
+#else
+#define MYSTL_PREFETCH(addr) ((void)(addr))
+#endif
+
+namespace mystl
+{
+
+// 返回最低位的 1 所在的位置，x 不能为 0
+inline unsigned ctz32(uint32_t x) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<unsigned>(__builtin_ctz(x));
+#elif defined(_MSC_VER)
+  unsigned long r;
+  _BitScanForward(&r, x);
+  return static_cast<unsigned>(r);
+#else
+  unsigned r = 0;
+  for (; (x & 1u) == 0; x >>= 1)
+    ++r;
+  return r;
+#endif
+}
+
+inline unsigned ctz64(uint64_t x) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<unsigned>(__builtin_ctzll(x));
+#elif defined(_MSC_VER) && defined(_M_X64)
+  unsigned long r;
+  _BitScanForward64(&r, x);
+  return static_cast<unsigned>(r);
+#else
+  return static_cast<uint32_t>(x) != 0
+    ? ctz32(static_cast<uint32_t>(x))
+    : 32 + ctz32(static_cast<uint32_t>(x >> 32));
+#endif
+}
+
+#ifdef MYSTL_HAS_SSE2
+
+// 按元素宽度选择 SSE2 指令
+template <size_t Width>
+struct simd_lane {};
+
+template <>
+struct simd_lane<2>
+{
+  static __m128i cmpeq(__m128i a, __m128i b) noexcept { return _mm_cmpeq_epi16(a, b); }
+  static __m128i set1(uint32_t v) noexcept { return _mm_set1_epi16(static_cast<short>(v)); }
+};
+
+template <>
+struct simd_lane<4>
+{
+  static __m128i cmpeq(__m128i a, __m128i b) noexcept { return _mm_cmpeq_epi32(a, b); }
+  static __m128i set1(uint32_t v) noexcept { return _mm_set1_epi32(static_cast<int>(v)); }
+};
+
+#endif // MYSTL_HAS_SSE2
+
+/*****************************************************************************************/
+// simd_length
+// 计算以空字符结尾的字符串长度
+// 对齐的读取不会越过页边界，但会读到字符串之外的字节，因此对 AddressSanitizer 关闭检测
+/*****************************************************************************************/
+template <class CharType>
+MYSTL_NO_SANITIZE_ADDRESS
+size_t simd_length(const CharType* str) noexcept
+{
+#ifdef MYSTL_HAS_SSE2
+  typedef simd_lane<sizeof(CharType)> lane;
+  const auto addr = reinterpret_cast<uintptr_t>(str);
+  if (addr % sizeof(CharType) == 0)
+  { // 从 16 字节对齐的位置开始读，去掉起点之前的字节
+    const auto offset = static_cast<unsigned>(addr & 15);
+    auto p = reinterpret_cast<const __m128i*>(addr - offset);
+    const __m128i zero = _mm_setzero_si128();
+    uint32_t mask = static_cast<uint32_t>(
+      _mm_movemask_epi8(lane::cmpeq(_mm_load_si128(p), zero))) >> offset;
+    if (mask != 0)
+      return ctz32(mask) / sizeof(CharType);
+    for (;;)
+    {
+      ++p;
+      mask = static_cast<uint32_t>(_mm_movemask_epi8(lane::cmpeq(_mm_load_si128(p), zero)));
+      if (mask != 0)
+      {
+        const auto hit = reinterpret_cast<const char*>(p) + ctz32(mask);
+        return static_cast<size_t>(hit - reinterpret_cast<const char*>(str)) / sizeof(CharType);
+      }
+    }
+  }
+#endif
+  size_t len = 0;
+  for (; *str != CharType(0); ++str)
+    ++len;
+  return len;
+}
+
+/*****************************************************************************************/
+// simd_compare
+// 按字符的无符号值比较 [s1, s1 + n) 和 [s2, s2 + n)，返回 -1 / 0 / 1
+/*****************************************************************************************/
+template <class CharType>
+int simd_compare(const CharType* s1, const CharType* s2, size_t n) noexcept
+{
+#ifdef MYSTL_HAS_SSE2
+  typedef simd_lane<sizeof(CharType)> lane;
+  const size_t step = 16 / sizeof(CharType);
+  for (; n >= step; n -= step, s1 += step, s2 += step)
+  {
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s1));
+    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s2));
+    const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(lane::cmpeq(a, b)));
+    if (mask != 0xffff)
+    { // 找到第一个不同的字符
+      const auto i = ctz32(~mask) / sizeof(CharType);
+      return s1[i] < s2[i] ? -1 : 1;
+    }
+  }
+#endif
+  for (; n != 0; --n, ++s1, ++s2)
+  {
+    if (*s1 != *s2)
+      return *s1 < *s2 ? -1 : 1;
+  }
+  return 0;
+}
+
+/*****************************************************************************************/
+// simd_fill
+// 将 [dst, dst + n) 填充为 ch
+/*****************************************************************************************/
+template <class CharType>
+CharType* simd_fill(CharType* dst, CharType ch, size_t n) noexcept
+{
+  CharType* r = dst;
+#ifdef MYSTL_HAS_SSE2
+  typedef simd_lane<sizeof(CharType)> lane;
+  const size_t step = 16 / sizeof(CharType);
+  const __m128i v = lane::set1(static_cast<uint32_t>(ch));
+  for (; n >= step; n -= step, dst += step)
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), v);
+#endif
+  for (; n != 0; --n, ++dst)
+    *dst = ch;
+  return r;
+}
+
+} // namespace mystl
+#endif // !MYTINYSTL_SIMD_H_
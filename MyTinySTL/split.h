@@ -0,0 +1,271 @@
+﻿#ifndef MYTINYSTL_SPLIT_H_
+#define MYTINYSTL_SPLIT_H_
+
+// 这个头文件包含 split 函数，以及它返回的惰性区间 split_range
+// split_range 是一个前向区间，每次前进时才查找下一个分隔符，产生的字段是指向原字符串的 basic_string_view
+
+// notes:
+//
+// 1. 分隔符可以是单个字符、一个字符串（by_string），或者一个字符集合（by_any_of）
+// 2. 默认保留空字段，"a,,b" 按 ',' 分割得到 "a" "" "b"，空字符串得到一个空字段；
+//    skip_empty 为 true 时跳过所有空字段
+// 3. 空的字符串分隔符会把输入分割为单个字符
+// 4. split_range 不拥有被分割的字符串，使用时须保证它仍然有效
+
+#include "iterator.h"
+#include "string_view.h"
+
+namespace mystl
+{
+
+/*****************************************************************************************/
+// 分隔符
+// find(text, pos) 返回从 pos 开始的第一个分隔符的位置，没有则返回 npos，length() 返回分隔符的长度
+/*****************************************************************************************/
+
+// 单个字符
+template <class CharType, class CharTraits = mystl::char_traits<CharType>>
+struct char_delimiter
+{
+  typedef basic_string_view<CharType, CharTraits> view_type;
+
+  CharType ch;
+
+  explicit char_delimiter(CharType c) noexcept :ch(c) {}
+
+  size_t find(view_type text, size_t pos) const noexcept { return text.find(ch, pos); }
+  size_t length() const noexcept { return 1; }
+};
+
+// 一个字符串
+template <class CharType, class CharTraits = mystl::char_traits<CharType>>
+struct string_delimiter
+{
+  typedef basic_string_view<CharType, CharTraits> view_type;
+
+  view_type delim;
+
+  explicit string_delimiter(view_type d) noexcept :delim(d) {}
+
+  size_t find(view_type text, size_t pos) const noexcept
+  {
+    if (delim.empty())
+      return pos + 1 < text.size() ? pos + 1 : view_type::npos;
+    return text.find(delim, pos);
+  }
+  size_t length() const noexcept { return delim.size(); }
+};
+
+// 字符集合中的任一字符
+template <class CharType, class CharTraits = mystl::char_traits<CharType>>
+struct any_of_delimiter
+{
+  typedef basic_string_view<CharType, CharTraits> view_type;
+
+  view_type chars;
+
+  explicit any_of_delimiter(view_type s) noexcept :chars(s) {}
+
+  size_t find(view_type text, size_t pos) const noexcept { return text.find_first_of(chars, pos); }
+  size_t length() const noexcept { return 1; }
+};
+
+template <class CharType>
+string_delimiter<CharType> by_string(const CharType* s)
+{ return string_delimiter<CharType>(s); }
+
+template <class CharType, class CharTraits>
+string_delimiter<CharType, CharTraits> by_string(basic_string_view<CharType, CharTraits> s)
+{ return string_delimiter<CharType, CharTraits>(s); }
+
+template <class CharType, class CharTraits>
+string_delimiter<CharType, CharTraits> by_string(const basic_string<CharType, CharTraits>& s)
+{ return string_delimiter<CharType, CharTraits>(s); }
+
+template <class CharType>
+any_of_delimiter<CharType> by_any_of(const CharType* s)
+{ return any_of_delimiter<CharType>(s); }
+
+template <class CharType, class CharTraits>
+any_of_delimiter<CharType, CharTraits> by_any_of(basic_string_view<CharType, CharTraits> s)
+{ return any_of_delimiter<CharType, CharTraits>(s); }
+
+template <class CharType, class CharTraits>
+any_of_delimiter<CharType, CharTraits> by_any_of(const basic_string<CharType, CharTraits>& s)
+{ return any_of_delimiter<CharType, CharTraits>(s); }
+
+template <class CharType, class CharTraits, class Delimiter>
+class split_range;
+
+/*****************************************************************************************/
+// split_iterator
+// split_range 的前向迭代器
+/*****************************************************************************************/
+template <class CharType, class CharTraits, class Delimiter>
+class split_iterator
+{
+public:
+  typedef basic_string_view<CharType, CharTraits>        view_type;
+  typedef split_range<CharType, CharTraits, Delimiter>   range_type;
+
+  typedef mystl::forward_iterator_tag                    iterator_category;
+  typedef view_type                                      value_type;
+  typedef const view_type*                               pointer;
+  typedef const view_type&                               reference;
+  typedef ptrdiff_t                                      difference_type;
+
+private:
+  static constexpr size_t npos = view_type::npos;
+
+  const range_type* range_;  // 所属的区间
+  view_type         field_;  // 当前字段
+  size_t            next_;   // 下一个字段的起始位置，等于 npos 表示已到末尾
+
+public:
+  split_iterator() noexcept :range_(nullptr), field_(), next_(npos) {}
+
+  // start 为第一个字段的起始位置，传入 npos 构造尾后迭代器
+  split_iterator(const range_type* range, size_t start)
+    :range_(range), field_(), next_(npos)
+  {
+    if (start != npos)
+      advance_from(start);
+  }
+
+  reference operator*()  const { return field_; }
+  pointer   operator->() const { return &field_; }
+
+  split_iterator& operator++()
+  {
+    MYSTL_DEBUG(next_ != npos);
+    advance_from(next_);
+    return *this;
+  }
+  split_iterator operator++(int)
+  {
+    split_iterator tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+  bool operator==(const split_iterator& rhs) const noexcept { return next_ == rhs.next_; }
+  bool operator!=(const split_iterator& rhs) const noexcept { return next_ != rhs.next_; }
+
+private:
+  // 从 start 开始取出下一个字段，若 start 已越过末尾则变为尾后迭代器
+  void advance_from(size_t start)
+  {
+    const auto text = range_->text();
+    for (;;)
+    {
+      if (start > text.size())
+      {
+        next_ = npos;
+        return;
+      }
+      const auto d = range_->delimiter().find(text, start);
+      if (d == npos)
+      {
+        field_ = view_type(text.data() + start, text.size() - start);
+        next_ = text.size() + 1;
+      }
+      else
+      {
+        field_ = view_type(text.data() + start, d - start);
+        next_ = d + range_->delimiter().length();
+      }
+      if (!range_->skip_empty() || !field_.empty())
+        return;
+      start = next_;
+    }
+  }
+};
+
+template <class CharType, class CharTraits, class Delimiter>
+constexpr size_t split_iterator<CharType, CharTraits, Delimiter>::npos;
+
+/*****************************************************************************************/
+// split_range
+// 惰性的分割结果，可以用于范围 for 以及接受前向迭代器的 mystl 算法
+/*****************************************************************************************/
+template <class CharType, class CharTraits, class Delimiter>
+class split_range
+{
+public:
+  typedef basic_string_view<CharType, CharTraits>          view_type;
+  typedef view_type                                        value_type;
+  typedef split_iterator<CharType, CharTraits, Delimiter>  iterator;
+  typedef split_iterator<CharType, CharTraits, Delimiter>  const_iterator;
+
+private:
+  view_type text_;
+  Delimiter delim_;
+  bool      skip_empty_;
+
+public:
+  split_range(view_type text, const Delimiter& delim, bool skip_empty)
+    :text_(text), delim_(delim), skip_empty_(skip_empty)
+  {
+  }
+
+  iterator begin() const { return iterator(this, 0); }
+  iterator end()   const { return iterator(this, view_type::npos); }
+
+  view_type        text()       const noexcept { return text_; }
+  const Delimiter& delimiter()  const noexcept { return delim_; }
+  bool             skip_empty() const noexcept { return skip_empty_; }
+};
+
+/*****************************************************************************************/
+// split
+// 按分隔符分割字符串，返回一个惰性区间
+/*****************************************************************************************/
+template <class CharType, class CharTraits>
+split_range<CharType, CharTraits, char_delimiter<CharType, CharTraits>>
+split(basic_string_view<CharType, CharTraits> text, CharType delim, bool skip_empty = false)
+{
+  return split_range<CharType, CharTraits, char_delimiter<CharType, CharTraits>>(
+    text, char_delimiter<CharType, CharTraits>(delim), skip_empty);
+}
+
+template <class CharType, class CharTraits>
+split_range<CharType, CharTraits, char_delimiter<CharType, CharTraits>>
+split(const basic_string<CharType, CharTraits>& text, CharType delim, bool skip_empty = false)
+{
+  return split(basic_string_view<CharType, CharTraits>(text), delim, skip_empty);
+}
+
+template <class CharType>
+split_range<CharType, mystl::char_traits<CharType>, char_delimiter<CharType>>
+split(const CharType* text, CharType delim, bool skip_empty = false)
+{
+  return split(basic_string_view<CharType>(text), delim, skip_empty);
+}
+
+template <class CharType, class CharTraits, template <class, class> class Delimiter>
+split_range<CharType, CharTraits, Delimiter<CharType, CharTraits>>
+split(basic_string_view<CharType, CharTraits> text,
+      const Delimiter<CharType, CharTraits>& delim, bool skip_empty = false)
+{
+  return split_range<CharType, CharTraits, Delimiter<CharType, CharTraits>>(
+    text, delim, skip_empty);
+}
+
+template <class CharType, class CharTraits, template <class, class> class Delimiter>
+split_range<CharType, CharTraits, Delimiter<CharType, CharTraits>>
+split(const basic_string<CharType, CharTraits>& text,
+      const Delimiter<CharType, CharTraits>& delim, bool skip_empty = false)
+{
+  return split(basic_string_view<CharType, CharTraits>(text), delim, skip_empty);
+}
+
+template <class CharType, template <class, class> class Delimiter>
+split_range<CharType, mystl::char_traits<CharType>, Delimiter<CharType, mystl::char_traits<CharType>>>
+split(const CharType* text,
+      const Delimiter<CharType, mystl::char_traits<CharType>>& delim, bool skip_empty = false)
+{
+  return split(basic_string_view<CharType>(text), delim, skip_empty);
+}
+
+} // namespace mystl
+#endif // !MYTINYSTL_SPLIT_H_
@@ -0,0 +1,351 @@
+﻿#ifndef MYTINYSTL_STRING_POOL_H_
+#define MYTINYSTL_STRING_POOL_H_
+
+// 这个头文件包含两个模板类 basic_string_pool 和 basic_interned_string
+// basic_string_pool     : 字符串驻留池，内容相同的字符串只保存一份
+// basic_interned_string : 字符串驻留池返回的句柄，只有一个指针的大小
+
+// notes:
+//
+// 1. 字符串被复制到池内的连续内存块（arena）中，块在池析构或 clear 之前不会移动或释放，
+//    所以句柄在这段时间内一直有效
+// 2. 同一个池返回的两个句柄，内容相同当且仅当指针相同，所以句柄的比较与哈希都是 O(1) 的，
+//    不同池返回的句柄之间不要互相比较
+// 3. 空字符串总是对应默认构造的句柄
+// 4. 池内的查找按 CharTraits::compare 判断相等，哈希由 string_pool_key_hash<CharType, CharTraits> 计算，
+//    缺省按字节哈希，只适用于逐字节相等的 traits；ci_char_traits 已经特化为忽略大小写的哈希，
+//    这时大小写不同的字符串共用第一次驻留时的写法。其他自定义相等的 traits 需要同样特化
+
+#include "astring.h"
+#include "ci_string.h"
+#include "hashtable.h"
+#include "string_view.h"
+
+namespace mystl
+{
+
+// 模板类 basic_interned_string
+// 参数一代表字符类型，参数二代表萃取字符类型的方式
+template <class CharType, class CharTraits = mystl::char_traits<CharType>>
+class basic_interned_string
+{
+  template <class C, class T>
+  friend class basic_string_pool;
+
+public:
+  typedef CharTraits                             traits_type;
+  typedef CharType                               value_type;
+  typedef const value_type*                      const_pointer;
+  typedef const value_type*                      const_iterator;
+  typedef size_t                                 size_type;
+  typedef mystl::basic_string<CharType, CharTraits> string_type;
+
+private:
+  const_pointer data_;  // 指向池内的字符串，长度保存在字符串之前
+
+public:
+  basic_interned_string() noexcept :data_(nullptr) {}
+
+  const_pointer  data()  const noexcept { return data_ ? data_ : empty_cstr(); }
+  const_pointer  c_str() const noexcept { return data(); }
+
+  size_type      size()   const noexcept
+  { return data_ ? *(reinterpret_cast<const size_type*>(data_) - 1) : 0; }
+  size_type      length() const noexcept { return size(); }
+  bool           empty()  const noexcept { return data_ == nullptr; }
+
+  const_iterator begin()  const noexcept { return data(); }
+  const_iterator end()    const noexcept { return data() + size(); }
+
+  // 复制出一个 basic_string
+  string_type    str()    const { return string_type(data(), size()); }
+
+  // 转为不复制字符的视图
+  basic_string_view<CharType, CharTraits> view() const noexcept
+  { return basic_string_view<CharType, CharTraits>(data(), size()); }
+
+  friend bool operator==(const basic_interned_string& lhs, const basic_interned_string& rhs) noexcept
+  { return lhs.data_ == rhs.data_; }
+  friend bool operator!=(const basic_interned_string& lhs, const basic_interned_string& rhs) noexcept
+  { return lhs.data_ != rhs.data_; }
+
+  friend std::ostream& operator<<(std::ostream& os, const basic_interned_string& s)
+  {
+    for (auto p = s.begin(); p != s.end(); ++p)
+      os << *p;
+    return os;
+  }
+
+private:
+  explicit basic_interned_string(const_pointer p) noexcept :data_(p) {}
+
+  static const_pointer empty_cstr() noexcept
+  {
+    static const value_type empty[1] = { value_type() };
+    return empty;
+  }
+};
+
+// 特化 mystl::hash，句柄按地址哈希
+template <class CharType, class CharTraits>
+struct hash<basic_interned_string<CharType, CharTraits>>
+{
+  size_t operator()(const basic_interned_string<CharType, CharTraits>& s) const noexcept
+  { return reinterpret_cast<size_t>(s.data()) / sizeof(size_t); }
+};
+
+// 池内 hashtable 使用的键，指向一段字符，不拥有它
+template <class CharType>
+struct string_pool_key
+{
+  const CharType* data;
+  size_t          size;
+};
+
+// 哈希必须与 CharTraits::compare 的相等一致
+template <class CharType, class CharTraits>
+struct string_pool_key_hash
+{
+  size_t operator()(const string_pool_key<CharType>& key) const noexcept
+  {
+    return bitwise_hash(reinterpret_cast<const unsigned char*>(key.data),
+                        key.size * sizeof(CharType));
+  }
+};
+
+template <>
+struct string_pool_key_hash<char, ci_char_traits>
+{
+  size_t operator()(const string_pool_key<char>& key) const noexcept
+  { return ci_bitwise_hash(key.data, key.size); }
+};
+
+template <class CharType, class CharTraits>
+struct string_pool_key_equal
+{
+  bool operator()(const string_pool_key<CharType>& lhs,
+                  const string_pool_key<CharType>& rhs) const noexcept
+  {
+    return lhs.size == rhs.size && CharTraits::compare(lhs.data, rhs.data, lhs.size) == 0;
+  }
+};
+
+// 模板类 basic_string_pool
+// 参数一代表字符类型，参数二代表萃取字符类型的方式
+template <class CharType, class CharTraits = mystl::char_traits<CharType>>
+class basic_string_pool
+{
+public:
+  typedef CharTraits                                   traits_type;
+  typedef CharType                                     value_type;
+  typedef const value_type*                            const_pointer;
+  typedef size_t                                       size_type;
+  typedef mystl::basic_string<CharType, CharTraits>    string_type;
+  typedef basic_interned_string<CharType, CharTraits>  handle_type;
+
+private:
+  typedef string_pool_key<CharType>                    key_type;
+  typedef hashtable<key_type, string_pool_key_hash<CharType, CharTraits>,
+    string_pool_key_equal<CharType, CharTraits>>       table_type;
+
+  // arena 以 size_type 为单位分配，保证每个条目头部的长度字段对齐
+  typedef mystl::allocator<size_type>                  block_allocator;
+
+  // 默认每个内存块的大小（字节）
+  static constexpr size_type default_block_bytes = 4096;
+
+private:
+  table_type               table_;        // 已驻留的字符串
+  mystl::vector<size_type*> blocks_;      // 所有内存块
+  mystl::vector<size_type>  block_sizes_; // 每个内存块的大小（以 size_type 为单位）
+  size_type*               cur_;          // 当前块的空闲位置
+  size_type                left_;         // 当前块剩余的空间（以 size_type 为单位）
+  size_type                block_words_;  // 新内存块的默认大小（以 size_type 为单位）
+
+public:
+  // 构造、移动、析构函数
+  explicit basic_string_pool(size_type block_bytes = default_block_bytes)
+    :table_(100), cur_(nullptr), left_(0),
+    block_words_(mystl::max(block_bytes / sizeof(size_type), static_cast<size_type>(16)))
+  {
+  }
+
+  basic_string_pool(const basic_string_pool&) = delete;
+  basic_string_pool& operator=(const basic_string_pool&) = delete;
+
+  basic_string_pool(basic_string_pool&& rhs) noexcept
+    :table_(mystl::move(rhs.table_)),
+    blocks_(mystl::move(rhs.blocks_)),
+    block_sizes_(mystl::move(rhs.block_sizes_)),
+    cur_(rhs.cur_), left_(rhs.left_), block_words_(rhs.block_words_)
+  {
+    rhs.cur_ = nullptr;
+    rhs.left_ = 0;
+  }
+
+  ~basic_string_pool() { release_blocks(); }
+
+public:
+  // 驻留一个字符串，返回它的句柄，若池中已有相同内容则直接返回已有的句柄
+  handle_type intern(const_pointer s, size_type n);
+  handle_type intern(const_pointer s)
+  { return intern(s, traits_type::length(s)); }
+  handle_type intern(const string_type& s)
+  { return intern(s.begin(), s.size()); }
+  handle_type intern(basic_string_view<CharType, CharTraits> s)
+  { return intern(s.data(), s.size()); }
+
+  // 查找一个字符串，若不在池中返回空句柄
+  handle_type find(const_pointer s, size_type n) const;
+  handle_type find(const_pointer s) const
+  { return find(s, traits_type::length(s)); }
+  handle_type find(const string_type& s) const
+  { return find(s.begin(), s.size()); }
+  handle_type find(basic_string_view<CharType, CharTraits> s) const
+  { return find(s.data(), s.size()); }
+
+  // 池中不同字符串的个数
+  size_type   size()  const noexcept { return table_.size(); }
+  bool        empty() const noexcept { return table_.empty(); }
+
+  // arena 占用的字节数
+  size_type   memory_usage() const noexcept;
+
+  // 清空池，之前返回的所有句柄失效
+  void        clear();
+
+  void        swap(basic_string_pool& rhs) noexcept;
+
+private:
+  const_pointer store(const_pointer s, size_type n);
+  void          release_blocks() noexcept;
+};
+
+/*****************************************************************************************/
+
+// 驻留一个字符串
+template <class CharType, class CharTraits>
+typename basic_string_pool<CharType, CharTraits>::handle_type
+basic_string_pool<CharType, CharTraits>::
+intern(const_pointer s, size_type n)
+{
+  if (n == 0)
+    return handle_type();
+  const key_type key = { s, n };
+  auto it = table_.find(key);
+  if (it.node != nullptr)
+    return handle_type(it->data);
+  const key_type stored = { store(s, n), n };
+  table_.insert_unique(stored);
+  return handle_type(stored.data);
+}
+
+// 查找一个字符串
+template <class CharType, class CharTraits>
+typename basic_string_pool<CharType, CharTraits>::handle_type
+basic_string_pool<CharType, CharTraits>::
+find(const_pointer s, size_type n) const
+{
+  if (n == 0)
+    return handle_type();
+  const key_type key = { s, n };
+  auto it = table_.find(key);
+  return it.node != nullptr ? handle_type(it->data) : handle_type();
+}
+
+// arena 占用的字节数
+template <class CharType, class CharTraits>
+typename basic_string_pool<CharType, CharTraits>::size_type
+basic_string_pool<CharType, CharTraits>::
+memory_usage() const noexcept
+{
+  size_type words = 0;
+  for (auto n : block_sizes_)
+    words += n;
+  return words * sizeof(size_type);
+}
+
+// 清空池
+template <class CharType, class CharTraits>
+void basic_string_pool<CharType, CharTraits>::
+clear()
+{
+  table_.clear();
+  release_blocks();
+}
+
+// 交换两个池
+template <class CharType, class CharTraits>
+void basic_string_pool<CharType, CharTraits>::
+swap(basic_string_pool& rhs) noexcept
+{
+  if (this != &rhs)
+  {
+    table_.swap(rhs.table_);
+    blocks_.swap(rhs.blocks_);
+    block_sizes_.swap(rhs.block_sizes_);
+    mystl::swap(cur_, rhs.cur_);
+    mystl::swap(left_, rhs.left_);
+    mystl::swap(block_words_, rhs.block_words_);
+  }
+}
+
+/*****************************************************************************************/
+// helper function
+
+// 把字符串复制到 arena 中，每个条目为：长度 + 字符 + 结尾的空字符，按 size_type 对齐
+template <class CharType, class CharTraits>
+typename basic_string_pool<CharType, CharTraits>::const_pointer
+basic_string_pool<CharType, CharTraits>::
+store(const_pointer s, size_type n)
+{
+  const size_type bytes = (n + 1) * sizeof(value_type);
+  const size_type words = 1 + (bytes + sizeof(size_type) - 1) / sizeof(size_type);
+  if (left_ < words)
+  { // 当前块放不下，开一个新块，过长的字符串单独占用一块
+    const size_type block = mystl::max(block_words_, words);
+    blocks_.reserve(blocks_.size() + 1);
+    block_sizes_.reserve(block_sizes_.size() + 1);
+    auto p = block_allocator::allocate(block);
+    blocks_.push_back(p);
+    block_sizes_.push_back(block);
+    cur_ = p;
+    left_ = block;
+  }
+  *cur_ = n;
+  auto data = reinterpret_cast<value_type*>(cur_ + 1);
+  traits_type::copy(data, s, n);
+  data[n] = value_type();
+  cur_ += words;
+  left_ -= words;
+  return data;
+}
+
+// 释放所有内存块
+template <class CharType, class CharTraits>
+void basic_string_pool<CharType, CharTraits>::
+release_blocks() noexcept
+{
+  for (auto p : blocks_)
+    block_allocator::deallocate(p);
+  blocks_.clear();
+  block_sizes_.clear();
+  cur_ = nullptr;
+  left_ = 0;
+}
+
+// 重载 mystl 的 swap
+template <class CharType, class CharTraits>
+void swap(basic_string_pool<CharType, CharTraits>& lhs,
+          basic_string_pool<CharType, CharTraits>& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+
+using string_pool       = mystl::basic_string_pool<char>;
+using wstring_pool      = mystl::basic_string_pool<wchar_t>;
+using interned_string   = mystl::basic_interned_string<char>;
+using interned_wstring  = mystl::basic_interned_string<wchar_t>;
+
+} // namespace mystl
+#endif // !MYTINYSTL_STRING_POOL_H_
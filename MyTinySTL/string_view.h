@@ -0,0 +1,367 @@
+﻿#ifndef MYTINYSTL_STRING_VIEW_H_
+#define MYTINYSTL_STRING_VIEW_H_
+
+// 这个头文件包含一个模板类 basic_string_view
+// basic_string_view : 指向一段连续字符的只读视图，不拥有这段字符，复制的代价只有一个指针和一个长度
+
+// notes:
+//
+// 1. 视图只在它所指向的字符串存活且未被修改时有效
+// 2. 视图的内容不一定以空字符结尾，不提供 c_str
+// 3. 查找子串时整段使用 char_traits::compare 比较，与 compare 的相等保持一致
+
+#include "astring.h"
+
+namespace mystl
+{
+
+// 模板类 basic_string_view
+// 参数一代表字符类型，参数二代表萃取字符类型的方式，缺省使用 mystl::char_traits
+template <class CharType, class CharTraits = mystl::char_traits<CharType>>
+class basic_string_view
+{
+public:
+  typedef CharTraits                               traits_type;
+  typedef CharTraits                               char_traits;
+
+  typedef CharType                                 value_type;
+  typedef const value_type*                        pointer;
+  typedef const value_type*                        const_pointer;
+  typedef const value_type&                        reference;
+  typedef const value_type&                        const_reference;
+
+  typedef size_t                                   size_type;
+  typedef ptrdiff_t                                difference_type;
+
+  typedef const value_type*                        iterator;
+  typedef const value_type*                        const_iterator;
+  typedef mystl::reverse_iterator<const_iterator>  reverse_iterator;
+  typedef mystl::reverse_iterator<const_iterator>  const_reverse_iterator;
+
+  typedef mystl::basic_string<CharType, CharTraits> string_type;
+
+  static constexpr size_type npos = static_cast<size_type>(-1);
+
+private:
+  const_pointer data_;  // 视图的起始位置
+  size_type     size_;  // 视图的长度
+
+public:
+  // 构造函数
+  constexpr basic_string_view() noexcept
+    :data_(nullptr), size_(0)
+  {
+  }
+
+  constexpr basic_string_view(const_pointer str, size_type count) noexcept
+    :data_(str), size_(count)
+  {
+  }
+
+  basic_string_view(const_pointer str) noexcept
+    :data_(str), size_(char_traits::length(str))
+  {
+  }
+
+  basic_string_view(const string_type& str) noexcept
+    :data_(str.begin()), size_(str.size())
+  {
+  }
+
+  constexpr basic_string_view(const basic_string_view&) noexcept = default;
+  basic_string_view& operator=(const basic_string_view&) noexcept = default;
+
+public:
+  // 迭代器相关操作
+  constexpr const_iterator begin()  const noexcept { return data_; }
+  constexpr const_iterator end()    const noexcept { return data_ + size_; }
+  constexpr const_iterator cbegin() const noexcept { return begin(); }
+  constexpr const_iterator cend()   const noexcept { return end(); }
+
+  const_reverse_iterator   rbegin()  const noexcept { return const_reverse_iterator(end()); }
+  const_reverse_iterator   rend()    const noexcept { return const_reverse_iterator(begin()); }
+  const_reverse_iterator   crbegin() const noexcept { return rbegin(); }
+  const_reverse_iterator   crend()   const noexcept { return rend(); }
+
+  // 容量相关操作
+  constexpr bool      empty()    const noexcept { return size_ == 0; }
+  constexpr size_type size()     const noexcept { return size_; }
+  constexpr size_type length()   const noexcept { return size_; }
+  constexpr size_type max_size() const noexcept { return npos / sizeof(value_type); }
+
+  // 访问元素相关操作
+  const_reference operator[](size_type n) const
+  {
+    MYSTL_DEBUG(n < size_);
+    return *(data_ + n);
+  }
+  const_reference at(size_type n) const
+  {
+    THROW_OUT_OF_RANGE_IF(n >= size_, "basic_string_view<Char, Traits>::at()"
+                          "subscript out of range");
+    return *(data_ + n);
+  }
+  const_reference front() const
+  {
+    MYSTL_DEBUG(!empty());
+    return *data_;
+  }
+  const_reference back()  const
+  {
+    MYSTL_DEBUG(!empty());
+    return *(data_ + size_ - 1);
+  }
+  constexpr const_pointer data() const noexcept { return data_; }
+
+  // 修改视图的范围
+  void remove_prefix(size_type n)
+  {
+    MYSTL_DEBUG(n <= size_);
+    data_ += n;
+    size_ -= n;
+  }
+  void remove_suffix(size_type n)
+  {
+    MYSTL_DEBUG(n <= size_);
+    size_ -= n;
+  }
+  void swap(basic_string_view& rhs) noexcept
+  {
+    mystl::swap(data_, rhs.data_);
+    mystl::swap(size_, rhs.size_);
+  }
+
+  // 子视图，不复制字符
+  basic_string_view substr(size_type pos = 0, size_type count = npos) const
+  {
+    THROW_OUT_OF_RANGE_IF(pos > size_, "basic_string_view<Char, Traits>::substr()"
+                          "subscript out of range");
+    return basic_string_view(data_ + pos, mystl::min(count, size_ - pos));
+  }
+
+  // 复制出一个 basic_string
+  string_type str() const { return string_type(data_, size_); }
+
+  // compare
+  int compare(basic_string_view other) const noexcept;
+
+  bool starts_with(basic_string_view s) const noexcept
+  { return size_ >= s.size_ && char_traits::compare(data_, s.data_, s.size_) == 0; }
+  bool ends_with(basic_string_view s) const noexcept
+  { return size_ >= s.size_ && char_traits::compare(data_ + size_ - s.size_, s.data_, s.size_) == 0; }
+
+  // find
+  size_type find(value_type ch, size_type pos = 0)                   const noexcept;
+  size_type find(basic_string_view s, size_type pos = 0)             const noexcept;
+
+  // rfind
+  size_type rfind(value_type ch, size_type pos = npos)               const noexcept;
+
+  // find_first_of / find_first_not_of
+  size_type find_first_of(basic_string_view s, size_type pos = 0)     const noexcept;
+  size_type find_first_not_of(basic_string_view s, size_type pos = 0) const noexcept;
+
+public:
+  // 重载比较操作符，定义为友元使得字符串与 C 风格字符串可以隐式转换后比较
+  friend bool operator==(basic_string_view lhs, basic_string_view rhs) noexcept
+  { return lhs.size_ == rhs.size_ && lhs.compare(rhs) == 0; }
+  friend bool operator!=(basic_string_view lhs, basic_string_view rhs) noexcept
+  { return !(lhs == rhs); }
+  friend bool operator< (basic_string_view lhs, basic_string_view rhs) noexcept
+  { return lhs.compare(rhs) < 0; }
+  friend bool operator<=(basic_string_view lhs, basic_string_view rhs) noexcept
+  { return lhs.compare(rhs) <= 0; }
+  friend bool operator> (basic_string_view lhs, basic_string_view rhs) noexcept
+  { return lhs.compare(rhs) > 0; }
+  friend bool operator>=(basic_string_view lhs, basic_string_view rhs) noexcept
+  { return lhs.compare(rhs) >= 0; }
+
+  friend std::ostream& operator<<(std::ostream& os, basic_string_view s)
+  {
+    for (size_type i = 0; i < s.size_; ++i)
+      os << *(s.data_ + i);
+    return os;
+  }
+};
+
+/*****************************************************************************************/
+
+// 比较两个视图，小于返回 -1，大于返回 1，等于返回 0
+template <class CharType, class CharTraits>
+int basic_string_view<CharType, CharTraits>::
+compare(basic_string_view other) const noexcept
+{
+  const auto n = mystl::min(size_, other.size_);
+  const auto r = n == 0 ? 0 : char_traits::compare(data_, other.data_, n);
+  if (r != 0)
+    return r < 0 ? -1 : 1;
+  if (size_ < other.size_)
+    return -1;
+  if (size_ > other.size_)
+    return 1;
+  return 0;
+}
+
+// 从下标 pos 开始查找字符为 ch 的元素，若找到返回其下标，否则返回 npos
+template <class CharType, class CharTraits>
+typename basic_string_view<CharType, CharTraits>::size_type
+basic_string_view<CharType, CharTraits>::
+find(value_type ch, size_type pos) const noexcept
+{
+  for (auto i = pos; i < size_; ++i)
+  {
+    if (*(data_ + i) == ch)
+      return i;
+  }
+  return npos;
+}
+
+// 从下标 pos 开始查找视图 s，若找到返回起始位置的下标，否则返回 npos
+template <class CharType, class CharTraits>
+typename basic_string_view<CharType, CharTraits>::size_type
+basic_string_view<CharType, CharTraits>::
+find(basic_string_view s, size_type pos) const noexcept
+{
+  if (pos > size_)
+    return npos;
+  if (s.size_ == 0)
+    return pos;
+  if (size_ - pos < s.size_)
+    return npos;
+  const auto left = size_ - s.size_;
+  for (auto i = pos; i <= left; ++i)
+  {
+    if (char_traits::compare(data_ + i, s.data_, s.size_) == 0)
+      return i;
+  }
+  return npos;
+}
+
+// 从下标 pos 开始反向查找字符为 ch 的元素，若找到返回其下标，否则返回 npos
+template <class CharType, class CharTraits>
+typename basic_string_view<CharType, CharTraits>::size_type
+basic_string_view<CharType, CharTraits>::
+rfind(value_type ch, size_type pos) const noexcept
+{
+  if (size_ == 0)
+    return npos;
+  for (auto i = mystl::min(pos, size_ - 1) + 1; i != 0; --i)
+  {
+    if (*(data_ + i - 1) == ch)
+      return i - 1;
+  }
+  return npos;
+}
+
+// 从下标 pos 开始查找 s 中的任一字符，若找到返回其下标，否则返回 npos
+template <class CharType, class CharTraits>
+typename basic_string_view<CharType, CharTraits>::size_type
+basic_string_view<CharType, CharTraits>::
+find_first_of(basic_string_view s, size_type pos) const noexcept
+{
+  for (auto i = pos; i < size_; ++i)
+  {
+    if (s.find(*(data_ + i)) != npos)
+      return i;
+  }
+  return npos;
+}
+
+// 从下标 pos 开始查找不在 s 中的字符，若找到返回其下标，否则返回 npos
+template <class CharType, class CharTraits>
+typename basic_string_view<CharType, CharTraits>::size_type
+basic_string_view<CharType, CharTraits>::
+find_first_not_of(basic_string_view s, size_type pos) const noexcept
+{
+  for (auto i = pos; i < size_; ++i)
+  {
+    if (s.find(*(data_ + i)) == npos)
+      return i;
+  }
+  return npos;
+}
+
+template <class CharType, class CharTraits>
+constexpr typename basic_string_view<CharType, CharTraits>::size_type
+basic_string_view<CharType, CharTraits>::npos;
+
+// 重载 mystl 的 swap
+template <class CharType, class CharTraits>
+void swap(basic_string_view<CharType, CharTraits>& lhs,
+          basic_string_view<CharType, CharTraits>& rhs) noexcept
+{
+  lhs.swap(rhs);
+}
+
+// 特化 mystl::hash，与 basic_string 的哈希值相同
+template <class CharType, class CharTraits>
+struct hash<basic_string_view<CharType, CharTraits>>
+{
+  size_t operator()(const basic_string_view<CharType, CharTraits>& str) const noexcept
+  {
+    return bitwise_hash(reinterpret_cast<const unsigned char*>(str.data()),
+                        str.size() * sizeof(CharType));
+  }
+};
+
+// 透明的字符串哈希与比较函数对象
+// 参数都先转成 basic_string_view，键值为 basic_string 的容器可以直接用视图或以空字符结尾的字符指针查找，
+// 不需要构造临时字符串
+template <class CharType, class CharTraits = mystl::char_traits<CharType>>
+struct basic_string_hash
+{
+  typedef void is_transparent;
+
+  size_t operator()(basic_string_view<CharType, CharTraits> str) const noexcept
+  { return hash<basic_string_view<CharType, CharTraits>>()(str); }
+};
+
+template <class CharType, class CharTraits = mystl::char_traits<CharType>>
+struct basic_string_equal
+{
+  typedef void is_transparent;
+
+  bool operator()(basic_string_view<CharType, CharTraits> lhs,
+                  basic_string_view<CharType, CharTraits> rhs) const noexcept
+  { return lhs == rhs; }
+};
+
+template <class CharType, class CharTraits = mystl::char_traits<CharType>>
+struct basic_string_less
+{
+  typedef void is_transparent;
+
+  bool operator()(basic_string_view<CharType, CharTraits> lhs,
+                  basic_string_view<CharType, CharTraits> rhs) const noexcept
+  { return lhs < rhs; }
+};
+
+using string_hash    = mystl::basic_string_hash<char>;
+using string_equal   = mystl::basic_string_equal<char>;
+using string_less    = mystl::basic_string_less<char>;
+
+using string_view    = mystl::basic_string_view<char>;
+using wstring_view   = mystl::basic_string_view<wchar_t>;
+using u16string_view = mystl::basic_string_view<char16_t>;
+using u32string_view = mystl::basic_string_view<char32_t>;
+
+// 字符串字面量后缀 _sv，长度在编译期确定，得到的视图可以用于常量表达式
+inline namespace literals
+{
+
+constexpr string_view operator"" _sv(const char* str, size_t len) noexcept
+{ return string_view(str, len); }
+
+constexpr wstring_view operator"" _sv(const wchar_t* str, size_t len) noexcept
+{ return wstring_view(str, len); }
+
+constexpr u16string_view operator"" _sv(const char16_t* str, size_t len) noexcept
+{ return u16string_view(str, len); }
+
+constexpr u32string_view operator"" _sv(const char32_t* str, size_t len) noexcept
+{ return u32string_view(str, len); }
+
+} // namespace literals
+
+} // namespace mystl
+#endif // !MYTINYSTL_STRING_VIEW_H_
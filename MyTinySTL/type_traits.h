@@ -39,6 +39,42 @@ struct is_pair : mystl::m_false_type {};
 template <class T1, class T2>
 struct is_pair<mystl::pair<T1, T2>> : mystl::m_true_type {};
 
+// is_transparent
+// 函数对象定义了 is_transparent 时，容器的查找函数可以接受任意能与键值比较的类型
+
+template <class... Ts>
+struct m_void
+{
+  typedef void type;
+};
+
+template <class T, class = void>
+struct is_transparent : mystl::m_false_type {};
+
+template <class T>
+struct is_transparent<T, typename m_void<typename T::is_transparent>::type> : mystl::m_true_type {};
+
+template <class... Fn>
+struct m_all_transparent : mystl::m_true_type {};
+
+template <class F, class... Fn>
+struct m_all_transparent<F, Fn...>
+  : mystl::m_bool_constant<is_transparent<F>::value && m_all_transparent<Fn...>::value> {};
+
+// 所有函数对象都透明时为 int，否则替换失败，用来约束透明查找的函数模板
+template <class... Fn>
+using enable_if_transparent = typename std::enable_if<m_all_transparent<Fn...>::value, int>::type;
+
+// is_key_first
+// 参数包的第一个参数去掉引用与 cv 限定后是否为 Key，emplace 据此先按键值查找再分配节点
+
+template <class Key, class... Args>
+struct is_key_first : mystl::m_false_type {};
+
+template <class Key, class Arg, class... Args>
+struct is_key_first<Key, Arg, Args...>
+  : mystl::m_bool_constant<std::is_same<Key, typename std::decay<Arg>::type>::value> {};
+
 } // namespace mystl
 
 #endif // !MYTINYSTL_TYPE_TRAITS_H_
@@ -11,23 +11,35 @@
 //   * emplace
 //   * emplace_hint
 //   * insert
+//   * try_emplace
+//
+// try_emplace / insert_or_assign 以及第一个参数为键值的 emplace 先按键值查找，键值已存在时不分配节点
 
 #include "hashtable.h"
 
 namespace mystl
 {
 
+// forward declaration
+
+template <class Key, class T, class Hash, class KeyEqual, class BucketPolicy>
+class unordered_multimap;
+
 // 模板类 unordered_map，键值不允许重复
 // 参数一代表键值类型，参数二代表实值类型，参数三代表哈希函数，缺省使用 mystl::hash
 // 参数四代表键值比较方式，缺省使用 mystl::equal_to
-template <class Key, class T, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>>
+// 参数五代表 bucket 策略，缺省使用 ht_prime_policy，键值的哈希值低位规律明显时可以用 ht_power2_policy
+template <class Key, class T, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>,
+          class BucketPolicy = mystl::ht_prime_policy>
 class unordered_map
 {
 private:
   // 使用 hashtable 作为底层机制
-  typedef hashtable<mystl::pair<const Key, T>, Hash, KeyEqual> base_type;
+  typedef hashtable<mystl::pair<const Key, T>, Hash, KeyEqual, BucketPolicy> base_type;
   base_type ht_;
 
+  friend class unordered_multimap<Key, T, Hash, KeyEqual, BucketPolicy>;
+
 public:
   // 使用 hashtable 的型别  
 
@@ -50,6 +62,9 @@ public:
   typedef typename base_type::local_iterator       local_iterator;
   typedef typename base_type::const_local_iterator const_local_iterator;
 
+  typedef typename base_type::node_handle_type     node_type;
+  typedef typename base_type::insert_return_type   insert_return_type;
+
   allocator_type get_allocator() const { return ht_.get_allocator(); }
 
 public:
@@ -72,10 +87,9 @@ public:
                 const size_type bucket_count = 100,
                 const Hash& hash = Hash(),
                 const KeyEqual& equal = KeyEqual())
-    : ht_(mystl::max(bucket_count, static_cast<size_type>(mystl::distance(first, last))), hash, equal)
+    :ht_(bucket_count, hash, equal)
   {
-    for (; first != last; ++first)
-      ht_.insert_unique_noresize(*first);
+    ht_.insert_unique(first, last);
   }
 
   unordered_map(std::initializer_list<value_type> ilist,
@@ -153,6 +167,35 @@ public:
   iterator emplace_hint(const_iterator hint, Args&& ...args)
   { return ht_.emplace_unique_use_hint(hint, mystl::forward<Args>(args)...); }
 
+  // try_emplace / insert_or_assign
+
+  template <class ...Args>
+  pair<iterator, bool> try_emplace(const key_type& key, Args&& ...args)
+  { return ht_.try_emplace_unique(key, mystl::emplace_key, key, mystl::forward<Args>(args)...); }
+  template <class ...Args>
+  pair<iterator, bool> try_emplace(key_type&& key, Args&& ...args)
+  {
+    return ht_.try_emplace_unique(key, mystl::emplace_key, mystl::move(key),
+                                  mystl::forward<Args>(args)...);
+  }
+
+  template <class M>
+  pair<iterator, bool> insert_or_assign(const key_type& key, M&& obj)
+  {
+    auto res = try_emplace(key, mystl::forward<M>(obj));
+    if (!res.second)
+      res.first->second = mystl::forward<M>(obj);
+    return res;
+  }
+  template <class M>
+  pair<iterator, bool> insert_or_assign(key_type&& key, M&& obj)
+  {
+    auto res = try_emplace(mystl::move(key), mystl::forward<M>(obj));
+    if (!res.second)
+      res.first->second = mystl::forward<M>(obj);
+    return res;
+  }
+
   // insert
 
   pair<iterator, bool> insert(const value_type& value)
@@ -169,6 +212,11 @@ public:
   void insert(InputIterator first, InputIterator last)
   { ht_.insert_unique(first, last); }
 
+  // 分组预取后插入，适合向远大于缓存的表中插入大量元素
+  template <class ForwardIter>
+  void insert_batch(ForwardIter first, ForwardIter last)
+  { ht_.insert_unique_batch(first, last); }
+
   // erase / clear
 
   void      erase(iterator it)
@@ -185,6 +233,23 @@ public:
   void      swap(unordered_map& other) noexcept
   { ht_.swap(other.ht_); }
 
+  // 节点句柄，摘下、重新插入节点与合并容器都不分配也不释放节点
+
+  node_type          extract(const_iterator position)
+  { return ht_.extract(position); }
+  node_type          extract(const key_type& key)
+  { return ht_.extract(key); }
+
+  insert_return_type insert(node_type&& nh)
+  { return ht_.insert_unique(mystl::move(nh)); }
+  iterator           insert(const_iterator /*hint*/, node_type&& nh)
+  { return ht_.insert_unique(mystl::move(nh)).position; }
+
+  void      merge(unordered_map& other)
+  { ht_.merge_unique(other.ht_); }
+  void      merge(unordered_multimap<Key, T, Hash, KeyEqual, BucketPolicy>& other)
+  { ht_.merge_unique(other.ht_); }
+
   // 查找相关
 
   mapped_type& at(const key_type& key)
@@ -201,19 +266,9 @@ public:
   }
 
   mapped_type& operator[](const key_type& key)
-  {
-    iterator it = ht_.find(key);
-    if (it.node == nullptr)
-      it = ht_.emplace_unique(key, T{}).first;
-    return it->second;
-  }
+  { return try_emplace(key).first->second; }
   mapped_type& operator[](key_type&& key)
-  {
-    iterator it = ht_.find(key);
-    if (it.node == nullptr)
-      it = ht_.emplace_unique(mystl::move(key), T{}).first;
-    return it->second;
-  }
+  { return try_emplace(mystl::move(key)).first->second; }
 
   size_type      count(const key_type& key) const 
   { return ht_.count(key); }
@@ -228,6 +283,39 @@ public:
   pair<const_iterator, const_iterator> equal_range(const key_type& key) const
   { return ht_.equal_range_unique(key); }
 
+  // 透明查找，Hash 与 KeyEqual 都定义了 is_transparent 时可用
+
+  template <class K, class H = Hash, mystl::enable_if_transparent<H, KeyEqual> = 0>
+  size_type      count(const K& key) const
+  { return ht_.count(key); }
+
+  template <class K, class H = Hash, mystl::enable_if_transparent<H, KeyEqual> = 0>
+  iterator       find(const K& key)
+  { return ht_.find(key); }
+  template <class K, class H = Hash, mystl::enable_if_transparent<H, KeyEqual> = 0>
+  const_iterator find(const K& key)  const
+  { return ht_.find(key); }
+
+  template <class K, class H = Hash, mystl::enable_if_transparent<H, KeyEqual> = 0>
+  pair<iterator, iterator> equal_range(const K& key)
+  { return ht_.equal_range_unique(key); }
+  template <class K, class H = Hash, mystl::enable_if_transparent<H, KeyEqual> = 0>
+  pair<const_iterator, const_iterator> equal_range(const K& key) const
+  { return ht_.equal_range_unique(key); }
+
+  // 批量查找，每组先预取再比较，把结果依次写到 result
+
+  template <class ForwardIter, class OutputIter>
+  OutputIter find_batch(ForwardIter first, ForwardIter last, OutputIter result)
+  { return ht_.find_batch(first, last, result); }
+  template <class ForwardIter, class OutputIter>
+  OutputIter find_batch(ForwardIter first, ForwardIter last, OutputIter result) const
+  { return ht_.find_batch(first, last, result); }
+
+  template <class ForwardIter, class OutputIter>
+  OutputIter count_batch(ForwardIter first, ForwardIter last, OutputIter result) const
+  { return ht_.count_batch(first, last, result); }
+
   // bucket interface
 
   local_iterator       begin(size_type n)        noexcept
@@ -264,9 +352,16 @@ public:
   void      rehash(size_type count)                 { ht_.rehash(count); }
   void      reserve(size_type count)                { ht_.reserve(count); }
 
+  bool      incremental_rehash()     const noexcept { return ht_.incremental_rehash(); }
+  void      incremental_rehash(bool on)             { ht_.incremental_rehash(on); }
+
   hasher    hash_fcn()               const          { return ht_.hash_fcn(); }
   key_equal key_eq()                 const          { return ht_.key_eq(); }
 
+  // 诊断信息
+  ht_stats  stats()                  const          { return ht_.stats(); }
+  void      reset_stats()            noexcept       { ht_.reset_stats(); }
+
 public:
   friend bool operator==(const unordered_map& lhs, const unordered_map& rhs)
   {
@@ -279,24 +374,24 @@ public:
 };
 
 // 重载比较操作符
-template <class Key, class T, class Hash, class KeyEqual>
-bool operator==(const unordered_map<Key, T, Hash, KeyEqual>& lhs,
-                const unordered_map<Key, T, Hash, KeyEqual>& rhs)
+template <class Key, class T, class Hash, class KeyEqual, class BucketPolicy>
+bool operator==(const unordered_map<Key, T, Hash, KeyEqual, BucketPolicy>& lhs,
+                const unordered_map<Key, T, Hash, KeyEqual, BucketPolicy>& rhs)
 {
   return lhs == rhs;
 }
 
-template <class Key, class T, class Hash, class KeyEqual>
-bool operator!=(const unordered_map<Key, T, Hash, KeyEqual>& lhs,
-                const unordered_map<Key, T, Hash, KeyEqual>& rhs)
+template <class Key, class T, class Hash, class KeyEqual, class BucketPolicy>
+bool operator!=(const unordered_map<Key, T, Hash, KeyEqual, BucketPolicy>& lhs,
+                const unordered_map<Key, T, Hash, KeyEqual, BucketPolicy>& rhs)
 {
   return lhs != rhs;
 }
 
 // 重载 mystl 的 swap
-template <class Key, class T, class Hash, class KeyEqual>
-void swap(unordered_map<Key, T, Hash, KeyEqual>& lhs,
-          unordered_map<Key, T, Hash, KeyEqual>& rhs)
+template <class Key, class T, class Hash, class KeyEqual, class BucketPolicy>
+void swap(unordered_map<Key, T, Hash, KeyEqual, BucketPolicy>& lhs,
+          unordered_map<Key, T, Hash, KeyEqual, BucketPolicy>& rhs)
 {
   lhs.swap(rhs);
 }
@@ -306,14 +401,18 @@ void swap(unordered_map<Key, T, Hash, KeyEqual>& lhs,
 // 模板类 unordered_multimap，键值允许重复
 // 参数一代表键值类型，参数二代表实值类型，参数三代表哈希函数，缺省使用 mystl::hash
 // 参数四代表键值比较方式，缺省使用 mystl::equal_to
-template <class Key, class T, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>>
+// 参数五代表 bucket 策略，缺省使用 ht_prime_policy，键值的哈希值低位规律明显时可以用 ht_power2_policy
+template <class Key, class T, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>,
+          class BucketPolicy = mystl::ht_prime_policy>
 class unordered_multimap
 {
 private:
   // 使用 hashtable 作为底层机制
-  typedef hashtable<pair<const Key, T>, Hash, KeyEqual> base_type;
+  typedef hashtable<pair<const Key, T>, Hash, KeyEqual, BucketPolicy> base_type;
   base_type ht_;
 
+  friend class unordered_map<Key, T, Hash, KeyEqual, BucketPolicy>;
+
 public:
   // 使用 hashtable 的型别
   typedef typename base_type::allocator_type       allocator_type;
@@ -335,6 +434,8 @@ public:
   typedef typename base_type::local_iterator       local_iterator;
   typedef typename base_type::const_local_iterator const_local_iterator;
 
+  typedef typename base_type::node_handle_type     node_type;
+
   allocator_type get_allocator() const { return ht_.get_allocator(); }
 
 public:
@@ -357,10 +458,9 @@ public:
                      const size_type bucket_count = 100,
                      const Hash& hash = Hash(),
                      const KeyEqual& equal = KeyEqual())
-    :ht_(mystl::max(bucket_count, static_cast<size_type>(mystl::distance(first, last))), hash, equal)
+    :ht_(bucket_count, hash, equal)
   {
-    for (; first != last; ++first)
-      ht_.insert_multi_noresize(*first);
+    ht_.insert_multi(first, last);
   }
 
   unordered_multimap(std::initializer_list<value_type> ilist,
@@ -453,6 +553,11 @@ public:
   template <class InputIterator>
   void     insert(InputIterator first, InputIterator last) 
   { ht_.insert_multi(first, last); }
+
+  // 分组预取后插入，适合向远大于缓存的表中插入大量元素
+  template <class ForwardIter>
+  void insert_batch(ForwardIter first, ForwardIter last)
+  { ht_.insert_multi_batch(first, last); }
   
   // erase / clear
 
@@ -470,6 +575,23 @@ public:
   void      swap(unordered_multimap& other) noexcept 
   { ht_.swap(other.ht_); }
 
+  // 节点句柄，摘下、重新插入节点与合并容器都不分配也不释放节点
+
+  node_type extract(const_iterator position)
+  { return ht_.extract(position); }
+  node_type extract(const key_type& key)
+  { return ht_.extract(key); }
+
+  iterator  insert(node_type&& nh)
+  { return ht_.insert_multi(mystl::move(nh)); }
+  iterator  insert(const_iterator /*hint*/, node_type&& nh)
+  { return ht_.insert_multi(mystl::move(nh)); }
+
+  void      merge(unordered_multimap& other)
+  { ht_.merge_multi(other.ht_); }
+  void      merge(unordered_map<Key, T, Hash, KeyEqual, BucketPolicy>& other)
+  { ht_.merge_multi(other.ht_); }
+
   // 查找相关
 
   size_type      count(const key_type& key) const 
@@ -485,6 +607,39 @@ public:
   pair<const_iterator, const_iterator> equal_range(const key_type& key) const 
   { return ht_.equal_range_multi(key); }
 
+  // 透明查找，Hash 与 KeyEqual 都定义了 is_transparent 时可用
+
+  template <class K, class H = Hash, mystl::enable_if_transparent<H, KeyEqual> = 0>
+  size_type      count(const K& key) const
+  { return ht_.count(key); }
+
+  template <class K, class H = Hash, mystl::enable_if_transparent<H, KeyEqual> = 0>
+  iterator       find(const K& key)
+  { return ht_.find(key); }
+  template <class K, class H = Hash, mystl::enable_if_transparent<H, KeyEqual> = 0>
+  const_iterator find(const K& key)  const
+  { return ht_.find(key); }
+
+  template <class K, class H = Hash, mystl::enable_if_transparent<H, KeyEqual> = 0>
+  pair<iterator, iterator> equal_range(const K& key)
+  { return ht_.equal_range_multi(key); }
+  template <class K, class H = Hash, mystl::enable_if_transparent<H, KeyEqual> = 0>
+  pair<const_iterator, const_iterator> equal_range(const K& key) const
+  { return ht_.equal_range_multi(key); }
+
+  // 批量查找，每组先预取再比较，把结果依次写到 result
+
+  template <class ForwardIter, class OutputIter>
+  OutputIter find_batch(ForwardIter first, ForwardIter last, OutputIter result)
+  { return ht_.find_batch(first, last, result); }
+  template <class ForwardIter, class OutputIter>
+  OutputIter find_batch(ForwardIter first, ForwardIter last, OutputIter result) const
+  { return ht_.find_batch(first, last, result); }
+
+  template <class ForwardIter, class OutputIter>
+  OutputIter count_batch(ForwardIter first, ForwardIter last, OutputIter result) const
+  { return ht_.count_batch(first, last, result); }
+
   // bucket interface
 
   local_iterator       begin(size_type n)        noexcept
@@ -521,9 +676,16 @@ public:
   void      rehash(size_type count)                 { ht_.rehash(count); }
   void      reserve(size_type count)                { ht_.reserve(count); }
 
+  bool      incremental_rehash()     const noexcept { return ht_.incremental_rehash(); }
+  void      incremental_rehash(bool on)             { ht_.incremental_rehash(on); }
+
   hasher    hash_fcn()               const          { return ht_.hash_fcn(); }
   key_equal key_eq()                 const          { return ht_.key_eq(); }
 
+  // 诊断信息
+  ht_stats  stats()                  const          { return ht_.stats(); }
+  void      reset_stats()            noexcept       { ht_.reset_stats(); }
+
 public:
   friend bool operator==(const unordered_multimap& lhs, const unordered_multimap& rhs)
   {
@@ -536,24 +698,24 @@ public:
 };
 
 // 重载比较操作符
-template <class Key, class T, class Hash, class KeyEqual>
-bool operator==(const unordered_multimap<Key, T, Hash, KeyEqual>& lhs,
-                const unordered_multimap<Key, T, Hash, KeyEqual>& rhs)
+template <class Key, class T, class Hash, class KeyEqual, class BucketPolicy>
+bool operator==(const unordered_multimap<Key, T, Hash, KeyEqual, BucketPolicy>& lhs,
+                const unordered_multimap<Key, T, Hash, KeyEqual, BucketPolicy>& rhs)
 {
   return lhs == rhs;
 }
 
-template <class Key, class T, class Hash, class KeyEqual>
-bool operator!=(const unordered_multimap<Key, T, Hash, KeyEqual>& lhs,
-                const unordered_multimap<Key, T, Hash, KeyEqual>& rhs)
+template <class Key, class T, class Hash, class KeyEqual, class BucketPolicy>
+bool operator!=(const unordered_multimap<Key, T, Hash, KeyEqual, BucketPolicy>& lhs,
+                const unordered_multimap<Key, T, Hash, KeyEqual, BucketPolicy>& rhs)
 {
   return lhs != rhs;
 }
 
 // 重载 mystl 的 swap
-template <class Key, class T, class Hash, class KeyEqual>
-void swap(unordered_multimap<Key, T, Hash, KeyEqual>& lhs,
-          unordered_multimap<Key, T, Hash, KeyEqual>& rhs)
+template <class Key, class T, class Hash, class KeyEqual, class BucketPolicy>
+void swap(unordered_multimap<Key, T, Hash, KeyEqual, BucketPolicy>& lhs,
+          unordered_multimap<Key, T, Hash, KeyEqual, BucketPolicy>& rhs)
 {
   lhs.swap(rhs);
 }
@@ -17,17 +17,26 @@
 namespace mystl
 {
 
+// forward declaration
+
+template <class Key, class Hash, class KeyEqual, class BucketPolicy>
+class unordered_multiset;
+
 // 模板类 unordered_set，键值不允许重复
 // 参数一代表键值类型，参数二代表哈希函数，缺省使用 mystl::hash，
 // 参数三代表键值比较方式，缺省使用 mystl::equal_to
-template <class Key, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>>
+// 参数四代表 bucket 策略，缺省使用 ht_prime_policy，也可以使用 ht_power2_policy
+template <class Key, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>,
+          class BucketPolicy = mystl::ht_prime_policy>
 class unordered_set
 {
 private:
   // 使用 hashtable 作为底层机制
-  typedef hashtable<Key, Hash, KeyEqual> base_type;
+  typedef hashtable<Key, Hash, KeyEqual, BucketPolicy> base_type;
   base_type ht_;
 
+  friend class unordered_multiset<Key, Hash, KeyEqual, BucketPolicy>;
+
 public:
   // 使用 hashtable 的型别
   typedef typename base_type::allocator_type       allocator_type;
@@ -48,6 +57,9 @@ public:
   typedef typename base_type::const_local_iterator local_iterator;
   typedef typename base_type::const_local_iterator const_local_iterator;
 
+  typedef typename base_type::node_handle_type     node_type;
+  typedef typename base_type::insert_return_type   insert_return_type;
+
   allocator_type get_allocator() const { return ht_.get_allocator(); }
 
 public:
@@ -70,10 +82,9 @@ public:
                 const size_type bucket_count = 100,
                 const Hash& hash = Hash(),
                 const KeyEqual& equal = KeyEqual())
-    : ht_(mystl::max(bucket_count, static_cast<size_type>(mystl::distance(first, last))), hash, equal)
+    :ht_(bucket_count, hash, equal)
   {
-    for (; first != last; ++first)
-      ht_.insert_unique_noresize(*first);
+    ht_.insert_unique(first, last);
   }
 
   unordered_set(std::initializer_list<value_type> ilist,
@@ -167,6 +178,11 @@ public:
   void insert(InputIterator first, InputIterator last)
   { ht_.insert_unique(first, last); }
 
+  // 分组预取后插入，适合向远大于缓存的表中插入大量元素
+  template <class ForwardIter>
+  void insert_batch(ForwardIter first, ForwardIter last)
+  { ht_.insert_unique_batch(first, last); }
+
   // erase / clear
 
   void      erase(iterator it)
@@ -183,6 +199,23 @@ public:
   void      swap(unordered_set& other) noexcept
   { ht_.swap(other.ht_); }
 
+  // 节点句柄，摘下、重新插入节点与合并容器都不分配也不释放节点
+
+  node_type          extract(const_iterator position)
+  { return ht_.extract(position); }
+  node_type          extract(const key_type& key)
+  { return ht_.extract(key); }
+
+  insert_return_type insert(node_type&& nh)
+  { return ht_.insert_unique(mystl::move(nh)); }
+  iterator           insert(const_iterator /*hint*/, node_type&& nh)
+  { return ht_.insert_unique(mystl::move(nh)).position; }
+
+  void      merge(unordered_set& other)
+  { ht_.merge_unique(other.ht_); }
+  void      merge(unordered_multiset<Key, Hash, KeyEqual, BucketPolicy>& other)
+  { ht_.merge_unique(other.ht_); }
+
   // 查找相关
 
   size_type      count(const key_type& key) const 
@@ -198,6 +231,39 @@ public:
   pair<const_iterator, const_iterator> equal_range(const key_type& key) const
   { return ht_.equal_range_unique(key); }
 
+  // 透明查找，Hash 与 KeyEqual 都定义了 is_transparent 时可用
+
+  template <class K, class H = Hash, mystl::enable_if_transparent<H, KeyEqual> = 0>
+  size_type      count(const K& key) const
+  { return ht_.count(key); }
+
+  template <class K, class H = Hash, mystl::enable_if_transparent<H, KeyEqual> = 0>
+  iterator       find(const K& key)
+  { return ht_.find(key); }
+  template <class K, class H = Hash, mystl::enable_if_transparent<H, KeyEqual> = 0>
+  const_iterator find(const K& key)  const
+  { return ht_.find(key); }
+
+  template <class K, class H = Hash, mystl::enable_if_transparent<H, KeyEqual> = 0>
+  pair<iterator, iterator> equal_range(const K& key)
+  { return ht_.equal_range_unique(key); }
+  template <class K, class H = Hash, mystl::enable_if_transparent<H, KeyEqual> = 0>
+  pair<const_iterator, const_iterator> equal_range(const K& key) const
+  { return ht_.equal_range_unique(key); }
+
+  // 批量查找，每组先预取再比较，把结果依次写到 result
+
+  template <class ForwardIter, class OutputIter>
+  OutputIter find_batch(ForwardIter first, ForwardIter last, OutputIter result)
+  { return ht_.find_batch(first, last, result); }
+  template <class ForwardIter, class OutputIter>
+  OutputIter find_batch(ForwardIter first, ForwardIter last, OutputIter result) const
+  { return ht_.find_batch(first, last, result); }
+
+  template <class ForwardIter, class OutputIter>
+  OutputIter count_batch(ForwardIter first, ForwardIter last, OutputIter result) const
+  { return ht_.count_batch(first, last, result); }
+
   // bucket interface
 
   local_iterator       begin(size_type n)        noexcept
@@ -234,9 +300,16 @@ public:
   void      rehash(size_type count)                 { ht_.rehash(count); }
   void      reserve(size_type count)                { ht_.reserve(count); }
 
+  bool      incremental_rehash()     const noexcept { return ht_.incremental_rehash(); }
+  void      incremental_rehash(bool on)             { ht_.incremental_rehash(on); }
+
   hasher    hash_fcn()               const          { return ht_.hash_fcn(); }
   key_equal key_eq()                 const          { return ht_.key_eq(); }
 
+  // 诊断信息
+  ht_stats  stats()                  const          { return ht_.stats(); }
+  void      reset_stats()            noexcept       { ht_.reset_stats(); }
+
 
 public:
   friend bool operator==(const unordered_set& lhs, const unordered_set& rhs)
@@ -250,24 +323,24 @@ public:
 };
 
 // 重载比较操作符
-template <class Key, class Hash, class KeyEqual, class Alloc>
-bool operator==(const unordered_set<Key, Hash, KeyEqual>& lhs,
-                const unordered_set<Key, Hash, KeyEqual>& rhs)
+template <class Key, class Hash, class KeyEqual, class BucketPolicy>
+bool operator==(const unordered_set<Key, Hash, KeyEqual, BucketPolicy>& lhs,
+                const unordered_set<Key, Hash, KeyEqual, BucketPolicy>& rhs)
 {
   return lhs == rhs;
 }
 
-template <class Key, class Hash, class KeyEqual, class Alloc>
-bool operator!=(const unordered_set<Key, Hash, KeyEqual>& lhs,
-                const unordered_set<Key, Hash, KeyEqual>& rhs)
+template <class Key, class Hash, class KeyEqual, class BucketPolicy>
+bool operator!=(const unordered_set<Key, Hash, KeyEqual, BucketPolicy>& lhs,
+                const unordered_set<Key, Hash, KeyEqual, BucketPolicy>& rhs)
 {
   return lhs != rhs;
 }
 
 // 重载 mystl 的 swap
-template <class Key, class Hash, class KeyEqual, class Alloc>
-void swap(unordered_set<Key, Hash, KeyEqual>& lhs,
-          unordered_set<Key, Hash, KeyEqual>& rhs)
+template <class Key, class Hash, class KeyEqual, class BucketPolicy>
+void swap(unordered_set<Key, Hash, KeyEqual, BucketPolicy>& lhs,
+          unordered_set<Key, Hash, KeyEqual, BucketPolicy>& rhs)
 {
   lhs.swap(rhs);
 }
@@ -277,14 +350,18 @@ void swap(unordered_set<Key, Hash, KeyEqual>& lhs,
 // 模板类 unordered_multiset，键值允许重复
 // 参数一代表键值类型，参数二代表哈希函数，缺省使用 mystl::hash，
 // 参数三代表键值比较方式，缺省使用 mystl::equal_to
-template <class Key, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>>
+// 参数四代表 bucket 策略，缺省使用 ht_prime_policy，也可以使用 ht_power2_policy
+template <class Key, class Hash = mystl::hash<Key>, class KeyEqual = mystl::equal_to<Key>,
+          class BucketPolicy = mystl::ht_prime_policy>
 class unordered_multiset
 {
 private:
   // 使用 hashtable 作为底层机制
-  typedef hashtable<Key, Hash, KeyEqual> base_type;
+  typedef hashtable<Key, Hash, KeyEqual, BucketPolicy> base_type;
   base_type ht_;
 
+  friend class unordered_set<Key, Hash, KeyEqual, BucketPolicy>;
+
 public:
   // 使用 hashtable 的型别
   typedef typename base_type::allocator_type       allocator_type;
@@ -305,6 +382,8 @@ public:
   typedef typename base_type::const_local_iterator local_iterator;
   typedef typename base_type::const_local_iterator const_local_iterator;
 
+  typedef typename base_type::node_handle_type     node_type;
+
   allocator_type get_allocator() const { return ht_.get_allocator(); }
 
 public:
@@ -327,10 +406,9 @@ public:
                      const size_type bucket_count = 100,
                      const Hash& hash = Hash(),
                      const KeyEqual& equal = KeyEqual())
-    : ht_(mystl::max(bucket_count, static_cast<size_type>(mystl::distance(first, last))), hash, equal)
+    :ht_(bucket_count, hash, equal)
   {
-    for (; first != last; ++first)
-      ht_.insert_multi_noresize(*first);
+    ht_.insert_multi(first, last);
   }
 
   unordered_multiset(std::initializer_list<value_type> ilist,
@@ -425,6 +503,11 @@ public:
   void     insert(InputIterator first, InputIterator last)
   { ht_.insert_multi(first, last); }
 
+  // 分组预取后插入，适合向远大于缓存的表中插入大量元素
+  template <class ForwardIter>
+  void insert_batch(ForwardIter first, ForwardIter last)
+  { ht_.insert_multi_batch(first, last); }
+
   // erase / clear
 
   void      erase(iterator it)
@@ -441,6 +524,23 @@ public:
   void      swap(unordered_multiset& other) noexcept 
   { ht_.swap(other.ht_); }
 
+  // 节点句柄，摘下、重新插入节点与合并容器都不分配也不释放节点
+
+  node_type extract(const_iterator position)
+  { return ht_.extract(position); }
+  node_type extract(const key_type& key)
+  { return ht_.extract(key); }
+
+  iterator  insert(node_type&& nh)
+  { return ht_.insert_multi(mystl::move(nh)); }
+  iterator  insert(const_iterator /*hint*/, node_type&& nh)
+  { return ht_.insert_multi(mystl::move(nh)); }
+
+  void      merge(unordered_multiset& other)
+  { ht_.merge_multi(other.ht_); }
+  void      merge(unordered_set<Key, Hash, KeyEqual, BucketPolicy>& other)
+  { ht_.merge_multi(other.ht_); }
+
   // 查找相关
 
   size_type      count(const key_type& key) const 
@@ -456,6 +556,39 @@ public:
   pair<const_iterator, const_iterator> equal_range(const key_type& key) const
   { return ht_.equal_range_multi(key); }
 
+  // 透明查找，Hash 与 KeyEqual 都定义了 is_transparent 时可用
+
+  template <class K, class H = Hash, mystl::enable_if_transparent<H, KeyEqual> = 0>
+  size_type      count(const K& key) const
+  { return ht_.count(key); }
+
+  template <class K, class H = Hash, mystl::enable_if_transparent<H, KeyEqual> = 0>
+  iterator       find(const K& key)
+  { return ht_.find(key); }
+  template <class K, class H = Hash, mystl::enable_if_transparent<H, KeyEqual> = 0>
+  const_iterator find(const K& key)  const
+  { return ht_.find(key); }
+
+  template <class K, class H = Hash, mystl::enable_if_transparent<H, KeyEqual> = 0>
+  pair<iterator, iterator> equal_range(const K& key)
+  { return ht_.equal_range_multi(key); }
+  template <class K, class H = Hash, mystl::enable_if_transparent<H, KeyEqual> = 0>
+  pair<const_iterator, const_iterator> equal_range(const K& key) const
+  { return ht_.equal_range_multi(key); }
+
+  // 批量查找，每组先预取再比较，把结果依次写到 result
+
+  template <class ForwardIter, class OutputIter>
+  OutputIter find_batch(ForwardIter first, ForwardIter last, OutputIter result)
+  { return ht_.find_batch(first, last, result); }
+  template <class ForwardIter, class OutputIter>
+  OutputIter find_batch(ForwardIter first, ForwardIter last, OutputIter result) const
+  { return ht_.find_batch(first, last, result); }
+
+  template <class ForwardIter, class OutputIter>
+  OutputIter count_batch(ForwardIter first, ForwardIter last, OutputIter result) const
+  { return ht_.count_batch(first, last, result); }
+
   // bucket interface
 
   local_iterator       begin(size_type n)        noexcept
@@ -492,9 +625,16 @@ public:
   void      rehash(size_type count)                 { ht_.rehash(count); }
   void      reserve(size_type count)                { ht_.reserve(count); }
 
+  bool      incremental_rehash()     const noexcept { return ht_.incremental_rehash(); }
+  void      incremental_rehash(bool on)             { ht_.incremental_rehash(on); }
+
   hasher    hash_fcn()               const          { return ht_.hash_fcn(); }
   key_equal key_eq()                 const          { return ht_.key_eq(); }
 
+  // 诊断信息
+  ht_stats  stats()                  const          { return ht_.stats(); }
+  void      reset_stats()            noexcept       { ht_.reset_stats(); }
+
 public:
   friend bool operator==(const unordered_multiset& lhs, const unordered_multiset& rhs)
   {
@@ -507,24 +647,24 @@ public:
 };
 
 // 重载比较操作符
-template <class Key, class Hash, class KeyEqual, class Alloc>
-bool operator==(const unordered_multiset<Key, Hash, KeyEqual>& lhs,
-                const unordered_multiset<Key, Hash, KeyEqual>& rhs)
+template <class Key, class Hash, class KeyEqual, class BucketPolicy>
+bool operator==(const unordered_multiset<Key, Hash, KeyEqual, BucketPolicy>& lhs,
+                const unordered_multiset<Key, Hash, KeyEqual, BucketPolicy>& rhs)
 {
   return lhs == rhs;
 }
 
-template <class Key, class Hash, class KeyEqual, class Alloc>
-bool operator!=(const unordered_multiset<Key, Hash, KeyEqual>& lhs,
-                const unordered_multiset<Key, Hash, KeyEqual>& rhs)
+template <class Key, class Hash, class KeyEqual, class BucketPolicy>
+bool operator!=(const unordered_multiset<Key, Hash, KeyEqual, BucketPolicy>& lhs,
+                const unordered_multiset<Key, Hash, KeyEqual, BucketPolicy>& rhs)
 {
   return lhs != rhs;
 }
 
 // 重载 mystl 的 swap
-template <class Key, class Hash, class KeyEqual, class Alloc>
-void swap(unordered_multiset<Key, Hash, KeyEqual>& lhs,
-          unordered_multiset<Key, Hash, KeyEqual>& rhs)
+template <class Key, class Hash, class KeyEqual, class BucketPolicy>
+void swap(unordered_multiset<Key, Hash, KeyEqual, BucketPolicy>& lhs,
+          unordered_multiset<Key, Hash, KeyEqual, BucketPolicy>& rhs)
 {
   lhs.swap(rhs);
 }
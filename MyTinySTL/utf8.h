@@ -0,0 +1,458 @@
+﻿#ifndef MYTINYSTL_UTF8_H_
+#define MYTINYSTL_UTF8_H_
+
+// 这个头文件包含 UTF-8 的校验，以及 UTF-8 与 UTF-16 / UTF-32 之间的转换函数
+
+// notes:
+//
+// 1. 以指针为参数的转换函数要求输入合法，目标空间由调用者预先分配好，
+//    所需的长度可以由 xxx_length_from_xxx 算出，返回值为写入的字符个数
+// 2. 以 basic_string 为参数的转换函数会重用目标已有的空间，输入非法时返回 false 并清空目标
+// 3. 连续的 ASCII 字符每次处理 16 个字节，其余字符逐个解码
+
+#include "astring.h"
+#include "simd.h"
+
+namespace mystl
+{
+
+/*****************************************************************************************/
+// helper function
+
+// 解码一个 UTF-8 字符，成功返回所占字节数，非法（截断、过长编码、代理区、超出范围）返回 0
+inline size_t utf8_decode(const unsigned char* p, size_t n, char32_t& cp) noexcept
+{
+  const unsigned c = p[0];
+  if (c < 0x80)
+  {
+    cp = c;
+    return 1;
+  }
+  if (c < 0xc2)
+    return 0;
+  if (c < 0xe0)
+  {
+    if (n < 2 || (p[1] & 0xc0) != 0x80)
+      return 0;
+    cp = ((c & 0x1f) << 6) | (p[1] & 0x3f);
+    return 2;
+  }
+  if (c < 0xf0)
+  {
+    if (n < 3 || (p[1] & 0xc0) != 0x80 || (p[2] & 0xc0) != 0x80)
+      return 0;
+    cp = ((c & 0x0f) << 12) | ((p[1] & 0x3f) << 6) | (p[2] & 0x3f);
+    if (cp < 0x800 || (cp >= 0xd800 && cp <= 0xdfff))
+      return 0;
+    return 3;
+  }
+  if (c < 0xf5)
+  {
+    if (n < 4 || (p[1] & 0xc0) != 0x80 || (p[2] & 0xc0) != 0x80 || (p[3] & 0xc0) != 0x80)
+      return 0;
+    cp = ((c & 0x07) << 18) | ((p[1] & 0x3f) << 12) | ((p[2] & 0x3f) << 6) | (p[3] & 0x3f);
+    if (cp < 0x10000 || cp > 0x10ffff)
+      return 0;
+    return 4;
+  }
+  return 0;
+}
+
+// 把一个码点编码为 UTF-8，返回写入的字节数
+inline size_t utf8_encode(char32_t cp, char* dst) noexcept
+{
+  if (cp < 0x80)
+  {
+    dst[0] = static_cast<char>(cp);
+    return 1;
+  }
+  if (cp < 0x800)
+  {
+    dst[0] = static_cast<char>(0xc0 | (cp >> 6));
+    dst[1] = static_cast<char>(0x80 | (cp & 0x3f));
+    return 2;
+  }
+  if (cp < 0x10000)
+  {
+    dst[0] = static_cast<char>(0xe0 | (cp >> 12));
+    dst[1] = static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+    dst[2] = static_cast<char>(0x80 | (cp & 0x3f));
+    return 3;
+  }
+  dst[0] = static_cast<char>(0xf0 | (cp >> 18));
+  dst[1] = static_cast<char>(0x80 | ((cp >> 12) & 0x3f));
+  dst[2] = static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+  dst[3] = static_cast<char>(0x80 | (cp & 0x3f));
+  return 4;
+}
+
+// 一个码点编码为 UTF-8 所需的字节数
+inline size_t utf8_width(char32_t cp) noexcept
+{
+  return cp < 0x80 ? 1 : cp < 0x800 ? 2 : cp < 0x10000 ? 3 : 4;
+}
+
+// 跳过开头连续的 ASCII 字节，返回跳过的字节数（16 字节一组）
+inline size_t utf8_ascii_prefix(const unsigned char* p, size_t n) noexcept
+{
+  size_t i = 0;
+#ifdef MYSTL_HAS_SSE2
+  for (; i + 16 <= n; i += 16)
+  {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+    if (_mm_movemask_epi8(v) != 0)
+      break;
+  }
+#else
+  (void)p;
+  (void)n;
+#endif
+  return i;
+}
+
+/*****************************************************************************************/
+// utf8_validate
+// 检查 [s, s + n) 是否为合法的 UTF-8
+/*****************************************************************************************/
+inline bool utf8_validate(const char* s, size_t n) noexcept
+{
+  auto p = reinterpret_cast<const unsigned char*>(s);
+  size_t i = 0;
+  char32_t cp;
+  while (i < n)
+  {
+    i += utf8_ascii_prefix(p + i, n - i);
+    if (i == n)
+      break;
+    const auto len = utf8_decode(p + i, n - i, cp);
+    if (len == 0)
+      return false;
+    i += len;
+  }
+  return true;
+}
+
+inline bool utf8_validate(const string& s) noexcept
+{
+  return utf8_validate(s.begin(), s.size());
+}
+
+// 检查 UTF-16 是否合法，即代理对是否成对出现
+inline bool utf16_validate(const char16_t* s, size_t n) noexcept
+{
+  for (size_t i = 0; i < n; ++i)
+  {
+    const char32_t c = s[i];
+    if (c >= 0xd800 && c <= 0xdbff)
+    {
+      if (i + 1 == n || s[i + 1] < 0xdc00 || s[i + 1] > 0xdfff)
+        return false;
+      ++i;
+    }
+    else if (c >= 0xdc00 && c <= 0xdfff)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// 检查 UTF-32 是否合法，即不含代理区且不超出范围
+inline bool utf32_validate(const char32_t* s, size_t n) noexcept
+{
+  for (size_t i = 0; i < n; ++i)
+  {
+    if (s[i] > 0x10ffff || (s[i] >= 0xd800 && s[i] <= 0xdfff))
+      return false;
+  }
+  return true;
+}
+
+/*****************************************************************************************/
+// 计算转换后的长度，输入须合法
+
+// UTF-8 转为 UTF-32 后的长度，即非后续字节的个数
+inline size_t utf32_length_from_utf8(const char* s, size_t n) noexcept
+{
+  auto p = reinterpret_cast<const unsigned char*>(s);
+  size_t i = 0, len = 0;
+#ifdef MYSTL_HAS_SSE2
+  // 作为有符号数，后续字节 0x80 ~ 0xbf 不大于 -65，其余字节都大于 -65
+  const __m128i lead = _mm_set1_epi8(-65);
+  const __m128i one = _mm_set1_epi8(1);
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16 <= n; i += 16)
+  {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+    const __m128i sum = _mm_sad_epu8(_mm_and_si128(_mm_cmpgt_epi8(v, lead), one), zero);
+    len += static_cast<size_t>(_mm_cvtsi128_si32(sum) + _mm_extract_epi16(sum, 4));
+  }
+#endif
+  for (; i < n; ++i)
+    len += (p[i] & 0xc0) != 0x80;
+  return len;
+}
+
+// UTF-8 转为 UTF-16 后的长度，四字节的字符需要一个代理对
+inline size_t utf16_length_from_utf8(const char* s, size_t n) noexcept
+{
+  auto p = reinterpret_cast<const unsigned char*>(s);
+  size_t i = 0, len = 0;
+#ifdef MYSTL_HAS_SSE2
+  // 作为有符号数，四字节字符的首字节 0xf0 ~ 0xf4 在 (-17, 0) 之间
+  const __m128i lead = _mm_set1_epi8(-65);
+  const __m128i lead4 = _mm_set1_epi8(-17);
+  const __m128i one = _mm_set1_epi8(1);
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16 <= n; i += 16)
+  {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+    const __m128i is_lead = _mm_and_si128(_mm_cmpgt_epi8(v, lead), one);
+    const __m128i is_lead4 = _mm_and_si128(
+      _mm_and_si128(_mm_cmpgt_epi8(v, lead4), _mm_cmplt_epi8(v, zero)), one);
+    const __m128i sum = _mm_sad_epu8(_mm_add_epi8(is_lead, is_lead4), zero);
+    len += static_cast<size_t>(_mm_cvtsi128_si32(sum) + _mm_extract_epi16(sum, 4));
+  }
+#endif
+  for (; i < n; ++i)
+    len += ((p[i] & 0xc0) != 0x80) + (p[i] >= 0xf0);
+  return len;
+}
+
+// UTF-16 转为 UTF-8 后的长度，代理对中的每一个单元各占两个字节
+inline size_t utf8_length_from_utf16(const char16_t* s, size_t n) noexcept
+{
+  size_t len = 0;
+  for (size_t i = 0; i < n; ++i)
+  {
+    const char16_t c = s[i];
+    len += 1 + (c >= 0x80) + (c >= 0x800 && (c < 0xd800 || c > 0xdfff));
+  }
+  return len;
+}
+
+// UTF-32 转为 UTF-8 后的长度
+inline size_t utf8_length_from_utf32(const char32_t* s, size_t n) noexcept
+{
+  size_t len = 0;
+  for (size_t i = 0; i < n; ++i)
+    len += utf8_width(s[i]);
+  return len;
+}
+
+/*****************************************************************************************/
+// utf8_transcode
+// 把 UTF-8 转为 UTF-16，从 out 开始写入并移动 out，遇到非法序列时停止，返回已转换的字节数
+/*****************************************************************************************/
+inline size_t utf8_transcode(const char* s, size_t n, char16_t*& out) noexcept
+{
+  auto p = reinterpret_cast<const unsigned char*>(s);
+  size_t i = 0;
+  char32_t cp;
+  while (i < n)
+  {
+#ifdef MYSTL_HAS_SSE2
+    if (p[i] < 0x80)
+    { // 16 个 ASCII 字节零扩展为 16 个 UTF-16 单元
+      const __m128i zero = _mm_setzero_si128();
+      for (; i + 16 <= n; i += 16, out += 16)
+      {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        if (_mm_movemask_epi8(v) != 0)
+          break;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(v, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpackhi_epi8(v, zero));
+      }
+      if (i == n)
+        break;
+    }
+#endif
+    const auto len = utf8_decode(p + i, n - i, cp);
+    if (len == 0)
+      break;
+    if (cp >= 0x10000)
+    {
+      cp -= 0x10000;
+      *out++ = static_cast<char16_t>(0xd800 + (cp >> 10));
+      *out++ = static_cast<char16_t>(0xdc00 + (cp & 0x3ff));
+    }
+    else
+    {
+      *out++ = static_cast<char16_t>(cp);
+    }
+    i += len;
+  }
+  return i;
+}
+
+// 把 UTF-8 转为 UTF-16，写入 dst 开始的空间，返回写入的字符个数
+inline size_t utf8_to_utf16(const char* s, size_t n, char16_t* dst) noexcept
+{
+  auto out = dst;
+  utf8_transcode(s, n, out);
+  return static_cast<size_t>(out - dst);
+}
+
+/*****************************************************************************************/
+// utf8_transcode
+// 把 UTF-8 转为 UTF-32，从 out 开始写入并移动 out，遇到非法序列时停止，返回已转换的字节数
+/*****************************************************************************************/
+inline size_t utf8_transcode(const char* s, size_t n, char32_t*& out) noexcept
+{
+  auto p = reinterpret_cast<const unsigned char*>(s);
+  size_t i = 0;
+  char32_t cp;
+  while (i < n)
+  {
+#ifdef MYSTL_HAS_SSE2
+    if (p[i] < 0x80)
+    { // 16 个 ASCII 字节零扩展为 16 个 UTF-32 单元
+      const __m128i zero = _mm_setzero_si128();
+      for (; i + 16 <= n; i += 16, out += 16)
+      {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        if (_mm_movemask_epi8(v) != 0)
+          break;
+        const __m128i lo = _mm_unpacklo_epi8(v, zero);
+        const __m128i hi = _mm_unpackhi_epi8(v, zero);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi16(lo, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4), _mm_unpackhi_epi16(lo, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpacklo_epi16(hi, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 12), _mm_unpackhi_epi16(hi, zero));
+      }
+      if (i == n)
+        break;
+    }
+#endif
+    const auto len = utf8_decode(p + i, n - i, cp);
+    if (len == 0)
+      break;
+    *out++ = cp;
+    i += len;
+  }
+  return i;
+}
+
+// 把 UTF-8 转为 UTF-32，写入 dst 开始的空间，返回写入的字符个数
+inline size_t utf8_to_utf32(const char* s, size_t n, char32_t* dst) noexcept
+{
+  auto out = dst;
+  utf8_transcode(s, n, out);
+  return static_cast<size_t>(out - dst);
+}
+
+/*****************************************************************************************/
+// utf16_to_utf8
+// 把 UTF-16 转为 UTF-8，写入 dst 开始的空间，返回写入的字节数
+/*****************************************************************************************/
+inline size_t utf16_to_utf8(const char16_t* s, size_t n, char* dst) noexcept
+{
+  auto out = dst;
+  size_t i = 0;
+  while (i < n)
+  {
+#ifdef MYSTL_HAS_SSE2
+    if (s[i] < 0x80)
+    { // 8 个 ASCII 单元压缩为 8 个字节
+      const __m128i zero = _mm_setzero_si128();
+      const __m128i high = _mm_set1_epi16(static_cast<short>(0xff80));
+      for (; i + 8 <= n; i += 8, out += 8)
+      {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(v, high), zero)) != 0xffff)
+          break;
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(v, v));
+      }
+      if (i == n)
+        break;
+    }
+#endif
+    char32_t cp = s[i++];
+    if (cp >= 0xd800 && cp <= 0xdbff && i < n)
+      cp = 0x10000 + ((cp - 0xd800) << 10) + (s[i++] - 0xdc00);
+    out += utf8_encode(cp, out);
+  }
+  return static_cast<size_t>(out - dst);
+}
+
+/*****************************************************************************************/
+// utf32_to_utf8
+// 把 UTF-32 转为 UTF-8，写入 dst 开始的空间，返回写入的字节数
+/*****************************************************************************************/
+inline size_t utf32_to_utf8(const char32_t* s, size_t n, char* dst) noexcept
+{
+  auto out = dst;
+  size_t i = 0;
+  while (i < n)
+  {
+#ifdef MYSTL_HAS_SSE2
+    if (s[i] < 0x80)
+    { // 8 个 ASCII 单元压缩为 8 个字节
+      const __m128i zero = _mm_setzero_si128();
+      const __m128i high = _mm_set1_epi32(~0x7f);
+      for (; i + 8 <= n; i += 8, out += 8)
+      {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + 4));
+        const __m128i h = _mm_and_si128(_mm_or_si128(a, b), high);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(h, zero)) != 0xffff)
+          break;
+        const __m128i w = _mm_packs_epi32(a, b);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(w, w));
+      }
+      if (i == n)
+        break;
+    }
+#endif
+    out += utf8_encode(s[i++], out);
+  }
+  return static_cast<size_t>(out - dst);
+}
+
+/*****************************************************************************************/
+// 以 basic_string 为参数的转换，dst 的大小会被调整为转换后的长度，输入非法时返回 false 并清空 dst
+/*****************************************************************************************/
+inline bool utf8_to_utf16(const string& src, u16string& dst)
+{ // 校验与转换在同一遍中完成
+  dst.resize(utf16_length_from_utf8(src.begin(), src.size()));
+  auto out = dst.begin();
+  if (utf8_transcode(src.begin(), src.size(), out) != src.size())
+  {
+    dst.clear();
+    return false;
+  }
+  return true;
+}
+
+inline bool utf8_to_utf32(const string& src, u32string& dst)
+{ // 校验与转换在同一遍中完成
+  dst.resize(utf32_length_from_utf8(src.begin(), src.size()));
+  auto out = dst.begin();
+  if (utf8_transcode(src.begin(), src.size(), out) != src.size())
+  {
+    dst.clear();
+    return false;
+  }
+  return true;
+}
+
+inline bool utf16_to_utf8(const u16string& src, string& dst)
+{
+  if (!utf16_validate(src.begin(), src.size()))
+    return false;
+  dst.resize(utf8_length_from_utf16(src.begin(), src.size()));
+  utf16_to_utf8(src.begin(), src.size(), dst.begin());
+  return true;
+}
+
+inline bool utf32_to_utf8(const u32string& src, string& dst)
+{
+  if (!utf32_validate(src.begin(), src.size()))
+    return false;
+  dst.resize(utf8_length_from_utf32(src.begin(), src.size()));
+  utf32_to_utf8(src.begin(), src.size(), dst.begin());
+  return true;
+}
+
+} // namespace mystl
+#endif // !MYTINYSTL_UTF8_H_
@@ -13,7 +13,7 @@ namespace mystl
 // move
 
 template <class T>
-typename std::remove_reference<T>::type&& move(T&& arg) noexcept
+constexpr typename std::remove_reference<T>::type&& move(T&& arg) noexcept
 {
   return static_cast<typename std::remove_reference<T>::type&&>(arg);
 }
@@ -21,13 +21,13 @@ typename std::remove_reference<T>::type&& move(T&& arg) noexcept
 // forward
 
 template <class T>
-T&& forward(typename std::remove_reference<T>::type& arg) noexcept
+constexpr T&& forward(typename std::remove_reference<T>::type& arg) noexcept
 {
   return static_cast<T&&>(arg);
 }
 
 template <class T>
-T&& forward(typename std::remove_reference<T>::type&& arg) noexcept
+constexpr T&& forward(typename std::remove_reference<T>::type&& arg) noexcept
 {
   static_assert(!std::is_lvalue_reference<T>::value, "bad forward");
   return static_cast<T&&>(arg);
@@ -60,6 +60,16 @@ void swap(Tp(&a)[N], Tp(&b)[N])
 // --------------------------------------------------------------------------------------
 // pair
 
+// emplace_key
+// 构造 pair 时 first 由第一个参数构造，其余参数就地构造 second，
+// 用于 map 的 try_emplace，second 不必先构造一个临时对象再移动
+struct emplace_key_t
+{
+  explicit emplace_key_t() = default;
+};
+
+constexpr emplace_key_t emplace_key = emplace_key_t();
+
 // 结构体模板 : pair
 // 两个模板参数分别表示两个数据的类型
 // 用 first 和 second 来分别取出第一个数据和第二个数据
@@ -187,6 +197,14 @@ struct pair
   {
   }
 
+  // first 由 a 构造，second 由 args 就地构造
+  template <class Other1, class ...Args>
+  constexpr pair(emplace_key_t, Other1&& a, Args&& ...args)
+    : first(mystl::forward<Other1>(a)),
+    second(mystl::forward<Args>(args)...)
+  {
+  }
+
   // copy assign for this pair
   pair& operator=(const pair& rhs)
   {
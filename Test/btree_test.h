@@ -0,0 +1,377 @@
+﻿#ifndef MYTINYSTL_BTREE_TEST_H_
+#define MYTINYSTL_BTREE_TEST_H_
+
+// btree test : 测试 btree_map, btree_multimap, btree_set, btree_multiset 的接口，
+// 以及 btree_map 与 map 的插入、查找、有序遍历性能和每个元素占用的内存
+
+#include <map>
+#include <set>
+
+#include "../MyTinySTL/btree_map.h"
+#include "../MyTinySTL/btree_set.h"
+#include "../MyTinySTL/map.h"
+#include "../MyTinySTL/set.h"
+#include "../MyTinySTL/vector.h"
+#include "map_test.h"
+#include "test.h"
+
+namespace mystl
+{
+namespace test
+{
+namespace btree_test
+{
+
+typedef std::map<int, int>                                               std_map_type;
+typedef mystl::map<int, int>                                             rb_map_type;
+typedef mystl::btree_map<int, int>                                       btree_map_type;
+typedef std::set<int>                                                    std_set_type;
+typedef mystl::set<int>                                                  rb_set_type;
+typedef mystl::btree_set<int>                                            btree_set_type;
+
+// btree_map 的内存直接由节点个数算出
+using map_test::map_memory;
+using map_test::std_counting_map;
+using map_test::mystl_counting_map;
+using map_test::counting_bytes;
+
+inline size_t map_memory(const btree_map_type& c)
+{
+  return c.bytes_used();
+}
+
+// 插入 count 个随机键值，再按 mode 测量
+#define BTREE_DO_TEST(con, mode, count) do {                 \
+  srand((int)time(0));                                       \
+  clock_t start, end;                                        \
+  char buf[16];                                              \
+  con c;                                                     \
+  mystl::vector<int> keys;                                   \
+  keys.reserve(count);                                       \
+  volatile size_t total = 0;                                 \
+  BTREE_##mode(c, count);                                    \
+  (void)total;                                               \
+  std::string t = buf;                                       \
+  std::cout << std::setw(WIDE) << t;                         \
+} while(0)
+
+#define BTREE_FILL(c, count)                                 \
+  for (size_t i = 0; i < count; ++i)                         \
+  {                                                          \
+    keys.push_back(rand());                                  \
+    c.emplace(keys.back());                                  \
+  }
+
+#define BTREE_MAP_FILL(c, count)                             \
+  for (size_t i = 0; i < count; ++i)                         \
+  {                                                          \
+    keys.push_back(rand());                                  \
+    c.emplace(keys.back(), static_cast<int>(i));             \
+  }
+
+#define BTREE_TIME(start, end)                               \
+  std::snprintf(buf, sizeof(buf), "%dms    |",               \
+    static_cast<int>(static_cast<double>(end - start)        \
+      / CLOCKS_PER_SEC * 1000));
+
+#define BTREE_emplace(c, count)                              \
+  start = clock();                                           \
+  BTREE_MAP_FILL(c, count);                                  \
+  end = clock();                                             \
+  BTREE_TIME(start, end);
+
+#define BTREE_find(c, count)                                 \
+  BTREE_MAP_FILL(c, count);                                  \
+  start = clock();                                           \
+  for (size_t i = 0; i < count; ++i)                         \
+    total += c.find(keys[(i * 7919) % count]) != c.end();    \
+  end = clock();                                             \
+  BTREE_TIME(start, end);
+
+#define BTREE_iterate(c, count)                              \
+  BTREE_MAP_FILL(c, count);                                  \
+  start = clock();                                           \
+  for (int pass = 0; pass < 10; ++pass)                      \
+    for (auto it = c.begin(); it != c.end(); ++it)           \
+      total += it->second;                                   \
+  end = clock();                                             \
+  BTREE_TIME(start, end);
+
+#define BTREE_memory(c, count)                               \
+  (void)start;                                               \
+  (void)end;                                                 \
+  counting_bytes() = 0;                                      \
+  BTREE_MAP_FILL(c, count);                                  \
+  std::snprintf(buf, sizeof(buf), "%.1fB    |",              \
+    static_cast<double>(map_memory(c)) / c.size());
+
+#define BTREE_set_emplace(c, count)                          \
+  start = clock();                                           \
+  BTREE_FILL(c, count);                                      \
+  end = clock();                                             \
+  BTREE_TIME(start, end);
+
+#define BTREE_set_find(c, count)                             \
+  BTREE_FILL(c, count);                                      \
+  start = clock();                                           \
+  for (size_t i = 0; i < count; ++i)                         \
+    total += c.find(keys[(i * 7919) % count]) != c.end();    \
+  end = clock();                                             \
+  BTREE_TIME(start, end);
+
+#define BTREE_MAP_TEST(mode, std_con, rb_con, len1, len2, len3) \
+  TEST_LEN(len1, len2, len3, WIDE);                          \
+  std::cout << "|      std::map       |";                    \
+  BTREE_DO_TEST(std_con, mode, len1);                        \
+  BTREE_DO_TEST(std_con, mode, len2);                        \
+  BTREE_DO_TEST(std_con, mode, len3);                        \
+  std::cout << "\n|     mystl::map      |";                  \
+  BTREE_DO_TEST(rb_con, mode, len1);                         \
+  BTREE_DO_TEST(rb_con, mode, len2);                         \
+  BTREE_DO_TEST(rb_con, mode, len3);                         \
+  std::cout << "\n|   mystl::btree_map  |";                  \
+  BTREE_DO_TEST(btree_map_type, mode, len1);                 \
+  BTREE_DO_TEST(btree_map_type, mode, len2);                 \
+  BTREE_DO_TEST(btree_map_type, mode, len3);
+
+#define BTREE_SET_TEST(mode, len1, len2, len3)               \
+  TEST_LEN(len1, len2, len3, WIDE);                          \
+  std::cout << "|      std::set       |";                    \
+  BTREE_DO_TEST(std_set_type, mode, len1);                   \
+  BTREE_DO_TEST(std_set_type, mode, len2);                   \
+  BTREE_DO_TEST(std_set_type, mode, len3);                   \
+  std::cout << "\n|     mystl::set      |";                  \
+  BTREE_DO_TEST(rb_set_type, mode, len1);                    \
+  BTREE_DO_TEST(rb_set_type, mode, len2);                    \
+  BTREE_DO_TEST(rb_set_type, mode, len3);                    \
+  std::cout << "\n|   mystl::btree_set  |";                  \
+  BTREE_DO_TEST(btree_set_type, mode, len1);                 \
+  BTREE_DO_TEST(btree_set_type, mode, len2);                 \
+  BTREE_DO_TEST(btree_set_type, mode, len3);
+
+void btree_map_test()
+{
+  std::cout << "[===============================================================]" << std::endl;
+  std::cout << "[--------------- Run container test : btree_map ----------------]" << std::endl;
+  std::cout << "[-------------------------- API test ---------------------------]" << std::endl;
+  mystl::vector<PAIR> v;
+  for (int i = 0; i < 5; ++i)
+    v.push_back(PAIR(i, i));
+  mystl::btree_map<int, int> m1;
+  mystl::btree_map<int, int, mystl::greater<int>> m2;
+  mystl::btree_map<int, int> m3(v.begin(), v.end());
+  mystl::btree_map<int, int> m4(v.begin(), v.end());
+  mystl::btree_map<int, int> m5(m3);
+  mystl::btree_map<int, int> m6(std::move(m3));
+  mystl::btree_map<int, int> m7;
+  m7 = m4;
+  mystl::btree_map<int, int> m8;
+  m8 = std::move(m4);
+  mystl::btree_map<int, int> m9{ PAIR(1,1),PAIR(3,2),PAIR(2,3) };
+  mystl::btree_map<int, int> m10;
+  m10 = { PAIR(1,1),PAIR(3,2),PAIR(2,3) };
+
+  for (int i = 5; i > 0; --i)
+  {
+    MAP_FUN_AFTER(m1, m1.emplace(i, i));
+  }
+  MAP_FUN_AFTER(m1, m1.emplace_hint(m1.begin(), 0, 0));
+  MAP_FUN_AFTER(m1, m1.erase(m1.begin()));
+  MAP_FUN_AFTER(m1, m1.erase(0));
+  MAP_FUN_AFTER(m1, m1.erase(1));
+  MAP_FUN_AFTER(m1, m1.erase(m1.begin(), m1.end()));
+  for (int i = 0; i < 5; ++i)
+  {
+    MAP_FUN_AFTER(m1, m1.insert(PAIR(i, i)));
+  }
+  MAP_FUN_AFTER(m1, m1.insert(v.begin(), v.end()));
+  MAP_FUN_AFTER(m1, m1.insert(m1.end(), PAIR(5, 5)));
+  FUN_VALUE(m1.count(1));
+  MAP_VALUE(*m1.find(3));
+  MAP_VALUE(*m1.lower_bound(3));
+  MAP_VALUE(*m1.upper_bound(2));
+  auto first = *m1.equal_range(2).first;
+  auto second = *m1.equal_range(2).second;
+  std::cout << " m1.equal_range(2) : from <" << first.first << ", " << first.second
+    << "> to <" << second.first << ", " << second.second << ">" << std::endl;
+  MAP_VALUE(*m1.erase(m1.find(2)));
+  MAP_FUN_AFTER(m1, m1.erase(1));
+  MAP_FUN_AFTER(m1, m1.erase(m1.begin(), m1.find(4)));
+  MAP_FUN_AFTER(m1, m1.clear());
+  MAP_FUN_AFTER(m1, m1.swap(m9));
+  MAP_VALUE(*m1.begin());
+  MAP_VALUE(*m1.rbegin());
+  FUN_VALUE(m1[1]);
+  MAP_FUN_AFTER(m1, m1[1] = 3);
+  FUN_VALUE(m1.at(1));
+  MAP_FUN_AFTER(m1, m1.try_emplace(1, 10));
+  MAP_FUN_AFTER(m1, m1.try_emplace(7, 7));
+  MAP_FUN_AFTER(m1, m1.insert_or_assign(1, 10));
+  MAP_FUN_AFTER(m1, m1.insert_or_assign(8, 8));
+  std::cout << std::boolalpha;
+  FUN_VALUE(m1.empty());
+  FUN_VALUE((m7 == m8));
+  FUN_VALUE((m1 < m7));
+  std::cout << std::noboolalpha;
+  FUN_VALUE(m1.size());
+  FUN_VALUE(m1.max_size());
+  for (int i = 0; i < 1000; ++i)
+    m2.emplace_hint(m2.end(), 1000 - i, i);
+  MAP_VALUE(*m2.begin());
+  FUN_VALUE(m2.size());
+  FUN_VALUE(m2.bytes_used());
+
+  mystl::btree_multimap<int, int> mm;
+  for (int i = 0; i < 5; ++i)
+  {
+    mm.emplace(i % 3, i);
+  }
+  MAP_COUT(mm);
+  MAP_FUN_AFTER(mm, mm.insert(PAIR(1, 5)));
+  MAP_FUN_AFTER(mm, mm.emplace_hint(mm.begin(), 0, 6));
+  FUN_VALUE(mm.count(1));
+  MAP_VALUE(*mm.find(1));
+  MAP_VALUE(*mm.upper_bound(1));
+  MAP_FUN_AFTER(mm, mm.erase(1));
+  FUN_VALUE(mm.size());
+  PASSED;
+#if PERFORMANCE_TEST_ON
+  std::cout << "[--------------------- Performance Testing ---------------------]" << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|       emplace       |";
+#if LARGER_TEST_DATA_ON
+  BTREE_MAP_TEST(emplace, std_map_type, rb_map_type, SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  BTREE_MAP_TEST(emplace, std_map_type, rb_map_type, SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|    find (random)    |";
+#if LARGER_TEST_DATA_ON
+  BTREE_MAP_TEST(find, std_map_type, rb_map_type, SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  BTREE_MAP_TEST(find, std_map_type, rb_map_type, SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|  iterate x10 passes |";
+#if LARGER_TEST_DATA_ON
+  BTREE_MAP_TEST(iterate, std_map_type, rb_map_type, SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  BTREE_MAP_TEST(iterate, std_map_type, rb_map_type, SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|   bytes / element   |";
+#if LARGER_TEST_DATA_ON
+  BTREE_MAP_TEST(memory, std_counting_map, mystl_counting_map,
+                 SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  BTREE_MAP_TEST(memory, std_counting_map, mystl_counting_map,
+                 SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  PASSED;
+#endif
+  std::cout << "[--------------- End container test : btree_map ----------------]" << std::endl;
+}
+
+void btree_set_test()
+{
+  std::cout << "[===============================================================]" << std::endl;
+  std::cout << "[--------------- Run container test : btree_set ----------------]" << std::endl;
+  std::cout << "[-------------------------- API test ---------------------------]" << std::endl;
+  int a[] = { 5,4,3,2,1 };
+  mystl::btree_set<int> s1;
+  mystl::btree_set<int, mystl::greater<int>> s2;
+  mystl::btree_set<int> s3(a, a + 5);
+  mystl::btree_set<int> s4(a, a + 5);
+  mystl::btree_set<int> s5(s3);
+  mystl::btree_set<int> s6(std::move(s3));
+  mystl::btree_set<int> s7;
+  s7 = s4;
+  mystl::btree_set<int> s8;
+  s8 = std::move(s4);
+  mystl::btree_set<int> s9{ 1,2,3,4,5 };
+  mystl::btree_set<int> s10;
+  s10 = { 1,2,3,4,5 };
+
+  for (int i = 5; i > 0; --i)
+  {
+    FUN_AFTER(s1, s1.emplace(i));
+  }
+  FUN_AFTER(s1, s1.emplace_hint(s1.begin(), 0));
+  FUN_AFTER(s1, s1.erase(s1.begin()));
+  FUN_AFTER(s1, s1.erase(0));
+  FUN_AFTER(s1, s1.erase(1));
+  FUN_AFTER(s1, s1.erase(s1.begin(), s1.end()));
+  for (int i = 0; i < 5; ++i)
+  {
+    FUN_AFTER(s1, s1.insert(i));
+  }
+  FUN_AFTER(s1, s1.insert(a, a + 5));
+  FUN_AFTER(s1, s1.insert(5));
+  FUN_AFTER(s1, s1.insert(s1.end(), 5));
+  FUN_VALUE(s1.count(5));
+  FUN_VALUE(*s1.find(3));
+  FUN_VALUE(*s1.lower_bound(3));
+  FUN_VALUE(*s1.upper_bound(3));
+  auto first = *s1.equal_range(3).first;
+  auto second = *s1.equal_range(3).second;
+  std::cout << " s1.equal_range(3) : from " << first << " to " << second << std::endl;
+  FUN_VALUE(*s1.erase(s1.find(3)));
+  FUN_AFTER(s1, s1.erase(1));
+  FUN_AFTER(s1, s1.erase(s1.begin(), s1.find(4)));
+  FUN_AFTER(s1, s1.clear());
+  FUN_AFTER(s1, s1.swap(s5));
+  FUN_VALUE(*s1.begin());
+  FUN_VALUE(*s1.rbegin());
+  std::cout << std::boolalpha;
+  FUN_VALUE(s1.empty());
+  FUN_VALUE((s9 == s10));
+  std::cout << std::noboolalpha;
+  FUN_VALUE(s1.size());
+  FUN_VALUE(s1.max_size());
+  for (int i = 0; i < 1000; ++i)
+    s2.insert(i);
+  FUN_VALUE(*s2.begin());
+  FUN_VALUE(s2.size());
+  FUN_VALUE(s2.bytes_used());
+
+  mystl::btree_multiset<int> ms(a, a + 5);
+  FUN_AFTER(ms, ms.insert(a, a + 5));
+  FUN_AFTER(ms, ms.emplace(3));
+  FUN_VALUE(ms.count(3));
+  FUN_AFTER(ms, ms.erase(3));
+  FUN_AFTER(ms, ms.erase(ms.begin(), ms.upper_bound(2)));
+  FUN_VALUE(ms.size());
+  PASSED;
+#if PERFORMANCE_TEST_ON
+  std::cout << "[--------------------- Performance Testing ---------------------]" << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|       emplace       |";
+#if LARGER_TEST_DATA_ON
+  BTREE_SET_TEST(set_emplace, SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  BTREE_SET_TEST(set_emplace, SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|    find (random)    |";
+#if LARGER_TEST_DATA_ON
+  BTREE_SET_TEST(set_find, SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  BTREE_SET_TEST(set_find, SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  PASSED;
+#endif
+  std::cout << "[--------------- End container test : btree_set ----------------]" << std::endl;
+}
+
+} // namespace btree_test
+} // namespace test
+} // namespace mystl
+#endif // !MYTINYSTL_BTREE_TEST_H_
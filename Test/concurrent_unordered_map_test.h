@@ -0,0 +1,198 @@
+﻿#ifndef MYTINYSTL_CONCURRENT_UNORDERED_MAP_TEST_H_
+#define MYTINYSTL_CONCURRENT_UNORDERED_MAP_TEST_H_
+
+// concurrent_unordered_map test : 测试 concurrent_unordered_map 的接口，以及它与全局加锁的 unordered_map 在多线程下的性能
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../MyTinySTL/concurrent_unordered_map.h"
+#include "../MyTinySTL/unordered_map.h"
+#include "../MyTinySTL/algo.h"
+#include "map_test.h"
+#include "test.h"
+
+namespace mystl
+{
+namespace test
+{
+namespace concurrent_unordered_map_test
+{
+
+typedef mystl::concurrent_unordered_map<int, int> cmap_type;
+
+// 按键值排序后输出快照
+#define CMAP_COUT(m) do {                                    \
+  std::string m_name = #m;                                   \
+  std::cout << " " << m_name << " :";                        \
+  auto snap = m.snapshot();                                  \
+  mystl::sort(snap.begin(), snap.end());                     \
+  for (auto it : snap)                                       \
+    std::cout << " <" << it.first << "," << it.second << ">";\
+  std::cout << std::endl;                                    \
+} while(0)
+
+#define CMAP_FUN_AFTER(con, fun) do {                        \
+  std::string str = #fun;                                    \
+  std::cout << " After " << str << " :" << std::endl;        \
+  fun;                                                       \
+  CMAP_COUT(con);                                            \
+} while(0)
+
+// 用一个全局互斥锁保护的 unordered_map 作为对照
+struct locked_map
+{
+  std::mutex                     mtx;
+  mystl::unordered_map<int, int> map;
+
+  bool find(int key, int& value)
+  {
+    std::lock_guard<std::mutex> guard(mtx);
+    auto it = map.find(key);
+    if (it == map.end())
+      return false;
+    value = it->second;
+    return true;
+  }
+
+  void insert_or_assign(int key, int value)
+  {
+    std::lock_guard<std::mutex> guard(mtx);
+    map[key] = value;
+  }
+};
+
+static constexpr int cmap_key_range = 1 << 16;
+
+// threads 个线程共做 ops 次操作，十分之一是 insert_or_assign，其余是 find，返回耗时的毫秒数
+template <class Map>
+long long cmap_workload(Map& m, size_t threads, size_t ops)
+{
+  for (int i = 0; i < cmap_key_range; i += 2)
+    m.insert_or_assign(i, i);
+  std::vector<std::thread> workers;
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t t = 0; t < threads; ++t)
+  {
+    workers.emplace_back([&m, t, threads, ops]
+    {
+      // 每个线程用自己的 xorshift，rand 不是线程安全的
+      unsigned x = static_cast<unsigned>(t) * 2654435761u + 1;
+      int value = 0;
+      volatile int found = 0;
+      for (size_t i = t; i < ops; i += threads)
+      {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        const int key = static_cast<int>(x % cmap_key_range);
+        if (x % 10 == 0)
+          m.insert_or_assign(key, static_cast<int>(i));
+        else
+          found += m.find(key, value);
+      }
+      (void)found;
+    });
+  }
+  for (auto& w : workers)
+    w.join();
+  const auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+}
+
+#define CMAP_SCALING_ROW(threads, ops) do {                  \
+  char buf[32];                                              \
+  std::snprintf(buf, sizeof(buf), "|     %2d threads      |", \
+    static_cast<int>(threads));                              \
+  std::cout << buf;                                          \
+  locked_map lm;                                             \
+  cmap_type cm;                                              \
+  const long long t1 = cmap_workload(lm, threads, ops);      \
+  const long long t2 = cmap_workload(cm, threads, ops);      \
+  std::snprintf(buf, sizeof(buf), "%lldms    |", t1);        \
+  std::cout << std::setw(WIDE) << std::string(buf);          \
+  std::snprintf(buf, sizeof(buf), "%lldms    |", t2);        \
+  std::cout << std::setw(WIDE) << std::string(buf);          \
+  std::snprintf(buf, sizeof(buf), "%.1fx    |",              \
+    static_cast<double>(t1) / (t2 == 0 ? 1 : t2));           \
+  std::cout << std::setw(WIDE) << std::string(buf) << "\n";  \
+} while(0)
+
+#define CMAP_SCALING_TEST(ops)                               \
+  for (size_t threads = 1; threads <= 64; threads *= 2)      \
+    CMAP_SCALING_ROW(threads, ops);
+
+void concurrent_unordered_map_test()
+{
+  std::cout << "[===============================================================]" << std::endl;
+  std::cout << "[--------- Run container test : concurrent_unordered_map -------]" << std::endl;
+  std::cout << "[-------------------------- API test ---------------------------]" << std::endl;
+  cmap_type cm1;
+  cmap_type cm2(4);
+  cmap_type cm3(4, mystl::hash<int>());
+  cmap_type cm4(4, mystl::hash<int>(), mystl::equal_to<int>());
+
+  CMAP_FUN_AFTER(cm2, cm2.emplace(1, 1));
+  CMAP_FUN_AFTER(cm2, cm2.insert(PAIR(2, 2)));
+  CMAP_FUN_AFTER(cm2, cm2.insert_or_assign(2, 20));
+  CMAP_FUN_AFTER(cm2, cm2.insert_or_assign(3, 3));
+  CMAP_FUN_AFTER(cm2, cm2.compute(1, [](int& v) { v += 10; }));
+  CMAP_FUN_AFTER(cm2, cm2.compute(4, [](int& v) { v += 4; }));
+  CMAP_FUN_AFTER(cm2, cm2.compute_if_present(5, [](int& v) { v = 0; }));
+  CMAP_FUN_AFTER(cm2, cm2.erase(3));
+  int value = 0;
+  std::cout << std::boolalpha;
+  FUN_VALUE(cm2.find(1, value));
+  FUN_VALUE(value);
+  FUN_VALUE(cm2.find(3, value));
+  FUN_VALUE(cm2.empty());
+  FUN_VALUE(cm1.empty());
+  std::cout << std::noboolalpha;
+  FUN_VALUE(cm2.size());
+  FUN_VALUE(cm2.count(2));
+  FUN_VALUE(cm2.shard_count());
+  FUN_VALUE(cm2.stats(0).size);
+  FUN_VALUE(cm2.stats(0).bucket_count);
+  CMAP_FUN_AFTER(cm2, cm2.reserve(1000));
+  FUN_VALUE(cm2.stats(0).bucket_count);
+  int sum = 0;
+  cm2.for_each([&sum](const mystl::pair<const int, int>& p) { sum += p.second; });
+  FUN_VALUE(sum);
+  CMAP_FUN_AFTER(cm2, cm2.clear());
+  {
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t)
+    {
+      workers.emplace_back([&cm3]
+      {
+        for (int i = 0; i < 1000; ++i)
+          cm3.compute(i % 10, [](int& v) { ++v; });
+      });
+    }
+    for (auto& w : workers)
+      w.join();
+  }
+  CMAP_COUT(cm3);
+  PASSED;
+#if PERFORMANCE_TEST_ON
+  std::cout << "[--------------------- Performance Testing ---------------------]" << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "| 90% find, 10% write | global lock |   sharded   |   speedup   |" << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+#if LARGER_TEST_DATA_ON
+  CMAP_SCALING_TEST(SCALE_L(LEN2));
+#else
+  CMAP_SCALING_TEST(SCALE_M(LEN2));
+#endif
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  PASSED;
+#endif
+  std::cout << "[--------- End container test : concurrent_unordered_map -------]" << std::endl;
+}
+
+} // namespace concurrent_unordered_map_test
+} // namespace test
+} // namespace mystl
+#endif // !MYTINYSTL_CONCURRENT_UNORDERED_MAP_TEST_H_
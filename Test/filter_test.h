@@ -0,0 +1,315 @@
+﻿#ifndef MYTINYSTL_FILTER_TEST_H_
+#define MYTINYSTL_FILTER_TEST_H_
+
+// filter test : 测试 bloom_filter, cuckoo_filter 的接口，它们插入与查询的吞吐量以及实际的假阳性率
+
+#include <unordered_set>
+#include <vector>
+
+#include "../MyTinySTL/bloom_filter.h"
+#include "../MyTinySTL/cuckoo_filter.h"
+#include "../MyTinySTL/astring.h"
+#include "test.h"
+
+namespace mystl
+{
+namespace test
+{
+namespace filter_test
+{
+
+// 用 xorshift 生成 n 个 64 位的键值，种子不同的两组键值几乎不会相交
+inline std::vector<uint64_t> filter_keys(size_t n, uint64_t seed)
+{
+  std::vector<uint64_t> keys(n);
+  uint64_t x = seed * 0x9e3779b97f4a7c15ull + 1;
+  for (auto& k : keys)
+  {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    k = x;
+  }
+  return keys;
+}
+
+inline bool filter_contains(const std::unordered_set<uint64_t>& s, uint64_t key)
+{ return s.count(key) != 0; }
+
+template <class Filter>
+bool filter_contains(const Filter& f, uint64_t key)
+{ return f.contains(key); }
+
+#define FILTER_TIME_COUT(start, end) do {                    \
+  char buf[10];                                              \
+  int n = static_cast<int>(static_cast<double>(end - start)  \
+      / CLOCKS_PER_SEC * 1000);                              \
+  std::snprintf(buf, sizeof(buf), "%d", n);                  \
+  std::string t = buf;                                       \
+  t += "ms    |";                                            \
+  std::cout << std::setw(WIDE) << t;                         \
+} while(0)
+
+// 插入 len 个键值，decl 声明一个名为 c 的容器或过滤器
+#define FILTER_INSERT_DO_TEST(decl, len) do {                \
+  const auto keys = filter_keys(len, 1);                     \
+  clock_t start, end;                                        \
+  start = clock();                                           \
+  decl;                                                      \
+  for (auto k : keys)                                        \
+    c.insert(k);                                             \
+  end = clock();                                             \
+  FILTER_TIME_COUT(start, end);                              \
+} while(0)
+
+// 插入 len 个键值后查询 2 * len 次，一半是插入过的键值，一半不是
+#define FILTER_CONTAINS_DO_TEST(decl, len) do {              \
+  const auto keys = filter_keys(len, 1);                     \
+  const auto miss = filter_keys(len, 2);                     \
+  decl;                                                      \
+  for (auto k : keys)                                        \
+    c.insert(k);                                             \
+  volatile size_t total = 0;                                 \
+  clock_t start, end;                                        \
+  start = clock();                                           \
+  for (size_t i = 0; i < len; ++i)                           \
+  {                                                          \
+    total += filter_contains(c, keys[i]);                    \
+    total += filter_contains(c, miss[i]);                    \
+  }                                                          \
+  end = clock();                                             \
+  (void)total;                                               \
+  FILTER_TIME_COUT(start, end);                              \
+} while(0)
+
+#define FILTER_THROUGHPUT_TEST(DO_TEST, len1, len2, len3)    \
+  TEST_LEN(len1, len2, len3, WIDE);                          \
+  std::cout << "|  std unordered_set  |";                    \
+  DO_TEST(std::unordered_set<uint64_t> c, len1);             \
+  DO_TEST(std::unordered_set<uint64_t> c, len2);             \
+  DO_TEST(std::unordered_set<uint64_t> c, len3);             \
+  std::cout << "\n|    bloom_filter     |";                  \
+  DO_TEST(mystl::bloom_filter<uint64_t> c(len1, 0.01), len1); \
+  DO_TEST(mystl::bloom_filter<uint64_t> c(len2, 0.01), len2); \
+  DO_TEST(mystl::bloom_filter<uint64_t> c(len3, 0.01), len3); \
+  std::cout << "\n|    cuckoo_filter    |";                  \
+  DO_TEST(mystl::cuckoo_filter<uint64_t> c(len1, 0.01), len1); \
+  DO_TEST(mystl::cuckoo_filter<uint64_t> c(len2, 0.01), len2); \
+  DO_TEST(mystl::cuckoo_filter<uint64_t> c(len3, 0.01), len3);
+
+// 按目标假阳性率 fpp 构造并插入 len 个键值，用 10 * len 个没有插入过的键值测量假阳性率
+// 输出实际的假阳性率与每个键值占用的位数
+#define FILTER_FPP_DO_TEST(filter, fpp, len) do {            \
+  const auto keys = filter_keys(len, 1);                     \
+  const auto miss = filter_keys(10 * len, 2);                \
+  filter f(len, fpp);                                        \
+  for (auto k : keys)                                        \
+    f.insert(k);                                             \
+  size_t positive = 0;                                       \
+  for (auto k : miss)                                        \
+    positive += f.contains(k);                               \
+  char buf[32];                                              \
+  std::snprintf(buf, sizeof(buf), "%.3f%% %2.0fb |",          \
+                100.0 * positive / miss.size(),              \
+                8.0 * f.bytes() / len);                      \
+  std::cout << std::setw(WIDE) << std::string(buf);          \
+} while(0)
+
+#define FILTER_FPP_TEST(len)                                 \
+  std::cout << "       1%    |      0.1%   |     0.01%   |\n"; \
+  std::cout << "|    bloom_filter     |";                    \
+  FILTER_FPP_DO_TEST(mystl::bloom_filter<uint64_t>, 0.01, len);    \
+  FILTER_FPP_DO_TEST(mystl::bloom_filter<uint64_t>, 0.001, len);   \
+  FILTER_FPP_DO_TEST(mystl::bloom_filter<uint64_t>, 0.0001, len);  \
+  std::cout << "\n|    cuckoo_filter    |";                  \
+  FILTER_FPP_DO_TEST(mystl::cuckoo_filter<uint64_t>, 0.01, len);   \
+  FILTER_FPP_DO_TEST(mystl::cuckoo_filter<uint64_t>, 0.001, len);  \
+  FILTER_FPP_DO_TEST(mystl::cuckoo_filter<uint64_t>, 0.0001, len);
+
+void bloom_filter_test()
+{
+  std::cout << "[===============================================================]" << std::endl;
+  std::cout << "[-------------- Run container test : bloom_filter --------------]" << std::endl;
+  std::cout << "[-------------------------- API test ---------------------------]" << std::endl;
+  int a[] = { 1,2,3,4,5 };
+  mystl::bloom_filter<int> bf1;
+  mystl::bloom_filter<int> bf2(1000);
+  mystl::bloom_filter<int> bf3(1000, 0.001);
+  mystl::bloom_filter<int> bf4(1000, 0.001, mystl::hash<int>());
+  mystl::bloom_filter<mystl::string> bf5(100);
+  bf2.insert(a, a + 5);
+  mystl::bloom_filter<int> bf6(bf2);
+  mystl::bloom_filter<int> bf7(std::move(bf6));
+  mystl::bloom_filter<int> bf8;
+  bf8 = bf2;
+  mystl::bloom_filter<int> bf9;
+  bf9 = std::move(bf8);
+
+  std::cout << std::boolalpha;
+  FUN_VALUE(bf1.empty());
+  FUN_VALUE(bf2.contains(3));
+  FUN_VALUE(bf2.contains(6));
+  FUN_VALUE(bf7.contains(5));
+  FUN_VALUE(bf9.contains(1));
+  bf5.insert(mystl::string("apple"));
+  FUN_VALUE(bf5.contains(mystl::string("apple")));
+  FUN_VALUE(bf5.contains(mystl::string("banana")));
+  // 被移动过的 bf6 只剩一个空块，仍然可以插入与查询
+  FUN_VALUE(bf6.contains(5));
+  bf6.insert(7);
+  FUN_VALUE(bf6.contains(7));
+  std::cout << std::noboolalpha;
+  FUN_VALUE(bf6.block_count());
+  FUN_VALUE(bf6.estimated_fpp());
+  FUN_VALUE(bf1.block_count());
+  FUN_VALUE(bf2.size());
+  FUN_VALUE(bf2.block_count());
+  FUN_VALUE(bf3.block_count());
+  FUN_VALUE(bf3.bit_count());
+  FUN_VALUE(bf3.bytes());
+  FUN_VALUE(bf2.estimated_fpp());
+  FUN_VALUE((mystl::bloom_filter<int>::blocks_for(1000000, 0.01)));
+  // 目标低于每块一个键值的假阳性率时，块数多于键值个数
+  FUN_VALUE((mystl::bloom_filter<int>::blocks_for(1000, 1e-13)));
+  FUN_VALUE((mystl::bloom_filter<int>::block_fpp(
+    1000.0 / mystl::bloom_filter<int>::blocks_for(1000, 1e-13))));
+  for (int i = 100; i < 105; ++i)
+    bf4.insert(i);
+  bf3.insert(a, a + 5);
+  std::cout << std::boolalpha;
+  FUN_VALUE(bf3.contains(102));
+  bf3 |= bf4;
+  FUN_VALUE(bf3.contains(102));
+  FUN_VALUE(bf3.contains(3));
+  std::cout << std::noboolalpha;
+  FUN_VALUE(bf3.size());
+  try
+  {
+    bf3.merge(bf2);
+  }
+  catch (const std::runtime_error& e)
+  {
+    FUN_VALUE(e.what());
+  }
+  bf2.clear();
+  std::cout << std::boolalpha;
+  FUN_VALUE(bf2.contains(3));
+  FUN_VALUE(bf2.empty());
+  std::cout << std::noboolalpha;
+  PASSED;
+#if PERFORMANCE_TEST_ON
+  std::cout << "[--------------------- Performance Testing ---------------------]" << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|       insert        |";
+#if LARGER_TEST_DATA_ON
+  FILTER_THROUGHPUT_TEST(FILTER_INSERT_DO_TEST, SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  FILTER_THROUGHPUT_TEST(FILTER_INSERT_DO_TEST, SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "| contains (50% hit)  |";
+#if LARGER_TEST_DATA_ON
+  FILTER_THROUGHPUT_TEST(FILTER_CONTAINS_DO_TEST, SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  FILTER_THROUGHPUT_TEST(FILTER_CONTAINS_DO_TEST, SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "| fpp and bits / key  |";
+#if LARGER_TEST_DATA_ON
+  FILTER_FPP_TEST(SCALE_M(LEN2));
+#else
+  FILTER_FPP_TEST(SCALE_M(LEN1));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  PASSED;
+#endif
+  std::cout << "[-------------- End container test : bloom_filter --------------]" << std::endl;
+}
+
+void cuckoo_filter_test()
+{
+  std::cout << "[===============================================================]" << std::endl;
+  std::cout << "[------------- Run container test : cuckoo_filter --------------]" << std::endl;
+  std::cout << "[-------------------------- API test ---------------------------]" << std::endl;
+  mystl::cuckoo_filter<int> cf1;
+  mystl::cuckoo_filter<int> cf2(1000);
+  mystl::cuckoo_filter<int> cf3(1000, 0.01);
+  mystl::cuckoo_filter<int> cf4(1000, 0.01, mystl::hash<int>());
+  for (int i = 1; i <= 5; ++i)
+    cf2.insert(i);
+  mystl::cuckoo_filter<int> cf5(cf2);
+  mystl::cuckoo_filter<int> cf6(std::move(cf5));
+  mystl::cuckoo_filter<int> cf7;
+  cf7 = cf2;
+  mystl::cuckoo_filter<int> cf8;
+  cf8 = std::move(cf7);
+
+  std::cout << std::boolalpha;
+  FUN_VALUE(cf1.empty());
+  FUN_VALUE(cf2.contains(3));
+  FUN_VALUE(cf2.contains(6));
+  FUN_VALUE(cf6.contains(5));
+  FUN_VALUE(cf8.contains(1));
+  FUN_VALUE(cf2.erase(3));
+  FUN_VALUE(cf2.contains(3));
+  FUN_VALUE(cf2.erase(3));
+  // 被移动过的 cf5 只剩一个空桶，仍然可以插入、查询与删除
+  FUN_VALUE(cf5.contains(5));
+  FUN_VALUE(cf5.insert(7));
+  FUN_VALUE(cf5.contains(7));
+  FUN_VALUE(cf5.erase(7));
+  std::cout << std::noboolalpha;
+  FUN_VALUE(cf5.bucket_count());
+  FUN_VALUE(cf5.estimated_fpp());
+  FUN_VALUE(cf2.size());
+  FUN_VALUE(cf2.capacity());
+  FUN_VALUE(cf2.bucket_count());
+  FUN_VALUE(cf2.fingerprint_bits());
+  FUN_VALUE(cf3.fingerprint_bits());
+  FUN_VALUE(cf2.bytes());
+  FUN_VALUE(cf3.bytes());
+  FUN_VALUE(cf2.load_factor());
+  FUN_VALUE(cf2.estimated_fpp());
+  for (int i = 100; i < 105; ++i)
+    cf4.insert(i);
+  for (int i = 1; i <= 5; ++i)
+    cf3.insert(i);
+  std::cout << std::boolalpha;
+  FUN_VALUE(cf3.merge(cf4));
+  FUN_VALUE(cf3.contains(102));
+  std::cout << std::noboolalpha;
+  FUN_VALUE(cf3.size());
+  try
+  {
+    cf3.merge(cf2);
+  }
+  catch (const std::runtime_error& e)
+  {
+    FUN_VALUE(e.what());
+  }
+  // 装满之后插入失败，删除一些键值后又可以插入
+  mystl::cuckoo_filter<int> cf9(100);
+  int n = 0;
+  while (cf9.insert(n))
+    ++n;
+  FUN_VALUE(n);
+  FUN_VALUE(cf9.capacity());
+  std::cout << std::boolalpha;
+  FUN_VALUE(cf9.full());
+  for (int i = 0; i < 10; ++i)
+    cf9.erase(i);
+  FUN_VALUE(cf9.insert(-1));
+  std::cout << std::noboolalpha;
+  cf2.clear();
+  FUN_VALUE(cf2.size());
+  PASSED;
+  std::cout << "[------------- End container test : cuckoo_filter --------------]" << std::endl;
+}
+
+} // namespace filter_test
+} // namespace test
+} // namespace mystl
+#endif // !MYTINYSTL_FILTER_TEST_H_
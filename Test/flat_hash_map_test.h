@@ -0,0 +1,225 @@
+﻿#ifndef MYTINYSTL_FLAT_HASH_MAP_TEST_H_
+#define MYTINYSTL_FLAT_HASH_MAP_TEST_H_
+
+// flat_hash_map test : 测试 flat_hash_map 的接口，以及它与 unordered_map 的插入、查找性能和内存占用
+
+#include <unordered_map>
+
+#include "../MyTinySTL/flat_hash_map.h"
+#include "../MyTinySTL/unordered_map.h"
+#include "map_test.h"
+#include "test.h"
+
+namespace mystl
+{
+namespace test
+{
+namespace flat_hash_map_test
+{
+
+using map_test::counting_bytes;
+using map_test::counting_allocator;
+
+typedef std::unordered_map<int, int, std::hash<int>, std::equal_to<int>,
+  counting_allocator<std::pair<const int, int>>>                         std_map_type;
+typedef mystl::unordered_map<int, int>                                   um_map_type;
+typedef mystl::flat_hash_map<int, int>                                   flat_map_type;
+
+// 容器占用的字节数
+inline size_t map_memory(const std_map_type&)
+{
+  return counting_bytes();
+}
+
+inline size_t map_memory(const um_map_type& c)
+{
+  return c.size() * sizeof(mystl::hashtable_node<mystl::pair<const int, int>>) +
+    c.bucket_count() * sizeof(void*);
+}
+
+inline size_t map_memory(const flat_map_type& c)
+{
+  return c.bucket_count() * (sizeof(mystl::pair<const int, int>) + 1) + mystl::flat_group_width;
+}
+
+// 插入偶数键值，查找时用原来的键值命中，加一后不命中
+#define FLAT_MAP_DO_TEST(con, mode, count) do {              \
+  srand((int)time(0));                                       \
+  counting_bytes() = 0;                                      \
+  clock_t start, end;                                        \
+  char buf[16];                                              \
+  con c;                                                     \
+  std::vector<int> keys;                                     \
+  keys.reserve(count);                                       \
+  volatile size_t total = 0;                                 \
+  FLAT_MAP_##mode(c, count);                                 \
+  (void)total;                                               \
+  std::string t = buf;                                       \
+  std::cout << std::setw(WIDE) << t;                         \
+} while(0)
+
+#define FLAT_MAP_FILL(c, count)                              \
+  for (size_t i = 0; i < count; ++i)                         \
+  {                                                          \
+    keys.push_back(rand() & ~1);                             \
+    c.emplace(keys.back(), static_cast<int>(i));             \
+  }
+
+#define FLAT_MAP_TIME(start, end)                            \
+  std::snprintf(buf, sizeof(buf), "%dms    |",               \
+    static_cast<int>(static_cast<double>(end - start)        \
+      / CLOCKS_PER_SEC * 1000));
+
+#define FLAT_MAP_emplace(c, count)                           \
+  start = clock();                                           \
+  FLAT_MAP_FILL(c, count);                                   \
+  end = clock();                                             \
+  FLAT_MAP_TIME(start, end);
+
+#define FLAT_MAP_hit(c, count)                               \
+  FLAT_MAP_FILL(c, count);                                   \
+  start = clock();                                           \
+  for (size_t i = 0; i < count; ++i)                         \
+    total += c.find(keys[i]) != c.end();                     \
+  end = clock();                                             \
+  FLAT_MAP_TIME(start, end);
+
+#define FLAT_MAP_miss(c, count)                              \
+  FLAT_MAP_FILL(c, count);                                   \
+  start = clock();                                           \
+  for (size_t i = 0; i < count; ++i)                         \
+    total += c.find(keys[i] + 1) != c.end();                 \
+  end = clock();                                             \
+  FLAT_MAP_TIME(start, end);
+
+#define FLAT_MAP_memory(c, count)                            \
+  FLAT_MAP_FILL(c, count);                                   \
+  (void)start; (void)end;                                    \
+  std::snprintf(buf, sizeof(buf), "%.1fB    |",              \
+    static_cast<double>(map_memory(c)) / c.size());
+
+#define FLAT_MAP_TEST(mode, len1, len2, len3)                \
+  TEST_LEN(len1, len2, len3, WIDE);                          \
+  std::cout << "|  std unordered_map  |";                    \
+  FLAT_MAP_DO_TEST(std_map_type, mode, len1);                \
+  FLAT_MAP_DO_TEST(std_map_type, mode, len2);                \
+  FLAT_MAP_DO_TEST(std_map_type, mode, len3);                \
+  std::cout << "\n| mystl unordered_map |";                  \
+  FLAT_MAP_DO_TEST(um_map_type, mode, len1);                 \
+  FLAT_MAP_DO_TEST(um_map_type, mode, len2);                 \
+  FLAT_MAP_DO_TEST(um_map_type, mode, len3);                 \
+  std::cout << "\n| mystl flat_hash_map |";                  \
+  FLAT_MAP_DO_TEST(flat_map_type, mode, len1);               \
+  FLAT_MAP_DO_TEST(flat_map_type, mode, len2);               \
+  FLAT_MAP_DO_TEST(flat_map_type, mode, len3);
+
+void flat_hash_map_test()
+{
+  std::cout << "[===============================================================]" << std::endl;
+  std::cout << "[-------------- Run container test : flat_hash_map -------------]" << std::endl;
+  std::cout << "[-------------------------- API test ---------------------------]" << std::endl;
+  mystl::vector<PAIR> v;
+  for (int i = 0; i < 5; ++i)
+    v.push_back(PAIR(5 - i, 5 - i));
+  mystl::flat_hash_map<int, int> fm1;
+  mystl::flat_hash_map<int, int> fm2(520);
+  mystl::flat_hash_map<int, int> fm3(520, mystl::hash<int>());
+  mystl::flat_hash_map<int, int> fm4(520, mystl::hash<int>(), mystl::equal_to<int>());
+  mystl::flat_hash_map<int, int> fm5(v.begin(), v.end());
+  mystl::flat_hash_map<int, int> fm6(v.begin(), v.end(), 100);
+  mystl::flat_hash_map<int, int> fm7(v.begin(), v.end(), 100, mystl::hash<int>());
+  mystl::flat_hash_map<int, int> fm8(v.begin(), v.end(), 100, mystl::hash<int>(), mystl::equal_to<int>());
+  mystl::flat_hash_map<int, int> fm9(fm5);
+  mystl::flat_hash_map<int, int> fm10(std::move(fm5));
+  mystl::flat_hash_map<int, int> fm11;
+  fm11 = fm6;
+  mystl::flat_hash_map<int, int> fm12;
+  fm12 = std::move(fm6);
+  mystl::flat_hash_map<int, int> fm13{ PAIR(1,1),PAIR(2,3),PAIR(3,3) };
+  mystl::flat_hash_map<int, int> fm14;
+  fm14 = { PAIR(1,1),PAIR(2,3),PAIR(3,3) };
+
+  MAP_FUN_AFTER(fm1, fm1.emplace(1, 1));
+  MAP_FUN_AFTER(fm1, fm1.emplace_hint(fm1.begin(), 1, 2));
+  MAP_FUN_AFTER(fm1, fm1.insert(PAIR(2, 2)));
+  MAP_FUN_AFTER(fm1, fm1.insert(fm1.end(), PAIR(3, 3)));
+  MAP_FUN_AFTER(fm1, fm1.insert(v.begin(), v.end()));
+  MAP_FUN_AFTER(fm1, fm1.erase(fm1.begin()));
+  MAP_FUN_AFTER(fm1, fm1.erase(fm1.begin(), fm1.find(3)));
+  MAP_FUN_AFTER(fm1, fm1.erase(1));
+  std::cout << std::boolalpha;
+  FUN_VALUE(fm1.empty());
+  std::cout << std::noboolalpha;
+  FUN_VALUE(fm1.size());
+  FUN_VALUE(fm1.bucket_count());
+  MAP_FUN_AFTER(fm1, fm1.clear());
+  MAP_FUN_AFTER(fm1, fm1.swap(fm7));
+  MAP_VALUE(*fm1.begin());
+  FUN_VALUE(fm1.at(1));
+  FUN_VALUE(fm1[1]);
+  MAP_FUN_AFTER(fm1, fm1[6] = 6);
+  std::cout << std::boolalpha;
+  FUN_VALUE(fm1.empty());
+  FUN_VALUE((fm1 == fm7));
+  FUN_VALUE((fm8 == fm9));
+  std::cout << std::noboolalpha;
+  FUN_VALUE(fm1.size());
+  FUN_VALUE(fm1.max_size());
+  FUN_VALUE(fm1.bucket_count());
+  MAP_FUN_AFTER(fm1, fm1.reserve(1000));
+  FUN_VALUE(fm1.size());
+  FUN_VALUE(fm1.bucket_count());
+  MAP_FUN_AFTER(fm1, fm1.rehash(150));
+  FUN_VALUE(fm1.bucket_count());
+  FUN_VALUE(fm1.count(1));
+  MAP_VALUE(*fm1.find(3));
+  auto first = *fm1.equal_range(3).first;
+  std::cout << " fm1.equal_range(3) : from <" << first.first << ", " << first.second
+    << "> to next" << std::endl;
+  FUN_VALUE(fm1.load_factor());
+  FUN_VALUE(fm1.max_load_factor());
+  PASSED;
+#if PERFORMANCE_TEST_ON
+  std::cout << "[--------------------- Performance Testing ---------------------]" << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|       emplace       |";
+#if LARGER_TEST_DATA_ON
+  FLAT_MAP_TEST(emplace, SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  FLAT_MAP_TEST(emplace, SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|      find (hit)     |";
+#if LARGER_TEST_DATA_ON
+  FLAT_MAP_TEST(hit, SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  FLAT_MAP_TEST(hit, SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|     find (miss)     |";
+#if LARGER_TEST_DATA_ON
+  FLAT_MAP_TEST(miss, SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  FLAT_MAP_TEST(miss, SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|   bytes / element   |";
+#if LARGER_TEST_DATA_ON
+  FLAT_MAP_TEST(memory, SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  FLAT_MAP_TEST(memory, SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  PASSED;
+#endif
+  std::cout << "[-------------- End container test : flat_hash_map -------------]" << std::endl;
+}
+
+} // namespace flat_hash_map_test
+} // namespace test
+} // namespace mystl
+#endif // !MYTINYSTL_FLAT_HASH_MAP_TEST_H_
@@ -0,0 +1,105 @@
+﻿#ifndef MYTINYSTL_FLAT_HASH_SET_TEST_H_
+#define MYTINYSTL_FLAT_HASH_SET_TEST_H_
+
+// flat_hash_set test : 测试 flat_hash_set 的接口与它 emplace 的性能
+
+#include <unordered_set>
+
+#include "../MyTinySTL/flat_hash_set.h"
+#include "test.h"
+
+namespace mystl
+{
+namespace test
+{
+namespace flat_hash_set_test
+{
+
+#define FLAT_SET_EMPLACE_TEST(len1, len2, len3)                             \
+  TEST_LEN(len1, len2, len3, WIDE);                                         \
+  std::cout << "|  std unordered_set  |";                                   \
+  FUN_TEST_FORMAT1(std::unordered_set<int>, emplace, rand(), len1);         \
+  FUN_TEST_FORMAT1(std::unordered_set<int>, emplace, rand(), len2);         \
+  FUN_TEST_FORMAT1(std::unordered_set<int>, emplace, rand(), len3);         \
+  std::cout << "\n| mystl flat_hash_set |";                                 \
+  FUN_TEST_FORMAT1(mystl::flat_hash_set<int>, emplace, rand(), len1);       \
+  FUN_TEST_FORMAT1(mystl::flat_hash_set<int>, emplace, rand(), len2);       \
+  FUN_TEST_FORMAT1(mystl::flat_hash_set<int>, emplace, rand(), len3);
+
+void flat_hash_set_test()
+{
+  std::cout << "[===============================================================]" << std::endl;
+  std::cout << "[-------------- Run container test : flat_hash_set -------------]" << std::endl;
+  std::cout << "[-------------------------- API test ---------------------------]" << std::endl;
+  int a[] = { 5,4,3,2,1 };
+  mystl::flat_hash_set<int> fs1;
+  mystl::flat_hash_set<int> fs2(520);
+  mystl::flat_hash_set<int> fs3(520, mystl::hash<int>());
+  mystl::flat_hash_set<int> fs4(520, mystl::hash<int>(), mystl::equal_to<int>());
+  mystl::flat_hash_set<int> fs5(a, a + 5);
+  mystl::flat_hash_set<int> fs6(a, a + 5, 100);
+  mystl::flat_hash_set<int> fs7(a, a + 5, 100, mystl::hash<int>());
+  mystl::flat_hash_set<int> fs8(a, a + 5, 100, mystl::hash<int>(), mystl::equal_to<int>());
+  mystl::flat_hash_set<int> fs9(fs5);
+  mystl::flat_hash_set<int> fs10(std::move(fs5));
+  mystl::flat_hash_set<int> fs11;
+  fs11 = fs6;
+  mystl::flat_hash_set<int> fs12;
+  fs12 = std::move(fs6);
+  mystl::flat_hash_set<int> fs13{ 1,2,3,4,5 };
+  mystl::flat_hash_set<int> fs14;
+  fs14 = { 1,2,3,4,5 };
+
+  FUN_AFTER(fs1, fs1.emplace(1));
+  FUN_AFTER(fs1, fs1.emplace_hint(fs1.end(), 2));
+  FUN_AFTER(fs1, fs1.insert(5));
+  FUN_AFTER(fs1, fs1.insert(fs1.begin(), 5));
+  FUN_AFTER(fs1, fs1.insert(a, a + 5));
+  FUN_AFTER(fs1, fs1.erase(fs1.begin()));
+  FUN_AFTER(fs1, fs1.erase(fs1.begin(), fs1.find(3)));
+  FUN_AFTER(fs1, fs1.erase(1));
+  std::cout << std::boolalpha;
+  FUN_VALUE(fs1.empty());
+  std::cout << std::noboolalpha;
+  FUN_VALUE(fs1.size());
+  FUN_VALUE(fs1.bucket_count());
+  FUN_AFTER(fs1, fs1.clear());
+  FUN_AFTER(fs1, fs1.swap(fs7));
+  FUN_VALUE(*fs1.begin());
+  std::cout << std::boolalpha;
+  FUN_VALUE(fs1.empty());
+  FUN_VALUE((fs13 == fs14));
+  std::cout << std::noboolalpha;
+  FUN_VALUE(fs1.size());
+  FUN_VALUE(fs1.max_size());
+  FUN_VALUE(fs1.bucket_count());
+  FUN_AFTER(fs1, fs1.reserve(1000));
+  FUN_VALUE(fs1.size());
+  FUN_VALUE(fs1.bucket_count());
+  FUN_AFTER(fs1, fs1.rehash(150));
+  FUN_VALUE(fs1.bucket_count());
+  FUN_VALUE(fs1.count(1));
+  FUN_VALUE(*fs1.find(3));
+  FUN_VALUE(fs1.load_factor());
+  FUN_VALUE(fs1.max_load_factor());
+  PASSED;
+#if PERFORMANCE_TEST_ON
+  std::cout << "[--------------------- Performance Testing ---------------------]" << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|       emplace       |";
+#if LARGER_TEST_DATA_ON
+  FLAT_SET_EMPLACE_TEST(SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  FLAT_SET_EMPLACE_TEST(SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  PASSED;
+#endif
+  std::cout << "[-------------- End container test : flat_hash_set -------------]" << std::endl;
+}
+
+} // namespace flat_hash_set_test
+} // namespace test
+} // namespace mystl
+#endif // !MYTINYSTL_FLAT_HASH_SET_TEST_H_
@@ -0,0 +1,210 @@
+﻿#ifndef MYTINYSTL_FROZEN_MAP_TEST_H_
+#define MYTINYSTL_FROZEN_MAP_TEST_H_
+
+// frozen_map test : 测试 frozen_map, frozen_set 的接口，以及静态关键字表的查找性能
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../MyTinySTL/frozen_map.h"
+#include "../MyTinySTL/frozen_set.h"
+#include "../MyTinySTL/unordered_map.h"
+#include "map_test.h"
+#include "test.h"
+
+namespace mystl
+{
+namespace test
+{
+namespace frozen_map_test
+{
+
+using namespace mystl::literals;
+
+enum class token { kw_if, kw_else, kw_while, kw_for, kw_return };
+
+// C89 的 32 个关键字
+constexpr mystl::pair<mystl::string_view, int> c_keywords[] = {
+  { "auto"_sv, 0 },      { "break"_sv, 1 },     { "case"_sv, 2 },     { "char"_sv, 3 },
+  { "const"_sv, 4 },     { "continue"_sv, 5 },  { "default"_sv, 6 },  { "do"_sv, 7 },
+  { "double"_sv, 8 },    { "else"_sv, 9 },      { "enum"_sv, 10 },    { "extern"_sv, 11 },
+  { "float"_sv, 12 },    { "for"_sv, 13 },      { "goto"_sv, 14 },    { "if"_sv, 15 },
+  { "int"_sv, 16 },      { "long"_sv, 17 },     { "register"_sv, 18 },{ "return"_sv, 19 },
+  { "short"_sv, 20 },    { "signed"_sv, 21 },   { "sizeof"_sv, 22 },  { "static"_sv, 23 },
+  { "struct"_sv, 24 },   { "switch"_sv, 25 },   { "typedef"_sv, 26 }, { "union"_sv, 27 },
+  { "unsigned"_sv, 28 }, { "void"_sv, 29 },     { "volatile"_sv, 30 },{ "while"_sv, 31 }
+};
+
+// 查询的单词，一半是关键字，一半是普通的标识符
+static const char* const keyword_query[] = {
+  "if", "count", "while", "buffer", "return", "index", "struct", "node",
+  "unsigned", "value", "char", "length", "for", "result", "static", "next",
+  "const", "size", "switch", "offset", "void", "begin", "sizeof", "handle",
+  "else", "cursor", "int", "first", "typedef", "parent", "break", "total"
+};
+static constexpr size_t keyword_query_count = sizeof(keyword_query) / sizeof(keyword_query[0]);
+
+// 在关键字表中查找 len 次，table 为关键字表，query 为与表的键值类型一致的查询数组
+#define KEYWORD_FIND_DO_TEST(table, query, len) do {         \
+  clock_t start, end;                                        \
+  char buf[10];                                              \
+  volatile size_t total = 0;                                 \
+  start = clock();                                           \
+  for (size_t i = 0; i < len; ++i)                           \
+    total += table.count(query[i % keyword_query_count]);    \
+  end = clock();                                             \
+  (void)total;                                               \
+  int n = static_cast<int>(static_cast<double>(end - start)  \
+      / CLOCKS_PER_SEC * 1000);                              \
+  std::snprintf(buf, sizeof(buf), "%d", n);                  \
+  std::string t = buf;                                       \
+  t += "ms    |";                                            \
+  std::cout << std::setw(WIDE) << t;                         \
+} while(0)
+
+#define KEYWORD_FIND_TEST(len1, len2, len3)                  \
+  constexpr auto frozen_table = mystl::make_frozen_map(c_keywords); \
+  std::unordered_map<std::string, int> std_table;            \
+  mystl::unordered_map<mystl::string_view, int> mystl_table; \
+  for (auto& kw : c_keywords)                                \
+  {                                                          \
+    std_table.emplace(std::string(kw.first.data(), kw.first.size()), kw.second); \
+    mystl_table.emplace(kw.first, kw.second);                \
+  }                                                          \
+  std::vector<std::string> std_query;                        \
+  std::vector<mystl::string_view> view_query;                \
+  for (auto word : keyword_query)                            \
+  {                                                          \
+    std_query.push_back(word);                               \
+    view_query.push_back(mystl::string_view(word));          \
+  }                                                          \
+  TEST_LEN(len1, len2, len3, WIDE);                          \
+  std::cout << "|  std unordered_map  |";                    \
+  KEYWORD_FIND_DO_TEST(std_table, std_query, len1);          \
+  KEYWORD_FIND_DO_TEST(std_table, std_query, len2);          \
+  KEYWORD_FIND_DO_TEST(std_table, std_query, len3);          \
+  std::cout << "\n| mystl unordered_map |";                  \
+  KEYWORD_FIND_DO_TEST(mystl_table, view_query, len1);       \
+  KEYWORD_FIND_DO_TEST(mystl_table, view_query, len2);       \
+  KEYWORD_FIND_DO_TEST(mystl_table, view_query, len3);       \
+  std::cout << "\n|     frozen_map      |";                  \
+  KEYWORD_FIND_DO_TEST(frozen_table, view_query, len1);      \
+  KEYWORD_FIND_DO_TEST(frozen_table, view_query, len2);      \
+  KEYWORD_FIND_DO_TEST(frozen_table, view_query, len3);
+
+void frozen_map_test()
+{
+  std::cout << "[===============================================================]" << std::endl;
+  std::cout << "[---------------- Run container test : frozen_map --------------]" << std::endl;
+  std::cout << "[-------------------------- API test ---------------------------]" << std::endl;
+  constexpr PAIR a[] = { PAIR(1, 10), PAIR(2, 20), PAIR(3, 30), PAIR(4, 40), PAIR(5, 50) };
+  constexpr mystl::frozen_map<int, int, 5> fm1(a);
+  constexpr auto fm2 = mystl::make_frozen_map(a);
+  constexpr auto fm3 = mystl::make_frozen_map(c_keywords);
+  constexpr mystl::pair<mystl::pair<int, int>, mystl::string_view> b[] = {
+    { PAIR(0, 0), "origin"_sv }, { PAIR(1, 0), "east"_sv }, { PAIR(0, 1), "north"_sv }
+  };
+  constexpr auto fm4 = mystl::make_frozen_map(b);
+
+  // 查找在编译期完成
+  static_assert(fm1.at(3) == 30, "frozen_map lookup in a constant expression");
+  static_assert(fm3.at("while"_sv) == 31, "frozen_map lookup in a constant expression");
+  static_assert(fm3.count("main"_sv) == 0, "frozen_map lookup in a constant expression");
+  static_assert(fm4.find(PAIR(0, 1))->second.size() == 5, "frozen_map with pair keys");
+
+  MAP_COUT(fm1);
+  MAP_COUT(fm2);
+  std::cout << std::boolalpha;
+  FUN_VALUE(fm1.empty());
+  std::cout << std::noboolalpha;
+  FUN_VALUE(fm1.size());
+  FUN_VALUE(fm1.max_size());
+  FUN_VALUE(fm1.bucket_count());
+  FUN_VALUE(fm1.load_factor());
+  FUN_VALUE(fm1.at(2));
+  FUN_VALUE(fm1.count(6));
+  FUN_VALUE(fm1.find(4)->second);
+  FUN_VALUE((fm1.find(6) == fm1.end()));
+  FUN_VALUE((fm1.equal_range(5).second - fm1.equal_range(5).first));
+  FUN_VALUE(fm3.size());
+  FUN_VALUE(fm3.bucket_count());
+  FUN_VALUE(fm3.at(mystl::string_view("return")));
+  FUN_VALUE(fm3.count(mystl::string_view("main")));
+  FUN_VALUE(fm4.at(PAIR(1, 0)));
+  try
+  {
+    fm3.at(mystl::string_view("main"));
+  }
+  catch (const std::out_of_range& e)
+  {
+    FUN_VALUE(e.what());
+  }
+  // 运行期的数据同样可以构造，键值重复时抛出异常
+  PAIR c[] = { PAIR(rand() % 100, 1), PAIR(100, 2), PAIR(101, 3) };
+  mystl::frozen_map<int, int, 3> fm5(c);
+  FUN_VALUE(fm5.at(100));
+  try
+  {
+    PAIR d[] = { PAIR(7, 1), PAIR(7, 2) };
+    mystl::frozen_map<int, int, 2> fm6(d);
+  }
+  catch (const std::logic_error& e)
+  {
+    FUN_VALUE(e.what());
+  }
+  PASSED;
+#if PERFORMANCE_TEST_ON
+  std::cout << "[--------------------- Performance Testing ---------------------]" << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|   keyword lookup    |";
+#if LARGER_TEST_DATA_ON
+  KEYWORD_FIND_TEST(SCALE_L(LEN1), SCALE_L(LEN2), SCALE_L(LEN3));
+#else
+  KEYWORD_FIND_TEST(SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  PASSED;
+#endif
+  std::cout << "[---------------- End container test : frozen_map --------------]" << std::endl;
+}
+
+void frozen_set_test()
+{
+  std::cout << "[===============================================================]" << std::endl;
+  std::cout << "[---------------- Run container test : frozen_set --------------]" << std::endl;
+  std::cout << "[-------------------------- API test ---------------------------]" << std::endl;
+  constexpr int a[] = { 5, 4, 3, 2, 1 };
+  constexpr mystl::frozen_set<int, 5> fs1(a);
+  constexpr mystl::string_view b[] = { "red"_sv, "green"_sv, "blue"_sv };
+  constexpr auto fs2 = mystl::make_frozen_set(b);
+  constexpr token c[] = { token::kw_if, token::kw_while, token::kw_return };
+  constexpr auto fs3 = mystl::make_frozen_set(c);
+
+  static_assert(fs1.count(3) == 1 && fs1.count(6) == 0, "frozen_set lookup in a constant expression");
+  static_assert(fs2.count("blue"_sv) == 1, "frozen_set lookup in a constant expression");
+  static_assert(fs3.count(token::kw_else) == 0, "frozen_set with enum keys");
+
+  COUT(fs1);
+  COUT(fs2);
+  std::cout << std::boolalpha;
+  FUN_VALUE(fs1.empty());
+  std::cout << std::noboolalpha;
+  FUN_VALUE(fs1.size());
+  FUN_VALUE(fs1.bucket_count());
+  FUN_VALUE(fs1.count(1));
+  FUN_VALUE(*fs1.find(2));
+  FUN_VALUE((fs1.find(0) == fs1.end()));
+  FUN_VALUE(fs2.count(mystl::string_view("green")));
+  FUN_VALUE(fs2.count(mystl::string_view("black")));
+  FUN_VALUE(fs3.count(token::kw_while));
+  FUN_VALUE(fs3.count(token::kw_for));
+  PASSED;
+  std::cout << "[---------------- End container test : frozen_set --------------]" << std::endl;
+}
+
+} // namespace frozen_map_test
+} // namespace test
+} // namespace mystl
+#endif // !MYTINYSTL_FROZEN_MAP_TEST_H_
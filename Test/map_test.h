@@ -1,11 +1,15 @@
 ﻿#ifndef MYTINYSTL_MAP_TEST_H_
 #define MYTINYSTL_MAP_TEST_H_
 
-// map test : 测试 map, multimap 的接口与它们 insert 的性能
+// map test : 测试 map, multimap 的接口与它们 insert 的性能，以及 map 每个元素占用的内存、
+//            删除最旧元素与分割拼接的性能
 
 #include <map>
+#include <string>
+#include <vector>
 
 #include "../MyTinySTL/map.h"
+#include "../MyTinySTL/string_view.h"
 #include "../MyTinySTL/vector.h"
 #include "test.h"
 
@@ -19,6 +23,132 @@ namespace map_test
 // pair 的宏定义
 #define PAIR    mystl::pair<int, int>
 
+// 统计 std 容器申请的字节数，所有 rebind 出来的分配器共用一个计数
+inline size_t& counting_bytes()
+{
+  static size_t bytes = 0;
+  return bytes;
+}
+
+template <class T>
+struct counting_allocator
+{
+  typedef T value_type;
+
+  counting_allocator() = default;
+  template <class U>
+  counting_allocator(const counting_allocator<U>&) {}
+
+  T* allocate(size_t n)
+  {
+    counting_bytes() += n * sizeof(T);
+    return static_cast<T*>(::operator new(n * sizeof(T)));
+  }
+  void deallocate(T* p, size_t n)
+  {
+    counting_bytes() -= n * sizeof(T);
+    ::operator delete(p);
+  }
+
+  friend bool operator==(const counting_allocator&, const counting_allocator&) { return true; }
+  friend bool operator!=(const counting_allocator&, const counting_allocator&) { return false; }
+};
+
+// mystl::map 没有分配器参数，统计它申请的字节数时使用专用的键值型别 counted_key，
+// 再为它的节点与 header 特化 mystl::allocator
+struct counted_key
+{
+  int v;
+  counted_key(int x) :v(x) {}
+  friend bool operator<(const counted_key& a, const counted_key& b) { return a.v < b.v; }
+};
+
+typedef mystl::pair<const counted_key, int> counted_value;
+
+// rb_tree 对节点与 header 只调用 allocate 与 deallocate，申请与释放时更新 counting_bytes
+template <class T>
+class counting_mystl_allocator
+{
+public:
+  typedef T            value_type;
+  typedef T*           pointer;
+  typedef size_t       size_type;
+
+  static T* allocate() { return allocate(1); }
+  static T* allocate(size_type n)
+  {
+    counting_bytes() += n * sizeof(T);
+    return static_cast<T*>(::operator new(n * sizeof(T)));
+  }
+  static void deallocate(T* ptr) { deallocate(ptr, 1); }
+  static void deallocate(T* ptr, size_type n)
+  {
+    if (ptr == nullptr)
+      return;
+    counting_bytes() -= n * sizeof(T);
+    ::operator delete(ptr);
+  }
+};
+
+} // namespace map_test
+} // namespace test
+
+template <>
+class allocator<rb_tree_node<test::map_test::counted_value>>
+  :public test::map_test::counting_mystl_allocator<rb_tree_node<test::map_test::counted_value>>
+{
+};
+
+template <>
+class allocator<rb_tree_node_base<test::map_test::counted_value>>
+  :public test::map_test::counting_mystl_allocator<rb_tree_node_base<test::map_test::counted_value>>
+{
+};
+
+namespace test
+{
+namespace map_test
+{
+
+typedef std::map<int, int, std::less<int>,
+  counting_allocator<std::pair<const int, int>>>                         std_counting_map;
+typedef mystl::map<counted_key, int>                                     mystl_counting_map;
+
+// 插入 count 个随机键值后，每个元素平均占用的字节数，两边都统计实际申请的字节数
+inline size_t map_memory(const std_counting_map&)
+{
+  return counting_bytes();
+}
+
+inline size_t map_memory(const mystl_counting_map&)
+{
+  return counting_bytes();
+}
+
+#define MAP_MEMORY_DO_TEST(con, count) do {                  \
+  srand((int)time(0));                                       \
+  counting_bytes() = 0;                                      \
+  char buf[16];                                              \
+  con c;                                                     \
+  for (size_t i = 0; i < count; ++i)                         \
+    c.emplace(rand(), static_cast<int>(i));                  \
+  std::snprintf(buf, sizeof(buf), "%.1fB    |",              \
+    static_cast<double>(map_memory(c)) / c.size());          \
+  std::string t = buf;                                       \
+  std::cout << std::setw(WIDE) << t;                         \
+} while(0)
+
+#define MAP_MEMORY_TEST(len1, len2, len3)                    \
+  TEST_LEN(len1, len2, len3, WIDE);                          \
+  std::cout << "|         std         |";                    \
+  MAP_MEMORY_DO_TEST(std_counting_map, len1);                \
+  MAP_MEMORY_DO_TEST(std_counting_map, len2);                \
+  MAP_MEMORY_DO_TEST(std_counting_map, len3);                \
+  std::cout << "\n|        mystl        |";                  \
+  MAP_MEMORY_DO_TEST(mystl_counting_map, len1);              \
+  MAP_MEMORY_DO_TEST(mystl_counting_map, len2);              \
+  MAP_MEMORY_DO_TEST(mystl_counting_map, len3);
+
 // map 的遍历输出
 #define MAP_COUT(m) do { \
     std::string m_name = #m; \
@@ -42,6 +172,221 @@ namespace map_test
     std::cout << " " << str << " : <" << it.first << "," << it.second << ">\n"; \
 } while(0)
 
+// 以字符串为键值插入 count 个元素，再用 const char* 把每个键值查找一遍，
+// 比较函数不透明时，每次查找都要先构造一个临时的 mystl::string
+#define TRANSPARENT_FIND_DO_TEST(con, count) do {            \
+  srand((int)time(0));                                       \
+  clock_t start, end;                                        \
+  con c;                                                     \
+  std::vector<std::string> keys;                             \
+  char buf[10];                                              \
+  char key[64];                                              \
+  volatile size_t total = 0;                                 \
+  for (size_t i = 0; i < count; ++i)                         \
+  {                                                          \
+    std::snprintf(key, sizeof(key), "user:%d:session:%x",    \
+                  rand(), static_cast<unsigned>(i));         \
+    keys.push_back(key);                                     \
+    c.emplace(mystl::string(key), static_cast<int>(i));      \
+  }                                                          \
+  start = clock();                                           \
+  for (size_t i = 0; i < count; ++i)                         \
+    total += c.find(keys[i].c_str()) != c.end();             \
+  end = clock();                                             \
+  (void)total;                                               \
+  int n = static_cast<int>(static_cast<double>(end - start)  \
+      / CLOCKS_PER_SEC * 1000);                              \
+  std::snprintf(buf, sizeof(buf), "%d", n);                  \
+  std::string t = buf;                                       \
+  t += "ms    |";                                            \
+  std::cout << std::setw(WIDE) << t;                         \
+} while(0)
+
+#define TRANSPARENT_FIND_TEST(plain, transparent, len1, len2, len3) \
+  TEST_LEN(len1, len2, len3, WIDE);                          \
+  std::cout << "|        mystl        |";                    \
+  TRANSPARENT_FIND_DO_TEST(plain, len1);                     \
+  TRANSPARENT_FIND_DO_TEST(plain, len2);                     \
+  TRANSPARENT_FIND_DO_TEST(plain, len3);                     \
+  std::cout << "\n|  mystl transparent  |";                  \
+  TRANSPARENT_FIND_DO_TEST(transparent, len1);               \
+  TRANSPARENT_FIND_DO_TEST(transparent, len2);               \
+  TRANSPARENT_FIND_DO_TEST(transparent, len3);
+
+// 先插入 count / 10 个键值，再对随机的已有键值做 count 次更新，op 中可以使用 c、k 与 i
+// 先构造节点再查找的 emplace 每次都要分配并释放一个节点
+#define DUP_UPDATE_DO_TEST(con, op, count) do {              \
+  srand((int)time(0));                                       \
+  clock_t start, end;                                        \
+  con c;                                                     \
+  char buf[10];                                              \
+  const int keys = static_cast<int>(count / 10 + 1);         \
+  for (int k = 0; k < keys; ++k)                             \
+    c.emplace(k, k);                                         \
+  start = clock();                                           \
+  for (size_t i = 0; i < count; ++i)                         \
+  {                                                          \
+    const int k = rand() % keys;                             \
+    op;                                                      \
+  }                                                          \
+  end = clock();                                             \
+  int n = static_cast<int>(static_cast<double>(end - start)  \
+      / CLOCKS_PER_SEC * 1000);                              \
+  std::snprintf(buf, sizeof(buf), "%d", n);                  \
+  std::string t = buf;                                       \
+  t += "ms    |";                                            \
+  std::cout << std::setw(WIDE) << t;                         \
+} while(0)
+
+#define DUP_UPDATE_TEST(stdcon, con, len1, len2, len3)       \
+  TEST_LEN(len1, len2, len3, WIDE);                          \
+  std::cout << "|     std emplace     |";                    \
+  DUP_UPDATE_DO_TEST(stdcon, c.emplace(k, static_cast<int>(i)), len1); \
+  DUP_UPDATE_DO_TEST(stdcon, c.emplace(k, static_cast<int>(i)), len2); \
+  DUP_UPDATE_DO_TEST(stdcon, c.emplace(k, static_cast<int>(i)), len3); \
+  std::cout << "\n|    mystl emplace    |";                  \
+  DUP_UPDATE_DO_TEST(con, c.emplace(k, static_cast<int>(i)), len1);    \
+  DUP_UPDATE_DO_TEST(con, c.emplace(k, static_cast<int>(i)), len2);    \
+  DUP_UPDATE_DO_TEST(con, c.emplace(k, static_cast<int>(i)), len3);    \
+  std::cout << "\n| mystl ins_or_assign |";                  \
+  DUP_UPDATE_DO_TEST(con, c.insert_or_assign(k, static_cast<int>(i)), len1); \
+  DUP_UPDATE_DO_TEST(con, c.insert_or_assign(k, static_cast<int>(i)), len2); \
+  DUP_UPDATE_DO_TEST(con, c.insert_or_assign(k, static_cast<int>(i)), len3);
+
+// 把 src 的 n 个元素逐个移到 dst：复制后删除、摘下节点后插入，或者一次合并
+template <class Map>
+void move_by_copy(Map& src, Map& dst, int n)
+{
+  for (int k = 0; k < n; ++k)
+  {
+    auto it = src.find(k);
+    dst.insert(*it);
+    src.erase(it);
+  }
+}
+
+template <class Map>
+void move_by_extract(Map& src, Map& dst, int n)
+{
+  for (int k = 0; k < n; ++k)
+    dst.insert(src.extract(k));
+}
+
+template <class Map>
+void move_by_merge(Map& src, Map& dst, int)
+{
+  dst.merge(src);
+}
+
+// 时间窗口：c 中有 n 个递增的键值，分十次删除最旧的一半
+template <class Map>
+void drop_by_range_erase(Map& c, int n)
+{
+  for (int i = 1; i <= 10; ++i)
+    c.erase(c.begin(), c.lower_bound(n / 20 * i));
+}
+
+template <class Map>
+void drop_by_erase_before(Map& c, int n)
+{
+  for (int i = 1; i <= 10; ++i)
+    c.erase_before(n / 20 * i);
+}
+
+// 在随机的键值处分成两个 map 再拼接回去，重复 100 次
+template <class Map>
+void split_and_append(Map& c, int n)
+{
+  for (int i = 0; i < 100; ++i)
+  {
+    auto right = c.split(rand() % n);
+    c.append_greater(right);
+  }
+}
+
+#define WINDOW_DO_TEST(con, fn, count) do {                  \
+  srand((int)time(0));                                       \
+  clock_t start, end;                                        \
+  con c;                                                     \
+  char buf[10];                                              \
+  for (int k = 0; k < static_cast<int>(count); ++k)          \
+    c.emplace_hint(c.end(), k, k);                           \
+  start = clock();                                           \
+  map_test::fn(c, static_cast<int>(count));                  \
+  end = clock();                                             \
+  int n = static_cast<int>(static_cast<double>(end - start)  \
+      / CLOCKS_PER_SEC * 1000);                              \
+  std::snprintf(buf, sizeof(buf), "%d", n);                  \
+  std::string t = buf;                                       \
+  t += "ms    |";                                            \
+  std::cout << std::setw(WIDE) << t;                         \
+} while(0)
+
+#define WINDOW_DROP_TEST(len1, len2, len3)                   \
+  TEST_LEN(len1, len2, len3, WIDE);                          \
+  std::cout << "|   std erase range   |";                    \
+  WINDOW_DO_TEST(std_int_map_type, drop_by_range_erase, len1); \
+  WINDOW_DO_TEST(std_int_map_type, drop_by_range_erase, len2); \
+  WINDOW_DO_TEST(std_int_map_type, drop_by_range_erase, len3); \
+  std::cout << "\n|  mystl erase range  |";                  \
+  WINDOW_DO_TEST(int_map_type, drop_by_range_erase, len1);   \
+  WINDOW_DO_TEST(int_map_type, drop_by_range_erase, len2);   \
+  WINDOW_DO_TEST(int_map_type, drop_by_range_erase, len3);   \
+  std::cout << "\n| mystl erase_before  |";                  \
+  WINDOW_DO_TEST(int_map_type, drop_by_erase_before, len1);  \
+  WINDOW_DO_TEST(int_map_type, drop_by_erase_before, len2);  \
+  WINDOW_DO_TEST(int_map_type, drop_by_erase_before, len3);
+
+// 普通的 map 分割时要数一遍分出的元素，维护顺序统计的 map 只需 O(log n)
+#define SPLIT_APPEND_TEST(len1, len2, len3)                  \
+  TEST_LEN(len1, len2, len3, WIDE);                          \
+  std::cout << "|        mystl        |";                    \
+  WINDOW_DO_TEST(int_map_type, split_and_append, len1);      \
+  WINDOW_DO_TEST(int_map_type, split_and_append, len2);      \
+  WINDOW_DO_TEST(int_map_type, split_and_append, len3);      \
+  std::cout << "\n|  mystl order stat   |";                  \
+  WINDOW_DO_TEST(order_stat_map_type, split_and_append, len1); \
+  WINDOW_DO_TEST(order_stat_map_type, split_and_append, len2); \
+  WINDOW_DO_TEST(order_stat_map_type, split_and_append, len3);
+
+#define MOVE_NODE_DO_TEST(con, fn, count) do {               \
+  clock_t start, end;                                        \
+  con src, dst;                                              \
+  char buf[10];                                              \
+  for (int k = 0; k < static_cast<int>(count); ++k)          \
+    src.emplace(k, k);                                       \
+  start = clock();                                           \
+  map_test::fn(src, dst, static_cast<int>(count));           \
+  end = clock();                                             \
+  int n = static_cast<int>(static_cast<double>(end - start)  \
+      / CLOCKS_PER_SEC * 1000);                              \
+  std::snprintf(buf, sizeof(buf), "%d", n);                  \
+  std::string t = buf;                                       \
+  t += "ms    |";                                            \
+  std::cout << std::setw(WIDE) << t;                         \
+} while(0)
+
+#define MOVE_NODE_TEST(con, len1, len2, len3)                \
+  TEST_LEN(len1, len2, len3, WIDE);                          \
+  std::cout << "|    erase + insert   |";                    \
+  MOVE_NODE_DO_TEST(con, move_by_copy, len1);                \
+  MOVE_NODE_DO_TEST(con, move_by_copy, len2);                \
+  MOVE_NODE_DO_TEST(con, move_by_copy, len3);                \
+  std::cout << "\n|   extract + insert  |";                  \
+  MOVE_NODE_DO_TEST(con, move_by_extract, len1);             \
+  MOVE_NODE_DO_TEST(con, move_by_extract, len2);             \
+  MOVE_NODE_DO_TEST(con, move_by_extract, len3);             \
+  std::cout << "\n|        merge        |";                  \
+  MOVE_NODE_DO_TEST(con, move_by_merge, len1);               \
+  MOVE_NODE_DO_TEST(con, move_by_merge, len2);               \
+  MOVE_NODE_DO_TEST(con, move_by_merge, len3);
+
+typedef std::map<int, int>                                  std_int_map_type;
+typedef mystl::map<int, int>                                int_map_type;
+typedef mystl::map<mystl::string, int>                      string_map_type;
+typedef mystl::map<mystl::string, int, mystl::string_less>  transparent_map_type;
+typedef mystl::map<int, int, mystl::less<int>, true>        order_stat_map_type;
+
 void map_test()
 {
   std::cout << "[===============================================================]" << std::endl;
@@ -94,9 +439,35 @@ void map_test()
   MAP_FUN_AFTER(m1, m1.swap(m9));
   MAP_VALUE(*m1.begin());
   MAP_VALUE(*m1.rbegin());
+  transparent_map_type sm;
+  sm.emplace(mystl::string("apple"), 1);
+  sm.emplace(mystl::string("banana"), 2);
+  sm.emplace(mystl::string("cherry"), 3);
+  MAP_VALUE(*sm.find("banana"));
+  FUN_VALUE(sm.count("durian"));
+  MAP_VALUE(*sm.lower_bound(mystl::string_view("b")));
+  MAP_VALUE(*sm.upper_bound("banana"));
+  order_stat_map_type om{ PAIR(10,1),PAIR(30,3),PAIR(20,2),PAIR(40,4) };
+  MAP_VALUE(*om.find_by_order(2));
+  FUN_VALUE(om.order_of_key(25));
+  auto om_right = om.split(25);
+  MAP_COUT(om);
+  MAP_COUT(om_right);
+  MAP_FUN_AFTER(om, om.append_greater(om_right));
+  FUN_VALUE(om.erase_before(30));
+  MAP_COUT(om);
   FUN_VALUE(m1[1]);
   MAP_FUN_AFTER(m1, m1[1] = 3);
   FUN_VALUE(m1.at(1));
+  MAP_FUN_AFTER(m1, m1.try_emplace(1, 10));
+  MAP_FUN_AFTER(m1, m1.try_emplace(7, 7));
+  MAP_FUN_AFTER(m1, m1.insert_or_assign(1, 10));
+  MAP_FUN_AFTER(m1, m1.insert_or_assign(8, 8));
+  auto nh = m1.extract(1);
+  nh.key() = 9;
+  MAP_FUN_AFTER(m1, m1.insert(mystl::move(nh)));
+  MAP_FUN_AFTER(m1, m1.merge(m10));
+  MAP_COUT(m10);
   std::cout << std::boolalpha;
   FUN_VALUE(m1.empty());
   std::cout << std::noboolalpha;
@@ -111,6 +482,56 @@ void map_test()
   MAP_EMPLACE_TEST(map, SCALE_L(LEN1), SCALE_L(LEN2), SCALE_L(LEN3));
 #else
   MAP_EMPLACE_TEST(map, SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|   bytes / element   |";
+#if LARGER_TEST_DATA_ON
+  MAP_MEMORY_TEST(SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  MAP_MEMORY_TEST(SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "| find by const char* |";
+#if LARGER_TEST_DATA_ON
+  TRANSPARENT_FIND_TEST(string_map_type, transparent_map_type,
+                        SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  TRANSPARENT_FIND_TEST(string_map_type, transparent_map_type,
+                        SCALE_SS(LEN1), SCALE_SS(LEN2), SCALE_SS(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "| update existing key |";
+#if LARGER_TEST_DATA_ON
+  DUP_UPDATE_TEST(std_int_map_type, int_map_type, SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  DUP_UPDATE_TEST(std_int_map_type, int_map_type, SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|  move all elements  |";
+#if LARGER_TEST_DATA_ON
+  MOVE_NODE_TEST(int_map_type, SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  MOVE_NODE_TEST(int_map_type, SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|  drop oldest half   |";
+#if LARGER_TEST_DATA_ON
+  WINDOW_DROP_TEST(SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  WINDOW_DROP_TEST(SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "| split + append x100 |";
+#if LARGER_TEST_DATA_ON
+  SPLIT_APPEND_TEST(SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#else
+  SPLIT_APPEND_TEST(SCALE_SSS(LEN1), SCALE_SSS(LEN2), SCALE_SSS(LEN3));
 #endif
   std::cout << std::endl;
   std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
@@ -171,6 +592,8 @@ void multimap_test()
   MAP_FUN_AFTER(m1, m1.clear());
   MAP_FUN_AFTER(m1, m1.swap(m9));
   MAP_FUN_AFTER(m1, m1.insert(PAIR(3, 3)));
+  MAP_FUN_AFTER(m1, m1.insert(m1.extract(3)));
+  MAP_FUN_AFTER(m1, m1.merge(m10));
   MAP_VALUE(*m1.begin());
   MAP_VALUE(*m1.rbegin());
   std::cout << std::boolalpha;
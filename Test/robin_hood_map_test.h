@@ -0,0 +1,244 @@
+﻿#ifndef MYTINYSTL_ROBIN_HOOD_MAP_TEST_H_
+#define MYTINYSTL_ROBIN_HOOD_MAP_TEST_H_
+
+// robin_hood_map test : 测试 robin_hood_map 的接口，以及它与 unordered_map 在不同装载因子下的插入、查找、删除性能
+
+#include <unordered_map>
+
+#include "../MyTinySTL/robin_hood_map.h"
+#include "../MyTinySTL/unordered_map.h"
+#include "map_test.h"
+#include "test.h"
+
+namespace mystl
+{
+namespace test
+{
+namespace robin_hood_map_test
+{
+
+typedef std::unordered_map<int, int>                                     std_map_type;
+typedef mystl::unordered_map<int, int>                                   um_map_type;
+typedef mystl::robin_hood_map<int, int>                                  robin_map_type;
+
+// 插入偶数键值，查找时用原来的键值命中，加一后不命中
+#define ROBIN_MAP_DO_TEST(con, mode, count) do {             \
+  srand((int)time(0));                                       \
+  clock_t start, end;                                        \
+  char buf[16];                                              \
+  con c;                                                     \
+  std::vector<int> keys;                                     \
+  keys.reserve(count);                                       \
+  volatile size_t total = 0;                                 \
+  ROBIN_MAP_##mode(c, count);                                \
+  (void)total;                                               \
+  std::string t = buf;                                       \
+  std::cout << std::setw(WIDE) << t;                         \
+} while(0)
+
+#define ROBIN_MAP_FILL(c, count)                             \
+  for (size_t i = 0; i < count; ++i)                         \
+  {                                                          \
+    keys.push_back(rand() & ~1);                             \
+    c.emplace(keys.back(), static_cast<int>(i));             \
+  }
+
+#define ROBIN_MAP_TIME(start, end)                           \
+  std::snprintf(buf, sizeof(buf), "%dms    |",               \
+    static_cast<int>(static_cast<double>(end - start)        \
+      / CLOCKS_PER_SEC * 1000));
+
+#define ROBIN_MAP_emplace(c, count)                          \
+  start = clock();                                           \
+  ROBIN_MAP_FILL(c, count);                                  \
+  end = clock();                                             \
+  ROBIN_MAP_TIME(start, end);
+
+#define ROBIN_MAP_hit(c, count)                              \
+  ROBIN_MAP_FILL(c, count);                                  \
+  start = clock();                                           \
+  for (size_t i = 0; i < count; ++i)                         \
+    total += c.find(keys[i]) != c.end();                     \
+  end = clock();                                             \
+  ROBIN_MAP_TIME(start, end);
+
+#define ROBIN_MAP_miss(c, count)                             \
+  ROBIN_MAP_FILL(c, count);                                  \
+  start = clock();                                           \
+  for (size_t i = 0; i < count; ++i)                         \
+    total += c.find(keys[i] + 1) != c.end();                 \
+  end = clock();                                             \
+  ROBIN_MAP_TIME(start, end);
+
+#define ROBIN_MAP_erase(c, count)                            \
+  ROBIN_MAP_FILL(c, count);                                  \
+  start = clock();                                           \
+  for (size_t i = 0; i < count; ++i)                         \
+    total += c.erase(keys[i]);                               \
+  end = clock();                                             \
+  ROBIN_MAP_TIME(start, end);
+
+// 三种容器都插入 n 个元素，n 取不小于 count 的 2 的幂的 93%，
+// 装载因子上限设为 0.95 并预留 n 个元素的位置，使装载因子都在 0.93 附近，再测量不命中的查找
+#define ROBIN_MAP_dense(c, count)                            \
+  size_t n = 1;                                              \
+  while (n < count)                                          \
+    n <<= 1;                                                 \
+  n = n / 100 * 93;                                          \
+  c.max_load_factor(0.95f);                                  \
+  c.reserve(n);                                              \
+  while (c.size() < n)                                       \
+  {                                                          \
+    keys.push_back(rand() & ~1);                             \
+    c.emplace(keys.back(), 0);                               \
+  }                                                          \
+  start = clock();                                           \
+  for (size_t i = 0; i < count; ++i)                         \
+    total += c.find(keys[i % keys.size()] + 1) != c.end();   \
+  end = clock();                                             \
+  ROBIN_MAP_TIME(start, end);
+
+#define ROBIN_MAP_TEST(mode, len1, len2, len3)               \
+  TEST_LEN(len1, len2, len3, WIDE);                          \
+  std::cout << "|  std unordered_map  |";                    \
+  ROBIN_MAP_DO_TEST(std_map_type, mode, len1);               \
+  ROBIN_MAP_DO_TEST(std_map_type, mode, len2);               \
+  ROBIN_MAP_DO_TEST(std_map_type, mode, len3);               \
+  std::cout << "\n| mystl unordered_map |";                  \
+  ROBIN_MAP_DO_TEST(um_map_type, mode, len1);                \
+  ROBIN_MAP_DO_TEST(um_map_type, mode, len2);                \
+  ROBIN_MAP_DO_TEST(um_map_type, mode, len3);                \
+  std::cout << "\n|   robin_hood_map    |";                  \
+  ROBIN_MAP_DO_TEST(robin_map_type, mode, len1);             \
+  ROBIN_MAP_DO_TEST(robin_map_type, mode, len2);             \
+  ROBIN_MAP_DO_TEST(robin_map_type, mode, len3);
+
+void robin_hood_map_test()
+{
+  std::cout << "[===============================================================]" << std::endl;
+  std::cout << "[------------- Run container test : robin_hood_map -------------]" << std::endl;
+  std::cout << "[-------------------------- API test ---------------------------]" << std::endl;
+  mystl::vector<PAIR> v;
+  for (int i = 0; i < 5; ++i)
+    v.push_back(PAIR(5 - i, 5 - i));
+  mystl::robin_hood_map<int, int> rm1;
+  mystl::robin_hood_map<int, int> rm2(520);
+  mystl::robin_hood_map<int, int> rm3(520, mystl::hash<int>());
+  mystl::robin_hood_map<int, int> rm4(520, mystl::hash<int>(), mystl::equal_to<int>());
+  mystl::robin_hood_map<int, int> rm5(v.begin(), v.end());
+  mystl::robin_hood_map<int, int> rm6(v.begin(), v.end(), 100);
+  mystl::robin_hood_map<int, int> rm7(v.begin(), v.end(), 100, mystl::hash<int>());
+  mystl::robin_hood_map<int, int> rm8(v.begin(), v.end(), 100, mystl::hash<int>(), mystl::equal_to<int>());
+  mystl::robin_hood_map<int, int> rm9(rm5);
+  mystl::robin_hood_map<int, int> rm10(std::move(rm5));
+  mystl::robin_hood_map<int, int> rm11;
+  rm11 = rm6;
+  mystl::robin_hood_map<int, int> rm12;
+  rm12 = std::move(rm6);
+  mystl::robin_hood_map<int, int> rm13{ PAIR(1,1),PAIR(2,3),PAIR(3,3) };
+  mystl::robin_hood_map<int, int> rm14;
+  rm14 = { PAIR(1,1),PAIR(2,3),PAIR(3,3) };
+
+  MAP_FUN_AFTER(rm1, rm1.emplace(1, 1));
+  MAP_FUN_AFTER(rm1, rm1.emplace_hint(rm1.begin(), 1, 2));
+  MAP_FUN_AFTER(rm1, rm1.insert(PAIR(2, 2)));
+  MAP_FUN_AFTER(rm1, rm1.insert(rm1.end(), PAIR(3, 3)));
+  MAP_FUN_AFTER(rm1, rm1.insert(v.begin(), v.end()));
+  MAP_FUN_AFTER(rm1, rm1.try_emplace(6, 6));
+  MAP_FUN_AFTER(rm1, rm1.try_emplace(6, 7));
+  MAP_FUN_AFTER(rm1, rm1.insert_or_assign(6, 8));
+  MAP_FUN_AFTER(rm1, rm1.erase(rm1.begin()));
+  MAP_FUN_AFTER(rm1, rm1.erase(rm1.begin(), rm1.find(3)));
+  MAP_FUN_AFTER(rm1, rm1.erase(1));
+  std::cout << std::boolalpha;
+  FUN_VALUE(rm1.empty());
+  std::cout << std::noboolalpha;
+  FUN_VALUE(rm1.size());
+  FUN_VALUE(rm1.bucket_count());
+  MAP_FUN_AFTER(rm1, rm1.clear());
+  MAP_FUN_AFTER(rm1, rm1.swap(rm7));
+  MAP_VALUE(*rm1.begin());
+  FUN_VALUE(rm1.at(1));
+  FUN_VALUE(rm1[1]);
+  MAP_FUN_AFTER(rm1, rm1[6] = 6);
+  std::cout << std::boolalpha;
+  FUN_VALUE(rm1.empty());
+  FUN_VALUE((rm1 == rm7));
+  FUN_VALUE((rm8 == rm9));
+  std::cout << std::noboolalpha;
+  FUN_VALUE(rm1.size());
+  FUN_VALUE(rm1.max_size());
+  FUN_VALUE(rm1.bucket_count());
+  MAP_FUN_AFTER(rm1, rm1.reserve(1000));
+  FUN_VALUE(rm1.size());
+  FUN_VALUE(rm1.bucket_count());
+  MAP_FUN_AFTER(rm1, rm1.rehash(150));
+  FUN_VALUE(rm1.bucket_count());
+  FUN_VALUE(rm1.count(1));
+  MAP_VALUE(*rm1.find(3));
+  auto first = *rm1.equal_range(3).first;
+  std::cout << " rm1.equal_range(3) : from <" << first.first << ", " << first.second
+    << "> to next" << std::endl;
+  FUN_VALUE(rm1.load_factor());
+  FUN_VALUE(rm1.max_load_factor());
+  rm1.max_load_factor(0.95f);
+  FUN_VALUE(rm1.max_load_factor());
+  for (int i = 0; i < 240; ++i)
+    rm1[i * 3] = i;
+  FUN_VALUE(rm1.size());
+  FUN_VALUE(rm1.bucket_count());
+  FUN_VALUE(rm1.load_factor());
+  FUN_VALUE(rm1.max_probe_length());
+  PASSED;
+#if PERFORMANCE_TEST_ON
+  std::cout << "[--------------------- Performance Testing ---------------------]" << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|       emplace       |";
+#if LARGER_TEST_DATA_ON
+  ROBIN_MAP_TEST(emplace, SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  ROBIN_MAP_TEST(emplace, SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|      find (hit)     |";
+#if LARGER_TEST_DATA_ON
+  ROBIN_MAP_TEST(hit, SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  ROBIN_MAP_TEST(hit, SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|     find (miss)     |";
+#if LARGER_TEST_DATA_ON
+  ROBIN_MAP_TEST(miss, SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  ROBIN_MAP_TEST(miss, SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "| miss at load 0.93   |";
+#if LARGER_TEST_DATA_ON
+  ROBIN_MAP_TEST(dense, SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  ROBIN_MAP_TEST(dense, SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|        erase        |";
+#if LARGER_TEST_DATA_ON
+  ROBIN_MAP_TEST(erase, SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  ROBIN_MAP_TEST(erase, SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  PASSED;
+#endif
+  std::cout << "[------------- End container test : robin_hood_map -------------]" << std::endl;
+}
+
+} // namespace robin_hood_map_test
+} // namespace test
+} // namespace mystl
+#endif // !MYTINYSTL_ROBIN_HOOD_MAP_TEST_H_
@@ -1,11 +1,14 @@
 ﻿#ifndef MYTINYSTL_SET_TEST_H_
 #define MYTINYSTL_SET_TEST_H_
 
-// set test : 测试 set, multiset 的接口与它们 insert 的性能
+// set test : 测试 set, multiset 的接口与它们 insert 的性能，以及用有序区间构造 set 的性能，
+//            和维护顺序统计的 set 按序号查找、求序号的性能
 
 #include <set>
+#include <vector>
 
 #include "../MyTinySTL/set.h"
+#include "../MyTinySTL/vector.h"
 #include "test.h"
 
 namespace mystl
@@ -15,6 +18,190 @@ namespace test
 namespace set_test
 {
 
+// 用 count 个有序的元素构造 set
+#define SET_SORTED_RANGE_DO_TEST(con, count) do {            \
+  mystl::vector<int> v(count);                               \
+  for (size_t i = 0; i < count; ++i)                         \
+    v[i] = static_cast<int>(i);                              \
+  clock_t start, end;                                        \
+  char buf[10];                                              \
+  start = clock();                                           \
+  con c(&v[0], &v[0] + count);                               \
+  end = clock();                                             \
+  int n = static_cast<int>(static_cast<double>(end - start)  \
+      / CLOCKS_PER_SEC * 1000);                              \
+  std::snprintf(buf, sizeof(buf), "%d", n);                  \
+  std::string t = buf;                                       \
+  t += "ms    |";                                            \
+  std::cout << std::setw(WIDE) << t;                         \
+} while(0)
+
+#define SET_SORTED_RANGE_TEST(len1, len2, len3)              \
+  TEST_LEN(len1, len2, len3, WIDE);                          \
+  std::cout << "|         std         |";                    \
+  SET_SORTED_RANGE_DO_TEST(std::set<int>, len1);             \
+  SET_SORTED_RANGE_DO_TEST(std::set<int>, len2);             \
+  SET_SORTED_RANGE_DO_TEST(std::set<int>, len3);             \
+  std::cout << "\n|        mystl        |";                  \
+  SET_SORTED_RANGE_DO_TEST(mystl::set<int>, len1);           \
+  SET_SORTED_RANGE_DO_TEST(mystl::set<int>, len2);           \
+  SET_SORTED_RANGE_DO_TEST(mystl::set<int>, len3);
+
+typedef mystl::set<int>                          plain_set;
+typedef mystl::set<int, mystl::less<int>, true> order_stat_set;
+
+// 普通的 set 只能移动迭代器求第 k 个元素与序号，时间复杂度为 O(n)
+inline int set_select(const plain_set& c, size_t k)
+{
+  auto it = c.begin();
+  mystl::advance(it, k);
+  return *it;
+}
+
+inline size_t set_rank(const plain_set& c, int key)
+{
+  return static_cast<size_t>(mystl::distance(c.begin(), c.lower_bound(key)));
+}
+
+// 维护子树大小的 set 沿一条路径就能得到结果，时间复杂度为 O(log n)
+inline int set_select(const order_stat_set& c, size_t k)
+{
+  return *c.find_by_order(k);
+}
+
+inline size_t set_rank(const order_stat_set& c, int key)
+{
+  return c.order_of_key(key);
+}
+
+// 在 count 个元素的 set 中做 1000 次按序号查找与求序号
+#define SET_ORDER_DO_TEST(con, count) do {                   \
+  srand((int)time(0));                                       \
+  mystl::vector<int> v(count);                               \
+  for (size_t i = 0; i < count; ++i)                         \
+    v[i] = static_cast<int>(i);                              \
+  con c(&v[0], &v[0] + count);                               \
+  clock_t start, end;                                        \
+  char buf[10];                                              \
+  volatile size_t total = 0;                                 \
+  start = clock();                                           \
+  for (size_t i = 0; i < 1000; ++i)                          \
+  {                                                          \
+    const size_t k = static_cast<size_t>(rand()) % count;    \
+    total += set_select(c, k);                               \
+    total += set_rank(c, static_cast<int>(k));               \
+  }                                                          \
+  end = clock();                                             \
+  (void)total;                                               \
+  int n = static_cast<int>(static_cast<double>(end - start)  \
+      / CLOCKS_PER_SEC * 1000);                              \
+  std::snprintf(buf, sizeof(buf), "%d", n);                  \
+  std::string t = buf;                                       \
+  t += "ms    |";                                            \
+  std::cout << std::setw(WIDE) << t;                         \
+} while(0)
+
+#define SET_ORDER_TEST(len1, len2, len3)                     \
+  TEST_LEN(len1, len2, len3, WIDE);                          \
+  std::cout << "|   mystl iterator    |";                    \
+  SET_ORDER_DO_TEST(plain_set, len1);                        \
+  SET_ORDER_DO_TEST(plain_set, len2);                        \
+  SET_ORDER_DO_TEST(plain_set, len3);                        \
+  std::cout << "\n|  mystl order stat   |";                  \
+  SET_ORDER_DO_TEST(order_stat_set, len1);                   \
+  SET_ORDER_DO_TEST(order_stat_set, len2);                   \
+  SET_ORDER_DO_TEST(order_stat_set, len3);
+
+// 两个容器的元素按顺序逐个相同，并从后往前再比较一次，检查最左、最右与父节点的链接
+template <class MyCon, class StdCon>
+bool same_elements(const MyCon& a, const StdCon& b)
+{
+  if (a.size() != b.size())
+    return false;
+  auto it = b.begin();
+  for (auto x = a.begin(); x != a.end(); ++x, ++it)
+  {
+    if (*x != *it)
+      return false;
+  }
+  auto rit = b.rbegin();
+  for (auto x = a.rbegin(); x != a.rend(); ++x, ++rit)
+  {
+    if (*x != *rit)
+      return false;
+  }
+  return true;
+}
+
+// 用区间 v 构造 mystl 与 std 的容器，比较构造出的元素，再插入、删除几次后比较，
+// 有序的区间会走批量建树的路径，之后的插入与删除要求它建出的是一颗合法的红黑树
+template <class MyCon, class StdCon>
+bool set_build_check(const std::vector<int>& v)
+{
+  MyCon a(v.data(), v.data() + v.size());
+  StdCon b(v.begin(), v.end());
+  if (!same_elements(a, b))
+    return false;
+  const int keys[] = { -1, 0, 3, 7, 1000 };
+  for (auto k : keys)
+  {
+    a.insert(k);
+    b.insert(k);
+  }
+  for (auto k : keys)
+  {
+    a.erase(k + 1);
+    b.erase(k + 1);
+  }
+  return same_elements(a, b);
+}
+
+// 维护顺序统计时，批量建树也要求每个节点的子树大小正确
+template <class MyCon>
+bool set_order_check(const std::vector<int>& v)
+{
+  MyCon a(v.data(), v.data() + v.size());
+  size_t k = 0;
+  for (auto it = a.begin(); it != a.end(); ++it, ++k)
+  {
+    if (a.find_by_order(k) != it || a.order_of_key(*it) > k)
+      return false;
+  }
+  return a.find_by_order(a.size()) == a.end();
+}
+
+// 有序、逆序、含重复元素与全部相同的区间
+template <class Check>
+bool set_build_ranges(Check check)
+{
+  for (int n = 0; n <= 70; ++n)
+  {
+    std::vector<int> sorted, reversed, dup, same;
+    for (int i = 0; i < n; ++i)
+    {
+      sorted.push_back(i);
+      reversed.push_back(n - 1 - i);
+      dup.push_back(i / 3);
+      same.push_back(5);
+    }
+    if (!check(sorted) || !check(reversed) || !check(dup) || !check(same))
+      return false;
+  }
+  return true;
+}
+
+// 用有序区间构造的 set / multiset 与逐个插入的 std::set / std::multiset 相同
+TEST(set_sorted_build_test)
+{
+  typedef mystl::multiset<int, mystl::less<int>, true> order_stat_multiset;
+  EXPECT_TRUE(set_build_ranges(set_build_check<mystl::set<int>, std::set<int>>));
+  EXPECT_TRUE(set_build_ranges(set_build_check<mystl::multiset<int>, std::multiset<int>>));
+  EXPECT_TRUE(set_build_ranges(set_build_check<order_stat_set, std::set<int>>));
+  EXPECT_TRUE(set_build_ranges(set_build_check<order_stat_multiset, std::multiset<int>>));
+  EXPECT_TRUE(set_build_ranges(set_order_check<order_stat_set>));
+  EXPECT_TRUE(set_build_ranges(set_order_check<order_stat_multiset>));
+}
+
 void set_test()
 {
   std::cout << "[===============================================================]" << std::endl;
@@ -63,6 +250,8 @@ void set_test()
   FUN_AFTER(s1, s1.erase(s1.begin(), s1.find(3)));
   FUN_AFTER(s1, s1.clear());
   FUN_AFTER(s1, s1.swap(s5));
+  FUN_AFTER(s1, s1.insert(s1.extract(s1.begin())));
+  FUN_AFTER(s1, s1.merge(s9));
   FUN_VALUE(*s1.begin());
   FUN_VALUE(*s1.rbegin());
   std::cout << std::boolalpha;
@@ -70,6 +259,11 @@ void set_test()
   std::cout << std::noboolalpha;
   FUN_VALUE(s1.size());
   FUN_VALUE(s1.max_size());
+  order_stat_set s11{ 50,10,40,20,30 };
+  FUN_VALUE(*s11.find_by_order(1));
+  FUN_VALUE(s11.order_of_key(35));
+  FUN_AFTER(s11, s11.erase(s11.find_by_order(0)));
+  FUN_VALUE(s11.order_of_key(35));
   PASSED;
 #if PERFORMANCE_TEST_ON
   std::cout << "[--------------------- Performance Testing ---------------------]" << std::endl;
@@ -79,6 +273,22 @@ void set_test()
   CON_TEST_P1(set<int>, emplace, rand(), SCALE_L(LEN1), SCALE_L(LEN2), SCALE_L(LEN3));
 #else
   CON_TEST_P1(set<int>, emplace, rand(), SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "| sorted range ctor   |";
+#if LARGER_TEST_DATA_ON
+  SET_SORTED_RANGE_TEST(SCALE_L(LEN1), SCALE_L(LEN2), SCALE_L(LEN3));
+#else
+  SET_SORTED_RANGE_TEST(SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "| k-th + rank (x1000) |";
+#if LARGER_TEST_DATA_ON
+  SET_ORDER_TEST(SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#else
+  SET_ORDER_TEST(SCALE_SSS(LEN1), SCALE_SSS(LEN2), SCALE_SSS(LEN3));
 #endif
   std::cout << std::endl;
   std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
@@ -135,6 +345,8 @@ void multiset_test()
   FUN_AFTER(s1, s1.erase(s1.begin(), s1.find(3)));
   FUN_AFTER(s1, s1.clear());
   FUN_AFTER(s1, s1.swap(s5));
+  FUN_AFTER(s1, s1.insert(s1.extract(s1.begin())));
+  FUN_AFTER(s1, s1.merge(s9));
   FUN_VALUE(*s1.begin());
   FUN_VALUE(*s1.rbegin());
   std::cout << std::boolalpha;
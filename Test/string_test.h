@@ -2,10 +2,25 @@
 #define MYTINYSTL_STRING_TEST_H_
 
 // string test : 测试 string 的接口和 insert 的性能
+// string pool test : 测试 string_pool 的接口和 intern 的性能
+// utf8 test : 测试 UTF-8 校验、转换的接口和转换的性能
+// split test : 测试 string_view、split 的接口和分割的性能
+// ci string test : 测试 ci_string 的接口，忽略大小写比较和大小写转换的性能
 
+#include <algorithm>
+#include <cctype>
+#include <codecvt>
+#include <locale>
 #include <string>
+#include <unordered_set>
 
+#include "../MyTinySTL/algorithm.h"
 #include "../MyTinySTL/astring.h"
+#include "../MyTinySTL/ci_string.h"
+#include "../MyTinySTL/split.h"
+#include "../MyTinySTL/string_pool.h"
+#include "../MyTinySTL/unordered_map.h"
+#include "../MyTinySTL/utf8.h"
 #include "test.h"
 
 namespace mystl
@@ -15,6 +30,95 @@ namespace test
 namespace string_test
 {
 
+// 检查 char_traits 的 length：每个字符串单独申请、恰好容纳结尾的空字符，
+// 起点从 0 到 7 个字符不等，长度跨越多个 16 字节块
+template <class CharType>
+bool simd_length_check()
+{
+  for (size_t start = 0; start < 8; ++start)
+  {
+    for (size_t len = 0; len <= 40; ++len)
+    {
+      CharType* buf = new CharType[start + len + 1];
+      for (size_t i = 0; i < start + len; ++i)
+        buf[i] = static_cast<CharType>('a' + i % 26);
+      buf[start + len] = CharType(0);
+      const auto r = mystl::char_traits<CharType>::length(buf + start);
+      delete[] buf;
+      if (r != len)
+        return false;
+    }
+  }
+  return true;
+}
+
+// 检查 char_traits 的 compare：不同的字符为 high，可能在 16 字节块之后，结果的符号按无符号值判断
+template <class CharType>
+bool simd_compare_check(CharType high)
+{
+  typedef mystl::char_traits<CharType> traits;
+  CharType a[48], b[48];
+  for (size_t start = 0; start < 8; ++start)
+  {
+    for (size_t n = 0; start + n <= 48; ++n)
+    {
+      for (size_t i = 0; i < 48; ++i)
+        a[i] = b[i] = static_cast<CharType>('a' + i % 26);
+      if (traits::compare(a + start, b + start, n) != 0)
+        return false;
+      for (size_t m = start; m < start + n; ++m)
+      {
+        b[m] = high;
+        if (traits::compare(a + start, b + start, n) >= 0 ||
+            traits::compare(b + start, a + start, n) <= 0)
+          return false;
+        b[m] = a[m];
+      }
+    }
+  }
+  return true;
+}
+
+// 检查 char_traits 的 fill：填充的范围之外不被改动
+template <class CharType>
+bool simd_fill_check(CharType ch)
+{
+  CharType buf[56];
+  for (size_t start = 0; start < 8; ++start)
+  {
+    for (size_t n = 0; start + n <= 48; ++n)
+    {
+      for (size_t i = 0; i < 56; ++i)
+        buf[i] = CharType('x');
+      if (mystl::char_traits<CharType>::fill(buf + start, ch, n) != buf + start)
+        return false;
+      for (size_t i = 0; i < 56; ++i)
+      {
+        const bool inside = i >= start && i < start + n;
+        if (buf[i] != (inside ? ch : CharType('x')))
+          return false;
+      }
+    }
+  }
+  return true;
+}
+
+// char16_t / char32_t 的 length、compare、fill 使用向量化的内核
+TEST(char_traits_simd_test)
+{
+  char16_t* s = new char16_t[3]{ u'a', u'b', 0 };
+  EXPECT_EQ(2u, mystl::char_traits<char16_t>::length(s));
+  delete[] s;
+  EXPECT_TRUE(simd_length_check<char16_t>());
+  EXPECT_TRUE(simd_length_check<char32_t>());
+  EXPECT_TRUE(simd_compare_check<char16_t>(char16_t(0x8000)));
+  EXPECT_TRUE(simd_compare_check<char16_t>(char16_t(0xffff)));
+  EXPECT_TRUE(simd_compare_check<char32_t>(char32_t(0x80000000u)));
+  EXPECT_TRUE(simd_compare_check<char32_t>(char32_t(0xffffffffu)));
+  EXPECT_TRUE(simd_fill_check<char16_t>(char16_t(0xfffe)));
+  EXPECT_TRUE(simd_fill_check<char32_t>(char32_t(0x8000fffeu)));
+}
+
 void string_test()
 {
   std::cout << "[===============================================================]" << std::endl;
@@ -193,6 +297,22 @@ void string_test()
   CON_TEST_P1(string, append, "s", SCALE_LL(LEN1), SCALE_LL(LEN2), SCALE_LL(LEN3));
 #else
   CON_TEST_P1(string, append, "s", SCALE_L(LEN1), SCALE_L(LEN2), SCALE_L(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|   u16string append  |";
+#if LARGER_TEST_DATA_ON
+  CON_TEST_P1(u16string, append, u"abcdefghijklmnopqrstuvwxyz", SCALE_L(LEN1), SCALE_L(LEN2), SCALE_L(LEN3));
+#else
+  CON_TEST_P1(u16string, append, u"abcdefghijklmnopqrstuvwxyz", SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|   u32string append  |";
+#if LARGER_TEST_DATA_ON
+  CON_TEST_P1(u32string, append, U"abcdefghijklmnopqrstuvwxyz", SCALE_L(LEN1), SCALE_L(LEN2), SCALE_L(LEN3));
+#else
+  CON_TEST_P1(u32string, append, U"abcdefghijklmnopqrstuvwxyz", SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
 #endif
   std::cout << std::endl;
   std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
@@ -201,6 +321,437 @@ void string_test()
   std::cout << "[----------------- End container test : string -----------------]" << std::endl;
 }
 
+// 重复字符串的驻留性能，每个字符串平均重复四次
+#define STRING_INTERN_DO_TEST(con, fun, count) do {          \
+  srand((int)time(0));                                       \
+  clock_t start, end;                                        \
+  con c;                                                     \
+  char buf[10];                                              \
+  char key[32];                                              \
+  start = clock();                                           \
+  for (size_t i = 0; i < count; ++i)                         \
+  {                                                          \
+    std::snprintf(key, sizeof(key), "host-%d.example.com",   \
+                  static_cast<int>(rand() % (count / 4 + 1)));\
+    c.fun(key);                                              \
+  }                                                          \
+  end = clock();                                             \
+  int n = static_cast<int>(static_cast<double>(end - start)  \
+      / CLOCKS_PER_SEC * 1000);                              \
+  std::snprintf(buf, sizeof(buf), "%d", n);                  \
+  std::string t = buf;                                       \
+  t += "ms    |";                                            \
+  std::cout << std::setw(WIDE) << t;                         \
+} while(0)
+
+#define STRING_INTERN_TEST(len1, len2, len3)                                      \
+  TEST_LEN(len1, len2, len3, WIDE);                                               \
+  std::cout << "|         std         |";                                         \
+  STRING_INTERN_DO_TEST(std::unordered_set<std::string>, insert, len1);           \
+  STRING_INTERN_DO_TEST(std::unordered_set<std::string>, insert, len2);           \
+  STRING_INTERN_DO_TEST(std::unordered_set<std::string>, insert, len3);           \
+  std::cout << "\n|        mystl        |";                                       \
+  STRING_INTERN_DO_TEST(mystl::string_pool, intern, len1);                        \
+  STRING_INTERN_DO_TEST(mystl::string_pool, intern, len2);                        \
+  STRING_INTERN_DO_TEST(mystl::string_pool, intern, len3);
+
+void string_pool_test()
+{
+  std::cout << "[===============================================================]" << std::endl;
+  std::cout << "[--------------- Run container test : string_pool --------------]" << std::endl;
+  std::cout << "[-------------------------- API test ---------------------------]" << std::endl;
+  mystl::string_pool pool;
+  mystl::string host("example.com");
+  auto h1 = pool.intern("example.com");
+  auto h2 = pool.intern(host);
+  auto h3 = pool.intern("example.org");
+  auto h4 = pool.intern("example.com", 7);
+  mystl::interned_string h5;
+
+  STR_COUT(h1);
+  STR_COUT(h3);
+  STR_COUT(h4);
+  FUN_VALUE(pool.size());
+  FUN_VALUE((h1 == h2));
+  FUN_VALUE((h1 == h3));
+  FUN_VALUE((h1.data() == h2.data()));
+  FUN_VALUE(h1.size());
+  FUN_VALUE(h5.empty());
+  FUN_VALUE((h5 == pool.intern("")));
+  FUN_VALUE((pool.find("example.org") == h3));
+  FUN_VALUE(pool.find("example.net").empty());
+  FUN_VALUE(h3.str().compare("example.org"));
+  FUN_VALUE((mystl::hash<mystl::interned_string>()(h1) == mystl::hash<mystl::interned_string>()(h2)));
+  FUN_VALUE(pool.memory_usage());
+  mystl::basic_string_pool<char, mystl::ci_char_traits> ci_pool;
+  auto h6 = ci_pool.intern("Foo");
+  FUN_VALUE((ci_pool.intern("foo") == h6));
+  FUN_VALUE((ci_pool.find("FOO") == h6));
+  FUN_VALUE(ci_pool.size());
+  for (int i = 0; i < 1000; ++i)
+    pool.intern(mystl::string(static_cast<size_t>(i % 100 + 1), 'x'));
+  FUN_VALUE(pool.size());
+  FUN_VALUE(h1.c_str());
+  pool.clear();
+  std::cout << " After pool.clear() :\n";
+  FUN_VALUE(pool.size());
+  FUN_VALUE(pool.memory_usage());
+  PASSED;
+#if PERFORMANCE_TEST_ON
+  std::cout << "[--------------------- Performance Testing ---------------------]" << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|        intern       |";
+#if LARGER_TEST_DATA_ON
+  STRING_INTERN_TEST(LEN1, LEN2, LEN3);
+#else
+  STRING_INTERN_TEST(SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  PASSED;
+#endif
+  std::cout << "[--------------- End container test : string_pool --------------]" << std::endl;
+}
+
+// 重复 unit 直到 count 个字节，再把它整体转为 UTF-16 十次
+#define UTF8_TO_UTF16_DO_TEST(mode, unit, count) do {        \
+  std::string corpus;                                        \
+  while (corpus.size() < count)                              \
+    corpus += unit;                                          \
+  clock_t start, end;                                        \
+  char buf[10];                                              \
+  UTF8_TO_UTF16_##mode(corpus);                              \
+  int n = static_cast<int>(static_cast<double>(end - start)  \
+      / CLOCKS_PER_SEC * 1000);                              \
+  std::snprintf(buf, sizeof(buf), "%d", n);                  \
+  std::string t = buf;                                       \
+  t += "ms    |";                                            \
+  std::cout << std::setw(WIDE) << t;                         \
+} while(0)
+
+#define UTF8_TO_UTF16_std(corpus)                            \
+  std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> cv; \
+  start = clock();                                           \
+  for (int i = 0; i < 10; ++i)                               \
+    cv.from_bytes(corpus);                                   \
+  end = clock();
+
+#define UTF8_TO_UTF16_mystl(corpus)                          \
+  mystl::string src(corpus.data(), corpus.size());           \
+  mystl::u16string dst;                                      \
+  start = clock();                                           \
+  for (int i = 0; i < 10; ++i)                               \
+    mystl::utf8_to_utf16(src, dst);                          \
+  end = clock();
+
+#define UTF8_TO_UTF16_TEST(unit, len1, len2, len3)           \
+  TEST_LEN(len1, len2, len3, WIDE);                          \
+  std::cout << "|         std         |";                    \
+  UTF8_TO_UTF16_DO_TEST(std, unit, len1);                    \
+  UTF8_TO_UTF16_DO_TEST(std, unit, len2);                    \
+  UTF8_TO_UTF16_DO_TEST(std, unit, len3);                    \
+  std::cout << "\n|        mystl        |";                  \
+  UTF8_TO_UTF16_DO_TEST(mystl, unit, len1);                  \
+  UTF8_TO_UTF16_DO_TEST(mystl, unit, len2);                  \
+  UTF8_TO_UTF16_DO_TEST(mystl, unit, len3);
+
+void utf8_test()
+{
+  std::cout << "[===============================================================]" << std::endl;
+  std::cout << "[------------------- Run string test : utf8 --------------------]" << std::endl;
+  std::cout << "[-------------------------- API test ---------------------------]" << std::endl;
+  mystl::string s1(u8"abc");
+  mystl::string s2(u8"中文 UTF-8 \U0001F600");
+  mystl::string s3("\xc0\x80");
+  mystl::string s4("\xed\xa0\x80");
+  mystl::u16string u16;
+  mystl::u32string u32;
+  mystl::string back;
+
+  FUN_VALUE(mystl::utf8_validate(s1));
+  FUN_VALUE(mystl::utf8_validate(s2));
+  FUN_VALUE(mystl::utf8_validate(s3));
+  FUN_VALUE(mystl::utf8_validate(s4));
+  FUN_VALUE(s2.size());
+  FUN_VALUE(mystl::utf16_length_from_utf8(s2.begin(), s2.size()));
+  FUN_VALUE(mystl::utf32_length_from_utf8(s2.begin(), s2.size()));
+  FUN_VALUE(mystl::utf8_to_utf16(s2, u16));
+  FUN_VALUE(u16.size());
+  FUN_VALUE(mystl::utf8_to_utf32(s2, u32));
+  FUN_VALUE(u32.size());
+  FUN_VALUE(static_cast<unsigned>(u32[9]));
+  FUN_VALUE(mystl::utf16_to_utf8(u16, back));
+  STR_COUT(back);
+  FUN_VALUE((back == s2));
+  FUN_VALUE(mystl::utf32_to_utf8(u32, back));
+  FUN_VALUE((back == s2));
+  FUN_VALUE(mystl::utf8_to_utf16(s3, u16));
+  FUN_VALUE(u16.size());
+  PASSED;
+#if PERFORMANCE_TEST_ON
+  std::cout << "[--------------------- Performance Testing ---------------------]" << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|  utf8->utf16 ascii  |";
+#if LARGER_TEST_DATA_ON
+  UTF8_TO_UTF16_TEST(u8"GET /index.html HTTP/1.1 Host: example.com\n", LEN1, LEN2, LEN3);
+#else
+  UTF8_TO_UTF16_TEST(u8"GET /index.html HTTP/1.1 Host: example.com\n", SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|   utf8->utf16 cjk   |";
+#if LARGER_TEST_DATA_ON
+  UTF8_TO_UTF16_TEST(u8"中文字符串测试，日本語のテキスト。한국어 문장\n", LEN1, LEN2, LEN3);
+#else
+  UTF8_TO_UTF16_TEST(u8"中文字符串测试，日本語のテキスト。한국어 문장\n", SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  PASSED;
+#endif
+  std::cout << "[------------------- End string test : utf8 --------------------]" << std::endl;
+}
+
+// 把一行日志分割为字段，std 使用 find + substr，mystl 使用 split
+#define SPLIT_DO_TEST(mode, count) do {                      \
+  const char* line = "2024-01-01T00:00:00,GET,/index.html,"  \
+                     "200,1234,example.com,Mozilla/5.0";     \
+  volatile size_t total = 0;                                 \
+  clock_t start, end;                                        \
+  char buf[10];                                              \
+  SPLIT_##mode(line, count);                                 \
+  int n = static_cast<int>(static_cast<double>(end - start)  \
+      / CLOCKS_PER_SEC * 1000);                              \
+  std::snprintf(buf, sizeof(buf), "%d", n);                  \
+  std::string t = buf;                                       \
+  t += "ms    |";                                            \
+  std::cout << std::setw(WIDE) << t;                         \
+} while(0)
+
+#define SPLIT_std(line, count)                               \
+  std::string s(line);                                       \
+  start = clock();                                           \
+  for (size_t i = 0; i < count; ++i)                         \
+  {                                                          \
+    size_t pos = 0, d;                                       \
+    while ((d = s.find(',', pos)) != std::string::npos)      \
+    {                                                        \
+      total += s.substr(pos, d - pos).size();                \
+      pos = d + 1;                                           \
+    }                                                        \
+    total += s.substr(pos).size();                           \
+  }                                                          \
+  end = clock();
+
+#define SPLIT_mystl(line, count)                             \
+  mystl::string s(line);                                     \
+  start = clock();                                           \
+  for (size_t i = 0; i < count; ++i)                         \
+  {                                                          \
+    for (auto field : mystl::split(s, ','))                  \
+      total += field.size();                                 \
+  }                                                          \
+  end = clock();
+
+#define SPLIT_TEST(len1, len2, len3)                         \
+  TEST_LEN(len1, len2, len3, WIDE);                          \
+  std::cout << "|         std         |";                    \
+  SPLIT_DO_TEST(std, len1);                                  \
+  SPLIT_DO_TEST(std, len2);                                  \
+  SPLIT_DO_TEST(std, len3);                                  \
+  std::cout << "\n|        mystl        |";                  \
+  SPLIT_DO_TEST(mystl, len1);                                \
+  SPLIT_DO_TEST(mystl, len2);                                \
+  SPLIT_DO_TEST(mystl, len3);
+
+void split_test()
+{
+  std::cout << "[===============================================================]" << std::endl;
+  std::cout << "[------------------- Run string test : split -------------------]" << std::endl;
+  std::cout << "[-------------------------- API test ---------------------------]" << std::endl;
+  mystl::string str("a,b,,c,");
+  mystl::string_view v1;
+  mystl::string_view v2("hello world");
+  mystl::string_view v3(str);
+  mystl::string_view v4("abcdef", 3);
+
+  STR_COUT(v2);
+  STR_COUT(v3);
+  STR_COUT(v4);
+  FUN_VALUE(v1.empty());
+  FUN_VALUE(v2.size());
+  FUN_VALUE(v2.substr(6));
+  FUN_VALUE(v2.find("world"));
+  FUN_VALUE(v2.rfind('o'));
+  FUN_VALUE(v2.find_first_of("ow"));
+  FUN_VALUE(v2.starts_with("hello"));
+  FUN_VALUE(v2.ends_with("word"));
+  FUN_VALUE((v4 == "abc"));
+  FUN_VALUE((v4 < v2));
+  FUN_VALUE(v4.compare(v2));
+  STR_FUN_AFTER(v2, v2.remove_prefix(6));
+  STR_FUN_AFTER(v2, v2.remove_suffix(2));
+
+  std::cout << " split(str, ',') :";
+  for (auto field : mystl::split(str, ','))
+    std::cout << " [" << field << "]";
+  std::cout << "\n split(str, ',', true) :";
+  for (auto field : mystl::split(str, ',', true))
+    std::cout << " [" << field << "]";
+  std::cout << "\n split(\"a::b::::c\", by_string(\"::\")) :";
+  for (auto field : mystl::split("a::b::::c", mystl::by_string("::")))
+    std::cout << " [" << field << "]";
+  std::cout << "\n split(\"k=v; x = y\", by_any_of(\" ;=\"), true) :";
+  for (auto field : mystl::split("k=v; x = y", mystl::by_any_of(" ;="), true))
+    std::cout << " [" << field << "]";
+  std::cout << "\n";
+  auto fields = mystl::split(str, ',');
+  FUN_VALUE(mystl::distance(fields.begin(), fields.end()));
+  FUN_VALUE(mystl::count(fields.begin(), fields.end(), mystl::string_view()));
+  FUN_VALUE(*mystl::max_element(fields.begin(), fields.end()));
+  PASSED;
+#if PERFORMANCE_TEST_ON
+  std::cout << "[--------------------- Performance Testing ---------------------]" << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|        split        |";
+#if LARGER_TEST_DATA_ON
+  SPLIT_TEST(LEN1, LEN2, LEN3);
+#else
+  SPLIT_TEST(SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  PASSED;
+#endif
+  std::cout << "[------------------- End string test : split -------------------]" << std::endl;
+}
+
+// 忽略大小写比较与大小写转换，std 使用逐字符的 tolower，mystl 使用 ci_compare 与 to_lower
+#define CI_DO_TEST(mode, fun, count) do {                    \
+  const char* header = "X-Forwarded-For-Client-Identifier";  \
+  volatile size_t total = 0;                                 \
+  clock_t start, end;                                        \
+  char buf[10];                                              \
+  CI_##fun##_##mode(header, count);                          \
+  int n = static_cast<int>(static_cast<double>(end - start)  \
+      / CLOCKS_PER_SEC * 1000);                              \
+  std::snprintf(buf, sizeof(buf), "%d", n);                  \
+  std::string t = buf;                                       \
+  t += "ms    |";                                            \
+  std::cout << std::setw(WIDE) << t;                         \
+} while(0)
+
+#define CI_compare_std(header, count)                        \
+  std::string a(header), b(header);                          \
+  std::transform(b.begin(), b.end(), b.begin(), ::tolower);  \
+  start = clock();                                           \
+  for (size_t i = 0; i < count; ++i)                         \
+  {                                                          \
+    size_t j = 0;                                            \
+    for (; j < a.size(); ++j)                                \
+    {                                                        \
+      if (std::tolower(static_cast<unsigned char>(a[j])) !=  \
+          std::tolower(static_cast<unsigned char>(b[j])))    \
+        break;                                               \
+    }                                                        \
+    total += j;                                              \
+  }                                                          \
+  end = clock();
+
+#define CI_compare_mystl(header, count)                      \
+  mystl::ci_string a(header), b(header);                     \
+  mystl::to_lower(b);                                        \
+  start = clock();                                           \
+  for (size_t i = 0; i < count; ++i)                         \
+    total += a.compare(b) == 0;                              \
+  end = clock();
+
+#define CI_lower_std(header, count)                          \
+  std::string a(header);                                     \
+  start = clock();                                           \
+  for (size_t i = 0; i < count; ++i)                         \
+  {                                                          \
+    a[i % a.size()] = 'A';                                   \
+    std::transform(a.begin(), a.end(), a.begin(), ::tolower);\
+    total += static_cast<size_t>(a[0]);                      \
+  }                                                          \
+  end = clock();
+
+#define CI_lower_mystl(header, count)                        \
+  mystl::string a(header);                                   \
+  start = clock();                                           \
+  for (size_t i = 0; i < count; ++i)                         \
+  {                                                          \
+    a[i % a.size()] = 'A';                                   \
+    mystl::to_lower(a);                                      \
+    total += static_cast<size_t>(a[0]);                      \
+  }                                                          \
+  end = clock();
+
+#define CI_TEST(fun, len1, len2, len3)                       \
+  TEST_LEN(len1, len2, len3, WIDE);                          \
+  std::cout << "|         std         |";                    \
+  CI_DO_TEST(std, fun, len1);                                \
+  CI_DO_TEST(std, fun, len2);                                \
+  CI_DO_TEST(std, fun, len3);                                \
+  std::cout << "\n|        mystl        |";                  \
+  CI_DO_TEST(mystl, fun, len1);                              \
+  CI_DO_TEST(mystl, fun, len2);                              \
+  CI_DO_TEST(mystl, fun, len3);
+
+void ci_string_test()
+{
+  std::cout << "[===============================================================]" << std::endl;
+  std::cout << "[----------------- Run string test : ci_string -----------------]" << std::endl;
+  std::cout << "[-------------------------- API test ---------------------------]" << std::endl;
+  mystl::ci_string s1("Content-Type");
+  mystl::ci_string s2("content-TYPE");
+  mystl::ci_string s3("Content-Length");
+  mystl::string s4("Accept-Encoding: GZIP, Deflate");
+  mystl::unordered_map<mystl::ci_string, int> headers;
+  mystl::unordered_map<mystl::string, int, mystl::ci_hash, mystl::ci_equal_to> names;
+
+  FUN_VALUE((s1 == s2));
+  FUN_VALUE((s1 == s3));
+  FUN_VALUE(s1.compare(s3));
+  FUN_VALUE(mystl::ci_compare("HOST", "host", 4));
+  FUN_VALUE((mystl::hash<mystl::ci_string>()(s1) == mystl::hash<mystl::ci_string>()(s2)));
+  FUN_VALUE((mystl::ci_hash()(mystl::string("Host")) == mystl::ci_hash()(mystl::string("hOST"))));
+  headers[s1] = 1;
+  headers[s3] = 2;
+  FUN_VALUE(headers.count(s2));
+  FUN_VALUE(headers[mystl::ci_string("CONTENT-LENGTH")]);
+  names[mystl::string("Host")] = 3;
+  FUN_VALUE(names[mystl::string("HOST")]);
+  FUN_VALUE(mystl::ci_string_view("Content-Type").find(mystl::ci_string_view("TYPE")));
+  FUN_VALUE(mystl::ci_string_view("Content-Type").find(mystl::ci_string_view("content")));
+  STR_FUN_AFTER(s4, mystl::to_lower(s4));
+  STR_FUN_AFTER(s4, mystl::to_upper(s4));
+  PASSED;
+#if PERFORMANCE_TEST_ON
+  std::cout << "[--------------------- Performance Testing ---------------------]" << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|      ci compare     |";
+#if LARGER_TEST_DATA_ON
+  CI_TEST(compare, SCALE_L(LEN1), SCALE_L(LEN2), SCALE_L(LEN3));
+#else
+  CI_TEST(compare, SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|       to_lower      |";
+#if LARGER_TEST_DATA_ON
+  CI_TEST(lower, SCALE_L(LEN1), SCALE_L(LEN2), SCALE_L(LEN3));
+#else
+  CI_TEST(lower, SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#endif
+  std::cout << std::endl;
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  PASSED;
+#endif
+  std::cout << "[----------------- End string test : ci_string -----------------]" << std::endl;
+}
+
 } // namespace string_test
 } // namespace test
 } // namespace mystl
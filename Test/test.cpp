@@ -17,8 +17,15 @@
 #include "stack_test.h"
 #include "map_test.h"
 #include "set_test.h"
+#include "btree_test.h"
 #include "unordered_map_test.h"
 #include "unordered_set_test.h"
+#include "flat_hash_map_test.h"
+#include "flat_hash_set_test.h"
+#include "robin_hood_map_test.h"
+#include "frozen_map_test.h"
+#include "filter_test.h"
+#include "concurrent_unordered_map_test.h"
 #include "string_test.h"
 #include "iterator_test.h"
 
@@ -41,11 +48,25 @@ int main()
   map_test::multimap_test();
   set_test::set_test();
   set_test::multiset_test();
+  btree_test::btree_map_test();
+  btree_test::btree_set_test();
   unordered_map_test::unordered_map_test();
   unordered_map_test::unordered_multimap_test();
   unordered_set_test::unordered_set_test();
   unordered_set_test::unordered_multiset_test();
+  flat_hash_map_test::flat_hash_map_test();
+  flat_hash_set_test::flat_hash_set_test();
+  robin_hood_map_test::robin_hood_map_test();
+  frozen_map_test::frozen_map_test();
+  frozen_map_test::frozen_set_test();
+  filter_test::bloom_filter_test();
+  filter_test::cuckoo_filter_test();
+  concurrent_unordered_map_test::concurrent_unordered_map_test();
   string_test::string_test();
+  string_test::string_pool_test();
+  string_test::utf8_test();
+  string_test::split_test();
+  string_test::ci_string_test();
 
 #if defined(_MSC_VER) && defined(_DEBUG)
   _CrtDumpMemoryLeaks();
@@ -711,6 +711,11 @@ void test_len(size_t len1, size_t len2, size_t len3, size_t wide)
 #define LARGER_TEST_DATA_ON 0
 #endif // !LARGER_TEST_DATA_ON
 
+// 是否在哈希表的性能测试之后输出 hashtable 的统计信息
+#ifndef HASHTABLE_STATS_ON
+#define HASHTABLE_STATS_ON 0
+#endif // !HASHTABLE_STATS_ON
+
 }    // namespace test
 }    // namespace mystl
 #endif // !MYTINYSTL_TEST_H_
@@ -3,8 +3,13 @@
 
 // unordered_map test : 测试 unordered_map, unordered_multimap 的接口与它们 insert 的性能
 
+#include <algorithm>
+#include <chrono>
 #include <unordered_map>
+#include <vector>
 
+#include "../MyTinySTL/astring.h"
+#include "../MyTinySTL/string_view.h"
 #include "../MyTinySTL/unordered_map.h"
 #include "map_test.h"
 #include "test.h"
@@ -16,6 +21,307 @@ namespace test
 namespace unordered_map_test
 {
 
+// 性能测试的统计信息钩子：HASHTABLE_STATS_ON 为 1 时，每项测试结束后记录 mystl 容器的 stats()，
+// 一组测试的结果输出之后再逐条打印。编译时定义 MYSTL_HASHTABLE_STATS 才有查找与比较的次数
+#if HASHTABLE_STATS_ON
+std::vector<std::string> ht_stats_log;
+
+// std 容器没有统计信息
+template <class Con>
+void ht_stats_record(const Con&)
+{
+}
+
+template <class K, class T, class H, class E, class P>
+void ht_stats_record(const mystl::unordered_map<K, T, H, E, P>& c)
+{
+  const auto s = c.stats();
+  const double lookups = s.lookups != 0 ? static_cast<double>(s.lookups) : 1.0;
+  char buf[256];
+  std::snprintf(buf, sizeof(buf),
+                " size %zu, buckets %zu (%zu empty), chain max %zu mean %.2f, rehash %zu,"
+                " bytes %zu + %zu, probes/lookup %.2f, compares/lookup %.2f\n",
+                s.size, s.bucket_count, s.empty_buckets, s.max_chain, s.mean_chain,
+                s.rehash_count, s.bucket_bytes, s.node_bytes,
+                s.probes / lookups, s.compares / lookups);
+  std::string line = buf;
+  line += " chain length histogram :";
+  for (size_t i = 0; i < mystl::ht_stats_bins; ++i)
+  {
+    std::snprintf(buf, sizeof(buf), " %zu%s:%zu", i, i + 1 == mystl::ht_stats_bins ? "+" : "",
+                  s.chain_hist[i]);
+    line += buf;
+  }
+  ht_stats_log.push_back(line);
+}
+
+#define HT_STATS_RECORD(c) ht_stats_record(c)
+#define HT_STATS_FLUSH() do {                                \
+  for (const auto& line : ht_stats_log)                      \
+    std::cout << line << "\n";                               \
+  ht_stats_log.clear();                                      \
+} while(0)
+#else
+#define HT_STATS_RECORD(c) ((void)0)
+#define HT_STATS_FLUSH()   ((void)0)
+#endif
+
+typedef mystl::unordered_map<mystl::string, int>         string_umap_type;
+typedef mystl::unordered_map<mystl::string, int, mystl::string_hash,
+  mystl::string_equal>                                    transparent_umap_type;
+
+// 以较长的字符串为键值插入 count 个元素，再遍历一遍，
+// 插入过程中的 rehash 与遍历时跨越 bucket 都要用到键值的哈希值
+#define STRING_KEY_DO_TEST(mode, count) do {                 \
+  srand((int)time(0));                                       \
+  clock_t start, end;                                        \
+  mode::unordered_map<mode::string, int> c;                  \
+  char buf[10];                                              \
+  char key[64];                                              \
+  volatile size_t total = 0;                                 \
+  start = clock();                                           \
+  for (size_t i = 0; i < count; ++i)                         \
+  {                                                          \
+    std::snprintf(key, sizeof(key),                          \
+                  "https://example.com/item/%d/detail", rand()); \
+    c.emplace(mode::string(key), static_cast<int>(i));       \
+  }                                                          \
+  for (int k = 0; k < 10; ++k)                               \
+    for (auto it = c.begin(); it != c.end(); ++it)           \
+      total += it->second;                                   \
+  end = clock();                                             \
+  (void)total;                                               \
+  HT_STATS_RECORD(c);                                        \
+  int n = static_cast<int>(static_cast<double>(end - start)  \
+      / CLOCKS_PER_SEC * 1000);                              \
+  std::snprintf(buf, sizeof(buf), "%d", n);                  \
+  std::string t = buf;                                       \
+  t += "ms    |";                                            \
+  std::cout << std::setw(WIDE) << t;                         \
+} while(0)
+
+#define STRING_KEY_TEST(len1, len2, len3)                    \
+  TEST_LEN(len1, len2, len3, WIDE);                          \
+  std::cout << "|         std         |";                    \
+  STRING_KEY_DO_TEST(std, len1);                             \
+  STRING_KEY_DO_TEST(std, len2);                             \
+  STRING_KEY_DO_TEST(std, len3);                             \
+  std::cout << "\n|        mystl        |";                  \
+  STRING_KEY_DO_TEST(mystl, len1);                           \
+  STRING_KEY_DO_TEST(mystl, len2);                           \
+  STRING_KEY_DO_TEST(mystl, len3);
+
+// 以长短不一的 URL 为键值插入 count 个元素，再把每个键值查找 5 次，主要开销在字符串的哈希上
+#define URL_FIND_DO_TEST(mode, count) do {                   \
+  srand((int)time(0));                                       \
+  clock_t start, end;                                        \
+  mode::unordered_map<mode::string, int> c;                  \
+  mode::vector<mode::string> keys;                           \
+  char buf[10];                                              \
+  char key[160];                                             \
+  volatile size_t total = 0;                                 \
+  for (size_t i = 0; i < count; ++i)                         \
+  {                                                          \
+    const int r = rand();                                    \
+    std::snprintf(key, sizeof(key),                          \
+                  "https://cdn%d.example.com/%s/%d?session=%x", \
+                  r % 8, "static/assets/images/thumbnails" + r % 24, \
+                  r, static_cast<unsigned>(i));              \
+    keys.push_back(mode::string(key));                       \
+    c.emplace(keys.back(), static_cast<int>(i));             \
+  }                                                          \
+  start = clock();                                           \
+  for (int k = 0; k < 5; ++k)                                \
+    for (size_t i = 0; i < count; ++i)                       \
+      total += c.find(keys[i]) != c.end();                   \
+  end = clock();                                             \
+  (void)total;                                               \
+  HT_STATS_RECORD(c);                                        \
+  int n = static_cast<int>(static_cast<double>(end - start)  \
+      / CLOCKS_PER_SEC * 1000);                              \
+  std::snprintf(buf, sizeof(buf), "%d", n);                  \
+  std::string t = buf;                                       \
+  t += "ms    |";                                            \
+  std::cout << std::setw(WIDE) << t;                         \
+} while(0)
+
+#define URL_FIND_TEST(len1, len2, len3)                      \
+  TEST_LEN(len1, len2, len3, WIDE);                          \
+  std::cout << "|         std         |";                    \
+  URL_FIND_DO_TEST(std, len1);                               \
+  URL_FIND_DO_TEST(std, len2);                               \
+  URL_FIND_DO_TEST(std, len3);                               \
+  std::cout << "\n|        mystl        |";                  \
+  URL_FIND_DO_TEST(mystl, len1);                             \
+  URL_FIND_DO_TEST(mystl, len2);                             \
+  URL_FIND_DO_TEST(mystl, len3);
+
+// 逐个插入 count 个元素，记录每次插入的耗时，输出 99.9 分位数与最长耗时（微秒），
+// 分位数反映一般的尾部延迟，一次性 rehash 的停顿体现在最长耗时里
+#define INSERT_LATENCY_DO_TEST(con, setup, len) do {         \
+  srand((int)time(0));                                       \
+  con c;                                                     \
+  setup;                                                     \
+  char buf[32];                                              \
+  std::vector<long long> ns(len);                            \
+  for (size_t i = 0; i < len; ++i)                           \
+  {                                                          \
+    const auto t0 = std::chrono::steady_clock::now();        \
+    c.emplace(rand(), static_cast<int>(i));                  \
+    const auto t1 = std::chrono::steady_clock::now();        \
+    ns[i] = std::chrono::duration_cast<                      \
+      std::chrono::nanoseconds>(t1 - t0).count();            \
+  }                                                          \
+  HT_STATS_RECORD(c);                                        \
+  const auto p999 = ns.begin() + ns.size() * 999 / 1000;     \
+  std::nth_element(ns.begin(), p999, ns.end());              \
+  const long long worst = *std::max_element(p999, ns.end()); \
+  std::snprintf(buf, sizeof(buf), "%.1f/%lldus |",           \
+    static_cast<double>(*p999) / 1000, worst / 1000);        \
+  std::string t = buf;                                       \
+  std::cout << std::setw(WIDE) << t;                         \
+} while(0)
+
+#define INSERT_LATENCY_TEST(len1, len2, len3)                \
+  TEST_LEN(len1, len2, len3, WIDE);                          \
+  std::cout << "|         std         |";                    \
+  INSERT_LATENCY_DO_TEST(std_map_type, (void)0, len1);       \
+  INSERT_LATENCY_DO_TEST(std_map_type, (void)0, len2);       \
+  INSERT_LATENCY_DO_TEST(std_map_type, (void)0, len3);       \
+  std::cout << "\n|        mystl        |";                  \
+  INSERT_LATENCY_DO_TEST(prime_map_type, (void)0, len1);     \
+  INSERT_LATENCY_DO_TEST(prime_map_type, (void)0, len2);     \
+  INSERT_LATENCY_DO_TEST(prime_map_type, (void)0, len3);     \
+  std::cout << "\n|  mystl incremental  |";                  \
+  INSERT_LATENCY_DO_TEST(prime_map_type, c.incremental_rehash(true), len1); \
+  INSERT_LATENCY_DO_TEST(prime_map_type, c.incremental_rehash(true), len2); \
+  INSERT_LATENCY_DO_TEST(prime_map_type, c.incremental_rehash(true), len3);
+
+// 插入 count 个整数键值后逐个查找，比较不同 bucket 策略把哈希值映射到 bucket 的开销
+#define BUCKET_POLICY_DO_TEST(con, count) do {               \
+  srand((int)time(0));                                       \
+  clock_t start, end;                                        \
+  con c;                                                     \
+  char buf[10];                                              \
+  volatile size_t total = 0;                                 \
+  start = clock();                                           \
+  for (size_t i = 0; i < count; ++i)                         \
+    c.emplace(rand(), static_cast<int>(i));                  \
+  for (size_t i = 0; i < count; ++i)                         \
+    total += c.find(rand()) != c.end();                      \
+  end = clock();                                             \
+  (void)total;                                               \
+  HT_STATS_RECORD(c);                                        \
+  int n = static_cast<int>(static_cast<double>(end - start)  \
+      / CLOCKS_PER_SEC * 1000);                              \
+  std::snprintf(buf, sizeof(buf), "%d", n);                  \
+  std::string t = buf;                                       \
+  t += "ms    |";                                            \
+  std::cout << std::setw(WIDE) << t;                         \
+} while(0)
+
+typedef std::unordered_map<int, int>                         std_map_type;
+typedef mystl::unordered_map<int, int>                       prime_map_type;
+typedef mystl::unordered_map<int, int, mystl::hash<int>, mystl::equal_to<int>,
+  mystl::ht_power2_policy>                                   power2_map_type;
+
+#define BUCKET_POLICY_TEST(len1, len2, len3)                 \
+  TEST_LEN(len1, len2, len3, WIDE);                          \
+  std::cout << "|         std         |";                    \
+  BUCKET_POLICY_DO_TEST(std_map_type, len1);                 \
+  BUCKET_POLICY_DO_TEST(std_map_type, len2);                 \
+  BUCKET_POLICY_DO_TEST(std_map_type, len3);                 \
+  std::cout << "\n|     mystl prime     |";                  \
+  BUCKET_POLICY_DO_TEST(prime_map_type, len1);               \
+  BUCKET_POLICY_DO_TEST(prime_map_type, len2);               \
+  BUCKET_POLICY_DO_TEST(prime_map_type, len3);               \
+  std::cout << "\n|    mystl power2     |";                  \
+  BUCKET_POLICY_DO_TEST(power2_map_type, len1);              \
+  BUCKET_POLICY_DO_TEST(power2_map_type, len2);              \
+  BUCKET_POLICY_DO_TEST(power2_map_type, len3);
+
+// bucket 很多而元素很少时反复插入、遍历、清空，遍历与 clear 的开销只与元素个数有关
+#define SPARSE_SCAN_DO_TEST(con, count) do {                 \
+  srand((int)time(0));                                       \
+  clock_t start, end;                                        \
+  con c;                                                     \
+  c.reserve(count);                                          \
+  char buf[10];                                              \
+  volatile long long total = 0;                              \
+  start = clock();                                           \
+  for (int round = 0; round < 1000; ++round)                 \
+  {                                                          \
+    for (int i = 0; i < 8; ++i)                              \
+      c.emplace(rand(), i);                                  \
+    for (auto it = c.begin(); it != c.end(); ++it)           \
+      total += it->second;                                   \
+    c.clear();                                               \
+  }                                                          \
+  end = clock();                                             \
+  (void)total;                                               \
+  int n = static_cast<int>(static_cast<double>(end - start)  \
+      / CLOCKS_PER_SEC * 1000);                              \
+  std::snprintf(buf, sizeof(buf), "%d", n);                  \
+  std::string t = buf;                                       \
+  t += "ms    |";                                            \
+  std::cout << std::setw(WIDE) << t;                         \
+} while(0)
+
+#define SPARSE_SCAN_TEST(len1, len2, len3)                   \
+  TEST_LEN(len1, len2, len3, WIDE);                          \
+  std::cout << "|         std         |";                    \
+  SPARSE_SCAN_DO_TEST(std_map_type, len1);                   \
+  SPARSE_SCAN_DO_TEST(std_map_type, len2);                   \
+  SPARSE_SCAN_DO_TEST(std_map_type, len3);                   \
+  std::cout << "\n|        mystl        |";                  \
+  SPARSE_SCAN_DO_TEST(prime_map_type, len1);                 \
+  SPARSE_SCAN_DO_TEST(prime_map_type, len2);                 \
+  SPARSE_SCAN_DO_TEST(prime_map_type, len3);
+
+// 插入 count 个偶数键值后（不计时）查找 count 个随机键值，约一半命中，batch 为 true 时用 find_batch
+// 数据量最大的一列要超过末级缓存，才能看出预取的效果
+#define BATCH_FIND_DO_TEST(batch, count) do {                \
+  srand((int)time(0));                                       \
+  clock_t start, end;                                        \
+  prime_map_type c;                                          \
+  char buf[10];                                              \
+  for (size_t i = 0; i < count; ++i)                         \
+    c.emplace(static_cast<int>(i * 2), static_cast<int>(i)); \
+  mystl::vector<int> keys;                                   \
+  for (size_t i = 0; i < count; ++i)                         \
+    keys.push_back(static_cast<int>(rand() % (count * 2)));  \
+  mystl::vector<prime_map_type::iterator> out(count);        \
+  start = clock();                                           \
+  if (batch)                                                 \
+  {                                                          \
+    c.find_batch(keys.begin(), keys.end(), out.begin());     \
+  }                                                          \
+  else                                                       \
+  {                                                          \
+    for (size_t i = 0; i < count; ++i)                       \
+      out[i] = c.find(keys[i]);                              \
+  }                                                          \
+  end = clock();                                             \
+  HT_STATS_RECORD(c);                                        \
+  int n = static_cast<int>(static_cast<double>(end - start)  \
+      / CLOCKS_PER_SEC * 1000);                              \
+  std::snprintf(buf, sizeof(buf), "%d", n);                  \
+  std::string t = buf;                                       \
+  t += "ms    |";                                            \
+  std::cout << std::setw(WIDE) << t;                         \
+} while(0)
+
+#define BATCH_FIND_TEST(len1, len2, len3)                    \
+  TEST_LEN(len1, len2, len3, WIDE);                          \
+  std::cout << "|     mystl find      |";                    \
+  BATCH_FIND_DO_TEST(false, len1);                           \
+  BATCH_FIND_DO_TEST(false, len2);                           \
+  BATCH_FIND_DO_TEST(false, len3);                           \
+  std::cout << "\n|  mystl find_batch   |";                  \
+  BATCH_FIND_DO_TEST(true, len1);                            \
+  BATCH_FIND_DO_TEST(true, len2);                            \
+  BATCH_FIND_DO_TEST(true, len3);
+
 void unordered_map_test()
 {
   std::cout << "[===============================================================]" << std::endl;
@@ -90,6 +396,70 @@ void unordered_map_test()
   FUN_VALUE(um1.max_load_factor());
   MAP_FUN_AFTER(um1, um1.max_load_factor(1.5f));
   FUN_VALUE(um1.max_load_factor());
+  try
+  {
+    um1.max_load_factor(0.0f);
+  }
+  catch (const std::out_of_range& e)
+  {
+    FUN_VALUE(e.what());
+  }
+  FUN_VALUE(um1.max_load_factor());
+  std::cout << std::boolalpha;
+  FUN_VALUE(um1.incremental_rehash());
+  MAP_FUN_AFTER(um1, um1.incremental_rehash(true));
+  FUN_VALUE(um1.incremental_rehash());
+  std::cout << std::noboolalpha;
+  for (int i = 10; i < 3000; ++i)
+    um1.emplace(i, i);
+  FUN_VALUE(um1.size());
+  FUN_VALUE(um1.bucket_count());
+  FUN_VALUE(um1.count(2000));
+  transparent_umap_type su;
+  su.emplace(mystl::string("apple"), 1);
+  su.emplace(mystl::string("banana"), 2);
+  MAP_VALUE(*su.find("banana"));
+  FUN_VALUE(su.count(mystl::string_view("apple")));
+  FUN_VALUE(su.count("cherry"));
+  MAP_FUN_AFTER(um4, um4.try_emplace(1, 1));
+  MAP_FUN_AFTER(um4, um4.try_emplace(1, 10));
+  MAP_FUN_AFTER(um4, um4.insert_or_assign(1, 10));
+  MAP_FUN_AFTER(um4, um4.insert_or_assign(2, 2));
+  auto nh = um4.extract(1);
+  nh.key() = 3;
+  MAP_FUN_AFTER(um4, um4.insert(mystl::move(nh)));
+  MAP_FUN_AFTER(um4, um4.merge(um13));
+  // 被移动过的 um5 没有 bucket，仍然可以插入
+  MAP_FUN_AFTER(um5, um5.emplace(1, 1));
+  MAP_FUN_AFTER(um5, um5[2] = 2);
+  MAP_FUN_AFTER(um5, um5.try_emplace(3, 3));
+  MAP_FUN_AFTER(um6, um6.insert_or_assign(4, 4));
+  FUN_VALUE(um5.max_load_factor());
+  // 被移动过的表格也可以查找、插入句柄与合并
+  mystl::unordered_map<int, int> um16{ PAIR(1, 1), PAIR(2, 2) };
+  mystl::unordered_map<int, int> um17(std::move(um16));
+  mystl::unordered_map<int, int> um18(std::move(um17));
+  FUN_VALUE(um16.count(1));
+  MAP_FUN_AFTER(um16, um16.insert(um18.extract(1)));
+  MAP_FUN_AFTER(um17, um17.merge(um18));
+  mystl::unordered_map<int, int> um15;
+  int keys[] = { 1,3,5,7,9 };
+  MAP_FUN_AFTER(um15, um15.insert_batch(v.begin(), v.end()));
+  mystl::vector<mystl::unordered_map<int, int>::iterator> found(5);
+  um15.find_batch(keys, keys + 5, found.begin());
+  for (auto it : found)
+  {
+    if (it != um15.end())
+      std::cout << " <" << it->first << "," << it->second << ">";
+  }
+  std::cout << std::endl;
+  mystl::vector<size_t> counts(5);
+  um15.count_batch(keys, keys + 5, counts.begin());
+  COUT(counts);
+  FUN_VALUE(um15.stats().size);
+  FUN_VALUE(um15.stats().empty_buckets);
+  FUN_VALUE(um15.stats().max_chain);
+  FUN_VALUE(um15.stats().rehash_count);
   PASSED;
 #if PERFORMANCE_TEST_ON
   std::cout << "[--------------------- Performance Testing ---------------------]" << std::endl;
@@ -101,6 +471,90 @@ void unordered_map_test()
   MAP_EMPLACE_TEST(unordered_map, SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
 #endif
   std::cout << std::endl;
+  HT_STATS_FLUSH();
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "| string key and scan |";
+#if LARGER_TEST_DATA_ON
+  STRING_KEY_TEST(SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  STRING_KEY_TEST(SCALE_SS(LEN1), SCALE_SS(LEN2), SCALE_SS(LEN3));
+#endif
+  std::cout << std::endl;
+  HT_STATS_FLUSH();
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|    url key find     |";
+#if LARGER_TEST_DATA_ON
+  URL_FIND_TEST(SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  URL_FIND_TEST(SCALE_SS(LEN1), SCALE_SS(LEN2), SCALE_SS(LEN3));
+#endif
+  std::cout << std::endl;
+  HT_STATS_FLUSH();
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "| find by const char* |";
+#if LARGER_TEST_DATA_ON
+  TRANSPARENT_FIND_TEST(string_umap_type, transparent_umap_type,
+                        SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  TRANSPARENT_FIND_TEST(string_umap_type, transparent_umap_type,
+                        SCALE_SS(LEN1), SCALE_SS(LEN2), SCALE_SS(LEN3));
+#endif
+  std::cout << std::endl;
+  HT_STATS_FLUSH();
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "| insert p99.9 / max  |";
+#if LARGER_TEST_DATA_ON
+  INSERT_LATENCY_TEST(SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  INSERT_LATENCY_TEST(SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  HT_STATS_FLUSH();
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|   emplace and find  |";
+#if LARGER_TEST_DATA_ON
+  BUCKET_POLICY_TEST(SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  BUCKET_POLICY_TEST(SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  HT_STATS_FLUSH();
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "| update existing key |";
+#if LARGER_TEST_DATA_ON
+  DUP_UPDATE_TEST(std_map_type, prime_map_type, SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  DUP_UPDATE_TEST(std_map_type, prime_map_type, SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  HT_STATS_FLUSH();
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "| sparse scan, clear  |";
+#if LARGER_TEST_DATA_ON
+  SPARSE_SCAN_TEST(SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  SPARSE_SCAN_TEST(SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  HT_STATS_FLUSH();
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|  batched find big   |";
+#if LARGER_TEST_DATA_ON
+  BATCH_FIND_TEST(SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  BATCH_FIND_TEST(SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  HT_STATS_FLUSH();
+  std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
+  std::cout << "|  move all elements  |";
+#if LARGER_TEST_DATA_ON
+  MOVE_NODE_TEST(prime_map_type, SCALE_M(LEN1), SCALE_M(LEN2), SCALE_M(LEN3));
+#else
+  MOVE_NODE_TEST(prime_map_type, SCALE_S(LEN1), SCALE_S(LEN2), SCALE_S(LEN3));
+#endif
+  std::cout << std::endl;
+  HT_STATS_FLUSH();
   std::cout << "|---------------------|-------------|-------------|-------------|" << std::endl;
   PASSED;
 #endif
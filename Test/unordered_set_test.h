@@ -58,6 +58,12 @@ void unordered_set_test()
   FUN_VALUE(us1.bucket_size(us1.bucket(5)));
   FUN_AFTER(us1, us1.clear());
   FUN_AFTER(us1, us1.swap(us7));
+  FUN_AFTER(us1, us1.insert(us1.extract(us1.begin())));
+  FUN_AFTER(us1, us1.merge(us13));
+  // 被移动过的 us5、us6 没有 bucket，仍然可以查找、插入句柄与合并
+  FUN_VALUE(us5.count(1));
+  FUN_AFTER(us5, us5.insert(us10.extract(1)));
+  FUN_AFTER(us6, us6.merge(us10));
   FUN_VALUE(*us1.begin());
   std::cout << std::boolalpha;
   FUN_VALUE(us1.empty());
@@ -142,6 +148,12 @@ void unordered_multiset_test()
   FUN_VALUE(us1.bucket_size(us1.bucket(5)));
   FUN_AFTER(us1, us1.clear());
   FUN_AFTER(us1, us1.swap(us7));
+  FUN_AFTER(us1, us1.insert(us1.extract(us1.begin())));
+  FUN_AFTER(us1, us1.merge(us13));
+  // 被移动过的 us5、us6 没有 bucket，仍然可以查找、插入句柄与合并
+  FUN_VALUE(us5.count(1));
+  FUN_AFTER(us5, us5.insert(us10.extract(1)));
+  FUN_AFTER(us6, us6.merge(us10));
   FUN_VALUE(*us1.begin());
   std::cout << std::boolalpha;
   FUN_VALUE(us1.empty());